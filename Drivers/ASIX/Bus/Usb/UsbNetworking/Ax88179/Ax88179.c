@@ -515,7 +515,10 @@ Ax88179Reset (
 
   if (EFI_ERROR(Status)) goto err;
 
-  Val = 12; //AX88179_BULKIN_SIZE_INK - 1;
+  //
+  //  The aggregated frame is (RXBINQSIZE + 2) KB at most
+  //
+  Val = AX88179_BULKIN_SIZE_INK - 2;
   Status =  Ax88179MacWrite (RXBINQSIZE,
                               0x01,
                               NicDevice,
@@ -529,6 +532,14 @@ Ax88179Reset (
                               NicDevice,
                               &Val);
 
+  //
+  //  PHYPWRRSTCTL was rewritten above, so the zero length packet needs to be
+  //  armed again before the next bulk in, and anything queued is stale
+  //
+  NicDevice->SetZeroLen = TRUE;
+  NicDevice->RxQueueHead = 0;
+  NicDevice->RxQueueCount = 0;
+
 err:
   return Status;
 }
@@ -934,109 +945,150 @@ Ax88179GetLinkStatus (
 
 }
 
+/**
+  Split an aggregated bulk-in frame into the receive queue
+
+  The frame holds the packets, each preceded by 2 bytes of 0xEEEE and padded
+  to 8 bytes, followed by one 4 byte header per packet and a 4 byte trailer
+  giving the packet count and the offset of the headers.
+
+  @param [in] NicDevice       Pointer to the NIC_DEVICE structure
+  @param [in] LengthInBytes   Number of bytes received in BulkInbuf
+
+  @retval TRUE                The frame was well formed.
+  @retval FALSE               The frame could not be parsed.
+
+**/
+STATIC
+BOOLEAN
+Ax88179RxQueueFill (
+  IN NIC_DEVICE *NicDevice,
+  IN UINTN      LengthInBytes
+  )
+{
+  UINT16  PktCnt;
+  UINT16  HdrOff;
+  UINT16  PktLen;
+  UINT16  Index;
+  UINT8   *PktHdr;
+  UINT8   *Pkt;
+  UINT8   *End;
+
+  if (LengthInBytes < 4) {
+    return FALSE;
+  }
+
+  PktCnt = *((UINT16 *) (NicDevice->BulkInbuf + LengthInBytes - 4));
+  HdrOff = *((UINT16 *) (NicDevice->BulkInbuf + LengthInBytes - 2));
+
+  if (((UINTN)(((PktCnt * 4 + 4 + 7) & 0xfff8) + HdrOff)) != LengthInBytes) {
+    return FALSE;
+  }
+
+  PktHdr = NicDevice->BulkInbuf + HdrOff;
+  Pkt = NicDevice->BulkInbuf;
+  End = PktHdr;
+
+  for (Index = 0; Index < PktCnt; Index++, PktHdr += 4) {
+    PktLen = *((UINT16 *) (PktHdr + 2));
+    if ((Pkt + (PktLen & 0x1fff)) > End) {
+      break;
+    }
+
+    //
+    //  Bad packets are dropped here, good ones are queued in place
+    //
+    if (((PktLen & (RXHDR_DROP | RXHDR_CRCERR)) == 0) &&
+        (60 <= (PktLen & 0x1fff) - 2) &&
+        (((PktLen & 0x1fff) - 2 - 14) <= MAX_ETHERNET_PKT_SIZE) &&
+        (*((UINT16 *) Pkt)) == 0xEEEE &&
+        NicDevice->RxQueueCount < AX88179_RX_QUEUE_SIZE) {
+      NicDevice->RxQueue[NicDevice->RxQueueCount].Data = Pkt + 2;
+      NicDevice->RxQueue[NicDevice->RxQueueCount].Length = (PktLen & 0x1fff) - 2;
+      NicDevice->RxQueueCount++;
+    }
+
+    Pkt += ((PktLen & 0x1fff) + 7) & 0xfff8;
+  }
+
+  return TRUE;
+}
+
+/**
+  Receive the next aggregated frame and queue its packets
+
+  The chip aggregates up to AX88179_MAX_BULKIN_SIZE bytes of packets into one
+  bulk-in frame, terminated by a short or zero length packet, so a single
+  transfer fetches all of them.
+
+  @param [in] NicDevice       Pointer to the NIC_DEVICE structure
+
+  @retval EFI_SUCCESS         At least one packet was queued.
+  @retval EFI_NOT_READY       No packet is available.
+
+**/
 EFI_STATUS
 Ax88179BulkIn(
   IN NIC_DEVICE *NicDevice
 )
 {
-  int i;
-  UINT16  Val;
-  UINTN               LengthInBytes = 0;
-  UINTN               TmpLen = AX88179_MAX_BULKIN_SIZE;
-  UINTN               CURBufSize = AX88179_MAX_BULKIN_SIZE;
-  UINTN               PREBufSize = 0;
-  EFI_STATUS          Status = EFI_NOT_READY;
+  UINT16              Val;
+  UINTN               LengthInBytes;
+  EFI_STATUS          Status;
   EFI_USB_IO_PROTOCOL *UsbIo;
-  UINT32 TransferStatus;
+  UINT32              TransferStatus;
 
   NicDevice->SkipRXCnt = 0;
+  NicDevice->RxQueueHead = 0;
+  NicDevice->RxQueueCount = 0;
 
   UsbIo = NicDevice->UsbIo;
-  for (i = 0 ; i < (AX88179_MAX_BULKIN_SIZE / 512) && UsbIo != NULL; i++) {
-    VOID* TmpAddr = 0;
-
-    if (NicDevice->SetZeroLen) {
-      Val =  PHYPWRRSTCTL_IPRL | PHYPWRRSTCTL_BZ;
-      Status = Ax88179MacWrite (PHYPWRRSTCTL,
-                                 sizeof (Val),
-                                 NicDevice,
-                                 &Val);
-      if (EFI_ERROR(Status)) {
-        LengthInBytes = 0;
-        Status = EFI_NOT_READY;
-        goto no_pkt;
-      }
-      NicDevice->SetZeroLen = FALSE;
-    }
-    TmpAddr = (VOID*) &NicDevice->BulkInbuf[LengthInBytes];
-
-    Status =  EFI_NOT_READY;
-    Status = UsbIo->UsbBulkTransfer (UsbIo,
-                          USB_ENDPOINT_DIR_IN | BULK_IN_ENDPOINT,
-                          TmpAddr,
-                          &TmpLen,
-                          BULKIN_TIMEOUT,
-                          &TransferStatus);
-
-    if ((!EFI_ERROR (Status)) && (!EFI_ERROR (TransferStatus)) && TmpLen != 0) {
-      LengthInBytes += TmpLen;
-      if ((TmpLen % NicDevice->UsbMaxPktSize) != 0) {
-        goto done;
-      }
-      CURBufSize = CURBufSize - TmpLen;
-      TmpLen = CURBufSize;
-      NicDevice->SetZeroLen = TRUE;
-    } else if ((!EFI_ERROR (Status)) &&
-               (!EFI_ERROR (TransferStatus)) &&
-               (TmpLen == 0) &&
-               LengthInBytes) {
-      if (PREBufSize == CURBufSize) {
-        goto done;
-      }
-      TmpLen = CURBufSize;
-      PREBufSize = CURBufSize;
-      NicDevice->SetZeroLen = TRUE;
-    } else if ((!EFI_ERROR (Status)) &&
-               (!EFI_ERROR (TransferStatus)) &&
-               (TmpLen == 0)) {
-      NicDevice->SetZeroLen = TRUE;
-      LengthInBytes = 0;
-      Status = EFI_NOT_READY;
-      goto done;
-    } else if (EFI_TIMEOUT == Status && EFI_USB_ERR_TIMEOUT == TransferStatus) {
-      NicDevice->SetZeroLen = TRUE;
-      LengthInBytes = 0;
-      Status = EFI_NOT_READY;
-      goto done;
-    } else {
-      NicDevice->SetZeroLen = TRUE;
-      LengthInBytes = 0;
-      Status = EFI_NOT_READY;
-      goto done;
-    }
+  if (UsbIo == NULL) {
+    return EFI_NOT_READY;
   }
 
-done:
-  if (LengthInBytes != 0) {
-    UINT16 tmplen = 0;
-    UINT16 TmpPktCnt = 0;
-
-    TmpPktCnt = *((UINT16 *) (NicDevice->BulkInbuf + LengthInBytes - 4));
-    tmplen =  *((UINT16*) (NicDevice->BulkInbuf + LengthInBytes - 2));
-
-    if (((UINTN)(((TmpPktCnt * 4 + 4 + 7) & 0xfff8) + tmplen)) == LengthInBytes) {
-      NicDevice->PktCnt = TmpPktCnt;
-      NicDevice->CurPktHdrOff = NicDevice->BulkInbuf + tmplen;
-      NicDevice->CurPktOff = NicDevice->BulkInbuf;
-      *((UINT16 *) (NicDevice->BulkInbuf + LengthInBytes - 4)) = 0;
-      *((UINT16*) (NicDevice->BulkInbuf + LengthInBytes - 2)) = 0;
-      Status = EFI_SUCCESS;
-    } else {
-      Status = EFI_NOT_READY;
+  //
+  //  The zero length packet terminating frames that end on a packet
+  //  boundary is only armed at start of day, or after a frame that could
+  //  not be parsed, not on every transfer.
+  //
+  if (NicDevice->SetZeroLen) {
+    Val =  PHYPWRRSTCTL_IPRL | PHYPWRRSTCTL_BZ;
+    Status = Ax88179MacWrite (PHYPWRRSTCTL,
+                               sizeof (Val),
+                               NicDevice,
+                               &Val);
+    if (EFI_ERROR(Status)) {
+      return EFI_NOT_READY;
     }
-  } else {
-    Status = EFI_NOT_READY;
+    NicDevice->SetZeroLen = FALSE;
+  }
+
+  LengthInBytes = AX88179_MAX_BULKIN_SIZE;
+  Status = UsbIo->UsbBulkTransfer (UsbIo,
+                        USB_ENDPOINT_DIR_IN | BULK_IN_ENDPOINT,
+                        NicDevice->BulkInbuf,
+                        &LengthInBytes,
+                        BULKIN_TIMEOUT,
+                        &TransferStatus);
+
+  if (EFI_TIMEOUT == Status && EFI_USB_ERR_TIMEOUT == TransferStatus) {
+    return EFI_NOT_READY;
+  }
+
+  if (EFI_ERROR (Status) || EFI_ERROR (TransferStatus)) {
+    NicDevice->SetZeroLen = TRUE;
+    return EFI_NOT_READY;
+  }
+
+  if (LengthInBytes == 0) {
+    return EFI_NOT_READY;
+  }
+
+  if (!Ax88179RxQueueFill (NicDevice, LengthInBytes)) {
+    NicDevice->SetZeroLen = TRUE;
+    return EFI_NOT_READY;
   }
-no_pkt:
-   return Status;
+
+  return (NicDevice->RxQueueCount != 0) ? EFI_SUCCESS : EFI_NOT_READY;
 }
@@ -69,8 +69,9 @@
 #define USB_NETWORK_CLASS   0x09    ///<  USB Network class code
 #define USB_BUS_TIMEOUT     1000    ///<  USB timeout in milliseconds
 
-#define AX88179_BULKIN_SIZE_INK     2
+#define AX88179_BULKIN_SIZE_INK     24
 #define AX88179_MAX_BULKIN_SIZE    (1024 * AX88179_BULKIN_SIZE_INK)
+#define AX88179_RX_QUEUE_SIZE      (AX88179_MAX_BULKIN_SIZE / 64) ///<  Smallest frame takes 64 bytes of the bulk-in buffer
 #define AX88179_MAX_PKT_SIZE  2048
 
 #define HC_DEBUG        0
@@ -234,6 +235,14 @@ typedef struct _RX_PACKET {
 } RX_PACKET;
 #pragma pack()
 
+///
+///  Received frame within the bulk-in buffer
+///
+typedef struct {
+  UINT8             *Data;                    ///<  Start of the Ethernet header
+  UINT16            Length;                   ///<  Frame length in bytes
+} RX_QUEUE_ENTRY;
+
 /**
   AX88179 control structure
 
@@ -275,9 +284,9 @@ typedef struct {
   UINTN                     SkipRXCnt;
 
   UINT8                     *BulkInbuf;
-  UINT16                    PktCnt;
-  UINT8                     *CurPktHdrOff;
-  UINT8                     *CurPktOff;
+  RX_QUEUE_ENTRY            RxQueue[AX88179_RX_QUEUE_SIZE]; ///<  Frames split out of the last bulk-in transfer
+  UINTN                     RxQueueHead;        ///<  Next frame to hand to Receive
+  UINTN                     RxQueueCount;       ///<  Frames left in RxQueue
 
   TX_PACKET                 *TxTest;
 
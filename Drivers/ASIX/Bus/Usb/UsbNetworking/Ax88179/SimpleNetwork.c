@@ -527,8 +527,7 @@ SN_Receive (
   NIC_DEVICE              *NicDevice;
   EFI_STATUS              Status;
   UINT16                  Type = 0;
-  UINT16                  CurrentPktLen;
-  BOOLEAN                 Valid = TRUE;
+  RX_QUEUE_ENTRY          *Entry;
   EFI_TPL                 TplPrevious;
 
   TplPrevious = gBS->RaiseTPL (TPL_CALLBACK);
@@ -563,54 +562,43 @@ SN_Receive (
         }
 
         //
-        //  Attempt to do bulk in
+        //  Refill the receive queue from the next bulk in frame once it
+        //  has been drained
         //
-        if (NicDevice->PktCnt == 0) {
+        if (NicDevice->RxQueueCount == 0) {
           Status = Ax88179BulkIn(NicDevice);
           if (EFI_ERROR(Status))
             goto  no_pkt;
         }
-        CurrentPktLen = *((UINT16*) (NicDevice->CurPktHdrOff + 2));
-        if (CurrentPktLen & (RXHDR_DROP | RXHDR_CRCERR))
-          Valid = FALSE;
-        CurrentPktLen &=  0x1fff;
-        CurrentPktLen -= 2; /*EEEE*/
-
-        if (Valid && (60 <= CurrentPktLen) &&
-        ((CurrentPktLen - 14) <= MAX_ETHERNET_PKT_SIZE) &&
-            (*((UINT16*)NicDevice->CurPktOff)) == 0xEEEE) {
-          if (*BufferSize < (UINTN)CurrentPktLen) {
-            gBS->RestoreTPL (TplPrevious);
-            return EFI_BUFFER_TOO_SMALL;
-          }
-          *BufferSize = CurrentPktLen;
-          CopyMem (Buffer, NicDevice->CurPktOff + 2, CurrentPktLen);
+        Entry = &NicDevice->RxQueue[NicDevice->RxQueueHead];
 
-          Header = (ETHERNET_HEADER *) NicDevice->CurPktOff + 2;
+        if (*BufferSize < (UINTN)Entry->Length) {
+          gBS->RestoreTPL (TplPrevious);
+          return EFI_BUFFER_TOO_SMALL;
+        }
+        *BufferSize = Entry->Length;
+        CopyMem (Buffer, Entry->Data, Entry->Length);
 
-          if ((HeaderSize != NULL)  && ((*HeaderSize != 7720))) {
-            *HeaderSize = sizeof (*Header);
-          }
+        Header = (ETHERNET_HEADER *) Entry->Data;
 
-          if (DestAddr != NULL) {
-            CopyMem (DestAddr, &Header->DestAddr, PXE_HWADDR_LEN_ETHER);
-          }
-          if (SrcAddr != NULL) {
-            CopyMem (SrcAddr, &Header->SrcAddr, PXE_HWADDR_LEN_ETHER);
-          }
-          if (Protocol != NULL) {
-            Type = Header->Type;
-            Type = (UINT16)((Type >> 8) | (Type << 8));
-            *Protocol = Type;
-          }
-          NicDevice->PktCnt--;
-          NicDevice->CurPktHdrOff += 4;
-          NicDevice->CurPktOff += (CurrentPktLen + 2 + 7) & 0xfff8;
-          Status = EFI_SUCCESS;
-        } else {
-          NicDevice->PktCnt = 0;
-          Status = EFI_NOT_READY;
+        if ((HeaderSize != NULL)  && ((*HeaderSize != 7720))) {
+          *HeaderSize = sizeof (*Header);
+        }
+
+        if (DestAddr != NULL) {
+          CopyMem (DestAddr, &Header->DestAddr, PXE_HWADDR_LEN_ETHER);
         }
+        if (SrcAddr != NULL) {
+          CopyMem (SrcAddr, &Header->SrcAddr, PXE_HWADDR_LEN_ETHER);
+        }
+        if (Protocol != NULL) {
+          Type = Header->Type;
+          Type = (UINT16)((Type >> 8) | (Type << 8));
+          *Protocol = Type;
+        }
+        NicDevice->RxQueueHead++;
+        NicDevice->RxQueueCount--;
+        Status = EFI_SUCCESS;
       } else {
         Status = EFI_NOT_READY;
       }
@@ -967,7 +955,8 @@ SN_Setup (
   NicDevice->LinkUp = FALSE;
   NicDevice->Grub_f = FALSE;
   NicDevice->FirstRst = TRUE;
-  NicDevice->PktCnt = 0;
+  NicDevice->RxQueueHead = 0;
+  NicDevice->RxQueueCount = 0;
   NicDevice->SkipRXCnt = 0;
   NicDevice->UsbMaxPktSize = 512;
   NicDevice->SetZeroLen = TRUE;
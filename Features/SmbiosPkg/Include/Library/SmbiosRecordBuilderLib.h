@@ -0,0 +1,155 @@
+/** @file
+  SMBIOS record builder library.
+
+  Collects the SMBIOS records of a platform driver together with their
+  strings, sizes them once, emits them into a single contiguous buffer and
+  adds them to the SMBIOS table in one pass. Identical strings are stored
+  once in a shared string pool. Records may refer to the handles of records
+  added before them; those handles are patched in at install time.
+
+  Copyright (c) 2026, Arm Limited. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _SMBIOS_RECORD_BUILDER_LIB_H_
+#define _SMBIOS_RECORD_BUILDER_LIB_H_
+
+#include <IndustryStandard/SmBios.h>
+
+typedef struct _SMBIOS_RECORD_BUILDER SMBIOS_RECORD_BUILDER;
+
+/**
+  Create an empty SMBIOS record builder.
+
+  @param[out] Builder           On return, the new builder.
+
+  @retval EFI_SUCCESS           The builder was created.
+  @retval EFI_INVALID_PARAMETER Builder is NULL.
+  @retval EFI_OUT_OF_RESOURCES  Not enough memory for the builder.
+**/
+EFI_STATUS
+EFIAPI
+SmbiosBuilderCreate (
+  OUT SMBIOS_RECORD_BUILDER  **Builder
+  );
+
+/**
+  Add a record to the builder.
+
+  The formatted area of Template and the strings are copied, so the caller
+  may modify or release them once this function returns. The handle in the
+  template header is passed to the SMBIOS protocol unchanged, so it may be
+  either a fixed handle or SMBIOS_HANDLE_PI_RESERVED.
+
+  @param[in]  Builder           The builder.
+  @param[in]  Template          The formatted area of the record.
+  @param[in]  Strings           A NULL terminated array of the record strings,
+                                in string number order. May be NULL if the
+                                record has no strings.
+  @param[out] RecordIndex       On return, the index of the record within the
+                                builder. Optional.
+
+  @retval EFI_SUCCESS           The record was added.
+  @retval EFI_INVALID_PARAMETER Builder or Template is NULL, or the template
+                                length is invalid.
+  @retval EFI_ALREADY_STARTED   The builder has already been installed.
+  @retval EFI_OUT_OF_RESOURCES  Not enough memory for the record.
+**/
+EFI_STATUS
+EFIAPI
+SmbiosBuilderAddRecord (
+  IN  SMBIOS_RECORD_BUILDER    *Builder,
+  IN  CONST SMBIOS_STRUCTURE   *Template,
+  IN  CONST CHAR8 * CONST      *Strings OPTIONAL,
+  OUT UINTN                    *RecordIndex OPTIONAL
+  );
+
+/**
+  Make a handle field of a record refer to another record.
+
+  When the builder is installed, the handle assigned to the target record is
+  written to the field at FieldOffset in the referring record. The target
+  must have been added before the referring record.
+
+  @param[in]  Builder           The builder.
+  @param[in]  RecordIndex       The index of the referring record.
+  @param[in]  FieldOffset       The offset of the SMBIOS_HANDLE field within
+                                the formatted area of the referring record.
+  @param[in]  TargetIndex       The index of the record being referred to.
+
+  @retval EFI_SUCCESS           The reference was recorded.
+  @retval EFI_INVALID_PARAMETER Builder is NULL, an index is out of range, the
+                                target was not added before the referring
+                                record, or the field lies outside the
+                                formatted area.
+  @retval EFI_ALREADY_STARTED   The builder has already been installed.
+  @retval EFI_OUT_OF_RESOURCES  Not enough memory for the reference.
+**/
+EFI_STATUS
+EFIAPI
+SmbiosBuilderLinkHandle (
+  IN SMBIOS_RECORD_BUILDER  *Builder,
+  IN UINTN                  RecordIndex,
+  IN UINTN                  FieldOffset,
+  IN UINTN                  TargetIndex
+  );
+
+/**
+  Add all records of the builder to the SMBIOS table.
+
+  Records are added in the order they were added to the builder. A record
+  the SMBIOS protocol rejects is skipped, and references to it are left as
+  they were in its template; the remaining records are still added.
+
+  @param[in]  Builder           The builder.
+  @param[in]  ProducerHandle    The producer handle passed to the SMBIOS
+                                protocol. Optional.
+
+  @retval EFI_SUCCESS           All records were added.
+  @retval EFI_INVALID_PARAMETER Builder is NULL.
+  @retval EFI_ALREADY_STARTED   The builder has already been installed.
+  @retval EFI_OUT_OF_RESOURCES  Not enough memory for the record buffer.
+  @retval Others                The SMBIOS protocol could not be located, or
+                                the status of the first record it rejected.
+**/
+EFI_STATUS
+EFIAPI
+SmbiosBuilderInstall (
+  IN SMBIOS_RECORD_BUILDER  *Builder,
+  IN EFI_HANDLE             ProducerHandle OPTIONAL
+  );
+
+/**
+  Retrieve the handle assigned to a record by SmbiosBuilderInstall().
+
+  @param[in]  Builder           The builder.
+  @param[in]  RecordIndex       The index of the record.
+  @param[out] Handle            On return, the handle of the record.
+
+  @retval EFI_SUCCESS           The handle was returned.
+  @retval EFI_INVALID_PARAMETER Builder or Handle is NULL, or RecordIndex is
+                                out of range.
+  @retval EFI_NOT_READY         The record has not been added to the SMBIOS
+                                table.
+**/
+EFI_STATUS
+EFIAPI
+SmbiosBuilderGetHandle (
+  IN  SMBIOS_RECORD_BUILDER  *Builder,
+  IN  UINTN                  RecordIndex,
+  OUT SMBIOS_HANDLE          *Handle
+  );
+
+/**
+  Release a builder and everything it holds.
+
+  @param[in]  Builder           The builder. May be NULL.
+**/
+VOID
+EFIAPI
+SmbiosBuilderFree (
+  IN SMBIOS_RECORD_BUILDER  *Builder
+  );
+
+#endif
@@ -0,0 +1,647 @@
+/** @file
+  SMBIOS record builder library.
+
+  Copyright (c) 2026, Arm Limited. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiDxe.h>
+#include <Protocol/Smbios.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/SmbiosRecordBuilderLib.h>
+#include <Library/TimerLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+
+//
+// Smallest allocation made for any of the growable builder arrays.
+//
+#define SMBIOS_BUILDER_MIN_ALLOCATION  256
+
+///
+/// A unique string in the string pool.
+///
+typedef struct {
+  UINTN    Offset;        ///< Offset of the string in StringData.
+  UINTN    Size;          ///< Size of the string including the null terminator.
+} SMBIOS_BUILDER_STRING;
+
+///
+/// A record collected by the builder.
+///
+typedef struct {
+  UINTN            DataOffset;    ///< Offset of the formatted area in Data.
+  UINTN            FirstString;   ///< First entry of the record in StringRefs.
+  UINTN            StringCount;   ///< Number of strings of the record.
+  UINTN            RecordSize;    ///< Size of the record including its string set.
+  UINTN            BufferOffset;  ///< Offset of the record in the install buffer.
+  SMBIOS_HANDLE    Handle;        ///< Handle assigned by the SMBIOS protocol.
+  BOOLEAN          Installed;
+} SMBIOS_BUILDER_RECORD;
+
+///
+/// A handle field of one record that refers to another record.
+///
+typedef struct {
+  UINTN    RecordIndex;
+  UINTN    FieldOffset;
+  UINTN    TargetIndex;
+} SMBIOS_BUILDER_LINK;
+
+struct _SMBIOS_RECORD_BUILDER {
+  SMBIOS_BUILDER_RECORD    *Records;
+  UINTN                    RecordCount;
+  UINTN                    RecordCapacity;
+
+  UINT8                    *Data;
+  UINTN                    DataSize;
+  UINTN                    DataCapacity;
+
+  SMBIOS_BUILDER_STRING    *Strings;
+  UINTN                    StringCount;
+  UINTN                    StringCapacity;
+
+  CHAR8                    *StringData;
+  UINTN                    StringDataSize;
+  UINTN                    StringDataCapacity;
+
+  UINTN                    *StringRefs;
+  UINTN                    StringRefCount;
+  UINTN                    StringRefCapacity;
+
+  SMBIOS_BUILDER_LINK      *Links;
+  UINTN                    LinkCount;
+  UINTN                    LinkCapacity;
+
+  UINTN                    TotalSize;
+  BOOLEAN                  Installed;
+};
+
+/**
+  Make sure a growable array can hold at least Required bytes.
+
+  @param[in, out] Buffer        The array.
+  @param[in, out] Capacity      The size of the array in bytes.
+  @param[in]      Required      The number of bytes the array must hold.
+
+  @retval EFI_SUCCESS           The array is large enough.
+  @retval EFI_OUT_OF_RESOURCES  The array could not be grown.
+**/
+STATIC
+EFI_STATUS
+BuilderReserve (
+  IN OUT VOID   **Buffer,
+  IN OUT UINTN  *Capacity,
+  IN     UINTN  Required
+  )
+{
+  UINTN  NewCapacity;
+  VOID   *NewBuffer;
+
+  if (Required <= *Capacity) {
+    return EFI_SUCCESS;
+  }
+
+  NewCapacity = MAX (*Capacity * 2, SMBIOS_BUILDER_MIN_ALLOCATION);
+  while (NewCapacity < Required) {
+    NewCapacity *= 2;
+  }
+
+  NewBuffer = ReallocatePool (*Capacity, NewCapacity, *Buffer);
+  if (NewBuffer == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  *Buffer   = NewBuffer;
+  *Capacity = NewCapacity;
+  return EFI_SUCCESS;
+}
+
+/**
+  Find a string in the string pool, adding it if it is not there yet.
+
+  @param[in]  Builder           The builder.
+  @param[in]  String            The string.
+  @param[out] PoolIndex         On return, the index of the string in the pool.
+
+  @retval EFI_SUCCESS           The string is in the pool.
+  @retval EFI_OUT_OF_RESOURCES  The string could not be added.
+**/
+STATIC
+EFI_STATUS
+BuilderInternString (
+  IN  SMBIOS_RECORD_BUILDER  *Builder,
+  IN  CONST CHAR8            *String,
+  OUT UINTN                  *PoolIndex
+  )
+{
+  EFI_STATUS             Status;
+  SMBIOS_BUILDER_STRING  *Entry;
+  UINTN                  Size;
+  UINTN                  Index;
+
+  Size = AsciiStrSize (String);
+
+  for (Index = 0; Index < Builder->StringCount; Index++) {
+    Entry = &Builder->Strings[Index];
+    if ((Entry->Size == Size) &&
+        (CompareMem (Builder->StringData + Entry->Offset, String, Size) == 0))
+    {
+      *PoolIndex = Index;
+      return EFI_SUCCESS;
+    }
+  }
+
+  Status = BuilderReserve (
+             (VOID **)&Builder->Strings,
+             &Builder->StringCapacity,
+             (Builder->StringCount + 1) * sizeof (SMBIOS_BUILDER_STRING)
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = BuilderReserve (
+             (VOID **)&Builder->StringData,
+             &Builder->StringDataCapacity,
+             Builder->StringDataSize + Size
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Entry         = &Builder->Strings[Builder->StringCount];
+  Entry->Offset = Builder->StringDataSize;
+  Entry->Size   = Size;
+  CopyMem (Builder->StringData + Entry->Offset, String, Size);
+
+  Builder->StringDataSize += Size;
+  *PoolIndex               = Builder->StringCount++;
+  return EFI_SUCCESS;
+}
+
+/**
+  Return the time elapsed between two performance counter values.
+
+  @param[in]  Begin             The counter value at the start.
+  @param[in]  End               The counter value at the end.
+
+  @return The elapsed time in nanoseconds.
+**/
+STATIC
+UINT64
+BuilderElapsedTime (
+  IN UINT64  Begin,
+  IN UINT64  End
+  )
+{
+  UINT64  CounterStart;
+  UINT64  CounterEnd;
+
+  GetPerformanceCounterProperties (&CounterStart, &CounterEnd);
+  if (CounterEnd < CounterStart) {
+    return GetTimeInNanoSecond (Begin - End);
+  }
+
+  return GetTimeInNanoSecond (End - Begin);
+}
+
+/**
+  Create an empty SMBIOS record builder.
+
+  @param[out] Builder           On return, the new builder.
+
+  @retval EFI_SUCCESS           The builder was created.
+  @retval EFI_INVALID_PARAMETER Builder is NULL.
+  @retval EFI_OUT_OF_RESOURCES  Not enough memory for the builder.
+**/
+EFI_STATUS
+EFIAPI
+SmbiosBuilderCreate (
+  OUT SMBIOS_RECORD_BUILDER  **Builder
+  )
+{
+  if (Builder == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  *Builder = AllocateZeroPool (sizeof (SMBIOS_RECORD_BUILDER));
+  if (*Builder == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Add a record to the builder.
+
+  The formatted area of Template and the strings are copied, so the caller
+  may modify or release them once this function returns. The handle in the
+  template header is passed to the SMBIOS protocol unchanged, so it may be
+  either a fixed handle or SMBIOS_HANDLE_PI_RESERVED.
+
+  @param[in]  Builder           The builder.
+  @param[in]  Template          The formatted area of the record.
+  @param[in]  Strings           A NULL terminated array of the record strings,
+                                in string number order. May be NULL if the
+                                record has no strings.
+  @param[out] RecordIndex       On return, the index of the record within the
+                                builder. Optional.
+
+  @retval EFI_SUCCESS           The record was added.
+  @retval EFI_INVALID_PARAMETER Builder or Template is NULL, or the template
+                                length is invalid.
+  @retval EFI_ALREADY_STARTED   The builder has already been installed.
+  @retval EFI_OUT_OF_RESOURCES  Not enough memory for the record.
+**/
+EFI_STATUS
+EFIAPI
+SmbiosBuilderAddRecord (
+  IN  SMBIOS_RECORD_BUILDER    *Builder,
+  IN  CONST SMBIOS_STRUCTURE   *Template,
+  IN  CONST CHAR8 * CONST      *Strings OPTIONAL,
+  OUT UINTN                    *RecordIndex OPTIONAL
+  )
+{
+  EFI_STATUS             Status;
+  SMBIOS_BUILDER_RECORD  *Record;
+  UINTN                  PoolIndex;
+  UINTN                  Index;
+
+  if ((Builder == NULL) || (Template == NULL) ||
+      (Template->Length < sizeof (SMBIOS_STRUCTURE)))
+  {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (Builder->Installed) {
+    return EFI_ALREADY_STARTED;
+  }
+
+  Status = BuilderReserve (
+             (VOID **)&Builder->Records,
+             &Builder->RecordCapacity,
+             (Builder->RecordCount + 1) * sizeof (SMBIOS_BUILDER_RECORD)
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = BuilderReserve (
+             (VOID **)&Builder->Data,
+             &Builder->DataCapacity,
+             Builder->DataSize + Template->Length
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Record = &Builder->Records[Builder->RecordCount];
+  ZeroMem (Record, sizeof (*Record));
+  Record->DataOffset  = Builder->DataSize;
+  Record->FirstString = Builder->StringRefCount;
+  Record->RecordSize  = Template->Length;
+
+  for (Index = 0; (Strings != NULL) && (Strings[Index] != NULL); Index++) {
+    Status = BuilderInternString (Builder, Strings[Index], &PoolIndex);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Status = BuilderReserve (
+               (VOID **)&Builder->StringRefs,
+               &Builder->StringRefCapacity,
+               (Record->FirstString + Index + 1) * sizeof (UINTN)
+               );
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Builder->StringRefs[Record->FirstString + Index] = PoolIndex;
+    Record->RecordSize                              += Builder->Strings[PoolIndex].Size;
+  }
+
+  //
+  // A record without strings is terminated by two null bytes, otherwise the
+  // last string is followed by a single extra null.
+  //
+  Record->StringCount = Index;
+  Record->RecordSize += (Index == 0) ? 2 : 1;
+
+  CopyMem (Builder->Data + Record->DataOffset, Template, Template->Length);
+  Builder->DataSize       += Template->Length;
+  Builder->StringRefCount += Index;
+  Builder->TotalSize      += Record->RecordSize;
+
+  if (RecordIndex != NULL) {
+    *RecordIndex = Builder->RecordCount;
+  }
+
+  Builder->RecordCount++;
+  return EFI_SUCCESS;
+}
+
+/**
+  Make a handle field of a record refer to another record.
+
+  When the builder is installed, the handle assigned to the target record is
+  written to the field at FieldOffset in the referring record. The target
+  must have been added before the referring record.
+
+  @param[in]  Builder           The builder.
+  @param[in]  RecordIndex       The index of the referring record.
+  @param[in]  FieldOffset       The offset of the SMBIOS_HANDLE field within
+                                the formatted area of the referring record.
+  @param[in]  TargetIndex       The index of the record being referred to.
+
+  @retval EFI_SUCCESS           The reference was recorded.
+  @retval EFI_INVALID_PARAMETER Builder is NULL, an index is out of range, the
+                                target was not added before the referring
+                                record, or the field lies outside the
+                                formatted area.
+  @retval EFI_ALREADY_STARTED   The builder has already been installed.
+  @retval EFI_OUT_OF_RESOURCES  Not enough memory for the reference.
+**/
+EFI_STATUS
+EFIAPI
+SmbiosBuilderLinkHandle (
+  IN SMBIOS_RECORD_BUILDER  *Builder,
+  IN UINTN                  RecordIndex,
+  IN UINTN                  FieldOffset,
+  IN UINTN                  TargetIndex
+  )
+{
+  EFI_STATUS           Status;
+  SMBIOS_STRUCTURE     *Header;
+  SMBIOS_BUILDER_LINK  *Link;
+
+  if ((Builder == NULL) || (RecordIndex >= Builder->RecordCount) ||
+      (TargetIndex >= RecordIndex))
+  {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Header = (SMBIOS_STRUCTURE *)(Builder->Data + Builder->Records[RecordIndex].DataOffset);
+  if ((FieldOffset < sizeof (SMBIOS_STRUCTURE)) ||
+      (FieldOffset + sizeof (SMBIOS_HANDLE) > Header->Length))
+  {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (Builder->Installed) {
+    return EFI_ALREADY_STARTED;
+  }
+
+  Status = BuilderReserve (
+             (VOID **)&Builder->Links,
+             &Builder->LinkCapacity,
+             (Builder->LinkCount + 1) * sizeof (SMBIOS_BUILDER_LINK)
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Link              = &Builder->Links[Builder->LinkCount++];
+  Link->RecordIndex = RecordIndex;
+  Link->FieldOffset = FieldOffset;
+  Link->TargetIndex = TargetIndex;
+  return EFI_SUCCESS;
+}
+
+/**
+  Add all records of the builder to the SMBIOS table.
+
+  Records are added in the order they were added to the builder. A record
+  the SMBIOS protocol rejects is skipped, and references to it are left as
+  they were in its template; the remaining records are still added.
+
+  @param[in]  Builder           The builder.
+  @param[in]  ProducerHandle    The producer handle passed to the SMBIOS
+                                protocol. Optional.
+
+  @retval EFI_SUCCESS           All records were added.
+  @retval EFI_INVALID_PARAMETER Builder is NULL.
+  @retval EFI_ALREADY_STARTED   The builder has already been installed.
+  @retval EFI_OUT_OF_RESOURCES  Not enough memory for the record buffer.
+  @retval Others                The SMBIOS protocol could not be located, or
+                                the status of the first record it rejected.
+**/
+EFI_STATUS
+EFIAPI
+SmbiosBuilderInstall (
+  IN SMBIOS_RECORD_BUILDER  *Builder,
+  IN EFI_HANDLE             ProducerHandle OPTIONAL
+  )
+{
+  EFI_STATUS               Status;
+  EFI_STATUS               AddStatus;
+  EFI_SMBIOS_PROTOCOL      *Smbios;
+  SMBIOS_BUILDER_RECORD    *Record;
+  SMBIOS_BUILDER_RECORD    *Target;
+  SMBIOS_BUILDER_STRING    *String;
+  SMBIOS_BUILDER_LINK      *Link;
+  EFI_SMBIOS_TABLE_HEADER  *Header;
+  UINT8                    *Buffer;
+  UINT8                    *Cursor;
+  UINTN                    Index;
+  UINTN                    StringIndex;
+  UINTN                    LinkIndex;
+  UINT64                   Begin;
+  UINT64                   Elapsed;
+  UINT64                   TotalTime;
+
+  if (Builder == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (Builder->Installed) {
+    return EFI_ALREADY_STARTED;
+  }
+
+  Status = gBS->LocateProtocol (&gEfiSmbiosProtocolGuid, NULL, (VOID **)&Smbios);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: SMBIOS protocol not found - %r\n", __func__, Status));
+    return Status;
+  }
+
+  Builder->Installed = TRUE;
+  if (Builder->RecordCount == 0) {
+    return EFI_SUCCESS;
+  }
+
+  //
+  // Record sizes were computed as the records were added, so everything can
+  // be emitted into a single buffer without any further sizing.
+  //
+  Buffer = AllocatePool (Builder->TotalSize);
+  if (Buffer == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Cursor = Buffer;
+  for (Index = 0; Index < Builder->RecordCount; Index++) {
+    Record               = &Builder->Records[Index];
+    Record->BufferOffset = (UINTN)(Cursor - Buffer);
+    Header               = (EFI_SMBIOS_TABLE_HEADER *)(Builder->Data + Record->DataOffset);
+
+    CopyMem (Cursor, Header, Header->Length);
+    Cursor += Header->Length;
+
+    for (StringIndex = 0; StringIndex < Record->StringCount; StringIndex++) {
+      String = &Builder->Strings[Builder->StringRefs[Record->FirstString + StringIndex]];
+      CopyMem (Cursor, Builder->StringData + String->Offset, String->Size);
+      Cursor += String->Size;
+    }
+
+    *Cursor++ = 0;
+    if (Record->StringCount == 0) {
+      *Cursor++ = 0;
+    }
+  }
+
+  ASSERT ((UINTN)(Cursor - Buffer) == Builder->TotalSize);
+
+  TotalTime = 0;
+  for (Index = 0; Index < Builder->RecordCount; Index++) {
+    Record = &Builder->Records[Index];
+    Header = (EFI_SMBIOS_TABLE_HEADER *)(Buffer + Record->BufferOffset);
+
+    for (LinkIndex = 0; LinkIndex < Builder->LinkCount; LinkIndex++) {
+      Link = &Builder->Links[LinkIndex];
+      if (Link->RecordIndex != Index) {
+        continue;
+      }
+
+      Target = &Builder->Records[Link->TargetIndex];
+      if (Target->Installed) {
+        WriteUnaligned16 ((UINT16 *)((UINT8 *)Header + Link->FieldOffset), Target->Handle);
+      }
+    }
+
+    Record->Handle = Header->Handle;
+    Begin          = GetPerformanceCounter ();
+    AddStatus      = Smbios->Add (Smbios, ProducerHandle, &Record->Handle, Header);
+    Elapsed        = BuilderElapsedTime (Begin, GetPerformanceCounter ());
+    TotalTime     += Elapsed;
+
+    if (EFI_ERROR (AddStatus)) {
+      DEBUG ((
+        DEBUG_ERROR,
+        "%a: failed to add SMBIOS type %d record - %r\n",
+        __func__,
+        Header->Type,
+        AddStatus
+        ));
+      if (!EFI_ERROR (Status)) {
+        Status = AddStatus;
+      }
+
+      continue;
+    }
+
+    Record->Installed = TRUE;
+    DEBUG ((
+      DEBUG_VERBOSE,
+      "%a: type %d, handle 0x%04x, %u bytes, %ld ns\n",
+      __func__,
+      Header->Type,
+      Record->Handle,
+      (UINT32)Record->RecordSize,
+      Elapsed
+      ));
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "%a: %u records, %u unique strings, %u bytes, %ld ns\n",
+    __func__,
+    (UINT32)Builder->RecordCount,
+    (UINT32)Builder->StringCount,
+    (UINT32)Builder->TotalSize,
+    TotalTime
+    ));
+
+  FreePool (Buffer);
+  return Status;
+}
+
+/**
+  Retrieve the handle assigned to a record by SmbiosBuilderInstall().
+
+  @param[in]  Builder           The builder.
+  @param[in]  RecordIndex       The index of the record.
+  @param[out] Handle            On return, the handle of the record.
+
+  @retval EFI_SUCCESS           The handle was returned.
+  @retval EFI_INVALID_PARAMETER Builder or Handle is NULL, or RecordIndex is
+                                out of range.
+  @retval EFI_NOT_READY         The record has not been added to the SMBIOS
+                                table.
+**/
+EFI_STATUS
+EFIAPI
+SmbiosBuilderGetHandle (
+  IN  SMBIOS_RECORD_BUILDER  *Builder,
+  IN  UINTN                  RecordIndex,
+  OUT SMBIOS_HANDLE          *Handle
+  )
+{
+  if ((Builder == NULL) || (Handle == NULL) ||
+      (RecordIndex >= Builder->RecordCount))
+  {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (!Builder->Records[RecordIndex].Installed) {
+    return EFI_NOT_READY;
+  }
+
+  *Handle = Builder->Records[RecordIndex].Handle;
+  return EFI_SUCCESS;
+}
+
+/**
+  Release a builder and everything it holds.
+
+  @param[in]  Builder           The builder. May be NULL.
+**/
+VOID
+EFIAPI
+SmbiosBuilderFree (
+  IN SMBIOS_RECORD_BUILDER  *Builder
+  )
+{
+  if (Builder == NULL) {
+    return;
+  }
+
+  if (Builder->Records != NULL) {
+    FreePool (Builder->Records);
+  }
+
+  if (Builder->Data != NULL) {
+    FreePool (Builder->Data);
+  }
+
+  if (Builder->Strings != NULL) {
+    FreePool (Builder->Strings);
+  }
+
+  if (Builder->StringData != NULL) {
+    FreePool (Builder->StringData);
+  }
+
+  if (Builder->StringRefs != NULL) {
+    FreePool (Builder->StringRefs);
+  }
+
+  if (Builder->Links != NULL) {
+    FreePool (Builder->Links);
+  }
+
+  FreePool (Builder);
+}
@@ -35,7 +35,7 @@ InternalAmlArgBuffer (
   UINT8  *Data;
   UINTN  DataSize;
 
-  Data = AllocateZeroPool (sizeof (UINT8));
+  Data = InternalAmlAllocateZeroPool (sizeof (UINT8));
   if (Data == NULL) {
     DEBUG ((
       DEBUG_ERROR,
@@ -69,7 +69,7 @@ InternalAmlArgBuffer (
       Data[0] = AML_ARG6;
       break;
     default:
-      FreePool (Data);
+      InternalAmlFreePool (Data);
       return EFI_INVALID_PARAMETER;
   }
 
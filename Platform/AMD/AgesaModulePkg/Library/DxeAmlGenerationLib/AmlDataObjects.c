@@ -56,7 +56,7 @@ InternalAmlSizedDataBuffer (
   }
 
   // Max Data Size is 64 bit. Plus one Opcode byte
-  Data = AllocateZeroPool (sizeof (UINT64));
+  Data = InternalAmlAllocateZeroPool (sizeof (UINT64));
   if (Data == NULL) {
     DEBUG ((DEBUG_ERROR, "%a: ERROR: Integer Space Alloc Failed\n", __func__));
     return EFI_OUT_OF_RESOURCES;
@@ -88,77 +88,57 @@ InternalAmlSizedDataBuffer (
   Forces max integer size UINT64
 
   @param[in]    Integer         - Integer value to encode
-  @param[out]   ReturnData      - Allocated DataBuffer with encoded integer
-  @param[out]   ReturnDataSize  - Size of ReturnData
+  @param[out]   ReturnData      - Buffer of at least MAX_AML_DATA_INTEGER_ENCODING_SIZE
+                                  bytes to receive the encoded integer
+  @param[out]   ReturnDataSize  - Size of encoded integer in ReturnData
 
   @return       EFI_SUCCESS     - Successful completion
-  @return       EFI_OUT_OF_RESOURCES - Failed to allocate ReturnDataBuffer
 */
 EFI_STATUS
 EFIAPI
 InternalAmlDataIntegerBuffer (
   IN      UINT64  Integer,
-  OUT     VOID    **ReturnData,
+  OUT     UINT8   *ReturnData,
   OUT     UINTN   *ReturnDataSize
   )
 {
-  UINT8  *IntegerData;
   UINTN  IntegerDataSize;
-  UINT8  *Data = NULL;
-  UINTN  DataSize;
-
-  // Max Data Size is 64 bit. Plus one Opcode byte
-  IntegerData = AllocateZeroPool (sizeof (UINT64) + 1);
-  if (IntegerData == NULL) {
-    DEBUG ((DEBUG_ERROR, "%a: ERROR: Integer Space Alloc Failed\n", __func__));
-    return EFI_OUT_OF_RESOURCES;
-  }
 
   if (Integer == 0) {
     // ZeroOp
     IntegerDataSize = 1;
-    IntegerData[0]  = AML_ZERO_OP;
+    ReturnData[0]   = AML_ZERO_OP;
   } else if (Integer == 1) {
     // OneOp
     IntegerDataSize = 1;
-    IntegerData[0]  = AML_ONE_OP;
+    ReturnData[0]   = AML_ONE_OP;
   } else if (Integer == (UINT64) ~0x0) {
     // OnesOp
     IntegerDataSize = 1;
-    IntegerData[0]  = AML_ONES_OP;
+    ReturnData[0]   = AML_ONES_OP;
   } else {
     if (Integer >= 0x100000000) {
       // QWordConst
       IntegerDataSize = sizeof (UINT64) + 1;
-      IntegerData[0]  = AML_QWORD_PREFIX;
+      ReturnData[0]   = AML_QWORD_PREFIX;
     } else if (Integer >= 0x10000) {
       // DWordConst
       IntegerDataSize = sizeof (UINT32) + 1;
-      IntegerData[0]  = AML_DWORD_PREFIX;
+      ReturnData[0]   = AML_DWORD_PREFIX;
     } else if (Integer >= 0x100) {
       // WordConst
       IntegerDataSize = sizeof (UINT16) + 1;
-      IntegerData[0]  = AML_WORD_PREFIX;
+      ReturnData[0]   = AML_WORD_PREFIX;
     } else {
       // ByteConst
       IntegerDataSize = sizeof (UINT8) + 1;
-      IntegerData[0]  = AML_BYTE_PREFIX;
+      ReturnData[0]   = AML_BYTE_PREFIX;
     }
 
-    DataSize = IntegerDataSize - 1;
-    InternalAmlSizedDataBuffer (Integer, DataSize, (VOID **)&Data);
-    if (Data == NULL) {
-      DEBUG ((DEBUG_ERROR, "%a: ERROR: Integer Data Space Alloc Failed\n", __func__));
-      FreePool (IntegerData);
-      return EFI_OUT_OF_RESOURCES;
-    }
-
-    CopyMem (&IntegerData[1], Data, DataSize);
-    FreePool (Data);
+    // AML integers are little endian, copy the low order bytes
+    CopyMem (&ReturnData[1], &Integer, IntegerDataSize - 1);
   }
 
-  // Reallocate the pool so size is exact
-  *ReturnData     = (VOID *)IntegerData;
   *ReturnDataSize = IntegerDataSize;
 
   return EFI_SUCCESS;
@@ -208,6 +188,8 @@ AmlOPDataInteger (
 {
   EFI_STATUS           Status;
   AML_OBJECT_INSTANCE  *Object;
+  UINT8                IntegerData[MAX_AML_DATA_INTEGER_ENCODING_SIZE];
+  UINTN                IntegerDataSize;
 
   if (ListHead == NULL) {
     return EFI_INVALID_PARAMETER;
@@ -222,16 +204,22 @@ AmlOPDataInteger (
     goto Done;
   }
 
-  Status = InternalAmlDataIntegerBuffer (
-             Integer,
-             (VOID **)&(Object->Data),
-             &(Object->DataSize)
-             );
+  Status = InternalAmlDataIntegerBuffer (Integer, IntegerData, &IntegerDataSize);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "%a: ERROR: ACPI Integer 0x%X object\n", __func__, Integer));
     goto Done;
   }
 
+  Object->Data = InternalAmlAllocatePool (IntegerDataSize);
+  if (Object->Data == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    DEBUG ((DEBUG_ERROR, "%a: ERROR: ACPI Integer 0x%X object\n", __func__, Integer));
+    goto Done;
+  }
+
+  CopyMem (Object->Data, IntegerData, IntegerDataSize);
+  Object->DataSize = IntegerDataSize;
+
   Object->Completed = TRUE;
 
   Status = EFI_SUCCESS;
@@ -458,7 +446,7 @@ AmlOPDataString (
 
   // AML_STRING_PREFIX + String + NULL Terminator
   DataSize += 2;
-  Data      = AllocatePool (DataSize);
+  Data      = InternalAmlAllocatePool (DataSize);
   if (Data == NULL) {
     Status = EFI_OUT_OF_RESOURCES;
     DEBUG ((
@@ -524,7 +512,7 @@ AmlOPDataBufferFromArray (
     goto Done;
   }
 
-  Object->Data     = AllocatePool (BufferSize);
+  Object->Data     = InternalAmlAllocatePool (BufferSize);
   Object->DataSize = BufferSize;
   if (Object->Data == NULL) {
     Status = EFI_OUT_OF_RESOURCES;
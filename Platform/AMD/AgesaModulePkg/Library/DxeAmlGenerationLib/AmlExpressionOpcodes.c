@@ -55,13 +55,14 @@ AmlBuffer (
 {
   EFI_STATUS           Status;
   AML_OBJECT_INSTANCE  *Object;
-  AML_OBJECT_INSTANCE  *ChildObject;
   UINTN                ChildCount;
+  UINTN                ChildDataSize;
+  UINT8                IntegerData[MAX_AML_DATA_INTEGER_ENCODING_SIZE];
+  UINTN                IntegerDataSize;
   UINTN                InternalBufferSize;
 
-  Status      = EFI_DEVICE_ERROR;
-  Object      = NULL;
-  ChildObject = NULL;
+  Status = EFI_DEVICE_ERROR;
+  Object = NULL;
 
   if ((Phase >= AmlInvalid) || (ListHead == NULL)) {
     return EFI_INVALID_PARAMETER;
@@ -115,11 +116,9 @@ AmlBuffer (
         goto Done;
       }
 
-      // Get rid of original Identifier data
-      InternalFreeAmlObjectData (Object);
-      // Collect child data and delete children
-      Status = InternalAmlCollapseAndReleaseChildren (
-                 &ChildObject,
+      // Size the children first so BufferSize can be encoded in front of them
+      Status = InternalAmlGetChildrenDataSize (
+                 &ChildDataSize,
                  &ChildCount,
                  &Object->Link,
                  ListHead
@@ -131,8 +130,8 @@ AmlBuffer (
 
       // Set BufferSize Object to correct value and size.
       // BufferSize should be from zero (no Child Data) to MAX of requested
-      // BufferSize or size required for ChildObject->Data.
-      InternalBufferSize = MAX (BufferSize, ChildObject->DataSize);
+      // BufferSize or size required for the child data.
+      InternalBufferSize = MAX (BufferSize, ChildDataSize);
       // iASL compiler 20200110 only keeps lower 32 bits of size.  We'll error if
       // someone requests something >= 4GB size.
       if (InternalBufferSize >= SIZE_4GB) {
@@ -148,38 +147,27 @@ AmlBuffer (
 
       Status = InternalAmlDataIntegerBuffer (
                  InternalBufferSize,
-                 (VOID **)&Object->Data,
-                 &Object->DataSize
+                 IntegerData,
+                 &IntegerDataSize
                  );
       if (EFI_ERROR (Status)) {
         DEBUG ((DEBUG_ERROR, "%a: ERROR: calc BufferSize\n", __func__));
         goto Done;
       }
 
-      if ((ChildObject->DataSize != 0) && (ChildObject->Data != NULL)) {
-        // Make room for ChildObject->Data
-        Object->Data = ReallocatePool (
-                         Object->DataSize,
-                         Object->DataSize +
-                         ChildObject->DataSize,
-                         Object->Data
-                         );
-        if (Object->Data == NULL) {
-          DEBUG ((DEBUG_ERROR, "%a: ERROR: to reallocate BufferSize\n", __func__));
-          Status = EFI_OUT_OF_RESOURCES;
-          goto Done;
-        }
-
-        CopyMem (
-          &Object->Data[Object->DataSize],
-          ChildObject->Data,
-          ChildObject->DataSize
-          );
-        Object->DataSize += ChildObject->DataSize;
+      // Collect child data behind the encoded BufferSize and delete children
+      Status = InternalAmlCollapseChildrenIntoObject (
+                 Object,
+                 IntegerDataSize,
+                 &ChildCount,
+                 ListHead
+                 );
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_ERROR, "%a: ERROR: to reallocate BufferSize\n", __func__));
+        goto Done;
       }
 
-      // Free Child Object since it has been consumed
-      InternalFreeAmlObject (&ChildObject, ListHead);
+      CopyMem (Object->Data, IntegerData, IntegerDataSize);
       Object->Completed = TRUE;
 
       // Close required PkgLength before finishing Object
@@ -196,42 +184,24 @@ AmlBuffer (
         goto Done;
       }
 
-      // Get rid of original Identifier data
-      InternalFreeAmlObjectData (Object);
-      // Collect child data and delete children
-      Status = InternalAmlCollapseAndReleaseChildren (
-                 &ChildObject,
+      // Collect child data behind the one byte BufferOp and delete children
+      Status = InternalAmlCollapseChildrenIntoObject (
+                 Object,
+                 1,
                  &ChildCount,
-                 &Object->Link,
                  ListHead
                  );
-
       // Buffer must have at least PkgLength BufferSize
-      if (EFI_ERROR (Status) ||
-          (ChildObject->Data == NULL) ||
-          (ChildObject->DataSize == 0))
-      {
-        DEBUG ((DEBUG_ERROR, "%a: ERROR: No Buffer Data\n", __func__));
-        goto Done;
-      }
+      if (EFI_ERROR (Status) || (Object->DataSize <= 1)) {
+        if (!EFI_ERROR (Status)) {
+          Status = EFI_DEVICE_ERROR;
+        }
 
-      //  BufferOp is one byte
-      Object->DataSize = ChildObject->DataSize + 1;
-      Object->Data     = AllocatePool (Object->DataSize);
-      if (Object->Data == NULL) {
-        DEBUG ((DEBUG_ERROR, "%a: ERROR: Buffer allocate failed\n", __func__));
-        Status = EFI_OUT_OF_RESOURCES;
+        DEBUG ((DEBUG_ERROR, "%a: ERROR: No Buffer Data\n", __func__));
         goto Done;
       }
 
-      Object->Data[0] = AML_BUFFER_OP;
-      CopyMem (
-        &Object->Data[1],
-        ChildObject->Data,
-        ChildObject->DataSize
-        );
-      // Free Child Object since it has been consumed
-      InternalFreeAmlObject (&ChildObject, ListHead);
+      Object->Data[0]   = AML_BUFFER_OP;
       Object->Completed = TRUE;
 
       Status = EFI_SUCCESS;
@@ -244,7 +214,6 @@ AmlBuffer (
 
 Done:
   if (EFI_ERROR (Status)) {
-    InternalFreeAmlObject (&ChildObject, ListHead);
     InternalFreeAmlObject (&Object, ListHead);
   }
 
@@ -333,7 +302,7 @@ AmlLEqual (
 
       //  LequalOp is one byte
       Object->DataSize = ChildObject->DataSize + 1;
-      Object->Data     = AllocatePool (Object->DataSize);
+      Object->Data     = InternalAmlAllocatePool (Object->DataSize);
       if (Object->Data == NULL) {
         DEBUG ((DEBUG_ERROR, "%a: ERROR: Buffer allocate failed\n", __func__));
         Status = EFI_OUT_OF_RESOURCES;
@@ -397,12 +366,13 @@ InternalAmlNumElements (
 {
   EFI_STATUS           Status;
   AML_OBJECT_INSTANCE  *Object;
-  AML_OBJECT_INSTANCE  *ChildObject;
   UINTN                ChildCount;
+  UINTN                ChildDataSize;
+  UINT8                IntegerData[MAX_AML_DATA_INTEGER_ENCODING_SIZE];
+  UINTN                IntegerDataSize;
 
   Status      = EFI_DEVICE_ERROR;
   Object      = NULL;
-  ChildObject = NULL;
   ChildCount  = 0;
 
   if ((Phase >= AmlInvalid) || (ListHead == NULL)) {
@@ -435,11 +405,10 @@ InternalAmlNumElements (
         goto Done;
       }
 
-      // Get rid of original Identifier data
-      InternalFreeAmlObjectData (Object);
-      // Collect child data and delete children
-      Status = InternalAmlCollapseAndReleaseChildren (
-                 &ChildObject,
+      // Count the children first so NumElements can be encoded in front of
+      // them
+      Status = InternalAmlGetChildrenDataSize (
+                 &ChildDataSize,
                  &ChildCount,
                  &Object->Link,
                  ListHead
@@ -459,20 +428,13 @@ InternalAmlNumElements (
       }
 
       if (*NumElements <= MAX_UINT8) {
-        Object->DataSize = 1;
-        Object->Data     = AllocateZeroPool (Object->DataSize);
-        if (Object->Data == NULL) {
-          DEBUG ((DEBUG_ERROR, "%a: ERROR: NumElements allocate failed\n", __func__));
-          Status = EFI_OUT_OF_RESOURCES;
-          goto Done;
-        }
-
-        Object->Data[0] = (UINT8)*NumElements;
+        IntegerDataSize = 1;
+        IntegerData[0]  = (UINT8)*NumElements;
       } else {
         Status = InternalAmlDataIntegerBuffer (
                    *NumElements,
-                   (VOID **)&Object->Data,
-                   &Object->DataSize
+                   IntegerData,
+                   &IntegerDataSize
                    );
         if (EFI_ERROR (Status)) {
           DEBUG ((DEBUG_ERROR, "%a: ERROR: calc NumElements\n", __func__));
@@ -480,30 +442,19 @@ InternalAmlNumElements (
         }
       }
 
-      if ((ChildObject->DataSize != 0) && (ChildObject->Data != NULL)) {
-        // Make room for ChildObject->Data
-        Object->Data = ReallocatePool (
-                         Object->DataSize,
-                         Object->DataSize +
-                         ChildObject->DataSize,
-                         Object->Data
-                         );
-        if (Object->Data == NULL) {
-          DEBUG ((DEBUG_ERROR, "%a: ERROR: to reallocate NumElements\n", __func__));
-          Status = EFI_OUT_OF_RESOURCES;
-          goto Done;
-        }
-
-        CopyMem (
-          &Object->Data[Object->DataSize],
-          ChildObject->Data,
-          ChildObject->DataSize
-          );
-        Object->DataSize += ChildObject->DataSize;
+      // Collect child data behind the encoded NumElements and delete children
+      Status = InternalAmlCollapseChildrenIntoObject (
+                 Object,
+                 IntegerDataSize,
+                 &ChildCount,
+                 ListHead
+                 );
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_ERROR, "%a: ERROR: to reallocate NumElements\n", __func__));
+        goto Done;
       }
 
-      // Free Child Object since it has been consumed
-      InternalFreeAmlObject (&ChildObject, ListHead);
+      CopyMem (Object->Data, IntegerData, IntegerDataSize);
       Object->Completed = TRUE;
 
       Status = EFI_SUCCESS;
@@ -516,7 +467,6 @@ InternalAmlNumElements (
 
 Done:
   if (EFI_ERROR (Status)) {
-    InternalFreeAmlObject (&ChildObject, ListHead);
     InternalFreeAmlObject (&Object, ListHead);
   }
 
@@ -556,13 +506,11 @@ AmlPackage (
 {
   EFI_STATUS           Status;
   AML_OBJECT_INSTANCE  *Object;
-  AML_OBJECT_INSTANCE  *ChildObject;
   UINTN                ChildCount;
   UINT8                OpCode;
 
-  Status      = EFI_DEVICE_ERROR;
-  Object      = NULL;
-  ChildObject = NULL;
+  Status = EFI_DEVICE_ERROR;
+  Object = NULL;
 
   if ((Phase >= AmlInvalid) || (ListHead == NULL)) {
     return EFI_INVALID_PARAMETER;
@@ -624,41 +572,25 @@ AmlPackage (
         goto Done;
       }
 
-      // Get rid of original Identifier data
-      InternalFreeAmlObjectData (Object);
-      // Collect child data and delete children
-      Status = InternalAmlCollapseAndReleaseChildren (
-                 &ChildObject,
+      // Collect child data behind the one byte PackageOp or VarPackageOp
+      // and delete children
+      Status = InternalAmlCollapseChildrenIntoObject (
+                 Object,
+                 1,
                  &ChildCount,
-                 &Object->Link,
                  ListHead
                  );
       // Package must have at least PkgLength NumElements
-      if (EFI_ERROR (Status) ||
-          (ChildObject->Data == NULL) ||
-          (ChildObject->DataSize == 0))
-      {
-        DEBUG ((DEBUG_ERROR, "%a: ERROR: No Package Data\n", __func__));
-        goto Done;
-      }
+      if (EFI_ERROR (Status) || (Object->DataSize <= 1)) {
+        if (!EFI_ERROR (Status)) {
+          Status = EFI_DEVICE_ERROR;
+        }
 
-      //  PackageOp and VarPackageOp are both one byte
-      Object->DataSize = ChildObject->DataSize + 1;
-      Object->Data     = AllocatePool (Object->DataSize);
-      if (Object->Data == NULL) {
-        DEBUG ((DEBUG_ERROR, "%a: ERROR: Package allocate failed\n", __func__));
-        Status = EFI_OUT_OF_RESOURCES;
+        DEBUG ((DEBUG_ERROR, "%a: ERROR: No Package Data\n", __func__));
         goto Done;
       }
 
-      Object->Data[0] = OpCode;
-      CopyMem (
-        &Object->Data[1],
-        ChildObject->Data,
-        ChildObject->DataSize
-        );
-      // Free Child Object since it has been consumed
-      InternalFreeAmlObject (&ChildObject, ListHead);
+      Object->Data[0]   = OpCode;
       Object->Completed = TRUE;
 
       Status = EFI_SUCCESS;
@@ -671,7 +603,6 @@ AmlPackage (
 
 Done:
   if (EFI_ERROR (Status)) {
-    InternalFreeAmlObject (&ChildObject, ListHead);
     InternalFreeAmlObject (&Object, ListHead);
   }
 
@@ -756,7 +687,7 @@ AmlStore (
         goto Done;
       }
 
-      Object->Data = AllocateZeroPool (ChildObject->DataSize + 1);
+      Object->Data = InternalAmlAllocateZeroPool (ChildObject->DataSize + 1);
       if (Object->Data == NULL) {
         Status = EFI_OUT_OF_RESOURCES;
         DEBUG ((DEBUG_ERROR, "%a: ERROR: allocate Object->Data for Store()\n", __func__));
@@ -882,7 +813,7 @@ InternalAmlShift (
         goto Done;
       }
 
-      Object->Data = AllocateZeroPool (ChildObject->DataSize + 1);
+      Object->Data = InternalAmlAllocateZeroPool (ChildObject->DataSize + 1);
       if (Object->Data == NULL) {
         Status = EFI_OUT_OF_RESOURCES;
         DEBUG ((DEBUG_ERROR, "%a: ERROR: allocate Object->Data for Store()\n", __func__));
@@ -1075,7 +1006,7 @@ InternalAmlFindSetBit (
         goto Done;
       }
 
-      Object->Data = AllocateZeroPool (ChildObject->DataSize + 1);
+      Object->Data = InternalAmlAllocateZeroPool (ChildObject->DataSize + 1);
       if (Object->Data == NULL) {
         Status = EFI_OUT_OF_RESOURCES;
         DEBUG ((DEBUG_ERROR, "%a: ERROR: allocate Object->Data for Store()\n", __func__));
@@ -1256,7 +1187,7 @@ AmlDecrement (
         goto Done;
       }
 
-      Object->Data = AllocateZeroPool (ChildObject->DataSize + 1);
+      Object->Data = InternalAmlAllocateZeroPool (ChildObject->DataSize + 1);
       if (Object->Data == NULL) {
         Status = EFI_OUT_OF_RESOURCES;
         DEBUG ((DEBUG_ERROR, "%a: ERROR: allocate Object->Data for Store()\n", __func__));
@@ -35,7 +35,7 @@ InternalAmlLocalBuffer (
   UINT8  *Data;
   UINTN  DataSize;
 
-  Data = AllocateZeroPool (sizeof (UINT8));
+  Data = InternalAmlAllocateZeroPool (sizeof (UINT8));
   if (Data == NULL) {
     DEBUG ((
       DEBUG_ERROR,
@@ -72,7 +72,7 @@ InternalAmlLocalBuffer (
       Data[0] = AML_LOCAL7;
       break;
     default:
-      FreePool (Data);
+      InternalAmlFreePool (Data);
       return EFI_INVALID_PARAMETER;
   }
 
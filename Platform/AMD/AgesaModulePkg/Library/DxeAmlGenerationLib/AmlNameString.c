@@ -194,7 +194,7 @@ InternalAmlNameSeg (
     }
   }
 
-  NameSeg = AllocateZeroPool (4);
+  NameSeg = InternalAmlAllocateZeroPool (4);
   if (NameSeg == NULL) {
     return EFI_OUT_OF_RESOURCES;
   }
@@ -213,7 +213,7 @@ InternalAmlNameSeg (
       Object->Completed = TRUE;
     } else {
       InternalFreeAmlObject (&Object, ListHead);
-      FreePool (NameSeg);
+      InternalAmlFreePool (NameSeg);
     }
   }
 
@@ -296,6 +296,7 @@ AmlOPNameString (
   Status                    = EFI_DEVICE_ERROR;
   Object                    = NULL;
   NameString                = NULL;
+  NameStringPrefix          = NULL;
   FoundRootChar             = FALSE;
   FoundParentPrefixChar     = FALSE;
   NameStringBufferSize      = 0;
@@ -507,20 +508,22 @@ AmlOPNameString (
   // Create AML Record with NameString contents from above
   // Copy in RootChar or ParentPrefixChar(s)
   if (NameStringPrefixSize != 0) {
-    Object->Data = ReallocatePool (
-                     Object->DataSize,
-                     NameStringPrefixSize,
-                     Object->Data
-                     );
+    Object->Data = InternalAmlReallocatePool (
+                                Object->DataSize,
+                                NameStringPrefixSize,
+                                Object->Data
+                                );
     CopyMem (
       &Object->Data[Object->DataSize],
       NameStringPrefix,
       NameStringPrefixSize
       );
     Object->DataSize += NameStringPrefixSize;
-    FreePool (NameStringPrefix);
   }
 
+  FreePool (NameStringPrefix);
+  NameStringPrefix = NULL;
+
   // Set up for Dual/MultiName Prefix
   if (NameSegCount > MAX_NAME_SEG_COUNT) {
     Status = EFI_INVALID_PARAMETER;
@@ -532,25 +535,25 @@ AmlOPNameString (
     goto Done;
   } else if (NameSegCount == 1) {
     // Single NameSeg
-    Object->Data = ReallocatePool (
-                     Object->DataSize,
-                     Object->DataSize + NameStringSize,
-                     Object->Data
-                     );
+    Object->Data = InternalAmlReallocatePool (
+                                Object->DataSize,
+                                Object->DataSize + NameStringSize,
+                                Object->Data
+                                );
   } else if (NameSegCount == 2) {
-    Object->Data = ReallocatePool (
-                     Object->DataSize,
-                     Object->DataSize + NameStringSize + 1,
-                     Object->Data
-                     );
+    Object->Data = InternalAmlReallocatePool (
+                                Object->DataSize,
+                                Object->DataSize + NameStringSize + 1,
+                                Object->Data
+                                );
     Object->Data[Object->DataSize] = AML_DUAL_NAME_PREFIX;
     Object->DataSize              += 1;
   } else {
-    Object->Data = ReallocatePool (
-                     Object->DataSize,
-                     Object->DataSize + NameStringSize + 2,
-                     Object->Data
-                     );
+    Object->Data = InternalAmlReallocatePool (
+                                Object->DataSize,
+                                Object->DataSize + NameStringSize + 2,
+                                Object->Data
+                                );
     Object->Data[Object->DataSize]     = AML_MULTI_NAME_PREFIX;
     Object->Data[Object->DataSize + 1] = NameSegCount & 0xFF;
     Object->DataSize                  += 2;
@@ -570,6 +573,10 @@ Done:
     if (NameString != NULL) {
       FreePool (NameString);
     }
+
+    if (NameStringPrefix != NULL) {
+      FreePool (NameStringPrefix);
+    }
   }
 
   return Status;
@@ -42,16 +42,14 @@ AmlDevice (
 {
   EFI_STATUS           Status;
   AML_OBJECT_INSTANCE  *Object;
-  AML_OBJECT_INSTANCE  *ChildObject;
   UINTN                ChildCount;
 
   if ((Phase >= AmlInvalid) || (String == NULL) || (ListHead == NULL)) {
     return EFI_INVALID_PARAMETER;
   }
 
-  Status      = EFI_DEVICE_ERROR;
-  Object      = NULL;
-  ChildObject = NULL;
+  Status = EFI_DEVICE_ERROR;
+  Object = NULL;
 
   switch (Phase) {
     case AmlStart:
@@ -94,40 +92,24 @@ AmlDevice (
         goto Done;
       }
 
-      // Get rid of original Identifier data
-      InternalFreeAmlObjectData (Object);
-      // Collect child data and delete children
-      Status = InternalAmlCollapseAndReleaseChildren (
-                 &ChildObject,
+      // Collect child data behind the two byte Device Op and delete children
+      Status = InternalAmlCollapseChildrenIntoObject (
+                 Object,
+                 2,
                  &ChildCount,
-                 &Object->Link,
                  ListHead
                  );
-      if (EFI_ERROR (Status) ||
-          (ChildObject->Data == NULL) ||
-          (ChildObject->DataSize == 0))
-      {
-        DEBUG ((DEBUG_ERROR, "%a: ERROR: %a child data collection.\n", __func__, String));
-        goto Done;
-      }
+      if (EFI_ERROR (Status) || (Object->DataSize <= 2)) {
+        if (!EFI_ERROR (Status)) {
+          Status = EFI_DEVICE_ERROR;
+        }
 
-      // Device Op is two bytes
-      Object->DataSize = ChildObject->DataSize + 2;
-      Object->Data     = AllocatePool (Object->DataSize);
-      if (Object->Data == NULL) {
-        Status = EFI_OUT_OF_RESOURCES;
-        DEBUG ((DEBUG_ERROR, "%a: ERROR: allocate Object->Data for %a\n", __func__, String));
+        DEBUG ((DEBUG_ERROR, "%a: ERROR: %a child data collection.\n", __func__, String));
         goto Done;
       }
 
-      Object->Data[0] = AML_EXT_OP;
-      Object->Data[1] = AML_EXT_DEVICE_OP;
-      CopyMem (
-        &Object->Data[2],
-        ChildObject->Data,
-        ChildObject->DataSize
-        );
-      InternalFreeAmlObject (&ChildObject, ListHead);
+      Object->Data[0]   = AML_EXT_OP;
+      Object->Data[1]   = AML_EXT_DEVICE_OP;
       Object->Completed = TRUE;
 
       Status = EFI_SUCCESS;
@@ -141,7 +123,6 @@ AmlDevice (
 Done:
   if (EFI_ERROR (Status)) {
     InternalFreeAmlObject (&Object, ListHead);
-    InternalFreeAmlObject (&ChildObject, ListHead);
   }
 
   return Status;
@@ -180,7 +161,7 @@ InternalAmlAccessField (
     goto Done;
   }
 
-  Object->Data = AllocateZeroPool (3);
+  Object->Data = InternalAmlAllocateZeroPool (3);
   // AML_ACCESSFIELD_OP + AccessType + AccessAttrib
   if (Object->Data == NULL) {
     Status = EFI_OUT_OF_RESOURCES;
@@ -239,7 +220,7 @@ InternalAmlExtendedAccessField (
     goto Done;
   }
 
-  Object->Data = AllocateZeroPool (4);
+  Object->Data = InternalAmlAllocateZeroPool (4);
   // AML_EXTACCESSFIELD_OP + AccessType + AccessAttrib + AccessLength
   if (Object->Data == NULL) {
     Status = EFI_OUT_OF_RESOURCES;
@@ -441,7 +422,7 @@ AmlOPExternal (
     goto Done;
   }
 
-  Object->Data = AllocateZeroPool (ChildObject->DataSize + 3);
+  Object->Data = InternalAmlAllocateZeroPool (ChildObject->DataSize + 3);
   // AML_EXTERNAL_OP + Name + ObjectType + ArgumentCount
   if (Object->Data == NULL) {
     Status = EFI_OUT_OF_RESOURCES;
@@ -569,7 +550,7 @@ AmlOPOffset (
 {
   AML_OBJECT_INSTANCE  *Object;
   AML_OBJECT_INSTANCE  *OffsetObject;
-  UINT8                *PkgLength;
+  UINT8                PkgLength[MAX_AML_PKG_LENGTH_ENCODING_SIZE];
   UINTN                DataLength;
   EFI_STATUS           Status;
   UINT64               InternalOffsetData;
@@ -583,7 +564,6 @@ AmlOPOffset (
   BitCount           = LShiftU64 (ByteOffset, 3);
   Object             = NULL;
   OffsetObject       = NULL;
-  PkgLength          = NULL;
 
   // Find and read internal offset data
   Status = InternalAmlLocateOffsetTerm (&OffsetObject, ListHead);
@@ -617,14 +597,14 @@ AmlOPOffset (
     goto Done;
   }
 
-  Status = InternalAmlBitPkgLength ((UINT32)BitCount, &PkgLength, &DataLength);
+  Status = InternalAmlBitPkgLength ((UINT32)BitCount, PkgLength, &DataLength);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "%a: ERROR: internal AML PkgLength\n", __func__));
     goto Done;
   }
 
   Object->DataSize = DataLength + 1; // add one for Reserved Field Indicator
-  Object->Data     = AllocateZeroPool (Object->DataSize);
+  Object->Data     = InternalAmlAllocateZeroPool (Object->DataSize);
 
   if (Object->Data == NULL) {
     Status = EFI_OUT_OF_RESOURCES;
@@ -635,7 +615,6 @@ AmlOPOffset (
   Object->Data[0] = 0;
   CopyMem (&Object->Data[1], PkgLength, DataLength); // read internal offset data
   Object->Completed = TRUE;
-  FreePool (PkgLength);
 
 Done:
   if (EFI_ERROR (Status)) {
@@ -675,6 +654,7 @@ AmlOPFieldUnit (
   AML_OBJECT_INSTANCE  *Object;
   AML_OBJECT_INSTANCE  *OffsetObject;
   EFI_STATUS           Status;
+  UINT8                PkgLength[MAX_AML_PKG_LENGTH_ENCODING_SIZE];
 
   if ((ListHead == NULL) || (Name == NULL)) {
     return EFI_INVALID_PARAMETER;
@@ -693,7 +673,7 @@ AmlOPFieldUnit (
         goto Done;
       }
 
-      Object->Data      = AllocateZeroPool (1);
+      Object->Data      = InternalAmlAllocateZeroPool (1);
       Object->DataSize  = 1;
       Object->Completed = TRUE;
     } else {
@@ -725,12 +705,21 @@ AmlOPFieldUnit (
     goto Done;
   }
 
-  Status = InternalAmlBitPkgLength (BitLength, &Object->Data, &Object->DataSize);
+  Status = InternalAmlBitPkgLength (BitLength, PkgLength, &Object->DataSize);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "%a: ERROR: Appending BitLength for %a object\n", __func__, Name));
     goto Done;
   }
 
+  Object->Data = InternalAmlAllocatePool (Object->DataSize);
+  if (Object->Data == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    DEBUG ((DEBUG_ERROR, "%a: ERROR: Appending BitLength for %a object\n", __func__, Name));
+    goto Done;
+  }
+
+  CopyMem (Object->Data, PkgLength, Object->DataSize);
+
   Object->Completed = TRUE;
 
 Done:
@@ -809,7 +798,7 @@ AmlField (
       }
 
       Object->DataSize  = sizeof (UINT64);
-      Object->Data      = AllocateZeroPool (Object->DataSize);
+      Object->Data      = InternalAmlAllocateZeroPool (Object->DataSize);
       Object->Completed = TRUE;
       if (EFI_ERROR (Status) || (Object->Data == NULL)) {
         DEBUG ((DEBUG_ERROR, "%a: ERROR: Start Field internal offset %a object\n", __func__, Name));
@@ -839,7 +828,7 @@ AmlField (
 
       // Field Flags is one byte
       Object->DataSize = 1;
-      Object->Data     = AllocatePool (Object->DataSize);
+      Object->Data     = InternalAmlAllocatePool (Object->DataSize);
       if (Object->Data == NULL) {
         Status = EFI_OUT_OF_RESOURCES;
         DEBUG ((DEBUG_ERROR, "%a: ERROR: allocate Object->Data for %a\n", __func__, Name));
@@ -905,7 +894,7 @@ AmlField (
 
       // Field Op is two bytes
       Object->DataSize = ChildObject->DataSize + 2;
-      Object->Data     = AllocatePool (Object->DataSize);
+      Object->Data     = InternalAmlAllocatePool (Object->DataSize);
       if (Object->Data == NULL) {
         Status = EFI_OUT_OF_RESOURCES;
         DEBUG ((DEBUG_ERROR, "%a: ERROR: allocate Object->Data for %a\n", __func__, Name));
@@ -1006,7 +995,7 @@ AmlBankField (
       // Insert internal offset counter
       Status            = InternalAppendNewAmlObjectNoData (&Object, ListHead);
       Object->DataSize  = sizeof (UINT64);
-      Object->Data      = AllocateZeroPool (Object->DataSize);
+      Object->Data      = InternalAmlAllocateZeroPool (Object->DataSize);
       Object->Completed = TRUE;
       if (EFI_ERROR (Status) || (Object->Data == NULL)) {
         DEBUG ((DEBUG_ERROR, "%a: ERROR: Start BankField internal offset %a object\n", __func__, BankName));
@@ -1050,7 +1039,7 @@ AmlBankField (
 
       // Field Flags is one byte
       Object->DataSize = 1;
-      Object->Data     = AllocatePool (Object->DataSize);
+      Object->Data     = InternalAmlAllocatePool (Object->DataSize);
       if (Object->Data == NULL) {
         Status = EFI_OUT_OF_RESOURCES;
         DEBUG ((DEBUG_ERROR, "%a: ERROR: allocate Object->Data for %a\n", __func__, BankName));
@@ -1116,7 +1105,7 @@ AmlBankField (
 
       // Field Op is two bytes
       Object->DataSize = ChildObject->DataSize + 2;
-      Object->Data     = AllocatePool (Object->DataSize);
+      Object->Data     = InternalAmlAllocatePool (Object->DataSize);
       if (Object->Data == NULL) {
         Status = EFI_OUT_OF_RESOURCES;
         DEBUG ((DEBUG_ERROR, "%a: ERROR: allocate Object->Data for %a\n", __func__, BankName));
@@ -1215,7 +1204,7 @@ AmlIndexField (
       // Insert internal offset counter
       Status            = InternalAppendNewAmlObjectNoData (&Object, ListHead);
       Object->DataSize  = sizeof (UINT64);
-      Object->Data      = AllocateZeroPool (Object->DataSize);
+      Object->Data      = InternalAmlAllocateZeroPool (Object->DataSize);
       Object->Completed = TRUE;
       if (EFI_ERROR (Status) || (Object->Data == NULL)) {
         DEBUG ((DEBUG_ERROR, "%a: ERROR: Start IndexField internal offset %a object\n", __func__, IndexName));
@@ -1252,7 +1241,7 @@ AmlIndexField (
 
       // Field Flags is one byte
       Object->DataSize = 1;
-      Object->Data     = AllocatePool (Object->DataSize);
+      Object->Data     = InternalAmlAllocatePool (Object->DataSize);
       if (Object->Data == NULL) {
         Status = EFI_OUT_OF_RESOURCES;
         DEBUG ((DEBUG_ERROR, "%a: ERROR: allocate Object->Data for %a\n", __func__, IndexName));
@@ -1318,7 +1307,7 @@ AmlIndexField (
 
       // Field Op is two bytes
       Object->DataSize = ChildObject->DataSize + 2;
-      Object->Data     = AllocatePool (Object->DataSize);
+      Object->Data     = InternalAmlAllocatePool (Object->DataSize);
       if (Object->Data == NULL) {
         Status = EFI_OUT_OF_RESOURCES;
         DEBUG ((DEBUG_ERROR, "%a: ERROR: allocate Object->Data for %a\n", __func__, IndexName));
@@ -1465,7 +1454,7 @@ AmlOPOperationRegion (
 
   // OpRegion Opcode is two bytes
   Object->DataSize = ChildObject->DataSize + 2;
-  Object->Data     = AllocatePool (Object->DataSize);
+  Object->Data     = InternalAmlAllocatePool (Object->DataSize);
   if (Object->Data == NULL) {
     Status = EFI_OUT_OF_RESOURCES;
     DEBUG ((DEBUG_ERROR, "%a: ERROR: allocate Object->Data for %a\n", __func__, RegionName));
@@ -1595,7 +1584,7 @@ AmlOPCreateField (
 
   // CreateFieldOp is two bytes
   Object->DataSize = ChildObject->DataSize + 2;
-  Object->Data     = AllocatePool (Object->DataSize);
+  Object->Data     = InternalAmlAllocatePool (Object->DataSize);
   if (Object->Data == NULL) {
     Status = EFI_OUT_OF_RESOURCES;
     DEBUG ((DEBUG_ERROR, "%a: ERROR: allocate Object->Data for %a\n", __func__, FieldName));
@@ -1729,7 +1718,7 @@ InternalAmlCreateFixedField (
 
   // CreateWordFieldOp is one byte
   Object->DataSize = ChildObject->DataSize + 1;
-  Object->Data     = AllocatePool (Object->DataSize);
+  Object->Data     = InternalAmlAllocatePool (Object->DataSize);
   if (Object->Data == NULL) {
     Status = EFI_OUT_OF_RESOURCES;
     DEBUG ((DEBUG_ERROR, "%a: ERROR: allocate Object->Data for %a\n", __func__, FixedFieldName));
@@ -1971,7 +1960,6 @@ AmlMethod (
 {
   EFI_STATUS           Status;
   AML_OBJECT_INSTANCE  *Object;
-  AML_OBJECT_INSTANCE  *ChildObject;
   UINT8                MethodFlags;
   UINTN                ChildCount;
 
@@ -1985,9 +1973,8 @@ AmlMethod (
     return EFI_INVALID_PARAMETER;
   }
 
-  Status      = EFI_DEVICE_ERROR;
-  Object      = NULL;
-  ChildObject = NULL;
+  Status = EFI_DEVICE_ERROR;
+  Object = NULL;
 
   switch (Phase) {
     case AmlStart:
@@ -2030,43 +2017,25 @@ AmlMethod (
         goto Done;
       }
 
-      // Get rid of original Identifier data
-      InternalFreeAmlObjectData (Object);
-      // Collect child data and delete children
-      Status = InternalAmlCollapseAndReleaseChildren (
-                 &ChildObject,
+      // Collect child data behind the one byte Method Flags and delete children
+      Status = InternalAmlCollapseChildrenIntoObject (
+                 Object,
+                 1,
                  &ChildCount,
-                 &Object->Link,
                  ListHead
                  );
-
       if (EFI_ERROR (Status)) {
         DEBUG ((DEBUG_ERROR, "%a: ERROR: %a METHOD_FLAGS child data collection.\n", __func__, Name));
         goto Done;
       }
 
-      // Method Flags is one byte
-      Object->DataSize = ChildObject->DataSize + 1;
-      Object->Data     = AllocatePool (Object->DataSize);
-      if (Object->Data == NULL) {
-        Status = EFI_OUT_OF_RESOURCES;
-        DEBUG ((DEBUG_ERROR, "%a: ERROR: allocate Object->Data for %a\n", __func__, Name));
-        goto Done;
-      }
-
       MethodFlags = NumArgs & 0x07;
       if (SerializeRule) {
         MethodFlags |= BIT3;
       }
 
-      MethodFlags    |= (SyncLevel & 0x0F) << 4;
-      Object->Data[0] = MethodFlags;
-      CopyMem (
-        &Object->Data[1],
-        ChildObject->Data,
-        ChildObject->DataSize
-        );
-      InternalFreeAmlObject (&ChildObject, ListHead);
+      MethodFlags      |= (SyncLevel & 0x0F) << 4;
+      Object->Data[0]   = MethodFlags;
       Object->Completed = TRUE;
 
       // Required NameString completed in one phase call
@@ -2084,40 +2053,23 @@ AmlMethod (
         goto Done;
       }
 
-      // Get rid of original Identifier data
-      InternalFreeAmlObjectData (Object);
-
-      // Collect child data and delete children
-      Status = InternalAmlCollapseAndReleaseChildren (
-                 &ChildObject,
+      // Collect child data behind the one byte Method Op and delete children
+      Status = InternalAmlCollapseChildrenIntoObject (
+                 Object,
+                 1,
                  &ChildCount,
-                 &Object->Link,
                  ListHead
                  );
-      if (EFI_ERROR (Status) ||
-          (ChildObject->Data == NULL) ||
-          (ChildObject->DataSize == 0))
-      {
-        DEBUG ((DEBUG_ERROR, "%a: ERROR: %a child data collection.\n", __func__, Name));
-        goto Done;
-      }
+      if (EFI_ERROR (Status) || (Object->DataSize <= 1)) {
+        if (!EFI_ERROR (Status)) {
+          Status = EFI_DEVICE_ERROR;
+        }
 
-      // Method Op is one byte
-      Object->DataSize = ChildObject->DataSize + 1;
-      Object->Data     = AllocatePool (Object->DataSize);
-      if (Object->Data == NULL) {
-        Status = EFI_OUT_OF_RESOURCES;
-        DEBUG ((DEBUG_ERROR, "%a: ERROR: allocate Object->Data for %a\n", __func__, Name));
+        DEBUG ((DEBUG_ERROR, "%a: ERROR: %a child data collection.\n", __func__, Name));
         goto Done;
       }
 
-      Object->Data[0] = AML_METHOD_OP;
-      CopyMem (
-        &Object->Data[1],
-        ChildObject->Data,
-        ChildObject->DataSize
-        );
-      InternalFreeAmlObject (&ChildObject, ListHead);
+      Object->Data[0]   = AML_METHOD_OP;
       Object->Completed = TRUE;
 
       Status = EFI_SUCCESS;
@@ -2130,7 +2082,6 @@ AmlMethod (
 
 Done:
   if (EFI_ERROR (Status)) {
-    InternalFreeAmlObject (&ChildObject, ListHead);
     InternalFreeAmlObject (&Object, ListHead);
   }
 
@@ -37,16 +37,14 @@ AmlScope (
 {
   EFI_STATUS           Status;
   AML_OBJECT_INSTANCE  *Object;
-  AML_OBJECT_INSTANCE  *ChildObject;
   UINTN                ChildCount;
 
   if ((Phase >= AmlInvalid) || (String == NULL) || (ListHead == NULL)) {
     return EFI_INVALID_PARAMETER;
   }
 
-  Status      = EFI_DEVICE_ERROR;
-  Object      = NULL;
-  ChildObject = NULL;
+  Status = EFI_DEVICE_ERROR;
+  Object = NULL;
 
   switch (Phase) {
     case AmlStart:
@@ -89,35 +87,23 @@ AmlScope (
         goto Done;
       }
 
-      // Get rid of original Identifier data
-      InternalFreeAmlObjectData (Object);
-      // Collect child data and delete children
-      Status = InternalAmlCollapseAndReleaseChildren (
-                 &ChildObject,
+      // Collect child data behind the one byte Scope Op and delete children
+      Status = InternalAmlCollapseChildrenIntoObject (
+                 Object,
+                 1,
                  &ChildCount,
-                 &Object->Link,
                  ListHead
                  );
-      if (EFI_ERROR (Status) ||
-          (ChildObject->Data == NULL) ||
-          (ChildObject->DataSize == 0))
-      {
-        DEBUG ((DEBUG_ERROR, "%a: ERROR: %a has no child data.\n", __func__, String));
-        goto Done;
-      }
+      if (EFI_ERROR (Status) || (Object->DataSize <= 1)) {
+        if (!EFI_ERROR (Status)) {
+          Status = EFI_DEVICE_ERROR;
+        }
 
-      // Scope Op is one byte
-      Object->DataSize = ChildObject->DataSize + 1;
-      Object->Data     = AllocatePool (Object->DataSize);
-      if (Object->Data == NULL) {
-        Status = EFI_OUT_OF_RESOURCES;
-        DEBUG ((DEBUG_ERROR, "%a: ERROR: allocate Object->Data for %a\n", __func__, String));
+        DEBUG ((DEBUG_ERROR, "%a: ERROR: %a has no child data.\n", __func__, String));
         goto Done;
       }
 
-      Object->Data[0] = AML_SCOPE_OP;
-      CopyMem (&Object->Data[1], ChildObject->Data, ChildObject->DataSize);
-      InternalFreeAmlObject (&ChildObject, ListHead);
+      Object->Data[0]   = AML_SCOPE_OP;
       Object->Completed = TRUE;
 
       Status = EFI_SUCCESS;
@@ -131,7 +117,6 @@ AmlScope (
 Done:
   if (EFI_ERROR (Status)) {
     InternalFreeAmlObject (&Object, ListHead);
-    InternalFreeAmlObject (&ChildObject, ListHead);
   }
 
   return Status;
@@ -163,16 +148,14 @@ AmlName (
 {
   EFI_STATUS           Status;
   AML_OBJECT_INSTANCE  *Object;
-  AML_OBJECT_INSTANCE  *ChildObject;
   UINTN                ChildCount;
 
   if ((Phase >= AmlInvalid) || (String == NULL) || (ListHead == NULL)) {
     return EFI_INVALID_PARAMETER;
   }
 
-  Status      = EFI_DEVICE_ERROR;
-  Object      = NULL;
-  ChildObject = NULL;
+  Status = EFI_DEVICE_ERROR;
+  Object = NULL;
 
   switch (Phase) {
     case AmlStart:
@@ -199,39 +182,23 @@ AmlName (
         goto Done;
       }
 
-      // Get rid of original Identifier data
-      InternalFreeAmlObjectData (Object);
-      // Collect child data and delete children
-      Status = InternalAmlCollapseAndReleaseChildren (
-                 &ChildObject,
+      // Collect child data behind the one byte Name Op and delete children
+      Status = InternalAmlCollapseChildrenIntoObject (
+                 Object,
+                 1,
                  &ChildCount,
-                 &Object->Link,
                  ListHead
                  );
-      if (EFI_ERROR (Status) ||
-          (ChildObject->Data == NULL) ||
-          (ChildObject->DataSize == 0))
-      {
-        DEBUG ((DEBUG_ERROR, "%a: ERROR: %a has no child data.\n", __func__, String));
-        goto Done;
-      }
+      if (EFI_ERROR (Status) || (Object->DataSize <= 1)) {
+        if (!EFI_ERROR (Status)) {
+          Status = EFI_DEVICE_ERROR;
+        }
 
-      Object->Data = AllocatePool (ChildObject->DataSize + 1);
-      // Name Op is one byte
-      Object->DataSize = ChildObject->DataSize + 1;
-      if (Object->Data == NULL) {
-        Status = EFI_OUT_OF_RESOURCES;
-        DEBUG ((DEBUG_ERROR, "%a: ERROR: allocate Object->Data for %a\n", __func__, String));
+        DEBUG ((DEBUG_ERROR, "%a: ERROR: %a has no child data.\n", __func__, String));
         goto Done;
       }
 
-      Object->Data[0] = AML_NAME_OP;
-      CopyMem (
-        &Object->Data[1],
-        ChildObject->Data,
-        ChildObject->DataSize
-        );
-      InternalFreeAmlObject (&ChildObject, ListHead);
+      Object->Data[0]   = AML_NAME_OP;
       Object->Completed = TRUE;
 
       Status = EFI_SUCCESS;
@@ -245,7 +212,6 @@ AmlName (
 Done:
   if (EFI_ERROR (Status)) {
     InternalFreeAmlObject (&Object, ListHead);
-    InternalFreeAmlObject (&ChildObject, ListHead);
   }
 
   return Status;
@@ -329,7 +295,7 @@ AmlOPAlias (
     goto Done;
   }
 
-  Object->Data = AllocateZeroPool (ChildObject->DataSize + 1);
+  Object->Data = InternalAmlAllocateZeroPool (ChildObject->DataSize + 1);
   // Alias Op is one byte
   Object->DataSize = ChildObject->DataSize + 1;
   if (Object->Data == NULL) {
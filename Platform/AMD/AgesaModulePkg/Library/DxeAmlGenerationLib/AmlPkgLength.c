@@ -31,8 +31,9 @@
   include the length of its own encoding.
 
   @param[in]   DataSize  - The size of data to be encoded as a pkglength
-  @param[out]  PkgLengthEncoding  - Return buffer containing the AML encoding
-  @param[out]  ReturnDataLength  - Size of the return buffer
+  @param[out]  PkgLengthEncoding  - Buffer of at least MAX_AML_PKG_LENGTH_ENCODING_SIZE
+                                    bytes to receive the AML encoding
+  @param[out]  ReturnDataLength  - Size of the encoding in PkgLengthEncoding
 
   @return   EFI_SUCCESS     - Success
   @return   all others      - Fail
@@ -41,7 +42,7 @@ EFI_STATUS
 EFIAPI
 InternalAmlBitPkgLength (
   IN   UINT32  DataSize,
-  OUT  UINT8   **PkgLengthEncoding,
+  OUT  UINT8   *PkgLengthEncoding,
   OUT  UINTN   *ReturnDataLength
   )
 {
@@ -82,25 +83,17 @@ InternalAmlBitPkgLength (
     PkgLeadByte |= ((DataSize) & PKG_LENGTH_NIBBLE_MASK);
   }
 
-  // Allocate new data buffer
-  // DataSize = DataLength + DataSize;
-  *PkgLengthEncoding = AllocatePool (DataLength);
-  if (*PkgLengthEncoding == NULL) {
-    Status = EFI_OUT_OF_RESOURCES;
-    DEBUG ((DEBUG_ERROR, "%a: ERROR: allocation failed Object=PkgLength\n", __func__));
-    goto Done;
-  }
-
   // Populate PkgLeadByte
-  *PkgLengthEncoding[0] = PkgLeadByte;
+  PkgLengthEncoding[0] = PkgLeadByte;
 
   // Populate remainder of PkgLength bytes
   PkgLengthRemainder = (DataSize) >> 4;
-  if (PkgLengthRemainder != 0) {
-    CopyMem (&PkgLengthEncoding[0][1], &PkgLengthRemainder, DataLength - 1);
+  if (DataLength > 1) {
+    CopyMem (&PkgLengthEncoding[1], &PkgLengthRemainder, DataLength - 1);
   }
 
   *ReturnDataLength = DataLength;
+  Status            = EFI_SUCCESS;
 
 Done:
   return Status;
@@ -144,8 +137,8 @@ AmlPkgLength (
 {
   EFI_STATUS           Status;
   AML_OBJECT_INSTANCE  *Object;
-  AML_OBJECT_INSTANCE  *ChildObject;
   UINTN                ChildCount;
+  UINTN                ChildDataSize;
   UINTN                DataLength;
   UINT8                PkgLeadByte;
   UINTN                PkgLengthRemainder;
@@ -154,9 +147,8 @@ AmlPkgLength (
     return EFI_INVALID_PARAMETER;
   }
 
-  Status      = EFI_DEVICE_ERROR;
-  Object      = NULL;
-  ChildObject = NULL;
+  Status = EFI_DEVICE_ERROR;
+  Object = NULL;
 
   switch (Phase) {
     case AmlStart:
@@ -174,20 +166,16 @@ AmlPkgLength (
         goto Done;
       }
 
-      // Get rid of original Identifier data
-      InternalFreeAmlObjectData (Object);
-
-      // Collect child data and delete children
-      Status = InternalAmlCollapseAndReleaseChildren (
-                 &ChildObject,
+      // Size the children first so the package length encoding is known
+      // before the single data buffer is allocated
+      Status = InternalAmlGetChildrenDataSize (
+                 &ChildDataSize,
                  &ChildCount,
                  &Object->Link,
                  ListHead
                  );
-      if (EFI_ERROR (Status) ||
-          (ChildObject->Data == NULL) ||
-          (ChildObject->DataSize == 0))
-      {
+      if (EFI_ERROR (Status) || (ChildDataSize == 0)) {
+        Status = EFI_DEVICE_ERROR;
         DEBUG ((DEBUG_ERROR, "%a: ERROR: %a has no child data.\n", __func__, "Length"));
         goto Done;
       }
@@ -195,18 +183,18 @@ AmlPkgLength (
       DataLength = 0;
       // Calculate Length of PkgLength Data and fill out least
       // significant nibble
-      if ((ChildObject->DataSize + 1) <= MAX_ONE_BYTE_PKG_LENGTH) {
+      if ((ChildDataSize + 1) <= MAX_ONE_BYTE_PKG_LENGTH) {
         DataLength   = 1;
         PkgLeadByte  = ONE_BYTE_PKG_LENGTH_ENCODING;
-        PkgLeadByte |= ((ChildObject->DataSize + DataLength) & ONE_BYTE_NIBBLE_MASK);
+        PkgLeadByte |= ((ChildDataSize + DataLength) & ONE_BYTE_NIBBLE_MASK);
       } else {
-        if ((ChildObject->DataSize + 2) <= MAX_TWO_BYTE_PKG_LENGTH) {
+        if ((ChildDataSize + 2) <= MAX_TWO_BYTE_PKG_LENGTH) {
           DataLength  = 2;
           PkgLeadByte = TWO_BYTE_PKG_LENGTH_ENCODING;
-        } else if ((ChildObject->DataSize + 3) <= MAX_THREE_BYTE_PKG_LENGTH) {
+        } else if ((ChildDataSize + 3) <= MAX_THREE_BYTE_PKG_LENGTH) {
           DataLength  = 3;
           PkgLeadByte = THREE_BYTE_PKG_LENGTH_ENCODING;
-        } else if ((ChildObject->DataSize + 4) <= MAX_FOUR_BYTE_PKG_LENGTH) {
+        } else if ((ChildDataSize + 4) <= MAX_FOUR_BYTE_PKG_LENGTH) {
           DataLength  = 4;
           PkgLeadByte = FOUR_BYTE_PKG_LENGTH_ENCODING;
         } else {
@@ -220,14 +208,17 @@ AmlPkgLength (
           goto Done;
         }
 
-        PkgLeadByte |= ((ChildObject->DataSize + DataLength) & PKG_LENGTH_NIBBLE_MASK);
+        PkgLeadByte |= ((ChildDataSize + DataLength) & PKG_LENGTH_NIBBLE_MASK);
       }
 
-      // Allocate new data buffer
-      Object->DataSize = DataLength + ChildObject->DataSize;
-      Object->Data     = AllocatePool (Object->DataSize);
-      if (Object->Data == NULL) {
-        Status = EFI_OUT_OF_RESOURCES;
+      // Collect child data behind the PkgLength bytes and delete children
+      Status = InternalAmlCollapseChildrenIntoObject (
+                 Object,
+                 DataLength,
+                 &ChildCount,
+                 ListHead
+                 );
+      if (EFI_ERROR (Status)) {
         DEBUG ((DEBUG_ERROR, "%a: ERROR: allocation failed Object=PkgLength\n", __func__));
         goto Done;
       }
@@ -236,18 +227,11 @@ AmlPkgLength (
       Object->Data[0] = PkgLeadByte;
 
       // Populate remainder of PkgLength bytes
-      PkgLengthRemainder = (ChildObject->DataSize + DataLength) >> 4;
-      if (PkgLengthRemainder != 0) {
+      PkgLengthRemainder = (ChildDataSize + DataLength) >> 4;
+      if (DataLength > 1) {
         CopyMem (&Object->Data[1], &PkgLengthRemainder, DataLength - 1);
       }
 
-      CopyMem (
-        &Object->Data[DataLength],
-        ChildObject->Data,
-        ChildObject->DataSize
-        );
-
-      InternalFreeAmlObject (&ChildObject, ListHead);
       Object->Completed = TRUE;
       Status            = EFI_SUCCESS;
       break;
@@ -260,7 +244,6 @@ AmlPkgLength (
 Done:
   if (EFI_ERROR (Status)) {
     InternalFreeAmlObject (&Object, ListHead);
-    InternalFreeAmlObject (&ChildObject, ListHead);
   }
 
   return Status;
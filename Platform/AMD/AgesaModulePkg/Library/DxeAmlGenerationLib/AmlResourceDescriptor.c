@@ -90,7 +90,7 @@ AmlResourceTemplate (
       }
 
       Object->DataSize = ChildObject->DataSize + sizeof (EFI_ACPI_END_TAG_DESCRIPTOR);
-      Object->Data     = AllocateZeroPool (Object->DataSize);
+      Object->Data     = InternalAmlAllocateZeroPool (Object->DataSize);
       if (Object->Data == NULL) {
         DEBUG ((DEBUG_ERROR, "%a: ERROR: EndTag Alloc Failed\n", __func__));
         Status = EFI_OUT_OF_RESOURCES;
@@ -367,7 +367,7 @@ InternalAmlOPDWordAddressSpace (
   }
 
   Object->DataSize = sizeof (EFI_ACPI_DWORD_ADDRESS_SPACE_DESCRIPTOR);
-  Object->Data     = AllocateZeroPool (Object->DataSize);
+  Object->Data     = InternalAmlAllocateZeroPool (Object->DataSize);
   if (Object->Data == NULL) {
     DEBUG ((DEBUG_ERROR, "%a: ERROR: %a Alloc Failed\n", __func__, "DWORD_ADDRESS"));
     Status = EFI_OUT_OF_RESOURCES;
@@ -464,7 +464,7 @@ AmlOPDma (
   }
 
   Object->DataSize = sizeof (EFI_ACPI_DMA_DESCRIPTOR);
-  Object->Data     = AllocateZeroPool (Object->DataSize);
+  Object->Data     = InternalAmlAllocateZeroPool (Object->DataSize);
   if (Object->Data == NULL) {
     DEBUG ((DEBUG_ERROR, "%a: ERROR: %a Alloc Failed\n", __func__, "DMA_RESOURCE"));
     Status = EFI_OUT_OF_RESOURCES;
@@ -843,7 +843,7 @@ InternalAmlOPQWordAddressSpace (
   }
 
   Object->DataSize = sizeof (EFI_ACPI_QWORD_ADDRESS_SPACE_DESCRIPTOR);
-  Object->Data     = AllocateZeroPool (Object->DataSize);
+  Object->Data     = InternalAmlAllocateZeroPool (Object->DataSize);
   if (Object->Data == NULL) {
     DEBUG ((DEBUG_ERROR, "%a: ERROR: %a Alloc Failed\n", __func__, "QWORD_ADDRESS"));
     Status = EFI_OUT_OF_RESOURCES;
@@ -980,7 +980,7 @@ AmlOPIRQ (
   }
 
   Object->DataSize = sizeof (EFI_ACPI_IRQ_DESCRIPTOR);
-  Object->Data     = AllocateZeroPool (Object->DataSize);
+  Object->Data     = InternalAmlAllocateZeroPool (Object->DataSize);
   if (Object->Data == NULL) {
     DEBUG ((DEBUG_ERROR, "%a: ERROR: Alloc for %a failed\n", __func__, "IRQ_RESOURCE"));
     Status = EFI_OUT_OF_RESOURCES;
@@ -1151,7 +1151,7 @@ AmlOPIO (
   }
 
   Object->DataSize = sizeof (EFI_ACPI_IO_PORT_DESCRIPTOR);
-  Object->Data     = AllocateZeroPool (Object->DataSize);
+  Object->Data     = InternalAmlAllocateZeroPool (Object->DataSize);
   if (Object->Data == NULL) {
     DEBUG ((DEBUG_ERROR, "%a: ERROR: %a Alloc Failed\n", __func__, "IO_RESOURCE"));
     Status = EFI_OUT_OF_RESOURCES;
@@ -1259,7 +1259,7 @@ AmlOPRegister (
   }
 
   Object->DataSize = sizeof (EFI_ACPI_GENERIC_REGISTER_DESCRIPTOR);
-  Object->Data     = AllocateZeroPool (Object->DataSize);
+  Object->Data     = InternalAmlAllocateZeroPool (Object->DataSize);
   if (Object->Data == NULL) {
     DEBUG ((DEBUG_ERROR, "%a: ERROR: %a Alloc Failed\n", __func__, "IO_RESOURCE"));
     Status = EFI_OUT_OF_RESOURCES;
@@ -1446,7 +1446,7 @@ AmlOPMemory32Fixed (
   }
 
   Object->DataSize = sizeof (EFI_ACPI_32_BIT_FIXED_MEMORY_RANGE_DESCRIPTOR);
-  Object->Data     = AllocateZeroPool (Object->DataSize);
+  Object->Data     = InternalAmlAllocateZeroPool (Object->DataSize);
   if (Object->Data == NULL) {
     DEBUG ((DEBUG_ERROR, "%a: ERROR: %a Alloc Failed\n", __func__, "MEMORY_32_FIXED_RESOURCE"));
     Status = EFI_OUT_OF_RESOURCES;
@@ -1732,7 +1732,7 @@ InternalAmlOPWordAddressSpace (
   }
 
   Object->DataSize = sizeof (EFI_ACPI_WORD_ADDRESS_SPACE_DESCRIPTOR);
-  Object->Data     = AllocateZeroPool (Object->DataSize);
+  Object->Data     = InternalAmlAllocateZeroPool (Object->DataSize);
   if (Object->Data == NULL) {
     DEBUG ((DEBUG_ERROR, "%a: ERROR: %a Alloc Failed\n", __func__, "DWORD_ADDRESS"));
     Status = EFI_OUT_OF_RESOURCES;
@@ -124,7 +124,7 @@ AmlElse (
       }
 
       // Allocate buffer for Return object
-      Object->Data     = AllocatePool (ChildObject->DataSize + 1);
+      Object->Data     = InternalAmlAllocatePool (ChildObject->DataSize + 1);
       Object->DataSize = ChildObject->DataSize + 1;
       if (Object->Data == NULL) {
         Status = EFI_OUT_OF_RESOURCES;
@@ -272,7 +272,7 @@ AmlIf (
       }
 
       // Allocate buffer for Return object
-      Object->Data     = AllocatePool (ChildObject->DataSize + 1);
+      Object->Data     = InternalAmlAllocatePool (ChildObject->DataSize + 1);
       Object->DataSize = ChildObject->DataSize + 1;
       if (Object->Data == NULL) {
         Status = EFI_OUT_OF_RESOURCES;
@@ -373,7 +373,7 @@ AmlOPNotify (
   }
 
   // Allocate buffer for Return object
-  Object->Data     = AllocatePool (ChildObject->DataSize + 1);
+  Object->Data     = InternalAmlAllocatePool (ChildObject->DataSize + 1);
   Object->DataSize = ChildObject->DataSize + 1;
   if (Object->Data == NULL) {
     Status = EFI_OUT_OF_RESOURCES;
@@ -469,7 +469,7 @@ AmlReturn (
       if ((ChildObject->Data == NULL) || (ChildObject->DataSize == 0)) {
         // Return without arguments is treated like Return(0)
         // Zeroed byte = ZeroOp
-        ChildObject->Data = AllocateZeroPool (sizeof (UINT8));
+        ChildObject->Data = InternalAmlAllocateZeroPool (sizeof (UINT8));
         if (ChildObject->Data == NULL) {
           Status = EFI_OUT_OF_RESOURCES;
           DEBUG ((DEBUG_ERROR, "%a: ERROR: allocate Zero Child for Return\n", __func__));
@@ -480,7 +480,7 @@ AmlReturn (
       }
 
       // Allocate buffer for Return object
-      Object->Data     = AllocatePool (ChildObject->DataSize + 1);
+      Object->Data     = InternalAmlAllocatePool (ChildObject->DataSize + 1);
       Object->DataSize = ChildObject->DataSize + 1;
       if (Object->Data == NULL) {
         Status = EFI_OUT_OF_RESOURCES;
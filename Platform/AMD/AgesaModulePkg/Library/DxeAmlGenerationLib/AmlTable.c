@@ -71,7 +71,6 @@ AmlDefinitionBlock (
 {
   EFI_STATUS           Status;
   AML_OBJECT_INSTANCE  *Object;
-  AML_OBJECT_INSTANCE  *ChildObject;
   UINTN                ChildCount;
 
   if ((Phase >= AmlInvalid) ||
@@ -88,13 +87,18 @@ AmlDefinitionBlock (
     return EFI_INVALID_PARAMETER;
   }
 
-  Status      = EFI_DEVICE_ERROR;
-  Object      = NULL;
-  ChildObject = NULL;
+  Status = EFI_DEVICE_ERROR;
+  Object = NULL;
 
   switch (Phase) {
     case AmlStart:
+      // Objects of the table are built in the arena until AmlClose
+      InternalAmlArenaStart ();
       Status = InternalAppendNewAmlObject (&Object, TableNameString, ListHead);
+      if (EFI_ERROR (Status)) {
+        InternalAmlArenaEnd ();
+      }
+
       // TermList is too complicated and must be added outside
       break;
 
@@ -106,31 +110,23 @@ AmlDefinitionBlock (
         goto Done;
       }
 
-      // Get rid of original Identifier data
-      InternalFreeAmlObjectData (Object);
-
-      // Collect child data and delete children
-      Status = InternalAmlCollapseAndReleaseChildren (
-                 &ChildObject,
+      // Collect child data behind the table header and delete children
+      Status = InternalAmlCollapseChildrenIntoObject (
+                 Object,
+                 sizeof (EFI_ACPI_DESCRIPTION_HEADER),
                  &ChildCount,
-                 &Object->Link,
                  ListHead
                  );
-      if (EFI_ERROR (Status) ||
-          (ChildObject->Data == NULL) ||
-          (ChildObject->DataSize == 0))
-      {
+      if (EFI_ERROR (Status) || (Object->DataSize <= sizeof (EFI_ACPI_DESCRIPTION_HEADER))) {
+        if (!EFI_ERROR (Status)) {
+          Status = EFI_DEVICE_ERROR;
+        }
+
         DEBUG ((DEBUG_ERROR, "%a: ERROR: %a has no child data.\n", __func__, TableNameString));
         goto Done;
       }
 
-      Object->DataSize = ChildObject->DataSize + sizeof (EFI_ACPI_DESCRIPTION_HEADER);
-      Object->Data     = AllocateZeroPool (Object->DataSize);
-      if (Object->Data == NULL) {
-        Status = EFI_OUT_OF_RESOURCES;
-        DEBUG ((DEBUG_ERROR, "%a: ERROR: allocate Object->Data for %a\n", __func__, TableNameString));
-        goto Done;
-      }
+      ZeroMem (Object->Data, sizeof (EFI_ACPI_DESCRIPTION_HEADER));
 
       // Fill table header with data
       // Signature
@@ -185,17 +181,16 @@ AmlDefinitionBlock (
         sizeof (UINT32)
         );
 
-      // Copy rest of data into Object
-      CopyMem (
-        &Object->Data[sizeof (EFI_ACPI_DESCRIPTION_HEADER)],
-        ChildObject->Data,
-        ChildObject->DataSize
-        );
-
       // Checksum Set on Table Install
-      InternalFreeAmlObject (&ChildObject, ListHead);
       Object->Completed = TRUE;
-      Status            = EFI_SUCCESS;
+
+      // The completed table outlives the arena
+      Status = InternalAmlMoveObjectToPool (&Object);
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_ERROR, "%a: ERROR: move %a out of arena\n", __func__, TableNameString));
+        goto Done;
+      }
+
       break;
 
     default:
@@ -206,7 +201,11 @@ AmlDefinitionBlock (
 Done:
   if (EFI_ERROR (Status)) {
     InternalFreeAmlObject (&Object, ListHead);
-    InternalFreeAmlObject (&ChildObject, ListHead);
+  }
+
+  if (Phase == AmlClose) {
+    // Releases the arena unless objects of a failed table are still listed
+    InternalAmlArenaEnd ();
   }
 
   return Status;
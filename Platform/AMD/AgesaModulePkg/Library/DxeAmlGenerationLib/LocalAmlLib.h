@@ -27,6 +27,12 @@
 // The max string size for a QWord is 8 bytes = 16 characters plus NULL Terminator
 #define MAX_AML_DATA_INTEGER_SIZE  17
 
+// An encoded integer is a one byte prefix plus up to a QWord of data
+#define MAX_AML_DATA_INTEGER_ENCODING_SIZE  (sizeof (UINT64) + 1)
+
+// A PkgLength encoding is one to four bytes
+#define MAX_AML_PKG_LENGTH_ENCODING_SIZE  4
+
 // Defines similar to ctype.h functions isalpha() and isdigit()
 #define IS_ASCII_UPPER_ALPHA(c)  ( ((c) >= AML_NAME_CHAR_A) && ((c) <= AML_NAME_CHAR_Z) )
 #define IS_ASCII_HEX_DIGIT(c)    ( (((c) >= AML_DIGIT_CHAR_0) && ((c) <= AML_DIGIT_CHAR_9)) ||\
@@ -43,17 +49,17 @@
   Not a public function so no doxygen comment identifiers.
 
   @param[in]    Integer         - Integer value to encode
-  @param[out]   ReturnData      - Allocated DataBuffer with encoded integer
-  @param[out]   ReturnDataSize  - Size of ReturnData
+  @param[out]   ReturnData      - Buffer of at least MAX_AML_DATA_INTEGER_ENCODING_SIZE
+                                  bytes to receive the encoded integer
+  @param[out]   ReturnDataSize  - Size of encoded integer in ReturnData
 
   @return       EFI_SUCCESS     - Successful completion
-  @return       EFI_OUT_OF_RESOURCES - Failed to allocate ReturnDataBuffer
 */
 EFI_STATUS
 EFIAPI
 InternalAmlDataIntegerBuffer (
   IN      UINT64  Integer,
-  OUT     VOID    **ReturnData,
+  OUT     UINT8   *ReturnData,
   OUT     UINTN   *ReturnDataSize
   );
 
@@ -63,8 +69,9 @@ InternalAmlDataIntegerBuffer (
   include the length of its own encoding.
 
   @param[in]   DataSize  - The size of data to be encoded as a pkglength
-  @param[out]  PkgLengthEncoding  - Return buffer containing the AML encoding
-  @param[out]  ReturnDataLength  - Size of the return buffer
+  @param[out]  PkgLengthEncoding  - Buffer of at least MAX_AML_PKG_LENGTH_ENCODING_SIZE
+                                    bytes to receive the AML encoding
+  @param[out]  ReturnDataLength  - Size of the encoding in PkgLengthEncoding
 
   @return   EFI_SUCCESS     - Success
   @return   all others      - Fail
@@ -73,7 +80,7 @@ EFI_STATUS
 EFIAPI
 InternalAmlBitPkgLength (
   IN   UINT32  DataSize,
-  OUT  UINT8   **PkgLengthEncoding,
+  OUT  UINT8   *PkgLengthEncoding,
   OUT  UINTN   *ReturnDataLength
   );
 
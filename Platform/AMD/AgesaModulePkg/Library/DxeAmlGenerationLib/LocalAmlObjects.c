@@ -11,6 +11,276 @@
 
 #define FILECODE  LIBRARY_DXEAMLGENERATIONLIB_LOCALAMLOBJECTS_FILECODE
 
+// Objects and small data buffers built inside a DefinitionBlock are carved
+// out of large chunks instead of being allocated one by one from pool.
+#define AML_ARENA_CHUNK_DATA_SIZE       (SIZE_64KB - sizeof (AML_ARENA_CHUNK))
+#define AML_ARENA_MAX_ALLOCATION_SIZE   256
+#define AML_ARENA_ALLOCATION_ALIGNMENT  sizeof (UINT64)
+
+// Every buffer from InternalAmlAllocatePool follows this header, so that
+// InternalAmlFreePool knows where it came from without a lookup.
+#define AML_ALLOCATION_SIGNATURE  SIGNATURE_32 ('A', 'M', 'L', 'B')
+
+typedef struct {
+  UINT32     Signature;
+  BOOLEAN    InArena;
+} AML_ALLOCATION_HEADER;
+
+typedef struct _AML_ARENA_CHUNK AML_ARENA_CHUNK;
+
+struct _AML_ARENA_CHUNK {
+  AML_ARENA_CHUNK    *Next;
+  UINTN              Used;
+};
+
+typedef struct {
+  AML_ARENA_CHUNK    *Chunks;
+  UINTN              Depth;
+  UINTN              LiveCount;
+} AML_ARENA;
+
+STATIC AML_ARENA  mAmlArena = { NULL, 0, 0 };
+
+/**
+  Release all arena chunks once nothing allocated from them is still in use
+  and no DefinitionBlock is being built.
+**/
+STATIC
+VOID
+InternalAmlArenaRelease (
+  VOID
+  )
+{
+  AML_ARENA_CHUNK  *Chunk;
+
+  if ((mAmlArena.Depth != 0) || (mAmlArena.LiveCount != 0)) {
+    return;
+  }
+
+  while (mAmlArena.Chunks != NULL) {
+    Chunk            = mAmlArena.Chunks;
+    mAmlArena.Chunks = Chunk->Next;
+    FreePool (Chunk);
+  }
+}
+
+/**
+  Returns the allocation header of a buffer from InternalAmlAllocatePool
+
+  @param [in]     Buffer      - Buffer from InternalAmlAllocatePool
+
+  @return         Pointer to the header in front of Buffer
+**/
+STATIC
+AML_ALLOCATION_HEADER *
+InternalAmlAllocationHeader (
+  IN      VOID  *Buffer
+  )
+{
+  AML_ALLOCATION_HEADER  *Header;
+
+  Header = (AML_ALLOCATION_HEADER *)Buffer - 1;
+  ASSERT (Header->Signature == AML_ALLOCATION_SIGNATURE);
+  return Header;
+}
+
+/**
+  Allocates a buffer for AML Object use from pool, never from the arena
+
+  @param [in]     AllocationSize  - Bytes to allocate
+
+  @return         Pointer to the buffer, NULL on failure
+**/
+STATIC
+VOID *
+InternalAmlAllocateFromPool (
+  IN      UINTN  AllocationSize
+  )
+{
+  AML_ALLOCATION_HEADER  *Header;
+
+  if (AllocationSize > MAX_UINTN - sizeof (AML_ALLOCATION_HEADER)) {
+    return NULL;
+  }
+
+  Header = AllocatePool (sizeof (AML_ALLOCATION_HEADER) + AllocationSize);
+  if (Header == NULL) {
+    return NULL;
+  }
+
+  Header->Signature = AML_ALLOCATION_SIGNATURE;
+  Header->InArena   = FALSE;
+
+  return Header + 1;
+}
+
+/**
+  Start using the arena for AML allocations.  Called when a DefinitionBlock
+  is started.
+**/
+VOID
+EFIAPI
+InternalAmlArenaStart (
+  VOID
+  )
+{
+  mAmlArena.Depth++;
+}
+
+/**
+  Stop using the arena for AML allocations.  Called when a DefinitionBlock
+  is closed.  Chunks are released as soon as no arena allocation remains in
+  use, a failed table keeps them until its list is freed.
+**/
+VOID
+EFIAPI
+InternalAmlArenaEnd (
+  VOID
+  )
+{
+  if (mAmlArena.Depth != 0) {
+    mAmlArena.Depth--;
+  }
+
+  InternalAmlArenaRelease ();
+}
+
+/**
+  Allocates a buffer for AML Object use
+
+  Small buffers requested while a DefinitionBlock is being built come from
+  the arena, everything else from pool.  Must be freed by InternalAmlFreePool.
+
+  @param [in]     AllocationSize  - Bytes to allocate
+
+  @return         Pointer to the buffer, NULL on failure
+**/
+VOID *
+EFIAPI
+InternalAmlAllocatePool (
+  IN      UINTN  AllocationSize
+  )
+{
+  AML_ARENA_CHUNK        *Chunk;
+  AML_ALLOCATION_HEADER  *Header;
+
+  if ((mAmlArena.Depth == 0) ||
+      (AllocationSize == 0) ||
+      (AllocationSize > AML_ARENA_MAX_ALLOCATION_SIZE))
+  {
+    return InternalAmlAllocateFromPool (AllocationSize);
+  }
+
+  AllocationSize = ALIGN_VALUE (
+                     sizeof (AML_ALLOCATION_HEADER) + AllocationSize,
+                     AML_ARENA_ALLOCATION_ALIGNMENT
+                     );
+  Chunk          = mAmlArena.Chunks;
+  if ((Chunk == NULL) || ((AML_ARENA_CHUNK_DATA_SIZE - Chunk->Used) < AllocationSize)) {
+    Chunk = AllocatePool (sizeof (AML_ARENA_CHUNK) + AML_ARENA_CHUNK_DATA_SIZE);
+    if (Chunk == NULL) {
+      return NULL;
+    }
+
+    Chunk->Used      = 0;
+    Chunk->Next      = mAmlArena.Chunks;
+    mAmlArena.Chunks = Chunk;
+  }
+
+  Header       = (AML_ALLOCATION_HEADER *)((UINT8 *)(Chunk + 1) + Chunk->Used);
+  Chunk->Used += AllocationSize;
+  mAmlArena.LiveCount++;
+
+  Header->Signature = AML_ALLOCATION_SIGNATURE;
+  Header->InArena   = TRUE;
+
+  return Header + 1;
+}
+
+/**
+  Allocates a zeroed buffer for AML Object use
+
+  @param [in]     AllocationSize  - Bytes to allocate
+
+  @return         Pointer to the buffer, NULL on failure
+**/
+VOID *
+EFIAPI
+InternalAmlAllocateZeroPool (
+  IN      UINTN  AllocationSize
+  )
+{
+  VOID  *Buffer;
+
+  Buffer = InternalAmlAllocatePool (AllocationSize);
+  if (Buffer != NULL) {
+    ZeroMem (Buffer, AllocationSize);
+  }
+
+  return Buffer;
+}
+
+/**
+  Reallocates a buffer from InternalAmlAllocatePool
+
+  @param [in]     OldSize     - Size of OldBuffer in bytes
+  @param [in]     NewSize     - Size of the new buffer in bytes
+  @param [in]     OldBuffer   - Buffer to copy and free, may be NULL
+
+  @return         Pointer to the new buffer, NULL on failure.  OldBuffer is
+                  left untouched on failure.
+**/
+VOID *
+EFIAPI
+InternalAmlReallocatePool (
+  IN      UINTN  OldSize,
+  IN      UINTN  NewSize,
+  IN      VOID   *OldBuffer
+  )
+{
+  VOID  *NewBuffer;
+
+  NewBuffer = InternalAmlAllocateZeroPool (NewSize);
+  if ((NewBuffer != NULL) && (OldBuffer != NULL)) {
+    CopyMem (NewBuffer, OldBuffer, MIN (OldSize, NewSize));
+    InternalAmlFreePool (OldBuffer);
+  }
+
+  return NewBuffer;
+}
+
+/**
+  Frees a buffer from InternalAmlAllocatePool
+
+  Arena space is not reused, the chunks are released together once the last
+  arena allocation is freed after its DefinitionBlock is closed.
+
+  @param [in]     Buffer      - Buffer to free
+**/
+VOID
+EFIAPI
+InternalAmlFreePool (
+  IN      VOID  *Buffer
+  )
+{
+  AML_ALLOCATION_HEADER  *Header;
+
+  if (Buffer == NULL) {
+    return;
+  }
+
+  Header            = InternalAmlAllocationHeader (Buffer);
+  Header->Signature = 0;
+  if (!Header->InArena) {
+    FreePool (Header);
+    return;
+  }
+
+  ASSERT (mAmlArena.LiveCount != 0);
+  mAmlArena.LiveCount--;
+  InternalAmlArenaRelease ();
+}
+
 /**
   Free Object->Data
 
@@ -33,7 +303,7 @@ InternalFreeAmlObjectData (
   }
 
   if (Object->Data != NULL) {
-    FreePool (Object->Data);
+    InternalAmlFreePool (Object->Data);
     Object->Data      = NULL;
     Object->DataSize  = 0;
     Object->Completed = FALSE;
@@ -49,6 +319,10 @@ InternalFreeAmlObjectData (
   Frees Object->Data
   Frees Object
 
+  Objects are zero allocated, so a NULL ForwardLink marks an Object that was
+  never inserted in a list.  Walking ListHead to find out would make freeing
+  all children of a large scope quadratic.
+
   @param [in]     Object      - Pointer to Object to be freed
   @param [in,out] ListHead    - Head of AML Object linked list
 
@@ -71,11 +345,11 @@ InternalFreeAmlObject (
   Object = *FreeObject;
   if (Object != NULL) {
     InternalFreeAmlObjectData (Object);
-    if (IsNodeInList (ListHead, &Object->Link)) {
+    if (Object->Link.ForwardLink != NULL) {
       RemoveEntryList (&Object->Link);
     }
 
-    FreePool (Object);
+    InternalAmlFreePool (Object);
   }
 
   *FreeObject = NULL;
@@ -108,7 +382,7 @@ InternalNewAmlObjectNoData (
   *ReturnObject = NULL;
 
   // Allocate AML Object
-  Object = AllocateZeroPool (sizeof (AML_OBJECT_INSTANCE));
+  Object = InternalAmlAllocateZeroPool (sizeof (AML_OBJECT_INSTANCE));
   if (Object == NULL) {
     DEBUG ((DEBUG_ERROR, "%a: ERROR: Allocate Object Failed\n", __func__));
     return EFI_OUT_OF_RESOURCES;
@@ -194,7 +468,7 @@ InternalAppendNewAmlObject (
 
   // Allocate Identifier Data + NULL termination
   Object->DataSize = AsciiStrLen (Identifier) + 1;
-  Object->Data     = AllocatePool (Object->DataSize);
+  Object->Data     = InternalAmlAllocatePool (Object->DataSize);
   if (Object->Data == NULL) {
     DEBUG ((DEBUG_ERROR, "%a: ERROR: Allocate Data Identifier=%a\n", __func__, Identifier));
     InternalFreeAmlObject (&Object, ListHead);
@@ -275,10 +549,89 @@ InternalAmlLocateObjectByIdentifier (
   return EFI_NOT_FOUND;
 }
 
+/**
+  Sums up the Data sizes of all children of the Link
+
+  @param [out]    DataSize      - Total Data size of the children
+  @param [out]    ChildCount    - Count of Child Objects
+  @param [in]     Link          - Linked List Object entry to collect children
+  @param [in]     ListHead      - Head of Object Linked List
+
+  @return         EFI_SUCCESS   - DataSize and ChildCount returned
+  @return         <all others>  - Invalid parameter
+**/
+EFI_STATUS
+EFIAPI
+InternalAmlGetChildrenDataSize (
+  OUT  UINTN       *DataSize,
+  OUT  UINTN       *ChildCount,
+  IN   LIST_ENTRY  *Link,
+  IN   LIST_ENTRY  *ListHead
+  )
+{
+  LIST_ENTRY           *Node;
+  AML_OBJECT_INSTANCE  *ChildObject;
+
+  if ((DataSize == NULL) ||
+      (ChildCount == NULL) ||
+      (Link == NULL) ||
+      (ListHead == NULL))
+  {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  *DataSize   = 0;
+  *ChildCount = 0;
+  Node        = GetNextNode (ListHead, Link);
+  while (Node != ListHead) {
+    ChildObject = AML_OBJECT_INSTANCE_FROM_LINK (Node);
+    *DataSize  += ChildObject->DataSize;
+    *ChildCount = *ChildCount + 1;
+    Node        = GetNextNode (ListHead, Node);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Copies the Data of all children of the Link into Buffer and frees the
+  children. Buffer must be large enough, see InternalAmlGetChildrenDataSize.
+
+  @param [out]    Buffer        - Buffer to receive the children Data
+  @param [in]     Link          - Linked List Object entry to collect children
+  @param [in,out] ListHead      - Head of Object Linked List
+**/
+STATIC
+VOID
+InternalAmlCopyAndReleaseChildren (
+  OUT     UINT8       *Buffer,
+  IN      LIST_ENTRY  *Link,
+  IN OUT  LIST_ENTRY  *ListHead
+  )
+{
+  LIST_ENTRY           *Node;
+  AML_OBJECT_INSTANCE  *ChildObject;
+
+  Node = GetNextNode (ListHead, Link);
+  while (Node != ListHead) {
+    ChildObject = AML_OBJECT_INSTANCE_FROM_LINK (Node);
+    if (ChildObject->DataSize != 0) {
+      CopyMem (Buffer, ChildObject->Data, ChildObject->DataSize);
+      Buffer += ChildObject->DataSize;
+    }
+
+    // Get Next ChildObject Node, then free ChildObject from list
+    Node = GetNextNode (ListHead, Node);
+    InternalFreeAmlObject (&ChildObject, ListHead);
+  }
+}
+
 /**
   Finds all children of the Link and appends them into a single ObjectData
   buffer of ObjectDataSize
 
+  The children are sized first so the buffer is allocated only once.
+
   Allocates AML_OBJECT_INSTANCE and Data which must be freed by caller
 
   @param [out]    ReturnObject  - Pointer to an Object pointer
@@ -299,10 +652,8 @@ InternalAmlCollapseAndReleaseChildren (
   )
 {
   EFI_STATUS           Status;
-  LIST_ENTRY           *Node;
   AML_OBJECT_INSTANCE  *Object;
-  AML_OBJECT_INSTANCE  *ChildObject;
-  UINT8                *TempBuffer;
+  UINTN                DataSize;
 
   Status = EFI_SUCCESS;
   if ((ReturnObject == NULL) ||
@@ -321,38 +672,21 @@ InternalAmlCollapseAndReleaseChildren (
     goto Done;
   }
 
-  // Get first Child Node
-  Node = GetNextNode (ListHead, Link);
-  while (Node != ListHead) {
-    ChildObject = AML_OBJECT_INSTANCE_FROM_LINK (Node);
-    // Expand data buffer to fit existing data + new data
-    TempBuffer = ReallocatePool (
-                   Object->DataSize,
-                   Object->DataSize + ChildObject->DataSize,
-                   Object->Data
-                   );
-    if (TempBuffer == NULL) {
-      Status = EFI_OUT_OF_RESOURCES;
-      FreePool (Object->Data);
-      Object->Data = NULL;
-      DEBUG ((DEBUG_ERROR, "%a: ERROR: reallocating Object Data\n", __func__));
+  InternalAmlGetChildrenDataSize (&DataSize, ChildCount, Link, ListHead);
+  if (DataSize != 0) {
+    Object->Data = InternalAmlAllocatePool (DataSize);
+    if (Object->Data == NULL) {
+      Status      = EFI_OUT_OF_RESOURCES;
+      *ChildCount = 0;
+      DEBUG ((DEBUG_ERROR, "%a: ERROR: allocating Object Data\n", __func__));
       goto Done;
     }
 
-    Object->Data = TempBuffer;
-    // Copy new data at end of buffer
-    CopyMem (
-      &Object->Data[Object->DataSize],
-      ChildObject->Data,
-      ChildObject->DataSize
-      );
-    Object->DataSize += ChildObject->DataSize;
-    // Get Next ChildObject Node, then free ChildObject from list
-    Node = GetNextNode (ListHead, Node);
-    InternalFreeAmlObject (&ChildObject, ListHead);
-    *ChildCount = *ChildCount + 1;
+    Object->DataSize = DataSize;
   }
 
+  InternalAmlCopyAndReleaseChildren (Object->Data, Link, ListHead);
+
 Done:
   if (EFI_ERROR (Status)) {
     InternalFreeAmlObject (&Object, ListHead);
@@ -362,3 +696,127 @@ Done:
   *ReturnObject = Object;
   return Status;
 }
+
+/**
+  Replaces Object->Data with the Data of all children of Object, placed after
+  PrefixSize bytes which are left for the caller to fill in (opcode, package
+  length, table header). The children are freed.
+
+  This saves the intermediate collapsed child Object and its copy.
+
+  @param [in,out] Object        - Object to collect its children into
+  @param [in]     PrefixSize    - Bytes to reserve in front of the children Data
+  @param [out]    ChildCount    - Count of Child Objects collapsed
+  @param [in,out] ListHead      - Head of Object Linked List
+
+  @return         EFI_SUCCESS   - Object->Data holds prefix and children Data
+  @return         <all others>  - Collapse failed, children are left in place
+**/
+EFI_STATUS
+EFIAPI
+InternalAmlCollapseChildrenIntoObject (
+  IN OUT  AML_OBJECT_INSTANCE  *Object,
+  IN      UINTN                PrefixSize,
+  OUT     UINTN                *ChildCount,
+  IN OUT  LIST_ENTRY           *ListHead
+  )
+{
+  UINTN  DataSize;
+
+  if ((Object == NULL) ||
+      (ChildCount == NULL) ||
+      (ListHead == NULL))
+  {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  // Get rid of original Identifier data
+  InternalFreeAmlObjectData (Object);
+
+  InternalAmlGetChildrenDataSize (&DataSize, ChildCount, &Object->Link, ListHead);
+  if (PrefixSize + DataSize == 0) {
+    return EFI_SUCCESS;
+  }
+
+  Object->Data = InternalAmlAllocatePool (PrefixSize + DataSize);
+  if (Object->Data == NULL) {
+    *ChildCount = 0;
+    DEBUG ((DEBUG_ERROR, "%a: ERROR: allocating Object Data\n", __func__));
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Object->DataSize = PrefixSize + DataSize;
+  InternalAmlCopyAndReleaseChildren (&Object->Data[PrefixSize], &Object->Link, ListHead);
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Moves an Object and its Data out of the arena into pool memory, keeping
+  its place in the linked list.  Used for the completed table which outlives
+  the arena.
+
+  @param [in,out] Object        - Pointer to Object pointer, updated on return
+
+  @return         EFI_SUCCESS   - Object is in pool memory
+  @return         <all others>  - Allocation failed, Object is unchanged
+**/
+EFI_STATUS
+EFIAPI
+InternalAmlMoveObjectToPool (
+  IN OUT  AML_OBJECT_INSTANCE  **Object
+  )
+{
+  AML_OBJECT_INSTANCE  *OldObject;
+  AML_OBJECT_INSTANCE  *NewObject;
+  UINT8                *Data;
+
+  if ((Object == NULL) || (*Object == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  OldObject = *Object;
+  Data      = OldObject->Data;
+  if ((Data != NULL) && InternalAmlAllocationHeader (Data)->InArena) {
+    Data = InternalAmlAllocateFromPool (OldObject->DataSize);
+    if (Data == NULL) {
+      DEBUG ((DEBUG_ERROR, "%a: ERROR: allocating Object Data\n", __func__));
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    CopyMem (Data, OldObject->Data, OldObject->DataSize);
+  }
+
+  if (!InternalAmlAllocationHeader (OldObject)->InArena) {
+    if (Data != OldObject->Data) {
+      InternalAmlFreePool (OldObject->Data);
+      OldObject->Data = Data;
+    }
+
+    return EFI_SUCCESS;
+  }
+
+  NewObject = InternalAmlAllocateFromPool (sizeof (AML_OBJECT_INSTANCE));
+  if (NewObject == NULL) {
+    if (Data != OldObject->Data) {
+      InternalAmlFreePool (Data);
+    }
+
+    DEBUG ((DEBUG_ERROR, "%a: ERROR: Allocate Object Failed\n", __func__));
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  // Take the old Object's place in the list
+  CopyMem (NewObject, OldObject, sizeof (AML_OBJECT_INSTANCE));
+  NewObject->Data = Data;
+  InsertHeadList (&OldObject->Link, &NewObject->Link);
+  RemoveEntryList (&OldObject->Link);
+  if (Data != OldObject->Data) {
+    InternalAmlFreePool (OldObject->Data);
+  }
+
+  InternalAmlFreePool (OldObject);
+
+  *Object = NewObject;
+  return EFI_SUCCESS;
+}
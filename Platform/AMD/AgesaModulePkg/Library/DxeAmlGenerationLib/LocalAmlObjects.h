@@ -11,6 +11,88 @@
 
 // #include "LocalAmlLib.h"
 
+/**
+  Start using the arena for AML allocations.  Called when a DefinitionBlock
+  is started.
+**/
+VOID
+EFIAPI
+InternalAmlArenaStart (
+  VOID
+  );
+
+/**
+  Stop using the arena for AML allocations.  Called when a DefinitionBlock
+  is closed.
+**/
+VOID
+EFIAPI
+InternalAmlArenaEnd (
+  VOID
+  );
+
+/**
+  Allocates a buffer for AML Object use
+
+  Small buffers requested while a DefinitionBlock is being built come from
+  the arena, everything else from pool.  Must be freed by InternalAmlFreePool.
+
+  @param [in]     AllocationSize  - Bytes to allocate
+
+  @return         Pointer to the buffer, NULL on failure
+**/
+VOID *
+EFIAPI
+InternalAmlAllocatePool (
+  IN      UINTN  AllocationSize
+  );
+
+/**
+  Allocates a zeroed buffer for AML Object use
+
+  @param [in]     AllocationSize  - Bytes to allocate
+
+  @return         Pointer to the buffer, NULL on failure
+**/
+VOID *
+EFIAPI
+InternalAmlAllocateZeroPool (
+  IN      UINTN  AllocationSize
+  );
+
+/**
+  Reallocates a buffer from InternalAmlAllocatePool
+
+  @param [in]     OldSize     - Size of OldBuffer in bytes
+  @param [in]     NewSize     - Size of the new buffer in bytes
+  @param [in]     OldBuffer   - Buffer to copy and free, may be NULL
+
+  @return         Pointer to the new buffer, NULL on failure.  OldBuffer is
+                  left untouched on failure.
+**/
+VOID *
+EFIAPI
+InternalAmlReallocatePool (
+  IN      UINTN  OldSize,
+  IN      UINTN  NewSize,
+  IN      VOID   *OldBuffer
+  );
+
+/**
+  Frees a buffer from InternalAmlAllocatePool
+
+  Object->Data and Objects themselves must always come from
+  InternalAmlAllocatePool, InternalAmlAllocateZeroPool or
+  InternalAmlReallocatePool.
+
+  @param [in]     Buffer      - Buffer to free
+**/
+VOID
+EFIAPI
+InternalAmlFreePool (
+  IN      VOID  *Buffer
+  );
+
 /**
   Free Object->Data
 
@@ -124,6 +206,26 @@ InternalAmlLocateObjectByIdentifier (
   IN      LIST_ENTRY        *ListHead
   );
 
+/**
+  Sums up the Data sizes of all children of the Link
+
+  @param [out]    DataSize      - Total Data size of the children
+  @param [out]    ChildCount    - Count of Child Objects
+  @param [in]     Link          - Linked List Object entry to collect children
+  @param [in]     ListHead      - Head of Object Linked List
+
+  @return         EFI_SUCCESS   - DataSize and ChildCount returned
+  @return         <all others>  - Invalid parameter
+**/
+EFI_STATUS
+EFIAPI
+InternalAmlGetChildrenDataSize (
+  OUT  UINTN       *DataSize,
+  OUT  UINTN       *ChildCount,
+  IN   LIST_ENTRY  *Link,
+  IN   LIST_ENTRY  *ListHead
+  );
+
 /**
   Finds all children of the Link and appends them into a single ObjectData
   buffer of ObjectDataSize
@@ -147,4 +249,41 @@ InternalAmlCollapseAndReleaseChildren (
   IN OUT  LIST_ENTRY        *ListHead
   );
 
+/**
+  Replaces Object->Data with the Data of all children of Object, placed after
+  PrefixSize bytes which are left for the caller to fill in (opcode, package
+  length, table header). The children are freed.
+
+  @param [in,out] Object        - Object to collect its children into
+  @param [in]     PrefixSize    - Bytes to reserve in front of the children Data
+  @param [out]    ChildCount    - Count of Child Objects collapsed
+  @param [in,out] ListHead      - Head of Object Linked List
+
+  @return         EFI_SUCCESS   - Object->Data holds prefix and children Data
+  @return         <all others>  - Collapse failed, children are left in place
+**/
+EFI_STATUS
+EFIAPI
+InternalAmlCollapseChildrenIntoObject (
+  IN OUT  AML_OBJECT_INSTANCE  *Object,
+  IN      UINTN                PrefixSize,
+  OUT     UINTN                *ChildCount,
+  IN OUT  LIST_ENTRY           *ListHead
+  );
+
+/**
+  Moves an Object and its Data out of the arena into pool memory, keeping
+  its place in the linked list.
+
+  @param [in,out] Object        - Pointer to Object pointer, updated on return
+
+  @return         EFI_SUCCESS   - Object is in pool memory
+  @return         <all others>  - Allocation failed, Object is unchanged
+**/
+EFI_STATUS
+EFIAPI
+InternalAmlMoveObjectToPool (
+  IN OUT  AML_OBJECT_INSTANCE  **Object
+  );
+
 #endif // _INTERNAL_AML_OBJECTS_H_
@@ -0,0 +1,606 @@
+/** @file
+  Host based benchmark for AmlGenerationLib.
+
+  Builds a CPU SSDT the way the platform SSDT generators do: one processor
+  device per logical CPU under \_SB, plus a PCI root bridge with a large
+  _PRT package, a _CRS resource template, a configuration space region and
+  an _OSC method. Each table is built several times at every CPU count and
+  the time per table is reported, so the cost per CPU shows whether
+  generation scales with the table size.
+
+  The table with the largest CPU count can be written to a file, to compare
+  the generated AML across library revisions.
+
+  Copyright (C) 2026 Advanced Micro Devices, Inc. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <Uefi.h>
+#include <IndustryStandard/Acpi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/AmlGenerationLib.h>
+
+#define BENCHMARK_ITERATIONS  64
+#define PRT_SLOT_COUNT        32
+#define PRT_PIN_COUNT         4
+
+STATIC CONST UINTN  mCpuCount[] = {
+  64,
+  128,
+  256,
+  512
+};
+
+/**
+  Add Name (NameString, Integer) to the current scope.
+
+  @param[in]      NameString  The 4 character name of the object.
+  @param[in]      Integer     The value of the object.
+  @param[in,out]  ListHead    Head of the AML object list.
+
+  @return The status of the first AmlGenerationLib call that failed.
+**/
+EFI_STATUS
+AddIntegerName (
+  IN     CHAR8       *NameString,
+  IN     UINT64      Integer,
+  IN OUT LIST_ENTRY  *ListHead
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = AmlName (AmlStart, NameString, ListHead);
+  if (!EFI_ERROR (Status)) {
+    Status = AmlOPDataInteger (Integer, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlName (AmlClose, NameString, ListHead);
+  }
+
+  return Status;
+}
+
+/**
+  Add Package (Count) { Integers[0], ... } to the current object.
+
+  @param[in]      Integers    The package elements.
+  @param[in]      Count       The number of package elements.
+  @param[in,out]  ListHead    Head of the AML object list.
+
+  @return The status of the first AmlGenerationLib call that failed.
+**/
+EFI_STATUS
+AddIntegerPackage (
+  IN     CONST UINT64  *Integers,
+  IN     UINTN         Count,
+  IN OUT LIST_ENTRY    *ListHead
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Index;
+
+  Status = AmlPackage (AmlStart, Count, ListHead);
+  for (Index = 0; !EFI_ERROR (Status) && (Index < Count); Index++) {
+    Status = AmlOPDataInteger (Integers[Index], ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlPackage (AmlClose, Count, ListHead);
+  }
+
+  return Status;
+}
+
+/**
+  Add a processor device with _HID, _UID, _STA and _PSD.
+
+  @param[in]      CpuIndex    The logical CPU number.
+  @param[in,out]  ListHead    Head of the AML object list.
+
+  @return The status of the first AmlGenerationLib call that failed.
+**/
+EFI_STATUS
+AddProcessorDevice (
+  IN     UINTN       CpuIndex,
+  IN OUT LIST_ENTRY  *ListHead
+  )
+{
+  EFI_STATUS  Status;
+  CHAR8       DeviceName[8];
+  UINT64      Psd[5];
+
+  snprintf (DeviceName, sizeof (DeviceName), "C%03X", (unsigned int)CpuIndex);
+
+  Status = AmlDevice (AmlStart, DeviceName, ListHead);
+  if (!EFI_ERROR (Status)) {
+    Status = AmlName (AmlStart, "_HID", ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlOPDataString ("ACPI0007", ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlName (AmlClose, "_HID", ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AddIntegerName ("_UID", CpuIndex, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlMethod (AmlStart, "_STA", 0, NotSerialized, 0, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlReturn (AmlStart, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlOPDataInteger (0x0F, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlReturn (AmlClose, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlMethod (AmlClose, "_STA", 0, NotSerialized, 0, ListHead);
+  }
+
+  //
+  // _PSD: one coordination domain per core, shared by its two threads.
+  //
+  Psd[0] = 5;
+  Psd[1] = 0;
+  Psd[2] = CpuIndex / 2;
+  Psd[3] = 0xFE;
+  Psd[4] = 2;
+  if (!EFI_ERROR (Status)) {
+    Status = AmlName (AmlStart, "_PSD", ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlPackage (AmlStart, 1, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AddIntegerPackage (Psd, ARRAY_SIZE (Psd), ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlPackage (AmlClose, 1, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlName (AmlClose, "_PSD", ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlDevice (AmlClose, DeviceName, ListHead);
+  }
+
+  return Status;
+}
+
+/**
+  Add a configuration space region with two fields, a capabilities buffer and
+  an _OSC method that uses them.
+
+  @param[in,out]  ListHead    Head of the AML object list.
+
+  @return The status of the first AmlGenerationLib call that failed.
+**/
+EFI_STATUS
+AddPciOscMethod (
+  IN OUT LIST_ENTRY  *ListHead
+  )
+{
+  EFI_STATUS    Status;
+  STATIC UINT8  Capabilities[12] = { 0x01, 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00, 0x1D, 0x00, 0x00, 0x00 };
+
+  Status = AmlOPOperationRegion ("PCFG", SystemMemory, 0xE0000000, 0x1000, ListHead);
+  if (!EFI_ERROR (Status)) {
+    Status = AmlField (AmlStart, "PCFG", DWordAcc, NoLock, Preserve, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlOPFieldUnit ("VDID", 32, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlOPFieldUnit ("CMDR", 16, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlField (AmlClose, "PCFG", DWordAcc, NoLock, Preserve, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlName (AmlStart, "SUPP", ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlBuffer (AmlStart, sizeof (Capabilities), ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlOPDataBufferFromArray (Capabilities, sizeof (Capabilities), ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlBuffer (AmlClose, sizeof (Capabilities), ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlName (AmlClose, "SUPP", ListHead);
+  }
+
+  //
+  // Method (_OSC, 4) {
+  //   CreateDWordField (SUPP, 0, CDW1)
+  //   If (LEqual (Arg1, 1)) { Store (Arg2, Local0) } Else { Store (Zero, Local0) }
+  //   Return (Local0)
+  // }
+  //
+  if (!EFI_ERROR (Status)) {
+    Status = AmlMethod (AmlStart, "_OSC", 4, NotSerialized, 0, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlOPCreateDWordField ("SUPP", 0, "CDW1", ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlIf (AmlStart, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlLEqual (AmlStart, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlOpArgN (1, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlOPDataInteger (1, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlLEqual (AmlClose, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlStore (AmlStart, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlOpArgN (2, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlOPLocalN (0, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlStore (AmlClose, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlIf (AmlClose, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlElse (AmlStart, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlStore (AmlStart, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlOPDataInteger (0, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlOPLocalN (0, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlStore (AmlClose, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlElse (AmlClose, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlReturn (AmlStart, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlOPLocalN (0, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlReturn (AmlClose, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlMethod (AmlClose, "_OSC", 4, NotSerialized, 0, ListHead);
+  }
+
+  return Status;
+}
+
+/**
+  Add a PCI root bridge with a _PRT entry for every slot and pin, and a _CRS
+  with its configuration ports and MMIO window, and an _OSC method.
+
+  @param[in,out]  ListHead    Head of the AML object list.
+
+  @return The status of the first AmlGenerationLib call that failed.
+**/
+EFI_STATUS
+AddPciRootBridge (
+  IN OUT LIST_ENTRY  *ListHead
+  )
+{
+  EFI_STATUS  Status;
+  UINT64      Prt[4];
+  UINTN       Index;
+
+  Status = AmlDevice (AmlStart, "PCI0", ListHead);
+  if (!EFI_ERROR (Status)) {
+    Status = AmlName (AmlStart, "_HID", ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlOPEisaId ("PNP0A08", ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlName (AmlClose, "_HID", ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AddIntegerName ("_UID", 0, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlName (AmlStart, "_PRT", ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlPackage (AmlStart, PRT_SLOT_COUNT * PRT_PIN_COUNT, ListHead);
+  }
+
+  for (Index = 0; !EFI_ERROR (Status) && (Index < PRT_SLOT_COUNT * PRT_PIN_COUNT); Index++) {
+    Prt[0] = LShiftU64 (Index / PRT_PIN_COUNT, 16) | 0xFFFF;
+    Prt[1] = Index % PRT_PIN_COUNT;
+    Prt[2] = 0;
+    Prt[3] = 32 + Index;
+    Status = AddIntegerPackage (Prt, ARRAY_SIZE (Prt), ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlPackage (AmlClose, PRT_SLOT_COUNT * PRT_PIN_COUNT, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlName (AmlClose, "_PRT", ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlName (AmlStart, "_CRS", ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlResourceTemplate (AmlStart, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlOPIO (Decode16, 0x0CF8, 0x0CF8, 1, 8, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlOPQWordMemory (
+               ResourceProducer,
+               PosDecode,
+               MinFixed,
+               MaxFixed,
+               NonCacheable,
+               ReadWrite,
+               0,
+               0x10000000000ULL,
+               0x1FFFFFFFFFFULL,
+               0,
+               0x10000000000ULL,
+               ListHead
+               );
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlResourceTemplate (AmlClose, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlName (AmlClose, "_CRS", ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AddPciOscMethod (ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlDevice (AmlClose, "PCI0", ListHead);
+  }
+
+  return Status;
+}
+
+/**
+  Build the SSDT for CpuCount processors and return a copy of it.
+
+  @param[in]  CpuCount    The number of processor devices.
+  @param[out] TableSize   The size of the returned table.
+
+  @return The table, or NULL if it could not be built.
+**/
+UINT8 *
+BuildCpuSsdt (
+  IN  UINTN  CpuCount,
+  OUT UINTN  *TableSize
+  )
+{
+  EFI_STATUS  Status;
+  LIST_ENTRY  *ListHead;
+  VOID        *Table;
+  UINT8       *Copy;
+  UINTN       Index;
+
+  Copy     = NULL;
+  ListHead = NULL;
+  Status   = AmlInitializeTableList (&ListHead);
+  if (EFI_ERROR (Status)) {
+    return NULL;
+  }
+
+  Status = AmlDefinitionBlock (AmlStart, "SSDT", 2, "AMD   ", "CPUSSDT ", 1, "AMD ", 1, ListHead);
+  if (!EFI_ERROR (Status)) {
+    Status = AmlScope (AmlStart, "\\_SB", ListHead);
+  }
+
+  for (Index = 0; !EFI_ERROR (Status) && (Index < CpuCount); Index++) {
+    Status = AddProcessorDevice (Index, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AddPciRootBridge (ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlScope (AmlClose, "\\_SB", ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlDefinitionBlock (AmlClose, "SSDT", 2, "AMD   ", "CPUSSDT ", 1, "AMD ", 1, ListHead);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = AmlGetCompletedTable (ListHead, &Table, TableSize);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Copy = malloc (*TableSize);
+    if (Copy != NULL) {
+      memcpy (Copy, Table, *TableSize);
+    }
+  } else {
+    printf ("%lu CPUs: table generation failed: %lx\n", (unsigned long)CpuCount, (unsigned long)Status);
+  }
+
+  AmlReleaseTableList (&ListHead);
+  return Copy;
+}
+
+/**
+  Check the table header of a generated SSDT. The checksum is left for the
+  ACPI table protocol to fill in when the table is installed.
+
+  @param[in] Table      The generated table.
+  @param[in] TableSize  The size of the generated table.
+
+  @retval TRUE   The signature and the header length match the table.
+  @retval FALSE  The table is malformed.
+**/
+BOOLEAN
+IsValidTable (
+  IN CONST UINT8  *Table,
+  IN UINTN        TableSize
+  )
+{
+  CONST EFI_ACPI_DESCRIPTION_HEADER  *Header;
+
+  Header = (CONST EFI_ACPI_DESCRIPTION_HEADER *)Table;
+  return (BOOLEAN)((TableSize >= sizeof (EFI_ACPI_DESCRIPTION_HEADER)) &&
+                   (CompareMem (&Header->Signature, "SSDT", 4) == 0) &&
+                   (Header->Length == TableSize));
+}
+
+/**
+  Benchmark entry point.
+
+  @param[in] Argc   Number of command line arguments.
+  @param[in] Argv   An optional file that receives the largest table.
+
+  @return 0 if every table was generated and valid, 1 otherwise.
+**/
+int
+main (
+  int   Argc,
+  char  *Argv[]
+  )
+{
+  UINT8    *Table;
+  UINTN    TableSize;
+  UINTN    CountIndex;
+  UINTN    Iteration;
+  clock_t  Start;
+  double   Seconds;
+  FILE     *File;
+
+  Table = NULL;
+  for (CountIndex = 0; CountIndex < ARRAY_SIZE (mCpuCount); CountIndex++) {
+    Start = clock ();
+    for (Iteration = 0; Iteration < BENCHMARK_ITERATIONS; Iteration++) {
+      free (Table);
+      Table = BuildCpuSsdt (mCpuCount[CountIndex], &TableSize);
+      if (Table == NULL) {
+        return 1;
+      }
+    }
+
+    Seconds = (double)(clock () - Start) / CLOCKS_PER_SEC;
+    if (!IsValidTable (Table, TableSize)) {
+      printf ("%lu CPUs: invalid table\n", (unsigned long)mCpuCount[CountIndex]);
+      free (Table);
+      return 1;
+    }
+
+    printf (
+      "%4lu CPUs  %8lu bytes  %10.3f ms/table  %8.3f us/CPU\n",
+      (unsigned long)mCpuCount[CountIndex],
+      (unsigned long)TableSize,
+      Seconds * 1000.0 / BENCHMARK_ITERATIONS,
+      Seconds * 1000000.0 / BENCHMARK_ITERATIONS / (double)mCpuCount[CountIndex]
+      );
+  }
+
+  if (Argc > 1) {
+    File = fopen (Argv[1], "wb");
+    if ((File == NULL) || (fwrite (Table, 1, TableSize, File) != TableSize)) {
+      printf ("%s: cannot write table\n", Argv[1]);
+      if (File != NULL) {
+        fclose (File);
+      }
+
+      free (Table);
+      return 1;
+    }
+
+    fclose (File);
+  }
+
+  free (Table);
+  return 0;
+}
@@ -2,6 +2,10 @@
   This is the driver that locates the MemoryConfigurationData HOB, if it
   exists, and saves the data to nvRAM.
 
+  A hash of the raw HOB data is kept in a separate variable. When it matches
+  the HOB produced on this boot, the saved data is only locked, skipping the
+  compression and variable I/O entirely.
+
 Copyright (c) 2017 - 2022, Intel Corporation. All rights reserved.<BR>
 Copyright (c) Microsoft Corporation.<BR>
 SPDX-License-Identifier: BSD-2-Clause-Patent
@@ -11,6 +15,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Base.h>
 #include <Uefi.h>
 #include <Library/BaseLib.h>
+#include <Library/BaseCryptLib.h>
 #include <Library/CompressLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiRuntimeServicesTableLib.h>
@@ -22,9 +27,80 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/LargeVariableReadLib.h>
 #include <Library/LargeVariableWriteLib.h>
 #include <Library/PcdLib.h>
+#include <Library/PerformanceLib.h>
 #include <Library/VariableWriteLib.h>
 #include <Guid/FspNonVolatileStorageHob2.h>
 
+#define FSP_NVS_BUFFER_HASH_VARIABLE_NAME  L"FspNvsBufferHash"
+
+//
+// Identifies the raw FSP NVS HOB data that the FspNvsBuffer variable was
+// last saved from.
+//
+typedef struct {
+  UINT64    DataSize;
+  UINT8     Hash[SHA256_DIGEST_SIZE];
+  UINT32    Compressed;
+  UINT32    Reserved;
+} FSP_NVS_BUFFER_HASH;
+
+/**
+  Computes the SHA-256 digest of the raw FSP NVS HOB data.
+
+  A cryptographic digest is used because a matching digest skips both the
+  comparison with and the update of the saved data.
+
+  @param[in]  Data        The data to hash.
+  @param[in]  DataSize    The size of the data in bytes.
+  @param[out] Hash        The digest of the data.
+
+  @retval TRUE   The digest was computed.
+  @retval FALSE  The digest could not be computed.
+**/
+BOOLEAN
+HashFspNvsData (
+  IN  CONST VOID  *Data,
+  IN  UINTN       DataSize,
+  OUT UINT8       *Hash
+  )
+{
+  return Sha256HashAll (Data, DataSize, Hash);
+}
+
+/**
+  Checks whether the saved FspNvsBuffer variable was produced from the same
+  raw HOB data, with the same compression setting, as the current boot.
+
+  @param[in] CurrentHash    The hash of the FSP NVS HOB data of this boot.
+
+  @retval TRUE   The saved data is up to date.
+  @retval FALSE  The saved data is missing or was saved from different data.
+**/
+BOOLEAN
+IsFspNvsBufferUpToDate (
+  IN FSP_NVS_BUFFER_HASH  *CurrentHash
+  )
+{
+  EFI_STATUS           Status;
+  FSP_NVS_BUFFER_HASH  SavedHash;
+  UINTN                BufferSize;
+
+  BufferSize = sizeof (SavedHash);
+  Status     = GetLargeVariable (FSP_NVS_BUFFER_HASH_VARIABLE_NAME, &gFspNvsBufferVariableGuid, &BufferSize, &SavedHash);
+  if (EFI_ERROR (Status) || (BufferSize != sizeof (SavedHash)) ||
+      (CompareMem (&SavedHash, CurrentHash, sizeof (SavedHash)) != 0))
+  {
+    return FALSE;
+  }
+
+  //
+  // Only the size is needed to confirm that the data itself is still there.
+  //
+  BufferSize = 0;
+  Status     = GetLargeVariable (L"FspNvsBuffer", &gFspNvsBufferVariableGuid, &BufferSize, NULL);
+  return (BOOLEAN)(Status == EFI_BUFFER_TOO_SMALL);
+}
+
 /**
   This is the standard EFI driver point that detects whether there is a
   MemoryConfigurationData HOB and, if so, saves its data to nvRAM.
@@ -51,6 +127,8 @@ SaveMemoryConfigEntryPoint (
   VOID               *CompressedData;
   UINT64             CompressedSize;
   UINTN              CompressedAllocationPages;
+  FSP_NVS_BUFFER_HASH  CurrentHash;
+  BOOLEAN            HashValid;
 
   DataSize                  = 0;
   BufferSize                = 0;
@@ -61,6 +139,8 @@ SaveMemoryConfigEntryPoint (
   CompressedData            = NULL;
   CompressedSize            = 0;
   CompressedAllocationPages = 0;
+  ZeroMem (&CurrentHash, sizeof (CurrentHash));
+  HashValid                 = FALSE;
 
   //
   // Search for the Memory Configuration GUID HOB.  If it is not present, then
@@ -82,6 +162,41 @@ SaveMemoryConfigEntryPoint (
     }
   }
 
+  if ((HobData != NULL) && (DataSize > 0)) {
+    //
+    // Skip the compression and all variable I/O when the HOB matches the data
+    // saved on a previous boot. The variables only need to be locked again.
+    //
+    CurrentHash.DataSize   = DataSize;
+    CurrentHash.Compressed = PcdGetBool (PcdEnableCompressedFspNvsBuffer) ? 1 : 0;
+    HashValid              = HashFspNvsData (HobData, DataSize, CurrentHash.Hash);
+    if (!HashValid) {
+      DEBUG ((DEBUG_WARN, "Failed to hash FSP / MRC Training Data, comparing with the saved data.\n"));
+    }
+    if (HashValid && IsFspNvsBufferUpToDate (&CurrentHash)) {
+      DEBUG ((DEBUG_INFO, "FSP / MRC Training Data hash matches the saved data, no need to save.\n"));
+      Status = LockLargeVariable (L"FspNvsBuffer", &gFspNvsBufferVariableGuid);
+      if (!EFI_ERROR (Status)) {
+        Status = LockLargeVariable (FSP_NVS_BUFFER_HASH_VARIABLE_NAME, &gFspNvsBufferVariableGuid);
+      }
+      if (EFI_ERROR (Status)) {
+        //
+        // Fail to lock variable is security vulnerability and should not happen.
+        //
+        ASSERT_EFI_ERROR (Status);
+        //
+        // When building without ASSERT_EFI_ERROR hang, delete the variables so they will not be consumed.
+        //
+        DEBUG ((DEBUG_ERROR, "Delete variable!\n"));
+        SetLargeVariable (FSP_NVS_BUFFER_HASH_VARIABLE_NAME, &gFspNvsBufferVariableGuid, FALSE, 0, NULL);
+        Status = SetLargeVariable (L"FspNvsBuffer", &gFspNvsBufferVariableGuid, FALSE, 0, NULL);
+        ASSERT_EFI_ERROR (Status);
+      }
+
+      return EFI_REQUEST_UNLOAD_IMAGE;
+    }
+  }
+
   if (PcdGetBool (PcdEnableCompressedFspNvsBuffer)) {
     if (DataSize > 0) {
       CompressedAllocationPages = EFI_SIZE_TO_PAGES (DataSize);
@@ -93,7 +208,9 @@ SaveMemoryConfigEntryPoint (
       }
 
       CompressedSize = EFI_PAGES_TO_SIZE (CompressedAllocationPages);
-      Status         = Compress (HobData, DataSize, CompressedData, &CompressedSize);
+      PERF_INMODULE_BEGIN ("SaveMemoryConfigCompress");
+      Status = Compress (HobData, DataSize, CompressedData, &CompressedSize);
+      PERF_INMODULE_END ("SaveMemoryConfigCompress");
       if (EFI_ERROR (Status)) {
         DEBUG ((DEBUG_ERROR, "[%a] - failed to compress data. Status = %r\n", __func__, Status));
         ASSERT_EFI_ERROR (Status);
@@ -145,7 +262,9 @@ SaveMemoryConfigEntryPoint (
       Status = EFI_SUCCESS;
 
       if (!DataIsIdentical) {
+        PERF_INMODULE_BEGIN ("SaveMemoryConfigWrite");
         Status = SetLargeVariable (L"FspNvsBuffer", &gFspNvsBufferVariableGuid, TRUE, DataSize, HobData);
+        PERF_INMODULE_END ("SaveMemoryConfigWrite");
         if (Status == EFI_ABORTED) {
           //
           // Fail to lock variable! This should not happen.
@@ -163,6 +282,20 @@ SaveMemoryConfigEntryPoint (
       } else {
         DEBUG ((DEBUG_INFO, "FSP / MRC Training Data is identical to data from last boot, no need to save.\n"));
       }
+
+      //
+      // Record which HOB data the variable now holds, so the next boot can
+      // take the fast path. Drop the record if the variable was deleted.
+      //
+      if (!EFI_ERROR (Status) && (DataSize != 0) && HashValid) {
+        Status = SetLargeVariable (FSP_NVS_BUFFER_HASH_VARIABLE_NAME, &gFspNvsBufferVariableGuid, TRUE, sizeof (CurrentHash), &CurrentHash);
+        if (EFI_ERROR (Status)) {
+          DEBUG ((DEBUG_WARN, "Failed to save FSP / MRC Training Data hash. Status = %r\n", Status));
+          SetLargeVariable (FSP_NVS_BUFFER_HASH_VARIABLE_NAME, &gFspNvsBufferVariableGuid, FALSE, 0, NULL);
+        }
+      } else {
+        SetLargeVariable (FSP_NVS_BUFFER_HASH_VARIABLE_NAME, &gFspNvsBufferVariableGuid, FALSE, 0, NULL);
+      }
     }
   } else {
     DEBUG((DEBUG_ERROR, "Memory S3 Data HOB was not found\n"));
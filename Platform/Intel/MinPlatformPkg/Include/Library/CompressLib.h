@@ -9,6 +9,35 @@
 #ifndef _EFI_COMPRESS_LIB_H_
 #define _EFI_COMPRESS_LIB_H_
 
+///
+/// Effort levels for the LZ77 match finder. All levels produce output that
+/// the standard EFI decompressor accepts; they only trade speed for ratio.
+///
+typedef enum {
+  CompressLevelFast,
+  CompressLevelDefault,
+  CompressLevelMax,
+  CompressLevelCount
+} COMPRESS_LEVEL;
+
+/**
+  Supply the next chunk of source data to CompressStream().
+
+  @param[in]  Context       The context passed to CompressStream().
+  @param[out] Buffer        The buffer to fill with source data.
+  @param[in]  Size          The number of bytes requested.
+
+  @return The number of bytes placed in Buffer, at most Size. Zero marks the
+          end of the source data.
+**/
+typedef
+UINTN
+(EFIAPI *COMPRESS_READ_FUNCTION)(
+  IN  VOID   *Context,
+  OUT VOID   *Buffer,
+  IN  UINTN  Size
+  );
+
 /**
   The compression routine.
 
@@ -30,5 +59,57 @@ Compress (
   IN OUT  UINT64  *DstSize
   );
 
+/**
+  The compression routine with a selectable compression level.
+
+  @param[in]       SrcBuffer     The buffer containing the source data.
+  @param[in]       SrcSize       Number of bytes in SrcBuffer.
+  @param[in]       DstBuffer     The buffer to put the compressed image in.
+  @param[in, out]  DstSize       On input the size (in bytes) of DstBuffer, on
+                                 return the number of bytes placed in DstBuffer.
+  @param[in]       Level         The compression level to use.
+
+  @retval EFI_SUCCESS           The compression was sucessful.
+  @retval EFI_BUFFER_TOO_SMALL  The buffer was too small.  DstSize is required.
+  @retval EFI_INVALID_PARAMETER Level is not a valid compression level.
+  @retval EFI_OUT_OF_RESOURCES  Not enough memory for compression process.
+**/
+EFI_STATUS
+EFIAPI
+CompressEx (
+  IN      VOID            *SrcBuffer,
+  IN      UINT64          SrcSize,
+  IN      VOID            *DstBuffer,
+  IN OUT  UINT64          *DstSize,
+  IN      COMPRESS_LEVEL  Level
+  );
+
+/**
+  The streaming compression routine. Source data is pulled through
+  ReadFunction as the compression window advances, so the caller does not
+  need to hold the whole input in memory.
+
+  @param[in]       ReadFunction  The function supplying the source data.
+  @param[in]       Context       The context passed to ReadFunction.
+  @param[in]       DstBuffer     The buffer to put the compressed image in.
+  @param[in, out]  DstSize       On input the size (in bytes) of DstBuffer, on
+                                 return the number of bytes placed in DstBuffer.
+  @param[in]       Level         The compression level to use.
+
+  @retval EFI_SUCCESS           The compression was sucessful.
+  @retval EFI_BUFFER_TOO_SMALL  The buffer was too small.  DstSize is required.
+  @retval EFI_INVALID_PARAMETER ReadFunction is NULL or Level is not valid.
+  @retval EFI_OUT_OF_RESOURCES  Not enough memory for compression process.
+**/
+EFI_STATUS
+EFIAPI
+CompressStream (
+  IN      COMPRESS_READ_FUNCTION  ReadFunction,
+  IN      VOID                    *Context,
+  IN      VOID                    *DstBuffer,
+  IN OUT  UINT64                  *DstSize,
+  IN      COMPRESS_LEVEL          Level
+  );
+
 #endif
 
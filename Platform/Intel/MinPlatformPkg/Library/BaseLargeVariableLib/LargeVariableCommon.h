@@ -11,6 +11,11 @@
   will be incremented for each variable as needed to retrieve the entire data
   set.
 
+  When the data is split, a small index variable (the variable name followed
+  by LARGE_VARIABLE_INDEX_SUFFIX) records the size and CRC32 of every chunk.
+  Readers use it to fetch each chunk with a single lookup, and writers use it
+  to skip chunks whose content has not changed.
+
   Copyright (c) 2021, Intel Corporation. All rights reserved.<BR>
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -51,4 +56,64 @@
 //
 #define MAX_VARIABLE_NAME_PAD_SIZE  3
 
+//
+// The chunk index is stored in a variable whose name is the large variable
+// name followed by this suffix. It is shorter than MAX_VARIABLE_SPLIT_DIGITS,
+// so any name short enough to be split also has room for the suffix.
+//
+#define LARGE_VARIABLE_INDEX_SUFFIX      L"Idx"
+
+#define LARGE_VARIABLE_INDEX_SIGNATURE   SIGNATURE_32 ('L', 'V', 'I', 'X')
+
+//
+// Data sets that need more chunks than this are stored without an index and
+// are found by probing the chunk names, as before the index was introduced.
+// 64 chunks of 32KB cover 2MB, far more than any memory configuration, and
+// keep the index small enough to live on the stack.
+//
+#define LARGE_VARIABLE_INDEX_MAX_CHUNKS  64
+
+typedef struct {
+  UINT32    Size;
+  UINT32    Crc32;
+} LARGE_VARIABLE_CHUNK;
+
+//
+// Only the first ChunkCount entries of Chunk[] are stored in the variable.
+// An index variable only exists while every chunk it describes is present
+// with exactly the recorded size and CRC32: writers delete it before they
+// modify any chunk and write it back once all chunks are stored.
+//
+typedef struct {
+  UINT32                  Signature;
+  UINT32                  ChunkCount;
+  LARGE_VARIABLE_CHUNK    Chunk[LARGE_VARIABLE_INDEX_MAX_CHUNKS];
+} LARGE_VARIABLE_INDEX;
+
+#define LARGE_VARIABLE_INDEX_SIZE(ChunkCount) \
+  (OFFSET_OF (LARGE_VARIABLE_INDEX, Chunk) + (ChunkCount) * sizeof (LARGE_VARIABLE_CHUNK))
+
+/**
+  Reads and validates the chunk index of a large variable.
+
+  This is implemented by the LargeVariableReadLib instance in this directory
+  and shared with the write library, which always links against it.
+
+  @param[in]   VariableName  A Null-terminated string that is the name of the vendor's
+                             variable.
+  @param[in]   VendorGuid    A unique identifier for the vendor.
+  @param[out]  Index         The chunk index of the variable.
+
+  @retval EFI_SUCCESS        A valid chunk index was found.
+  @retval EFI_NOT_FOUND      The variable has no valid chunk index.
+
+**/
+EFI_STATUS
+EFIAPI
+LargeVariableGetIndex (
+  IN  CHAR16                      *VariableName,
+  IN  EFI_GUID                    *VendorGuid,
+  OUT LARGE_VARIABLE_INDEX        *Index
+  );
+
 #endif  // _LARGE_VARIABLE_COMMON_H_
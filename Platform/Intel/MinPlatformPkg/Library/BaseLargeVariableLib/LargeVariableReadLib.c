@@ -11,6 +11,10 @@
   will be incremented for each variable as needed to retrieve the entire data
   set.
 
+  Split data sets carry a chunk index variable, which lets the data be read
+  with one variable lookup per chunk instead of probing every chunk name for
+  its size first.
+
   Copyright (c) 2021, Intel Corporation. All rights reserved.<BR>
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -24,6 +28,128 @@
 
 #include "LargeVariableCommon.h"
 
+/**
+  Reads and validates the chunk index of a large variable.
+
+  @param[in]   VariableName  A Null-terminated string that is the name of the vendor's
+                             variable.
+  @param[in]   VendorGuid    A unique identifier for the vendor.
+  @param[out]  Index         The chunk index of the variable.
+
+  @retval EFI_SUCCESS        A valid chunk index was found.
+  @retval EFI_NOT_FOUND      The variable has no valid chunk index.
+
+**/
+EFI_STATUS
+EFIAPI
+LargeVariableGetIndex (
+  IN  CHAR16                      *VariableName,
+  IN  EFI_GUID                    *VendorGuid,
+  OUT LARGE_VARIABLE_INDEX        *Index
+  )
+{
+  CHAR16        IndexVariableName[MAX_VARIABLE_NAME_SIZE];
+  EFI_STATUS    Status;
+  UINTN         IndexSize;
+
+  if (StrLen (VariableName) >= (MAX_VARIABLE_NAME_SIZE - MAX_VARIABLE_SPLIT_DIGITS)) {
+    return EFI_NOT_FOUND;
+  }
+
+  ZeroMem (IndexVariableName, MAX_VARIABLE_NAME_SIZE);
+  UnicodeSPrint (IndexVariableName, MAX_VARIABLE_NAME_SIZE, L"%s%s", VariableName, LARGE_VARIABLE_INDEX_SUFFIX);
+  IndexSize = sizeof (LARGE_VARIABLE_INDEX);
+  Status = VarLibGetVariable (IndexVariableName, VendorGuid, NULL, &IndexSize, Index);
+  if (EFI_ERROR (Status)) {
+    return EFI_NOT_FOUND;
+  }
+
+  if ((IndexSize < LARGE_VARIABLE_INDEX_SIZE (1)) ||
+      (Index->Signature != LARGE_VARIABLE_INDEX_SIGNATURE) ||
+      (Index->ChunkCount == 0) ||
+      (Index->ChunkCount > LARGE_VARIABLE_INDEX_MAX_CHUNKS) ||
+      (IndexSize != LARGE_VARIABLE_INDEX_SIZE (Index->ChunkCount))) {
+    DEBUG ((DEBUG_WARN, "LargeVariableGetIndex: Ignoring malformed index %s\n", IndexVariableName));
+    return EFI_NOT_FOUND;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Returns the value of a split large variable using its chunk index.
+
+  @param[in]       VariableName  A Null-terminated string that is the name of the vendor's
+                                 variable.
+  @param[in]       VendorGuid    A unique identifier for the vendor.
+  @param[in, out]  DataSize      On input, the size in bytes of the return Data buffer.
+                                 On output the size of data returned in Data.
+  @param[out]      Data          The buffer to return the contents of the variable. May be NULL
+                                 with a zero DataSize in order to determine the size buffer needed.
+
+  @retval EFI_SUCCESS            The function completed successfully.
+  @retval EFI_NOT_FOUND          There is no chunk index, or the chunks do not match it.
+  @retval EFI_BUFFER_TOO_SMALL   The DataSize is too small for the result.
+  @retval EFI_INVALID_PARAMETER  The DataSize is not too small and Data is NULL.
+
+**/
+EFI_STATUS
+GetLargeVariableFromIndex (
+  IN     CHAR16                      *VariableName,
+  IN     EFI_GUID                    *VendorGuid,
+  IN OUT UINTN                       *DataSize,
+  OUT    VOID                        *Data           OPTIONAL
+  )
+{
+  CHAR16                TempVariableName[MAX_VARIABLE_NAME_SIZE];
+  LARGE_VARIABLE_INDEX  VariableIndex;
+  EFI_STATUS            Status;
+  UINTN                 TotalSize;
+  UINTN                 Index;
+  UINTN                 VariableSize;
+  UINT8                 *OffsetPtr;
+
+  Status = LargeVariableGetIndex (VariableName, VendorGuid, &VariableIndex);
+  if (EFI_ERROR (Status)) {
+    return EFI_NOT_FOUND;
+  }
+
+  TotalSize = 0;
+  for (Index = 0; Index < VariableIndex.ChunkCount; Index++) {
+    TotalSize += VariableIndex.Chunk[Index].Size;
+  }
+  DEBUG ((DEBUG_VERBOSE, "TotalSize = %d, NumVariables = %d (indexed)\n", TotalSize, VariableIndex.ChunkCount));
+
+  if (*DataSize < TotalSize) {
+    *DataSize = TotalSize;
+    return EFI_BUFFER_TOO_SMALL;
+  }
+
+  if (Data == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  OffsetPtr = (UINT8 *) Data;
+  for (Index = 0; Index < VariableIndex.ChunkCount; Index++) {
+    ZeroMem (TempVariableName, MAX_VARIABLE_NAME_SIZE);
+    UnicodeSPrint (TempVariableName, MAX_VARIABLE_NAME_SIZE, L"%s%d", VariableName, Index);
+    VariableSize = VariableIndex.Chunk[Index].Size;
+    DEBUG ((DEBUG_INFO, "Reading %s, Guid = %g, Size %d\n", TempVariableName, VendorGuid, VariableSize));
+    Status = VarLibGetVariable (TempVariableName, VendorGuid, NULL, &VariableSize, (VOID *) OffsetPtr);
+    if (EFI_ERROR (Status) ||
+        (VariableSize != VariableIndex.Chunk[Index].Size) ||
+        (CalculateCrc32 (OffsetPtr, VariableSize) != VariableIndex.Chunk[Index].Crc32)) {
+      DEBUG ((DEBUG_WARN, "GetLargeVariable: %s does not match the chunk index\n", TempVariableName));
+      return EFI_NOT_FOUND;
+    }
+
+    OffsetPtr += VariableSize;
+  }
+
+  *DataSize = TotalSize;
+  return EFI_SUCCESS;
+}
+
 /**
   Returns the value of a large variable.
 
@@ -95,6 +221,15 @@ GetLargeVariable (
       goto Done;
     }
 
+    //
+    // Use the chunk index when there is one. Without it, or if the chunks do
+    // not match it, fall back to probing the chunk names.
+    //
+    Status = GetLargeVariableFromIndex (VariableName, VendorGuid, DataSize, Data);
+    if (Status != EFI_NOT_FOUND) {
+      goto Done;
+    }
+
     VarDataSize = 0;
     Index       = 0;
     ZeroMem (TempVariableName, MAX_VARIABLE_NAME_SIZE);
@@ -10,6 +10,12 @@
   integer number will be added to the end of the variable name. This number
   will be incremented for each variable as needed to store the entire data set.
 
+  Split data sets also get a chunk index variable recording the size and CRC32
+  of every chunk. When the data is updated, only chunks whose content changed
+  are written, which saves both boot time and flash wear. A matching CRC32 is
+  only a hint; the stored chunk is read back and compared before a write is
+  skipped.
+
   Copyright (c) 2021 - 2022, Intel Corporation. All rights reserved.<BR>
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -19,6 +25,7 @@
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
 #include <Library/PrintLib.h>
 #include <Library/VariableReadLib.h>
 #include <Library/VariableWriteLib.h>
@@ -118,6 +125,132 @@ GetVariableSplitSize (
   return VariableSplitSize;
 }
 
+/**
+  Writes or deletes the chunk index variable of a large variable.
+
+  @param[in]  VariableName       A Null-terminated string that is the name of the vendor's variable.
+  @param[in]  VendorGuid         A unique identifier for the vendor.
+  @param[in]  VariableIndex      The chunk index to store, or NULL to delete the index.
+
+  @retval EFI_SUCCESS            The index was written, or deleted or already absent.
+  @retval Others                 The index could not be written or deleted.
+
+**/
+EFI_STATUS
+SetLargeVariableIndex (
+  IN  CHAR16                       *VariableName,
+  IN  EFI_GUID                     *VendorGuid,
+  IN  LARGE_VARIABLE_INDEX         *VariableIndex  OPTIONAL
+  )
+{
+  CHAR16        IndexVariableName[MAX_VARIABLE_NAME_SIZE];
+  EFI_STATUS    Status;
+
+  ZeroMem (IndexVariableName, MAX_VARIABLE_NAME_SIZE);
+  UnicodeSPrint (IndexVariableName, MAX_VARIABLE_NAME_SIZE, L"%s%s", VariableName, LARGE_VARIABLE_INDEX_SUFFIX);
+  Status = VarLibSetVariable (
+             IndexVariableName,
+             VendorGuid,
+             EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS,
+             (VariableIndex == NULL) ? 0 : LARGE_VARIABLE_INDEX_SIZE (VariableIndex->ChunkCount),
+             VariableIndex
+             );
+  if ((VariableIndex == NULL) && (Status == EFI_NOT_FOUND)) {
+    Status = EFI_SUCCESS;
+  }
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "SetLargeVariableIndex: Error updating %s: Status = %r\n", IndexVariableName, Status));
+  }
+  return Status;
+}
+
+/**
+  Computes the chunk layout of a data set and the CRC32 of every chunk.
+
+  @param[in]  VariableName       A Null-terminated string that is the name of the vendor's variable.
+  @param[in]  DataSize           The size in bytes of the Data buffer.
+  @param[in]  Data               The contents for the variable.
+  @param[out] VariableIndex      The chunk index of the data. ChunkCount is zero if the data
+                                 needs more than LARGE_VARIABLE_INDEX_MAX_CHUNKS chunks.
+
+  @retval EFI_SUCCESS            The chunk index was computed.
+  @retval EFI_OUT_OF_RESOURCES   There is no NV storage space left for a chunk.
+
+**/
+EFI_STATUS
+BuildLargeVariableIndex (
+  IN  CHAR16                       *VariableName,
+  IN  UINTN                        DataSize,
+  IN  VOID                         *Data,
+  OUT LARGE_VARIABLE_INDEX         *VariableIndex
+  )
+{
+  CHAR16        TempVariableName[MAX_VARIABLE_NAME_SIZE];
+  UINT64        VariableSplitSize;
+  UINTN         Index;
+  UINT8         *OffsetPtr;
+  UINTN         BytesRemaining;
+  UINTN         SizeToSave;
+
+  ZeroMem (VariableIndex, sizeof (LARGE_VARIABLE_INDEX));
+  VariableIndex->Signature = LARGE_VARIABLE_INDEX_SIGNATURE;
+
+  OffsetPtr      = (UINT8 *) Data;
+  BytesRemaining = DataSize;
+  for (Index = 0; (Index < LARGE_VARIABLE_INDEX_MAX_CHUNKS) && (BytesRemaining > 0); Index++) {
+    ZeroMem (TempVariableName, MAX_VARIABLE_NAME_SIZE);
+    UnicodeSPrint (TempVariableName, MAX_VARIABLE_NAME_SIZE, L"%s%d", VariableName, Index);
+    VariableSplitSize = GetVariableSplitSize (StrLen (TempVariableName));
+    if (VariableSplitSize == 0) {
+      DEBUG ((DEBUG_ERROR, "Unable to save variable, out of NV storage space\n"));
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    SizeToSave = (UINTN) MIN (BytesRemaining, VariableSplitSize);
+    VariableIndex->Chunk[Index].Size  = (UINT32) SizeToSave;
+    VariableIndex->Chunk[Index].Crc32 = CalculateCrc32 (OffsetPtr, SizeToSave);
+    BytesRemaining -= SizeToSave;
+    OffsetPtr      += SizeToSave;
+  }
+
+  VariableIndex->ChunkCount = (BytesRemaining == 0) ? (UINT32) Index : 0;
+  return EFI_SUCCESS;
+}
+
+/**
+  Checks whether a stored chunk variable holds exactly the given data.
+
+  @param[in]  ChunkName          A Null-terminated string that is the name of the chunk variable.
+  @param[in]  VendorGuid         A unique identifier for the vendor.
+  @param[in]  Size               The size in bytes of the Data buffer.
+  @param[in]  Data               The data the chunk must hold.
+  @param[in]  Buffer             Scratch buffer of at least Size bytes.
+
+  @retval TRUE                   The chunk variable holds Data.
+  @retval FALSE                  The chunk variable differs, or could not be read.
+
+**/
+BOOLEAN
+LargeVariableChunkUnchanged (
+  IN  CHAR16                       *ChunkName,
+  IN  EFI_GUID                     *VendorGuid,
+  IN  UINTN                        Size,
+  IN  VOID                         *Data,
+  IN  VOID                         *Buffer
+  )
+{
+  EFI_STATUS    Status;
+  UINTN         VariableSize;
+
+  VariableSize = Size;
+  Status = VarLibGetVariable (ChunkName, VendorGuid, NULL, &VariableSize, Buffer);
+  if (EFI_ERROR (Status) || (VariableSize != Size)) {
+    return FALSE;
+  }
+  return (BOOLEAN) (CompareMem (Buffer, Data, Size) == 0);
+}
+
 /**
   Deletes a large variable.
 
@@ -189,7 +322,7 @@ DeleteLargeVariableInternal (
       // The first variable exists. Delete all the variables.
       //
       DEBUG ((DEBUG_VERBOSE, "DeleteLargeVariableInternal: Multiple Variables Found\n"));
-      Status = EFI_SUCCESS;
+      Status = SetLargeVariableIndex (VariableName, VendorGuid, NULL);
       for (Index = 0; Index < MAX_VARIABLE_SPLIT; Index++) {
         VarDataSize = 0;
         ZeroMem (TempVariableName, MAX_VARIABLE_NAME_SIZE);
@@ -271,6 +404,12 @@ SetLargeVariable (
   UINTN         BytesRemaining;
   UINTN         SizeToSave;
   UINTN         BufferSize = 0;
+  UINTN         OldChunkCount;
+  BOOLEAN       IndexChanged;
+  UINT8         *ChunkBuffer = NULL;
+  UINTN         ChunkBufferSize;
+  LARGE_VARIABLE_INDEX  OldIndex;
+  LARGE_VARIABLE_INDEX  NewIndex;
 
   //
   // Check input parameters.
@@ -379,6 +518,48 @@ SetLargeVariable (
       goto Done;
     }
 
+    //
+    // Compare the chunk layout and hashes of the new data with the index of
+    // the stored data, so that only chunks that changed need to be written.
+    //
+    Status = BuildLargeVariableIndex (VariableName, DataSize, Data, &NewIndex);
+    if (EFI_ERROR (Status)) {
+      goto Done;
+    }
+    Status = LargeVariableGetIndex (VariableName, VendorGuid, &OldIndex);
+    if (EFI_ERROR (Status)) {
+      OldIndex.ChunkCount = 0;
+    }
+    OldChunkCount = OldIndex.ChunkCount;
+    IndexChanged  = (NewIndex.ChunkCount == 0) ||
+                    (NewIndex.ChunkCount != OldIndex.ChunkCount) ||
+                    (CompareMem (NewIndex.Chunk, OldIndex.Chunk, NewIndex.ChunkCount * sizeof (LARGE_VARIABLE_CHUNK)) != 0);
+
+    //
+    // The index must never describe chunks that are being rewritten, so drop
+    // it before the first chunk is touched. It is restored once all chunks
+    // are stored.
+    //
+    if (IndexChanged && (OldIndex.ChunkCount != 0)) {
+      Status = SetLargeVariableIndex (VariableName, VendorGuid, NULL);
+      if (EFI_ERROR (Status)) {
+        goto Done;
+      }
+    }
+
+    //
+    // Chunks whose size and CRC32 match the index are read back into this
+    // buffer and compared, so a CRC32 collision never skips a changed chunk.
+    // Without the buffer every chunk is written.
+    //
+    if (OldIndex.ChunkCount != 0) {
+      ChunkBufferSize = 0;
+      for (Index = 0; Index < NewIndex.ChunkCount; Index++) {
+        ChunkBufferSize = MAX (ChunkBufferSize, NewIndex.Chunk[Index].Size);
+      }
+      ChunkBuffer = AllocatePool (ChunkBufferSize);
+    }
+
     DEBUG ((DEBUG_VERBOSE, "SetLargeVariable: Saving using multiple variables.\n"));
     OffsetPtr         = (UINT8 *) Data;
     BytesRemaining    = DataSize;
@@ -405,6 +586,20 @@ SetLargeVariable (
       } else {
         SizeToSave = BytesRemaining;
       }
+
+      if ((Index < OldIndex.ChunkCount) &&
+          (Index < NewIndex.ChunkCount) &&
+          (OldIndex.Chunk[Index].Size == NewIndex.Chunk[Index].Size) &&
+          (OldIndex.Chunk[Index].Crc32 == NewIndex.Chunk[Index].Crc32) &&
+          (ChunkBuffer != NULL) &&
+          LargeVariableChunkUnchanged (TempVariableName, VendorGuid, SizeToSave, OffsetPtr, ChunkBuffer)) {
+        DEBUG ((DEBUG_INFO, "Skipping %s, Guid = %g, content unchanged\n", TempVariableName, VendorGuid));
+        VariablesSaved++;
+        BytesRemaining -= SizeToSave;
+        OffsetPtr += SizeToSave;
+        continue;
+      }
+
       DEBUG ((DEBUG_INFO, "Saving %s, Guid = %g, Size %d\n", TempVariableName, VendorGuid, SizeToSave));
       Status = VarLibSetVariable (
                 TempVariableName,
@@ -422,6 +617,33 @@ SetLargeVariable (
       OffsetPtr += SizeToSave;
     }   // End of for loop
 
+    //
+    // Remove chunks left over from older, larger data.
+    //
+    for (Index = VariablesSaved; Index < OldChunkCount; Index++) {
+      ZeroMem (TempVariableName, MAX_VARIABLE_NAME_SIZE);
+      UnicodeSPrint (TempVariableName, MAX_VARIABLE_NAME_SIZE, L"%s%d", VariableName, Index);
+
+      DEBUG ((DEBUG_INFO, "Deleting stale %s, Guid = %g\n", TempVariableName, VendorGuid));
+      Status2 = VarLibSetVariable (
+                  TempVariableName,
+                  VendorGuid,
+                  EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS | EFI_VARIABLE_RUNTIME_ACCESS,
+                  0,
+                  NULL
+                  );
+      if (EFI_ERROR (Status2) && (Status2 != EFI_NOT_FOUND)) {
+        DEBUG ((DEBUG_ERROR, "SetLargeVariable: Error deleting variable: Status = %r\n", Status2));
+      }
+    }
+
+    if (IndexChanged && (NewIndex.ChunkCount != 0)) {
+      Status = SetLargeVariableIndex (VariableName, VendorGuid, &NewIndex);
+      if (EFI_ERROR (Status)) {
+        goto Done;
+      }
+    }
+
     //
     // If the user requested that the variables be locked, lock them now that
     // all data is saved.
@@ -443,12 +665,30 @@ SetLargeVariable (
           goto Done;
         }
       }
+
+      if (NewIndex.ChunkCount != 0) {
+        ZeroMem (TempVariableName, MAX_VARIABLE_NAME_SIZE);
+        UnicodeSPrint (TempVariableName, MAX_VARIABLE_NAME_SIZE, L"%s%s", VariableName, LARGE_VARIABLE_INDEX_SUFFIX);
+
+        DEBUG ((DEBUG_INFO, "Locking %s, Guid = %g\n", TempVariableName, VendorGuid));
+        Status = VarLibVariableRequestToLock (TempVariableName, VendorGuid);
+        if (EFI_ERROR (Status)) {
+          DEBUG ((DEBUG_ERROR, "SetLargeVariable: Error locking variable: Status = %r\n", Status));
+          Status = EFI_ABORTED;
+          VariablesSaved = 0;
+          goto Done;
+        }
+      }
     }
   }
 
 Done:
+  if (ChunkBuffer != NULL) {
+    FreePool (ChunkBuffer);
+  }
   if (EFI_ERROR (Status) && VariablesSaved > 0) {
     DEBUG ((DEBUG_ERROR, "SetLargeVariable: An error was encountered, deleting variables with partially stored data\n"));
+    SetLargeVariableIndex (VariableName, VendorGuid, NULL);
     for (Index = 0; Index < VariablesSaved; Index++) {
       ZeroMem (TempVariableName, MAX_VARIABLE_NAME_SIZE);
       UnicodeSPrint (TempVariableName, MAX_VARIABLE_NAME_SIZE, L"%s%d", VariableName, Index);
@@ -558,6 +798,23 @@ LockLargeVariable (
         DEBUG ((DEBUG_ERROR, "LockLargeVariable: Failed! Satus = %r\n", Status));
         return EFI_ABORTED;
       }
+
+      //
+      // Lock the chunk index too, if the variable has one.
+      //
+      ZeroMem (TempVariableName, MAX_VARIABLE_NAME_SIZE);
+      UnicodeSPrint (TempVariableName, MAX_VARIABLE_NAME_SIZE, L"%s%s", VariableName, LARGE_VARIABLE_INDEX_SUFFIX);
+      VariableSize = 0;
+      Status = VarLibGetVariable (TempVariableName, VendorGuid, NULL, &VariableSize, NULL);
+      if (Status == EFI_BUFFER_TOO_SMALL) {
+        DEBUG ((DEBUG_INFO, "Locking %s, Guid = %g\n", TempVariableName, VendorGuid));
+        Status = VarLibVariableRequestToLock (TempVariableName, VendorGuid);
+        if (EFI_ERROR (Status)) {
+          DEBUG ((DEBUG_ERROR, "LockLargeVariable: Failed! Satus = %r\n", Status));
+          return EFI_ABORTED;
+        }
+      }
+
       for (Index = 1; Index < MAX_VARIABLE_SPLIT; Index++) {
         ZeroMem (TempVariableName, MAX_VARIABLE_NAME_SIZE);
         UnicodeSPrint (TempVariableName, MAX_VARIABLE_NAME_SIZE, L"%s%d", VariableName, Index);
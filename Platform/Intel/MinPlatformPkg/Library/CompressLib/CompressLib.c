@@ -16,6 +16,7 @@
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Uefi/UefiBaseType.h>
+#include <Library/CompressLib.h>
 
 #define SHELL_FREE_NON_NULL(Pointer)  \
   do {                                \
@@ -30,21 +31,23 @@
 //
 // Macro Definitions
 //
-typedef INT16             NODE;
 #define UINT8_BIT         8
 #define THRESHOLD         3
-#define INIT_CRC          0
 #define WNDBIT            13
 #define WNDSIZ            (1U << WNDBIT)
 #define MAXMATCH          256
 #define BLKSIZ            (1U << 14)  // 16 * 1024U
-#define PERC_FLAG         0x8000U
 #define CODE_BIT          16
-#define NIL               0
-#define MAX_HASH_VAL      (3 * WNDSIZ + (WNDSIZ / 512 + 1) * MAX_UINT8)
-#define HASH(LoopVar7, LoopVar5)        ((LoopVar7) + ((LoopVar5) << (WNDBIT - 9)) + WNDSIZ * 2)
-#define CRCPOLY           0xA001
-#define UPDATE_CRC(LoopVar5)     mCrc = mCrcTable[(mCrc ^ (LoopVar5)) & 0xFF] ^ (mCrc >> UINT8_BIT)
+
+//
+// Hash chain match finder. Every window position is linked into a chain
+// keyed by a hash of its first THRESHOLD bytes; positions are INT16 offsets
+// into mText and NIL_POS terminates a chain.
+//
+#define HASH_BIT          14
+#define HASH_SIZE         (1U << HASH_BIT)
+#define NIL_POS           (-1)
+#define HASH(Ptr)         ((((((UINT32) (Ptr)[0]) << 16) | (((UINT32) (Ptr)[1]) << 8) | (Ptr)[2]) * 0x9E3779B1U) >> (32 - HASH_BIT))
 
 //
 // C: the Char&Len Set; P: the Position Set; T: the exTra Set
@@ -60,6 +63,22 @@ typedef INT16             NODE;
 #else
   #define                 NPT NP
 #endif
+
+//
+// Match finder tuning for each COMPRESS_LEVEL.
+//
+typedef struct {
+  UINT32   MaxChain;    // Maximum number of chain entries visited per search
+  INT32    NiceLength;  // Stop searching once a match this long is found
+  BOOLEAN  Lazy;        // Defer a match by one byte if the next one is longer
+} COMPRESS_LEVEL_CONFIG;
+
+STATIC CONST COMPRESS_LEVEL_CONFIG  mLevelConfig[CompressLevelCount] = {
+  { 4,    32,       FALSE },   // CompressLevelFast
+  { 16,   64,       TRUE  },   // CompressLevelDefault
+  { 4096, MAXMATCH, TRUE  }    // CompressLevelMax
+};
+
 //
 // Function Prototypes
 //
@@ -83,9 +102,11 @@ STATIC UINT8  *mDst;
 STATIC UINT8  *mSrcUpperLimit;
 STATIC UINT8  *mDstUpperLimit;
 
-STATIC UINT8  *mLevel;
+STATIC COMPRESS_READ_FUNCTION       mReadFunction;
+STATIC VOID                         *mReadContext;
+STATIC CONST COMPRESS_LEVEL_CONFIG  *mConfig;
+
 STATIC UINT8  *mText;
-STATIC UINT8  *mChildCount;
 STATIC UINT8  *mBuf;
 STATIC UINT8  mCLen[NC];
 STATIC UINT8  mPTLen[NPT];
@@ -100,7 +121,6 @@ STATIC UINT32 mBufSiz = 0;
 STATIC UINT32 mOutputPos;
 STATIC UINT32 mOutputMask;
 STATIC UINT32 mSubBitBuf;
-STATIC UINT32 mCrc;
 STATIC UINT32 mCompSize;
 STATIC UINT32 mOrigSize;
 
@@ -109,52 +129,18 @@ STATIC UINT16 *mSortPtr;
 STATIC UINT16 mLenCnt[17];
 STATIC UINT16 mLeft[2 * NC - 1];
 STATIC UINT16 mRight[2 * NC - 1];
-STATIC UINT16 mCrcTable[MAX_UINT8 + 1];
 STATIC UINT16 mCFreq[2 * NC - 1];
 STATIC UINT16 mCCode[NC];
 STATIC UINT16 mPFreq[2 * NP - 1];
 STATIC UINT16 mPTCode[NPT];
 STATIC UINT16 mTFreq[2 * NT - 1];
 
-STATIC NODE   mPos;
-STATIC NODE   mMatchPos;
-STATIC NODE   mAvail;
-STATIC NODE   *mPosition;
-STATIC NODE   *mParent;
-STATIC NODE   *mPrev;
-STATIC NODE   *mNext = NULL;
+STATIC INT32  mPos;
+STATIC INT32  mMatchPos;
+STATIC INT16  *mHashHead;
+STATIC INT16  *mHashPrev = NULL;
 INT32         mHuffmanDepth = 0;
 
-/**
-  Make a CRC table.
-
-**/
-VOID
-EFIAPI
-MakeCrcTable (
-  VOID
-  )
-{
-  UINT32  LoopVar1;
-
-  UINT32  LoopVar2;
-
-  UINT32  LoopVar4;
-
-  for (LoopVar1 = 0; LoopVar1 <= MAX_UINT8; LoopVar1++) {
-    LoopVar4 = LoopVar1;
-    for (LoopVar2 = 0; LoopVar2 < UINT8_BIT; LoopVar2++) {
-      if ((LoopVar4 & 1) != 0) {
-        LoopVar4 = (LoopVar4 >> 1) ^ CRCPOLY;
-      } else {
-        LoopVar4 >>= 1;
-      }
-    }
-
-    mCrcTable[LoopVar1] = (UINT16) LoopVar4;
-  }
-}
-
 /**
   Put a dword to output stream
 
@@ -196,12 +182,11 @@ AllocateMemory (
   )
 {
   mText       = AllocateZeroPool (WNDSIZ * 2 + MAXMATCH);
-  mLevel      = AllocateZeroPool ((WNDSIZ + MAX_UINT8 + 1) * sizeof (*mLevel));
-  mChildCount = AllocateZeroPool ((WNDSIZ + MAX_UINT8 + 1) * sizeof (*mChildCount));
-  mPosition   = AllocateZeroPool ((WNDSIZ + MAX_UINT8 + 1) * sizeof (*mPosition));
-  mParent     = AllocateZeroPool (WNDSIZ * 2 * sizeof (*mParent));
-  mPrev       = AllocateZeroPool (WNDSIZ * 2 * sizeof (*mPrev));
-  mNext       = AllocateZeroPool ((MAX_HASH_VAL + 1) * sizeof (*mNext));
+  mHashHead   = AllocatePool (HASH_SIZE * sizeof (*mHashHead));
+  mHashPrev   = AllocatePool (WNDSIZ * 2 * sizeof (*mHashPrev));
+  if ((mText == NULL) || (mHashHead == NULL) || (mHashPrev == NULL)) {
+    return EFI_OUT_OF_RESOURCES;
+  }
 
   mBufSiz     = BLKSIZ;
   mBuf        = AllocateZeroPool (mBufSiz);
@@ -230,12 +215,8 @@ FreeMemory (
   )
 {
   SHELL_FREE_NON_NULL (mText);
-  SHELL_FREE_NON_NULL (mLevel);
-  SHELL_FREE_NON_NULL (mChildCount);
-  SHELL_FREE_NON_NULL (mPosition);
-  SHELL_FREE_NON_NULL (mParent);
-  SHELL_FREE_NON_NULL (mPrev);
-  SHELL_FREE_NON_NULL (mNext);
+  SHELL_FREE_NON_NULL (mHashHead);
+  SHELL_FREE_NON_NULL (mHashPrev);
   SHELL_FREE_NON_NULL (mBuf);
 }
 
@@ -248,334 +229,120 @@ InitSlide (
   VOID
   )
 {
-  NODE  LoopVar1;
-
-  SetMem (mLevel + WNDSIZ, (MAX_UINT8 + 1) * sizeof (UINT8), 1);
-  SetMem (mPosition + WNDSIZ, (MAX_UINT8 + 1) * sizeof (NODE), 0);
-
-  SetMem (mParent + WNDSIZ, WNDSIZ * sizeof (NODE), 0);
-
-  mAvail = 1;
-  for (LoopVar1 = 1; LoopVar1 < WNDSIZ - 1; LoopVar1++) {
-    mNext[LoopVar1] = (NODE) (LoopVar1 + 1);
-  }
-
-  mNext[WNDSIZ - 1] = NIL;
-  SetMem (mNext + WNDSIZ * 2, (MAX_HASH_VAL - WNDSIZ * 2 + 1) * sizeof (NODE), 0);
+  //
+  // NIL_POS is all ones, so every chain head can be reset with a byte fill.
+  //
+  SetMem (mHashHead, HASH_SIZE * sizeof (*mHashHead), 0xFF);
+  SetMem (mHashPrev, WNDSIZ * 2 * sizeof (*mHashPrev), 0xFF);
 }
 
 /**
-  Find child node given the parent node and the edge character
+  Rebase a chain link after the window has slid down by WNDSIZ bytes.
 
-  @param[in] LoopVar6       The parent node.
-  @param[in] LoopVar5       The edge character.
-
-  @return             The child node.
-  @retval NIL(Zero)   No child could be found.
+  @param[in] Link    The chain link to rebase.
 
+  @return The rebased link, or NIL_POS if it dropped out of the window.
 **/
-NODE
+INT16
 EFIAPI
-Child (
-  IN NODE   LoopVar6,
-  IN UINT8  LoopVar5
+RebaseLink (
+  IN INT16 Link
   )
 {
-  NODE  LoopVar4;
-
-  LoopVar4      = mNext[HASH (LoopVar6, LoopVar5)];
-  mParent[NIL]  = LoopVar6;  /* sentinel */
-  while (mParent[LoopVar4] != LoopVar6) {
-    LoopVar4 = mNext[LoopVar4];
-  }
-
-  return LoopVar4;
+  return (INT16) ((Link >= (INT16) WNDSIZ) ? (Link - WNDSIZ) : NIL_POS);
 }
 
 /**
-  Create a new child for a given parent node.
-
-  @param[in] LoopVar6       The parent node.
-  @param[in] LoopVar5       The edge character.
-  @param[in] LoopVar4       The child node.
+  Slide the hash chains down by WNDSIZ bytes to follow mText.
 
 **/
 VOID
 EFIAPI
-MakeChild (
-  IN NODE   LoopVar6,
-  IN UINT8  LoopVar5,
-  IN NODE   LoopVar4
+SlideHash (
+  VOID
   )
 {
-  NODE  LoopVar12;
-
-  NODE  LoopVar10;
-
-  LoopVar12          = (NODE) HASH (LoopVar6, LoopVar5);
-  LoopVar10          = mNext[LoopVar12];
-  mNext[LoopVar12]   = LoopVar4;
-  mNext[LoopVar4]    = LoopVar10;
-  mPrev[LoopVar10]   = LoopVar4;
-  mPrev[LoopVar4]    = LoopVar12;
-  mParent[LoopVar4]  = LoopVar6;
-  mChildCount[LoopVar6]++;
-}
+  UINT32  Index;
 
-/**
-  Split a node.
+  for (Index = 0; Index < HASH_SIZE; Index++) {
+    mHashHead[Index] = RebaseLink (mHashHead[Index]);
+  }
 
-  @param[in] Old     The node to split.
+  for (Index = 0; Index < WNDSIZ; Index++) {
+    mHashPrev[Index] = RebaseLink (mHashPrev[Index + WNDSIZ]);
+  }
 
-**/
-VOID
-EFIAPI
-Split (
-  IN NODE Old
-  )
-{
-  NODE  New;
-
-  NODE  LoopVar10;
-
-  New               = mAvail;
-  mAvail            = mNext[New];
-  mChildCount[New]  = 0;
-  LoopVar10         = mPrev[Old];
-  mPrev[New]        = LoopVar10;
-  mNext[LoopVar10]  = New;
-  LoopVar10         = mNext[Old];
-  mNext[New]        = LoopVar10;
-  mPrev[LoopVar10]  = New;
-  mParent[New]      = mParent[Old];
-  mLevel[New]       = (UINT8) mMatchLen;
-  mPosition[New]    = mPos;
-  MakeChild (New, mText[mMatchPos + mMatchLen], Old);
-  MakeChild (New, mText[mPos + mMatchLen], mPos);
+  SetMem (&mHashPrev[WNDSIZ], WNDSIZ * sizeof (*mHashPrev), 0xFF);
 }
 
 /**
-  Insert string info for current position into the String Info Log.
+  Link the current position into its hash chain.
 
 **/
 VOID
 EFIAPI
-InsertNode (
+InsertPosition (
   VOID
   )
 {
-  NODE  LoopVar6;
-
-  NODE  LoopVar4;
-
-  NODE  LoopVar2;
-
-  NODE  LoopVar10;
-  UINT8 LoopVar5;
-  UINT8 *TempString3;
-  UINT8 *TempString2;
-
-  if (mMatchLen >= 4) {
-    //
-    // We have just got a long match, the target tree
-    // can be located by MatchPos + 1. Travese the tree
-    // from bottom up to get to a proper starting point.
-    // The usage of PERC_FLAG ensures proper node deletion
-    // in DeleteNode() later.
-    //
-    mMatchLen--;
-    LoopVar4 = (NODE) ((mMatchPos + 1) | WNDSIZ);
-    LoopVar6 = mParent[LoopVar4];
-    while (LoopVar6 == NIL) {
-      LoopVar4 = mNext[LoopVar4];
-      LoopVar6 = mParent[LoopVar4];
-    }
-
-    while (mLevel[LoopVar6] >= mMatchLen) {
-      LoopVar4 = LoopVar6;
-      LoopVar6 = mParent[LoopVar6];
-    }
-
-    LoopVar10 = LoopVar6;
-    while (mPosition[LoopVar10] < 0) {
-      mPosition[LoopVar10]  = mPos;
-      LoopVar10             = mParent[LoopVar10];
-    }
-
-    if (LoopVar10 < WNDSIZ) {
-      mPosition[LoopVar10] = (NODE) (mPos | PERC_FLAG);
-    }
-  } else {
-    //
-    // Locate the target tree
-    //
-    LoopVar6 = (NODE) (mText[mPos] + WNDSIZ);
-    LoopVar5 = mText[mPos + 1];
-    LoopVar4 = Child (LoopVar6, LoopVar5);
-    if (LoopVar4 == NIL) {
-      MakeChild (LoopVar6, LoopVar5, mPos);
-      mMatchLen = 1;
-      return;
-    }
-
-    mMatchLen = 2;
-  }
-  //
-  // Traverse down the tree to find a match.
-  // Update Position value along the route.
-  // Node split or creation is involved.
-  //
-  for (;;) {
-    if (LoopVar4 >= WNDSIZ) {
-      LoopVar2  = MAXMATCH;
-      mMatchPos = LoopVar4;
-    } else {
-      LoopVar2  = mLevel[LoopVar4];
-      mMatchPos = (NODE) (mPosition[LoopVar4] & ~PERC_FLAG);
-    }
-
-    if (mMatchPos >= mPos) {
-      mMatchPos -= WNDSIZ;
-    }
-
-    TempString3 = &mText[mPos + mMatchLen];
-    TempString2 = &mText[mMatchPos + mMatchLen];
-    while (mMatchLen < LoopVar2) {
-      if (*TempString3 != *TempString2) {
-        Split (LoopVar4);
-        return;
-      }
-
-      mMatchLen++;
-      TempString3++;
-      TempString2++;
-    }
-
-    if (mMatchLen >= MAXMATCH) {
-      break;
-    }
-
-    mPosition[LoopVar4]  = mPos;
-    LoopVar6             = LoopVar4;
-    LoopVar4             = Child (LoopVar6, *TempString3);
-    if (LoopVar4 == NIL) {
-      MakeChild (LoopVar6, *TempString3, mPos);
-      return;
-    }
-
-    mMatchLen++;
-  }
-
-  LoopVar10             = mPrev[LoopVar4];
-  mPrev[mPos]           = LoopVar10;
-  mNext[LoopVar10]      = mPos;
-  LoopVar10             = mNext[LoopVar4];
-  mNext[mPos]           = LoopVar10;
-  mPrev[LoopVar10]      = mPos;
-  mParent[mPos]         = LoopVar6;
-  mParent[LoopVar4]     = NIL;
-
-  //
-  // Special usage of 'next'
-  //
-  mNext[LoopVar4] = mPos;
+  UINT32  Hash;
 
+  Hash             = HASH (&mText[mPos]);
+  mHashPrev[mPos]  = mHashHead[Hash];
+  mHashHead[Hash]  = (INT16) mPos;
 }
 
 /**
-  Delete outdated string info. (The Usage of PERC_FLAG
-  ensures a clean deletion).
+  Search the hash chain of the current position for the longest match
+  within the window. The result is left in mMatchLen and mMatchPos.
 
 **/
 VOID
 EFIAPI
-DeleteNode (
+FindLongestMatch (
   VOID
   )
 {
-  NODE  LoopVar6;
-
-  NODE  LoopVar4;
-
-  NODE  LoopVar11;
-
-  NODE  LoopVar10;
-
-  NODE  LoopVar9;
-
-  if (mParent[mPos] == NIL) {
-    return;
-  }
-
-  LoopVar4             = mPrev[mPos];
-  LoopVar11            = mNext[mPos];
-  mNext[LoopVar4]      = LoopVar11;
-  mPrev[LoopVar11]     = LoopVar4;
-  LoopVar4             = mParent[mPos];
-  mParent[mPos]        = NIL;
-  if (LoopVar4 >= WNDSIZ) {
-    return;
-  }
-
-  mChildCount[LoopVar4]--;
-  if (mChildCount[LoopVar4] > 1) {
-    return;
-  }
-
-  LoopVar10 = (NODE) (mPosition[LoopVar4] & ~PERC_FLAG);
-  if (LoopVar10 >= mPos) {
-    LoopVar10 -= WNDSIZ;
-  }
-
-  LoopVar11 = LoopVar10;
-  LoopVar6 = mParent[LoopVar4];
-  LoopVar9 = mPosition[LoopVar6];
-  while ((LoopVar9 & PERC_FLAG) != 0) {
-    LoopVar9 &= ~PERC_FLAG;
-    if (LoopVar9 >= mPos) {
-      LoopVar9 -= WNDSIZ;
-    }
-
-    if (LoopVar9 > LoopVar11) {
-      LoopVar11 = LoopVar9;
-    }
-
-    mPosition[LoopVar6]  = (NODE) (LoopVar11 | WNDSIZ);
-    LoopVar6             = mParent[LoopVar6];
-    LoopVar9             = mPosition[LoopVar6];
-  }
-
-  if (LoopVar6 < WNDSIZ) {
-    if (LoopVar9 >= mPos) {
-      LoopVar9 -= WNDSIZ;
-    }
+  INT32   Candidate;
+  INT32   Limit;
+  INT32   Len;
+  UINT32  Chain;
+  UINT8   *Scan;
+  UINT8   *Match;
+
+  mMatchLen = 0;
+  Scan      = &mText[mPos];
+  Limit     = mPos - (INT32) WNDSIZ;
+  Chain     = mConfig->MaxChain;
+  Candidate = mHashHead[HASH (Scan)];
+
+  while ((Candidate > Limit) && (Chain-- != 0)) {
+    Match = &mText[Candidate];
+    //
+    // Reject the candidate quickly unless it can beat the current best.
+    //
+    if ((Match[mMatchLen] == Scan[mMatchLen]) && (Match[0] == Scan[0])) {
+      Len = 1;
+      while ((Len < MAXMATCH) && (Match[Len] == Scan[Len])) {
+        Len++;
+      }
 
-    if (LoopVar9 > LoopVar11) {
-      LoopVar11 = LoopVar9;
+      if (Len > mMatchLen) {
+        mMatchLen = Len;
+        mMatchPos = Candidate;
+        if (Len >= mConfig->NiceLength) {
+          break;
+        }
+      }
     }
 
-    mPosition[LoopVar6] = (NODE) (LoopVar11 | WNDSIZ | PERC_FLAG);
+    Candidate = mHashPrev[Candidate];
   }
-
-  LoopVar11           = Child (LoopVar4, mText[LoopVar10 + mLevel[LoopVar4]]);
-  LoopVar10           = mPrev[LoopVar11];
-  LoopVar9            = mNext[LoopVar11];
-  mNext[LoopVar10]    = LoopVar9;
-  mPrev[LoopVar9]     = LoopVar10;
-  LoopVar10           = mPrev[LoopVar4];
-  mNext[LoopVar10]    = LoopVar11;
-  mPrev[LoopVar11]    = LoopVar10;
-  LoopVar10           = mNext[LoopVar4];
-  mPrev[LoopVar10]    = LoopVar11;
-  mNext[LoopVar11]    = LoopVar10;
-  mParent[LoopVar11]  = mParent[LoopVar4];
-  mParent[LoopVar4]   = NIL;
-  mNext[LoopVar4]     = mAvail;
-  mAvail              = LoopVar4;
 }
 
 /**
-  Read in source data
+  Read in source data, either from the source buffer or from the caller's
+  read function when compressing a stream.
 
   @param[out] LoopVar7   The buffer to hold the data.
   @param[in] LoopVar8    The number of bytes to read.
@@ -585,66 +352,91 @@ DeleteNode (
 **/
 INT32
 EFIAPI
-FreadCrc (
+ReadSource (
   OUT UINT8 *LoopVar7,
   IN  INT32 LoopVar8
   )
 {
   INT32 LoopVar1;
+  UINTN Read;
 
-  for (LoopVar1 = 0; mSrc < mSrcUpperLimit && LoopVar1 < LoopVar8; LoopVar1++) {
-    *LoopVar7++ = *mSrc++;
-  }
-
-  LoopVar8 = LoopVar1;
+  if (mReadFunction == NULL) {
+    LoopVar1 = (INT32) MIN ((UINTN) LoopVar8, (UINTN) (mSrcUpperLimit - mSrc));
+    CopyMem (LoopVar7, mSrc, LoopVar1);
+    mSrc += LoopVar1;
+  } else {
+    //
+    // Keep asking until the request is satisfied or the stream ends, so a
+    // short read does not look like the end of the data.
+    //
+    for (LoopVar1 = 0; LoopVar1 < LoopVar8; LoopVar1 += (INT32) Read) {
+      Read = mReadFunction (mReadContext, LoopVar7 + LoopVar1, (UINTN) (LoopVar8 - LoopVar1));
+      if (Read == 0) {
+        break;
+      }
 
-  LoopVar7 -= LoopVar8;
-  mOrigSize += LoopVar8;
-  LoopVar1--;
-  while (LoopVar1 >= 0) {
-    UPDATE_CRC (*LoopVar7++);
-    LoopVar1--;
+      ASSERT (Read <= (UINTN) (LoopVar8 - LoopVar1));
+    }
   }
 
-  return LoopVar8;
+  mOrigSize += LoopVar1;
+  return LoopVar1;
 }
 
 /**
-  Advance the current position (read in new data if needed).
-  Delete outdated string info. Find a match string for current position.
+  Advance the current position (read in new data if needed) and link it into
+  the hash chains, optionally searching for a match string first.
 
-  @retval TRUE      The operation was successful.
-  @retval FALSE     The operation failed due to insufficient memory.
+  @param[in] FindMatch   TRUE to search for a match at the new position. Callers
+                         skipping over the body of a match pass FALSE.
 
 **/
-BOOLEAN
+VOID
 EFIAPI
 GetNextMatch (
-  VOID
+  IN BOOLEAN  FindMatch
   )
 {
   INT32 LoopVar8;
-  VOID  *Temp;
 
   mRemainder--;
   mPos++;
   if (mPos == WNDSIZ * 2) {
-    Temp = AllocateZeroPool (WNDSIZ + MAXMATCH);
-    if (Temp == NULL) {
-      return (FALSE);
-    }
-    CopyMem (Temp, &mText[WNDSIZ], WNDSIZ + MAXMATCH);
-    CopyMem (&mText[0], Temp, WNDSIZ + MAXMATCH);
-    FreePool (Temp);
-    LoopVar8 = FreadCrc (&mText[WNDSIZ + MAXMATCH], WNDSIZ);
+    CopyMem (&mText[0], &mText[WNDSIZ], WNDSIZ + MAXMATCH);
+    LoopVar8 = ReadSource (&mText[WNDSIZ + MAXMATCH], WNDSIZ);
     mRemainder += LoopVar8;
     mPos = WNDSIZ;
+    SlideHash ();
   }
 
-  DeleteNode ();
-  InsertNode ();
+  if (FindMatch) {
+    FindLongestMatch ();
+  }
 
-  return (TRUE);
+  InsertPosition ();
+}
+
+/**
+  Advance over the body of a match that has just been output. Only the last
+  position, where the next token starts, is searched.
+
+  @param[in] Count    The number of positions to advance.
+
+**/
+VOID
+EFIAPI
+SkipMatch (
+  IN INT32 Count
+  )
+{
+  while (Count > 0) {
+    Count--;
+    GetNextMatch (Count == 0);
+  }
+
+  if (mMatchLen > mRemainder) {
+    mMatchLen = mRemainder;
+  }
 }
 
 /**
@@ -1288,7 +1080,7 @@ Encode (
 {
   EFI_STATUS  Status;
   INT32       LastMatchLen;
-  NODE        LastMatchPos;
+  INT32       LastMatchPos;
 
   Status = AllocateMemory ();
   if (EFI_ERROR (Status)) {
@@ -1300,11 +1092,12 @@ Encode (
 
   HufEncodeStart ();
 
-  mRemainder  = FreadCrc (&mText[WNDSIZ], WNDSIZ + MAXMATCH);
+  mRemainder  = ReadSource (&mText[WNDSIZ], WNDSIZ + MAXMATCH);
 
   mMatchLen   = 0;
   mPos        = WNDSIZ;
-  InsertNode ();
+  FindLongestMatch ();
+  InsertPosition ();
   if (mMatchLen > mRemainder) {
     mMatchLen = mRemainder;
   }
@@ -1312,9 +1105,18 @@ Encode (
   while (mRemainder > 0) {
     LastMatchLen = mMatchLen;
     LastMatchPos = mMatchPos;
-    if (!GetNextMatch ()) {
-      Status = EFI_OUT_OF_RESOURCES;
+
+    if (!mConfig->Lazy && (LastMatchLen >= THRESHOLD)) {
+      //
+      // Greedy parsing: take the match without looking one byte ahead.
+      //
+      CompressOutput (LastMatchLen + (MAX_UINT8 + 1 - THRESHOLD),
+        (mPos - LastMatchPos - 1) & (WNDSIZ - 1));
+      SkipMatch (LastMatchLen);
+      continue;
     }
+
+    GetNextMatch (TRUE);
     if (mMatchLen > mRemainder) {
       mMatchLen = mRemainder;
     }
@@ -1332,17 +1134,7 @@ Encode (
 
       CompressOutput (LastMatchLen + (MAX_UINT8 + 1 - THRESHOLD),
         (mPos - LastMatchPos - 2) & (WNDSIZ - 1));
-      LastMatchLen--;
-      while (LastMatchLen > 0) {
-        if (!GetNextMatch ()) {
-          Status = EFI_OUT_OF_RESOURCES;
-        }
-        LastMatchLen--;
-      }
-
-      if (mMatchLen > mRemainder) {
-        mMatchLen = mRemainder;
-      }
+      SkipMatch (LastMatchLen - 1);
     }
   }
 
@@ -1352,53 +1144,50 @@ Encode (
 }
 
 /**
-  The compression routine.
+  Compress the data supplied by the source buffer or read function into
+  DstBuffer at the given level, and fill in the size header.
 
-  @param[in]       SrcBuffer     The buffer containing the source data.
-  @param[in]       SrcSize       The number of bytes in SrcBuffer.
+  @param[in]       Level         The compression level to use.
   @param[in]       DstBuffer     The buffer to put the compressed image in.
   @param[in, out]  DstSize       On input the size (in bytes) of DstBuffer, on
-                                return the number of bytes placed in DstBuffer.
+                                 return the number of bytes placed in DstBuffer.
 
   @retval EFI_SUCCESS           The compression was sucessful.
   @retval EFI_BUFFER_TOO_SMALL  The buffer was too small.  DstSize is required.
+  @retval EFI_INVALID_PARAMETER Level is not a valid compression level.
+  @retval EFI_OUT_OF_RESOURCES  Not enough memory for compression process.
 **/
 EFI_STATUS
 EFIAPI
-Compress (
-  IN       VOID   *SrcBuffer,
-  IN       UINT64 SrcSize,
-  IN       VOID   *DstBuffer,
-  IN OUT   UINT64 *DstSize
+CompressInternal (
+  IN       COMPRESS_LEVEL  Level,
+  IN       VOID            *DstBuffer,
+  IN OUT   UINT64          *DstSize
   )
 {
   EFI_STATUS  Status;
 
+  if ((UINT32) Level >= CompressLevelCount) {
+    return EFI_INVALID_PARAMETER;
+  }
+
   //
   // Initializations
   //
   mBufSiz         = 0;
   mBuf            = NULL;
   mText           = NULL;
-  mLevel          = NULL;
-  mChildCount     = NULL;
-  mPosition       = NULL;
-  mParent         = NULL;
-  mPrev           = NULL;
-  mNext           = NULL;
+  mHashHead       = NULL;
+  mHashPrev       = NULL;
+  mConfig         = &mLevelConfig[Level];
 
-  mSrc            = SrcBuffer;
-  mSrcUpperLimit  = mSrc + SrcSize;
   mDst            = DstBuffer;
   mDstUpperLimit  = mDst + *DstSize;
 
   PutDword (0L);
   PutDword (0L);
 
-  MakeCrcTable ();
-
   mOrigSize       = mCompSize = 0;
-  mCrc            = INIT_CRC;
 
   //
   // Compress it
@@ -1433,3 +1222,98 @@ Compress (
 
 }
 
+/**
+  The compression routine.
+
+  @param[in]       SrcBuffer     The buffer containing the source data.
+  @param[in]       SrcSize       The number of bytes in SrcBuffer.
+  @param[in]       DstBuffer     The buffer to put the compressed image in.
+  @param[in, out]  DstSize       On input the size (in bytes) of DstBuffer, on
+                                return the number of bytes placed in DstBuffer.
+
+  @retval EFI_SUCCESS           The compression was sucessful.
+  @retval EFI_BUFFER_TOO_SMALL  The buffer was too small.  DstSize is required.
+**/
+EFI_STATUS
+EFIAPI
+Compress (
+  IN       VOID   *SrcBuffer,
+  IN       UINT64 SrcSize,
+  IN       VOID   *DstBuffer,
+  IN OUT   UINT64 *DstSize
+  )
+{
+  return CompressEx (SrcBuffer, SrcSize, DstBuffer, DstSize, CompressLevelDefault);
+}
+
+/**
+  The compression routine with a selectable compression level.
+
+  @param[in]       SrcBuffer     The buffer containing the source data.
+  @param[in]       SrcSize       The number of bytes in SrcBuffer.
+  @param[in]       DstBuffer     The buffer to put the compressed image in.
+  @param[in, out]  DstSize       On input the size (in bytes) of DstBuffer, on
+                                 return the number of bytes placed in DstBuffer.
+  @param[in]       Level         The compression level to use.
+
+  @retval EFI_SUCCESS           The compression was sucessful.
+  @retval EFI_BUFFER_TOO_SMALL  The buffer was too small.  DstSize is required.
+  @retval EFI_INVALID_PARAMETER Level is not a valid compression level.
+  @retval EFI_OUT_OF_RESOURCES  Not enough memory for compression process.
+**/
+EFI_STATUS
+EFIAPI
+CompressEx (
+  IN       VOID            *SrcBuffer,
+  IN       UINT64          SrcSize,
+  IN       VOID            *DstBuffer,
+  IN OUT   UINT64          *DstSize,
+  IN       COMPRESS_LEVEL  Level
+  )
+{
+  mReadFunction   = NULL;
+  mReadContext    = NULL;
+  mSrc            = SrcBuffer;
+  mSrcUpperLimit  = mSrc + SrcSize;
+
+  return CompressInternal (Level, DstBuffer, DstSize);
+}
+
+/**
+  The streaming compression routine. Source data is pulled through
+  ReadFunction as the window advances, so the whole input never has to be
+  resident in memory.
+
+  @param[in]       ReadFunction  The function supplying the source data.
+  @param[in]       Context       The context passed to ReadFunction.
+  @param[in]       DstBuffer     The buffer to put the compressed image in.
+  @param[in, out]  DstSize       On input the size (in bytes) of DstBuffer, on
+                                 return the number of bytes placed in DstBuffer.
+  @param[in]       Level         The compression level to use.
+
+  @retval EFI_SUCCESS           The compression was sucessful.
+  @retval EFI_BUFFER_TOO_SMALL  The buffer was too small.  DstSize is required.
+  @retval EFI_INVALID_PARAMETER ReadFunction is NULL or Level is not valid.
+  @retval EFI_OUT_OF_RESOURCES  Not enough memory for compression process.
+**/
+EFI_STATUS
+EFIAPI
+CompressStream (
+  IN       COMPRESS_READ_FUNCTION  ReadFunction,
+  IN       VOID                    *Context,
+  IN       VOID                    *DstBuffer,
+  IN OUT   UINT64                  *DstSize,
+  IN       COMPRESS_LEVEL          Level
+  )
+{
+  if (ReadFunction == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  mReadFunction   = ReadFunction;
+  mReadContext    = Context;
+  mSrc            = NULL;
+  mSrcUpperLimit  = NULL;
+
+  return CompressInternal (Level, DstBuffer, DstSize);
+}
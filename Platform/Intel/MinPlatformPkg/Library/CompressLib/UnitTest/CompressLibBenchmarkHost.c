@@ -0,0 +1,241 @@
+/** @file
+  Host based benchmark for CompressLib.
+
+  Compresses each sample file named on the command line (typically FSP NVS
+  HOB dumps captured from real boards) at every COMPRESS_LEVEL, checks that
+  the standard EFI decompressor restores the original data, and reports the
+  throughput and the compression ratio. Without arguments a synthetic memory
+  training image is used instead.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <Uefi.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/CompressLib.h>
+#include <Library/UefiDecompressLib.h>
+
+#define BENCHMARK_ITERATIONS  16
+#define SYNTHETIC_SAMPLE_SIZE SIZE_64KB
+
+STATIC CONST CHAR8  *mLevelName[CompressLevelCount] = {
+  "fast",
+  "default",
+  "max"
+};
+
+/**
+  Build a sample that resembles FSP memory training data: mostly zero, with
+  repeated per-channel records that differ in a few bytes.
+
+  @param[out] Size    The size of the returned sample.
+
+  @return The synthetic sample, or NULL on allocation failure.
+**/
+UINT8 *
+CreateSyntheticSample (
+  OUT UINTN  *Size
+  )
+{
+  UINT8  *Sample;
+  UINTN  Index;
+
+  Sample = calloc (1, SYNTHETIC_SAMPLE_SIZE);
+  if (Sample == NULL) {
+    return NULL;
+  }
+
+  srand (0);
+  for (Index = 0; Index < SYNTHETIC_SAMPLE_SIZE; Index++) {
+    if ((Index % 0x400) < 0x100) {
+      Sample[Index] = (UINT8)((Index & 0xF) + ((rand () % 8) == 0 ? rand () : 0));
+    }
+  }
+
+  *Size = SYNTHETIC_SAMPLE_SIZE;
+  return Sample;
+}
+
+/**
+  Read a whole sample file into memory.
+
+  @param[in]  FileName  The sample file to read.
+  @param[out] Size      The size of the returned sample.
+
+  @return The file contents, or NULL if the file could not be read.
+**/
+UINT8 *
+ReadSampleFile (
+  IN  CONST CHAR8  *FileName,
+  OUT UINTN        *Size
+  )
+{
+  FILE   *File;
+  UINT8  *Sample;
+  long   Length;
+
+  File = fopen (FileName, "rb");
+  if (File == NULL) {
+    return NULL;
+  }
+
+  Sample = NULL;
+  if ((fseek (File, 0, SEEK_END) == 0) && ((Length = ftell (File)) > 0)) {
+    rewind (File);
+    Sample = malloc ((size_t)Length);
+    if ((Sample != NULL) && (fread (Sample, 1, (size_t)Length, File) != (size_t)Length)) {
+      free (Sample);
+      Sample = NULL;
+    }
+
+    *Size = (UINTN)Length;
+  }
+
+  fclose (File);
+  return Sample;
+}
+
+/**
+  Benchmark one sample at every compression level.
+
+  @param[in] Name     The name to report the sample under.
+  @param[in] Sample   The sample data.
+  @param[in] Size     The size of the sample.
+
+  @retval TRUE   Every level round-tripped through the EFI decompressor.
+  @retval FALSE  A level failed to compress or decompress the sample.
+**/
+BOOLEAN
+BenchmarkSample (
+  IN CONST CHAR8  *Name,
+  IN UINT8        *Sample,
+  IN UINTN        Size
+  )
+{
+  COMPRESS_LEVEL  Level;
+  UINT8           *Compressed;
+  UINT8           *Decompressed;
+  UINT8           *Scratch;
+  UINT64          CompressedSize;
+  UINT32          DestinationSize;
+  UINT32          ScratchSize;
+  UINTN           Iteration;
+  clock_t         Start;
+  double          Seconds;
+  EFI_STATUS      Status;
+  BOOLEAN         Passed;
+
+  Passed     = TRUE;
+  Compressed = malloc (Size * 2 + SIZE_4KB);
+  if (Compressed == NULL) {
+    return FALSE;
+  }
+
+  for (Level = CompressLevelFast; Level < CompressLevelCount; Level++) {
+    Start = clock ();
+    for (Iteration = 0; Iteration < BENCHMARK_ITERATIONS; Iteration++) {
+      CompressedSize = Size * 2 + SIZE_4KB;
+      Status         = CompressEx (Sample, Size, Compressed, &CompressedSize, Level);
+      if (EFI_ERROR (Status)) {
+        break;
+      }
+    }
+
+    Seconds = (double)(clock () - Start) / CLOCKS_PER_SEC;
+    if (EFI_ERROR (Status)) {
+      printf ("%s: %s level failed: %lx\n", Name, mLevelName[Level], (unsigned long)Status);
+      Passed = FALSE;
+      continue;
+    }
+
+    Status = UefiDecompressGetInfo (Compressed, (UINT32)CompressedSize, &DestinationSize, &ScratchSize);
+    if (EFI_ERROR (Status) || (DestinationSize != Size)) {
+      printf ("%s: %s level produced an invalid header\n", Name, mLevelName[Level]);
+      Passed = FALSE;
+      continue;
+    }
+
+    Decompressed = malloc (DestinationSize);
+    Scratch      = malloc (ScratchSize);
+    if ((Decompressed == NULL) || (Scratch == NULL)) {
+      free (Decompressed);
+      free (Scratch);
+      Passed = FALSE;
+      break;
+    }
+
+    Status = UefiDecompress (Compressed, Decompressed, Scratch);
+    if (EFI_ERROR (Status) || (CompareMem (Decompressed, Sample, Size) != 0)) {
+      printf ("%s: %s level did not round trip\n", Name, mLevelName[Level]);
+      Passed = FALSE;
+    } else {
+      printf (
+        "%-32s %-8s %8lu -> %8lu bytes  ratio %6.2f%%  %8.2f MB/s\n",
+        Name,
+        mLevelName[Level],
+        (unsigned long)Size,
+        (unsigned long)CompressedSize,
+        100.0 * (double)CompressedSize / (double)Size,
+        (Seconds > 0) ? ((double)Size * BENCHMARK_ITERATIONS / Seconds / 1000000.0) : 0.0
+        );
+    }
+
+    free (Decompressed);
+    free (Scratch);
+  }
+
+  free (Compressed);
+  return Passed;
+}
+
+/**
+  Benchmark entry point.
+
+  @param[in] Argc   Number of command line arguments.
+  @param[in] Argv   Sample files to benchmark.
+
+  @return 0 if every sample round-tripped at every level, 1 otherwise.
+**/
+int
+main (
+  int   Argc,
+  char  *Argv[]
+  )
+{
+  UINT8    *Sample;
+  UINTN    Size;
+  int      Index;
+  BOOLEAN  Passed;
+
+  Passed = TRUE;
+  if (Argc < 2) {
+    Sample = CreateSyntheticSample (&Size);
+    if (Sample == NULL) {
+      return 1;
+    }
+
+    Passed = BenchmarkSample ("synthetic", Sample, Size);
+    free (Sample);
+  }
+
+  for (Index = 1; Index < Argc; Index++) {
+    Sample = ReadSampleFile (Argv[Index], &Size);
+    if (Sample == NULL) {
+      printf ("%s: cannot read sample\n", Argv[Index]);
+      Passed = FALSE;
+      continue;
+    }
+
+    Passed &= BenchmarkSample (Argv[Index], Sample, Size);
+    free (Sample);
+  }
+
+  return Passed ? 0 : 1;
+}
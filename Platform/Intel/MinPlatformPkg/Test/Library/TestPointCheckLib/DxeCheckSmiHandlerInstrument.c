@@ -20,6 +20,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/SmmCommunication.h>
 #include <Guid/PiSmmCommunicationRegionTable.h>
 #include <Guid/SmiHandlerProfile.h>
+#include <Guid/PchSmiResidencyProfile.h>
 
 #define PROFILE_NAME_STRING_LENGTH  64
 CHAR8 mNameString[PROFILE_NAME_STRING_LENGTH + 1];
@@ -613,6 +614,171 @@ DumpSmiHandler(
   return;
 }
 
+/**
+  Get and dump the PCH SMI residency profile, if the PCH SMI dispatcher publishes it.
+**/
+VOID
+DumpPchSmiResidencyProfile (
+  VOID
+  )
+{
+  EFI_STATUS                                              Status;
+  UINTN                                                   CommSize;
+  UINT8                                                   *CommBuffer;
+  EFI_SMM_COMMUNICATE_HEADER                              *CommHeader;
+  PCH_SMI_RESIDENCY_PROFILE_PARAMETER_GET_INFO            *CommGetInfo;
+  PCH_SMI_RESIDENCY_PROFILE_PARAMETER_GET_DATA_BY_OFFSET  *CommGetData;
+  EFI_SMM_COMMUNICATION_PROTOCOL                          *SmmCommunication;
+  EDKII_PI_SMM_COMMUNICATION_REGION_TABLE                 *PiSmmCommunicationRegionTable;
+  UINT32                                                  Index;
+  EFI_MEMORY_DESCRIPTOR                                   *Entry;
+  VOID                                                    *Buffer;
+  UINTN                                                   Size;
+  UINTN                                                   Offset;
+  UINT8                                                   *Profile;
+  UINTN                                                   ProfileSize;
+  PCH_SMI_RESIDENCY_PROFILE_HEADER                        *Header;
+  PCH_SMI_RESIDENCY_SOURCE_ENTRY                          *Source;
+  PCH_SMI_RESIDENCY_HANDLER_ENTRY                         *Handler;
+  PCH_SMI_RESIDENCY_RING_ENTRY                            *Ring;
+
+  Status = gBS->LocateProtocol(&gEfiSmmCommunicationProtocolGuid, NULL, (VOID **)&SmmCommunication);
+  if (EFI_ERROR(Status)) {
+    return ;
+  }
+
+  Status = EfiGetSystemConfigurationTable(
+             &gEdkiiPiSmmCommunicationRegionTableGuid,
+             (VOID **)&PiSmmCommunicationRegionTable
+             );
+  if (EFI_ERROR(Status)) {
+    return ;
+  }
+  Entry = (EFI_MEMORY_DESCRIPTOR *)(PiSmmCommunicationRegionTable + 1);
+  Size = 0;
+  for (Index = 0; Index < PiSmmCommunicationRegionTable->NumberOfEntries; Index++) {
+    if (Entry->Type == EfiConventionalMemory) {
+      Size = EFI_PAGES_TO_SIZE((UINTN)Entry->NumberOfPages);
+      if (Size >= EFI_PAGE_SIZE) {
+        break;
+      }
+    }
+    Entry = (EFI_MEMORY_DESCRIPTOR *)((UINT8 *)Entry + PiSmmCommunicationRegionTable->DescriptorSize);
+  }
+  if (Index >= PiSmmCommunicationRegionTable->NumberOfEntries) {
+    return ;
+  }
+  CommBuffer = (UINT8 *)(UINTN)Entry->PhysicalStart;
+
+  //
+  // Get Size. The dispatcher takes a snapshot here, which the following reads copy out.
+  //
+  CommHeader = (EFI_SMM_COMMUNICATE_HEADER *)&CommBuffer[0];
+  CopyMem(&CommHeader->HeaderGuid, &gPchSmiResidencyProfileGuid, sizeof(gPchSmiResidencyProfileGuid));
+  CommHeader->MessageLength = sizeof(PCH_SMI_RESIDENCY_PROFILE_PARAMETER_GET_INFO);
+
+  CommGetInfo = (PCH_SMI_RESIDENCY_PROFILE_PARAMETER_GET_INFO *)&CommBuffer[OFFSET_OF(EFI_SMM_COMMUNICATE_HEADER, Data)];
+  CommGetInfo->Header.Command = PCH_SMI_RESIDENCY_PROFILE_COMMAND_GET_INFO;
+  CommGetInfo->Header.DataLength = sizeof(*CommGetInfo);
+  CommGetInfo->Header.ReturnStatus = (UINT64)-1;
+  CommGetInfo->DataSize = 0;
+
+  CommSize = OFFSET_OF (EFI_SMM_COMMUNICATE_HEADER, Data) + (UINTN)CommHeader->MessageLength;
+  Status = SmmCommunication->Communicate(SmmCommunication, CommBuffer, &CommSize);
+  if (EFI_ERROR(Status) || (CommGetInfo->Header.ReturnStatus != 0)) {
+    //
+    // PCH SMI residency profiling is not enabled
+    //
+    return ;
+  }
+
+  ProfileSize = (UINTN)CommGetInfo->DataSize;
+  if (ProfileSize < sizeof(PCH_SMI_RESIDENCY_PROFILE_HEADER)) {
+    return ;
+  }
+  Profile = AllocateZeroPool(ProfileSize);
+  if (Profile == NULL) {
+    DEBUG ((DEBUG_INFO, "PchSmiResidencyProfile: AllocateZeroPool (0x%x) for dump buffer - %r\n", ProfileSize, EFI_OUT_OF_RESOURCES));
+    return ;
+  }
+
+  //
+  // Get Data
+  //
+  CommHeader = (EFI_SMM_COMMUNICATE_HEADER *)&CommBuffer[0];
+  CopyMem(&CommHeader->HeaderGuid, &gPchSmiResidencyProfileGuid, sizeof(gPchSmiResidencyProfileGuid));
+  CommHeader->MessageLength = sizeof(PCH_SMI_RESIDENCY_PROFILE_PARAMETER_GET_DATA_BY_OFFSET);
+
+  CommGetData = (PCH_SMI_RESIDENCY_PROFILE_PARAMETER_GET_DATA_BY_OFFSET *)&CommBuffer[OFFSET_OF(EFI_SMM_COMMUNICATE_HEADER, Data)];
+  CommGetData->Header.Command = PCH_SMI_RESIDENCY_PROFILE_COMMAND_GET_DATA_BY_OFFSET;
+  CommGetData->Header.DataLength = sizeof(*CommGetData);
+  CommGetData->Header.ReturnStatus = (UINT64)-1;
+
+  CommSize = OFFSET_OF (EFI_SMM_COMMUNICATE_HEADER, Data) + (UINTN)CommHeader->MessageLength;
+  Buffer = (UINT8 *)CommHeader + CommSize;
+  Size -= CommSize;
+
+  CommGetData->DataBuffer = (PHYSICAL_ADDRESS)(UINTN)Buffer;
+  CommGetData->DataOffset = 0;
+  while (CommGetData->DataOffset < ProfileSize) {
+    Offset = (UINTN)CommGetData->DataOffset;
+    if (Size <= (ProfileSize - CommGetData->DataOffset)) {
+      CommGetData->DataSize = (UINT64)Size;
+    } else {
+      CommGetData->DataSize = (UINT64)(ProfileSize - CommGetData->DataOffset);
+    }
+    Status = SmmCommunication->Communicate(SmmCommunication, CommBuffer, &CommSize);
+    if (EFI_ERROR(Status) || (CommGetData->Header.ReturnStatus != 0)) {
+      DEBUG ((DEBUG_INFO, "PchSmiResidencyProfile: GetData - %r 0x%lx\n", Status, CommGetData->Header.ReturnStatus));
+      FreePool(Profile);
+      return ;
+    }
+    CopyMem(Profile + Offset, (VOID *)(UINTN)CommGetData->DataBuffer, (UINTN)CommGetData->DataSize);
+  }
+
+  Header = (PCH_SMI_RESIDENCY_PROFILE_HEADER *)Profile;
+  if ((Header->Signature != PCH_SMI_RESIDENCY_PROFILE_SIGNATURE) ||
+      (Header->Length != ProfileSize) ||
+      (sizeof(*Header) +
+       Header->SourceCount * sizeof(*Source) +
+       Header->HandlerCount * sizeof(*Handler) +
+       Header->RingCount * sizeof(*Ring) > ProfileSize)) {
+    DEBUG ((DEBUG_INFO, "PchSmiResidencyProfile: invalid data\n"));
+    FreePool(Profile);
+    return ;
+  }
+
+  //
+  // All times are in TSC ticks
+  //
+  DEBUG ((DEBUG_INFO, "<PchSmiResidencyProfile>\n"));
+  DEBUG ((DEBUG_INFO, "  <Dispatcher Count=\"%ld\" Total=\"%ld\" Max=\"%ld\"/>\n",
+    Header->Dispatcher.Count, Header->Dispatcher.TotalTicks, Header->Dispatcher.MaxTicks));
+  Source = (PCH_SMI_RESIDENCY_SOURCE_ENTRY *)(Header + 1);
+  for (Index = 0; Index < Header->SourceCount; Index++, Source++) {
+    if (Source->Counter.Count == 0) {
+      continue;
+    }
+    DEBUG ((DEBUG_INFO, "  <Source StsBit=\"0x%x\" Count=\"%ld\" Total=\"%ld\" Max=\"%ld\"/>\n",
+      Source->StsBit, Source->Counter.Count, Source->Counter.TotalTicks, Source->Counter.MaxTicks));
+  }
+  Handler = (PCH_SMI_RESIDENCY_HANDLER_ENTRY *)Source;
+  for (Index = 0; Index < Header->HandlerCount; Index++, Handler++) {
+    DEBUG ((DEBUG_INFO, "  <Handler Address=\"0x%lx\" StsBit=\"0x%x\" Type=\"%d\" PchSmiType=\"%d\"",
+      Handler->Handler, Handler->StsBit, Handler->ProtocolType, Handler->PchSmiType));
+    DEBUG ((DEBUG_INFO, " Count=\"%ld\" Total=\"%ld\" Max=\"%ld\"/>\n",
+      Handler->Counter.Count, Handler->Counter.TotalTicks, Handler->Counter.MaxTicks));
+  }
+  Ring = (PCH_SMI_RESIDENCY_RING_ENTRY *)Handler;
+  for (Index = 0; Index < Header->RingCount; Index++, Ring++) {
+    DEBUG ((DEBUG_INFO, "  <Last StsBit=\"0x%x\" Start=\"0x%lx\" Ticks=\"%ld\"/>\n",
+      Ring->StsBit, Ring->StartTsc, Ring->Ticks));
+  }
+  DEBUG ((DEBUG_INFO, "</PchSmiResidencyProfile>\n"));
+
+  FreePool(Profile);
+}
+
 EFI_STATUS
 EFIAPI
 TestPointCheckSmiHandlerInstrument (
@@ -621,6 +787,8 @@ TestPointCheckSmiHandlerInstrument (
 {
   DEBUG ((DEBUG_INFO, "==== TestPointCheckSmiHandlerInstrument - Enter\n"));
 
+  DumpPchSmiResidencyProfile();
+
   GetSmiHandlerProfileDatabase();
 
   if (mSmiHandlerProfileDatabase == NULL) {
@@ -0,0 +1,289 @@
+/** @file
+  Shell application that reads the PCH SMI residency profile through the
+  gPchSmiResidencyProfileGuid communication handler and prints it.
+
+  The profile is only published when the PCH SMI dispatcher is built with
+  PcdPchSmiResidencyProfileEnable set to TRUE. All times are in TSC ticks.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiDxe.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/DebugLib.h>
+#include <Library/UefiLib.h>
+#include <Protocol/SmmCommunication.h>
+#include <Guid/PiSmmCommunicationRegionTable.h>
+#include <Guid/PchSmiResidencyProfile.h>
+
+/**
+  Read a snapshot of the PCH SMI residency profile.
+
+  @param[out] Profile             The snapshot, to be freed by the caller with FreePool().
+  @param[out] ProfileSize         The size of the snapshot in bytes.
+
+  @retval EFI_SUCCESS             The snapshot is read.
+  @retval EFI_NOT_FOUND           SMM communication is not available.
+  @retval EFI_UNSUPPORTED         The residency profile is not published.
+  @retval EFI_OUT_OF_RESOURCES    Fail to allocate the snapshot buffer.
+  @retval EFI_DEVICE_ERROR        Reading the snapshot failed.
+**/
+EFI_STATUS
+GetPchSmiResidencyProfile (
+  OUT VOID                        **Profile,
+  OUT UINTN                       *ProfileSize
+  )
+{
+  EFI_STATUS                                              Status;
+  UINTN                                                   CommSize;
+  UINT8                                                   *CommBuffer;
+  EFI_SMM_COMMUNICATE_HEADER                              *CommHeader;
+  PCH_SMI_RESIDENCY_PROFILE_PARAMETER_GET_INFO            *CommGetInfo;
+  PCH_SMI_RESIDENCY_PROFILE_PARAMETER_GET_DATA_BY_OFFSET  *CommGetData;
+  EFI_SMM_COMMUNICATION_PROTOCOL                          *SmmCommunication;
+  EDKII_PI_SMM_COMMUNICATION_REGION_TABLE                 *PiSmmCommunicationRegionTable;
+  UINT32                                                  Index;
+  EFI_MEMORY_DESCRIPTOR                                   *Entry;
+  VOID                                                    *Buffer;
+  UINTN                                                   Size;
+  UINTN                                                   Offset;
+  UINT8                                                   *Data;
+  UINTN                                                   DataSize;
+
+  Status = gBS->LocateProtocol (&gEfiSmmCommunicationProtocolGuid, NULL, (VOID **)&SmmCommunication);
+  if (EFI_ERROR (Status)) {
+    return EFI_NOT_FOUND;
+  }
+
+  Status = EfiGetSystemConfigurationTable (
+             &gEdkiiPiSmmCommunicationRegionTableGuid,
+             (VOID **)&PiSmmCommunicationRegionTable
+             );
+  if (EFI_ERROR (Status)) {
+    return EFI_NOT_FOUND;
+  }
+  Entry = (EFI_MEMORY_DESCRIPTOR *)(PiSmmCommunicationRegionTable + 1);
+  Size = 0;
+  for (Index = 0; Index < PiSmmCommunicationRegionTable->NumberOfEntries; Index++) {
+    if (Entry->Type == EfiConventionalMemory) {
+      Size = EFI_PAGES_TO_SIZE ((UINTN)Entry->NumberOfPages);
+      if (Size >= EFI_PAGE_SIZE) {
+        break;
+      }
+    }
+    Entry = (EFI_MEMORY_DESCRIPTOR *)((UINT8 *)Entry + PiSmmCommunicationRegionTable->DescriptorSize);
+  }
+  if (Index >= PiSmmCommunicationRegionTable->NumberOfEntries) {
+    return EFI_NOT_FOUND;
+  }
+  CommBuffer = (UINT8 *)(UINTN)Entry->PhysicalStart;
+
+  //
+  // Get Size. The dispatcher takes a snapshot here, which the following reads copy out.
+  //
+  CommHeader = (EFI_SMM_COMMUNICATE_HEADER *)&CommBuffer[0];
+  CopyMem (&CommHeader->HeaderGuid, &gPchSmiResidencyProfileGuid, sizeof (gPchSmiResidencyProfileGuid));
+  CommHeader->MessageLength = sizeof (PCH_SMI_RESIDENCY_PROFILE_PARAMETER_GET_INFO);
+
+  CommGetInfo = (PCH_SMI_RESIDENCY_PROFILE_PARAMETER_GET_INFO *)&CommBuffer[OFFSET_OF (EFI_SMM_COMMUNICATE_HEADER, Data)];
+  CommGetInfo->Header.Command = PCH_SMI_RESIDENCY_PROFILE_COMMAND_GET_INFO;
+  CommGetInfo->Header.DataLength = sizeof (*CommGetInfo);
+  CommGetInfo->Header.ReturnStatus = (UINT64)-1;
+  CommGetInfo->DataSize = 0;
+
+  CommSize = OFFSET_OF (EFI_SMM_COMMUNICATE_HEADER, Data) + (UINTN)CommHeader->MessageLength;
+  Status = SmmCommunication->Communicate (SmmCommunication, CommBuffer, &CommSize);
+  if (EFI_ERROR (Status) || (CommGetInfo->Header.ReturnStatus != 0)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  DataSize = (UINTN)CommGetInfo->DataSize;
+  if (DataSize < sizeof (PCH_SMI_RESIDENCY_PROFILE_HEADER)) {
+    return EFI_DEVICE_ERROR;
+  }
+  Data = AllocateZeroPool (DataSize);
+  if (Data == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  //
+  // Get Data
+  //
+  CommHeader = (EFI_SMM_COMMUNICATE_HEADER *)&CommBuffer[0];
+  CopyMem (&CommHeader->HeaderGuid, &gPchSmiResidencyProfileGuid, sizeof (gPchSmiResidencyProfileGuid));
+  CommHeader->MessageLength = sizeof (PCH_SMI_RESIDENCY_PROFILE_PARAMETER_GET_DATA_BY_OFFSET);
+
+  CommGetData = (PCH_SMI_RESIDENCY_PROFILE_PARAMETER_GET_DATA_BY_OFFSET *)&CommBuffer[OFFSET_OF (EFI_SMM_COMMUNICATE_HEADER, Data)];
+  CommGetData->Header.Command = PCH_SMI_RESIDENCY_PROFILE_COMMAND_GET_DATA_BY_OFFSET;
+  CommGetData->Header.DataLength = sizeof (*CommGetData);
+
+  CommSize = OFFSET_OF (EFI_SMM_COMMUNICATE_HEADER, Data) + (UINTN)CommHeader->MessageLength;
+  Buffer = (UINT8 *)CommHeader + CommSize;
+  Size -= CommSize;
+
+  CommGetData->DataBuffer = (PHYSICAL_ADDRESS)(UINTN)Buffer;
+  CommGetData->DataOffset = 0;
+  while (CommGetData->DataOffset < DataSize) {
+    Offset = (UINTN)CommGetData->DataOffset;
+    if (Size <= (DataSize - CommGetData->DataOffset)) {
+      CommGetData->DataSize = (UINT64)Size;
+    } else {
+      CommGetData->DataSize = (UINT64)(DataSize - CommGetData->DataOffset);
+    }
+    CommGetData->Header.ReturnStatus = (UINT64)-1;
+    Status = SmmCommunication->Communicate (SmmCommunication, CommBuffer, &CommSize);
+    if (EFI_ERROR (Status) || (CommGetData->Header.ReturnStatus != 0) ||
+        (CommGetData->DataOffset != Offset + CommGetData->DataSize)) {
+      FreePool (Data);
+      return EFI_DEVICE_ERROR;
+    }
+    CopyMem (Data + Offset, (VOID *)(UINTN)CommGetData->DataBuffer, (UINTN)CommGetData->DataSize);
+  }
+
+  *Profile     = Data;
+  *ProfileSize = DataSize;
+  return EFI_SUCCESS;
+}
+
+/**
+  Print one residency counter.
+
+  @param[in] Counter              The residency counter
+**/
+VOID
+DumpResidencyCounter (
+  IN PCH_SMI_RESIDENCY_COUNTER    *Counter
+  )
+{
+  Print (
+    L"Count %10ld  Total %16ld  Avg %12ld  Max %12ld\n",
+    Counter->Count,
+    Counter->TotalTicks,
+    (Counter->Count == 0) ? 0 : DivU64x64Remainder (Counter->TotalTicks, Counter->Count, NULL),
+    Counter->MaxTicks
+    );
+}
+
+/**
+  Print the SMI_STS bit of a source.
+
+  @param[in] StsBit               PMC SMI_STS bit or PCH_SMI_RESIDENCY_STS_BIT_OTHER
+**/
+VOID
+DumpStsBit (
+  IN UINT32                       StsBit
+  )
+{
+  if (StsBit == PCH_SMI_RESIDENCY_STS_BIT_OTHER) {
+    Print (L"Other   ");
+  } else {
+    Print (L"Bit %2d  ", StsBit);
+  }
+}
+
+/**
+  Check and print a snapshot of the PCH SMI residency profile.
+
+  @param[in] Profile              The snapshot
+  @param[in] ProfileSize          The size of the snapshot in bytes
+
+  @retval EFI_SUCCESS             The snapshot is printed.
+  @retval EFI_VOLUME_CORRUPTED    The snapshot is malformed.
+**/
+EFI_STATUS
+DumpPchSmiResidencyProfile (
+  IN VOID                         *Profile,
+  IN UINTN                        ProfileSize
+  )
+{
+  PCH_SMI_RESIDENCY_PROFILE_HEADER  *Header;
+  PCH_SMI_RESIDENCY_SOURCE_ENTRY    *Source;
+  PCH_SMI_RESIDENCY_HANDLER_ENTRY   *Handler;
+  PCH_SMI_RESIDENCY_RING_ENTRY      *Ring;
+  UINTN                             Index;
+
+  Header = (PCH_SMI_RESIDENCY_PROFILE_HEADER *)Profile;
+  if ((Header->Signature != PCH_SMI_RESIDENCY_PROFILE_SIGNATURE) ||
+      (Header->Length != ProfileSize) ||
+      (sizeof (*Header) +
+       (UINT64)Header->SourceCount * sizeof (*Source) +
+       (UINT64)Header->HandlerCount * sizeof (*Handler) +
+       (UINT64)Header->RingCount * sizeof (*Ring) > ProfileSize)) {
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  Print (L"PCH SMI residency profile (TSC ticks)\n");
+  Print (L"Dispatcher      ");
+  DumpResidencyCounter (&Header->Dispatcher);
+
+  Print (L"\nSources\n");
+  Source = (PCH_SMI_RESIDENCY_SOURCE_ENTRY *)(Header + 1);
+  for (Index = 0; Index < Header->SourceCount; Index++, Source++) {
+    if (Source->Counter.Count == 0) {
+      continue;
+    }
+    Print (L"  ");
+    DumpStsBit (Source->StsBit);
+    Print (L"      ");
+    DumpResidencyCounter (&Source->Counter);
+  }
+
+  Print (L"\nHandlers\n");
+  Handler = (PCH_SMI_RESIDENCY_HANDLER_ENTRY *)Source;
+  for (Index = 0; Index < Header->HandlerCount; Index++, Handler++) {
+    Print (
+      L"  0x%016lx  Type %2d  PchSmiType %3d  ",
+      Handler->Handler,
+      Handler->ProtocolType,
+      Handler->PchSmiType
+      );
+    DumpStsBit (Handler->StsBit);
+    Print (L"\n    ");
+    DumpResidencyCounter (&Handler->Counter);
+  }
+
+  Print (L"\nLast %d sources, oldest first\n", Header->RingCount);
+  Ring = (PCH_SMI_RESIDENCY_RING_ENTRY *)Handler;
+  for (Index = 0; Index < Header->RingCount; Index++, Ring++) {
+    Print (L"  TSC 0x%016lx  ", Ring->StartTsc);
+    DumpStsBit (Ring->StsBit);
+    Print (L"Ticks %ld\n", Ring->Ticks);
+  }
+
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+PchSmiResidencyDumpAppEntrypoint (
+  IN EFI_HANDLE           ImageHandle,
+  IN EFI_SYSTEM_TABLE     *SystemTable
+  )
+{
+  EFI_STATUS              Status;
+  VOID                    *Profile;
+  UINTN                   ProfileSize;
+
+  Status = GetPchSmiResidencyProfile (&Profile, &ProfileSize);
+  if (Status == EFI_UNSUPPORTED) {
+    Print (L"PCH SMI residency profile not available, is PcdPchSmiResidencyProfileEnable TRUE?\n");
+    return Status;
+  }
+  if (EFI_ERROR (Status)) {
+    Print (L"Failed to read the PCH SMI residency profile - %r\n", Status);
+    return Status;
+  }
+
+  Status = DumpPchSmiResidencyProfile (Profile, ProfileSize);
+  if (EFI_ERROR (Status)) {
+    Print (L"PCH SMI residency profile is malformed\n");
+  }
+
+  FreePool (Profile);
+  return Status;
+}
@@ -0,0 +1,64 @@
+/** @file
+  fw_cfg library implementation.
+
+  Copyright (c) 2022 Loongson Technology Corporation Limited. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+  @par Glossary:
+    - FwCfg   - firmWare  Configure
+**/
+
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/HobLib.h>
+#include <Library/QemuFwCfgLib.h>
+
+#include "QemuFwCfgLibInternal.h"
+
+STATIC QEMU_FW_CFG_CACHE *mFwCfgCache;
+
+/**
+  Returns the fw_cfg cache of the current phase.
+
+  @retval    NULL     fw_cfg is not present, or the cache was never built.
+  @retval    Others   Pointer to the fw_cfg cache.
+**/
+QEMU_FW_CFG_CACHE *
+QemuFwCfgGetCache (
+  VOID
+  )
+{
+  return mFwCfgCache;
+}
+
+/**
+  firmware config initialize.
+
+  Picks up the fw_cfg cache that was built in PEI.
+
+  @param  VOID
+
+  @return    RETURN_SUCCESS  Initialization succeeded.
+**/
+RETURN_STATUS
+EFIAPI
+QemuFwCfgInitialize (
+  VOID
+  )
+{
+  EFI_HOB_GUID_TYPE *GuidHob;
+
+  GuidHob = GetFirstGuidHob (&gLoongArchQemuFwCfgCacheHobGuid);
+  if (GuidHob == NULL) {
+    DEBUG ((DEBUG_INFO, "%a: No fw_cfg cache HOB, fw_cfg unavailable\n",
+      __func__));
+    return RETURN_SUCCESS;
+  }
+
+  //
+  // The HOB list stays valid for as long as boot services are available.
+  //
+  mFwCfgCache = GET_GUID_HOB_DATA (GuidHob);
+  return RETURN_SUCCESS;
+}
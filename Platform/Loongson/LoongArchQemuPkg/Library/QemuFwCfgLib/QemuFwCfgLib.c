@@ -15,14 +15,8 @@
 #include <Library/DebugLib.h>
 #include <Library/IoLib.h>
 #include <Library/QemuFwCfgLib.h>
-#include <Library/MemoryAllocationLib.h>
-#include <Library/UefiBootServicesTableLib.h>
-#include <Library/PcdLib.h>
-#include <libfdt.h>
 #include "QemuFwCfgLibInternal.h"
 
-STATIC UINTN mFwCfgSelectorAddress;
-STATIC UINTN mFwCfgDataAddress;
 /**
   To get firmware configure selector address.
 
@@ -36,11 +30,13 @@ QemuGetFwCfgSelectorAddress (
   VOID
   )
 {
-  UINTN FwCfgSelectorAddress = mFwCfgSelectorAddress;
-  if (FwCfgSelectorAddress == 0) {
-    FwCfgSelectorAddress = (UINTN)PcdGet64 (PcdFwCfgSelectorAddress);
+  QEMU_FW_CFG_CACHE *Cache;
+
+  Cache = QemuFwCfgGetCache ();
+  if (Cache == NULL) {
+    return 0;
   }
-  return FwCfgSelectorAddress;
+  return (UINTN)Cache->SelectorAddress;
 }
 /**
   To get firmware configure Data address.
@@ -55,11 +51,13 @@ QemuGetFwCfgDataAddress (
   VOID
   )
 {
-  UINTN FwCfgDataAddress = mFwCfgDataAddress;
-  if (FwCfgDataAddress == 0) {
-    FwCfgDataAddress = (UINTN)PcdGet64 (PcdFwCfgDataAddress);
+  QEMU_FW_CFG_CACHE *Cache;
+
+  Cache = QemuFwCfgGetCache ();
+  if (Cache == NULL) {
+    return 0;
   }
-  return FwCfgDataAddress;
+  return (UINTN)Cache->DataAddress;
 }
 /**
   Selects a firmware configuration item for reading.
@@ -75,9 +73,17 @@ QemuFwCfgSelectItem (
   IN FIRMWARE_CONFIG_ITEM   QemuFwCfgItem
   )
 {
+  QEMU_FW_CFG_CACHE *Cache;
   UINTN FwCfgSelectorAddress;
   FwCfgSelectorAddress = QemuGetFwCfgSelectorAddress ();
+  if (FwCfgSelectorAddress == 0) {
+    return;
+  }
   MmioWrite16 (FwCfgSelectorAddress, SwapBytes16((UINT16) (UINTN)QemuFwCfgItem));
+
+  Cache           = QemuFwCfgGetCache ();
+  Cache->Selector = (UINT16)(UINTN)QemuFwCfgItem;
+  Cache->Offset   = 0;
 }
 
 /**
@@ -93,12 +99,16 @@ MmioReadBytes (
   IN VOID  *Buffer OPTIONAL
   )
 {
+  QEMU_FW_CFG_CACHE *Cache;
   UINTN Left;
   UINT8 *Ptr;
   UINT8 *End;
   UINTN FwCfgDataAddress;
   Left = Size & 7;
 
+  Cache = QemuFwCfgGetCache ();
+  Cache->Offset += (UINT32)Size;
+
   Size -= Left;
   Ptr = Buffer;
   End = Ptr + Size;
@@ -133,11 +143,212 @@ MmioWriteBytes (
   IN VOID  *Buffer OPTIONAL
   )
 {
-  UINTN Idx;
+  QEMU_FW_CFG_CACHE *Cache;
+  UINTN Left;
+  UINT8 *Ptr;
+  UINT8 *End;
   UINTN FwCfgDataAddress;
+  Left = Size & 7;
+
+  Cache = QemuFwCfgGetCache ();
+  Cache->Offset += (UINT32)Size;
+
+  Size -= Left;
+  Ptr = Buffer;
+  End = Ptr + Size;
   FwCfgDataAddress = QemuGetFwCfgDataAddress ();
-  for (Idx = 0; Idx < Size; ++Idx) {
-    MmioWrite8 (FwCfgDataAddress, ((UINT8 *)Buffer)[Idx]);
+  while (Ptr < End) {
+    MmioWrite64 (FwCfgDataAddress, *(UINT64 *)Ptr);
+    Ptr += 8;
+  }
+  if (Left & 4) {
+    MmioWrite32 (FwCfgDataAddress, *(UINT32 *)Ptr);
+    Ptr += 4;
+  }
+  if (Left & 2) {
+    MmioWrite16 (FwCfgDataAddress, *(UINT16 *)Ptr);
+    Ptr += 2;
+  }
+  if (Left & 1) {
+    MmioWrite8 (FwCfgDataAddress, *Ptr);
+  }
+}
+
+/**
+  Slow SKIP_BYTES_FUNCTION.
+
+  @param[in]  Size  Number of bytes to skip.
+**/
+STATIC
+VOID
+MmioSkipBytes (
+  IN UINTN Size
+  )
+{
+  UINTN ChunkSize;
+  UINT8 SkipBuffer[256];
+
+  //
+  // Emulate the skip by reading data in chunks, and throwing it away. The
+  // implementation below is suitable even for phases where RAM or dynamic
+  // allocation is not available or appropriate. It also doesn't affect the
+  // static data footprint for client modules. Large skips are not expected,
+  // therefore this fallback is not performance critical. The size of
+  // SkipBuffer is thought not to exert a large pressure on the stack in any
+  // phase.
+  //
+  while (Size > 0) {
+    ChunkSize = MIN (Size, sizeof SkipBuffer);
+    MmioReadBytes (ChunkSize, SkipBuffer);
+    Size -= ChunkSize;
+  }
+}
+
+/**
+  Returns a boolean indicating if the firmware configuration interface
+  is available or not.
+
+  The signature and revision are checked once, when the fw_cfg cache is
+  built, so this function does not change fw_cfg state.
+
+  @retval    TRUE   The interface is available
+  @retval    FALSE  The interface is not available
+**/
+BOOLEAN
+EFIAPI
+QemuFwCfgIsAvailable (
+  VOID
+  )
+{
+  return InternalQemuFwCfgIsAvailable ();
+}
+
+/**
+  Returns a boolean indicating if the firmware configuration interface is
+  available for library-internal purposes.
+
+  This function never changes fw_cfg state.
+
+  @retval    TRUE   The interface is available internally.
+  @retval    FALSE  The interface is not available internally.
+**/
+BOOLEAN
+InternalQemuFwCfgIsAvailable (
+  VOID
+  )
+{
+  return (BOOLEAN)(QemuFwCfgGetCache () != NULL);
+}
+
+/**
+  Returns a boolean indicating whether QEMU provides the DMA-like access method
+  for fw_cfg.
+
+  @retval    TRUE   The DMA-like access method is available.
+  @retval    FALSE  The DMA-like access method is unavailable.
+**/
+BOOLEAN
+InternalQemuFwCfgDmaIsAvailable (
+  VOID
+  )
+{
+  QEMU_FW_CFG_CACHE *Cache;
+
+  Cache = QemuFwCfgGetCache ();
+  return (BOOLEAN)((Cache != NULL) && Cache->DmaAvailable);
+}
+
+/**
+  Transfer an array of bytes, or skip a number of bytes, using the DMA
+  interface.
+
+  @param[in]     Size     Size in bytes to transfer or skip.
+
+  @param[in, out] Buffer   Buffer to read data into or write data from. Ignored,
+                          and may be NULL, if Size is zero, or Control is
+                          FW_CFG_DMA_CTL_SKIP.
+
+  @param[in]     Control  One of the following:
+                          FW_CFG_DMA_CTL_WRITE - write to fw_cfg from Buffer.
+                          FW_CFG_DMA_CTL_READ  - read from fw_cfg into Buffer.
+                          FW_CFG_DMA_CTL_SKIP  - skip bytes in fw_cfg.
+**/
+VOID
+InternalQemuFwCfgDmaBytes (
+  IN     UINT32   Size,
+  IN OUT VOID     *Buffer OPTIONAL,
+  IN     UINT32   Control
+  )
+{
+  volatile FW_CFG_DMA_ACCESS Access;
+  QEMU_FW_CFG_CACHE          *Cache;
+  UINT32                     Status;
+  UINT32                     Offset;
+
+  ASSERT ((Control == FW_CFG_DMA_CTL_WRITE)
+    || (Control == FW_CFG_DMA_CTL_READ)
+    || (Control == FW_CFG_DMA_CTL_SKIP));
+
+  if (Size == 0) {
+    return;
+  }
+
+  Cache = QemuFwCfgGetCache ();
+  ASSERT ((Cache != NULL) && Cache->DmaAvailable);
+
+  Access.Control = SwapBytes32 (Control);
+  Access.Length  = SwapBytes32 (Size);
+  Access.Address = SwapBytes64 ((UINTN)Buffer);
+
+  //
+  // Make sure the access descriptor, and the buffer for a write, are in
+  // memory before the device is told to fetch them. Writing the big-endian
+  // descriptor address to the DMA register starts the transfer.
+  //
+  MemoryFence ();
+  MmioWrite64 ((UINTN)Cache->DmaAddress, SwapBytes64 ((UINTN)&Access));
+  MemoryFence ();
+
+  //
+  // The device clears Control when the transfer is complete, or leaves only
+  // the error bit set.
+  //
+  do {
+    Status = SwapBytes32 (Access.Control);
+  } while ((Status & ~(UINT32)FW_CFG_DMA_CTL_ERROR) != 0);
+
+  //
+  // Make sure the data the device wrote is visible before it is consumed.
+  //
+  MemoryFence ();
+
+  if ((Status & FW_CFG_DMA_CTL_ERROR) == 0) {
+    Cache->Offset += Size;
+    return;
+  }
+
+  DEBUG ((DEBUG_ERROR, "%a: DMA transfer failed, using MMIO from now on\n",
+    __func__));
+  Cache->DmaAvailable = FALSE;
+
+  //
+  // The item offset is unknown after a failed transfer. Select the item
+  // again, skip to where this transfer started and redo it over MMIO.
+  //
+  Offset = Cache->Offset;
+  QemuFwCfgSelectItem (Cache->Selector);
+  MmioSkipBytes (Offset);
+
+  switch (Control) {
+    case FW_CFG_DMA_CTL_WRITE:
+      MmioWriteBytes (Size, Buffer);
+      break;
+    case FW_CFG_DMA_CTL_READ:
+      MmioReadBytes (Size, Buffer);
+      break;
+    default:
+      MmioSkipBytes (Size);
+      break;
   }
 }
 
@@ -230,9 +441,6 @@ QemuFwCfgSkipBytes (
   IN UINTN                  Size
   )
 {
-  UINTN ChunkSize;
-  UINT8 SkipBuffer[256];
-
   if (!InternalQemuFwCfgIsAvailable ()) {
     return;
   }
@@ -244,20 +452,7 @@ QemuFwCfgSkipBytes (
     return;
   }
 
-  //
-  // Emulate the skip by reading data in chunks, and throwing it away. The
-  // implementation below is suitable even for phases where RAM or dynamic
-  // allocation is not available or appropriate. It also doesn't affect the
-  // static data footprint for client modules. Large skips are not expected,
-  // therefore this fallback is not performance critical. The size of
-  // SkipBuffer is thought not to exert a large pressure on the stack in any
-  // phase.
-  //
-  while (Size > 0) {
-    ChunkSize = MIN (Size, sizeof SkipBuffer);
-    MmioReadBytes (ChunkSize, SkipBuffer);
-    Size -= ChunkSize;
-  }
+  MmioSkipBytes (Size);
 }
 
 /**
@@ -332,6 +527,32 @@ QemuFwCfgRead64 (
   return Result;
 }
 
+/**
+  Returns the hash bucket of a fw_cfg file name.
+
+  @param[in]  Name  File name to hash.
+
+  @return    Index into QEMU_FW_CFG_CACHE.Buckets.
+**/
+UINTN
+QemuFwCfgHashName (
+  IN CONST CHAR8  *Name
+  )
+{
+  UINT32 Hash;
+
+  //
+  // FNV-1a
+  //
+  Hash = 0x811C9DC5;
+  while (*Name != '\0') {
+    Hash ^= (UINT8)*Name++;
+    Hash *= 0x01000193;
+  }
+
+  return Hash % QEMU_FW_CFG_CACHE_BUCKETS;
+}
+
 /**
   Find the configuration item corresponding to the firmware configuration file.
 
@@ -352,13 +573,35 @@ QemuFwCfgFindFile (
   OUT  UINTN                 *Size
   )
 {
-  UINT32 Count;
-  UINT32 Idx;
+  QEMU_FW_CFG_CACHE        *Cache;
+  QEMU_FW_CFG_CACHED_FILE  *Files;
+  UINT32                   Count;
+  UINT32                   Idx;
 
-  if (!InternalQemuFwCfgIsAvailable ()) {
+  Cache = QemuFwCfgGetCache ();
+  if (Cache == NULL) {
     return RETURN_UNSUPPORTED;
   }
 
+  if (Cache->DirectoryCached) {
+    Files = (QEMU_FW_CFG_CACHED_FILE *)(Cache + 1);
+    for (Idx = Cache->Buckets[QemuFwCfgHashName (Name)];
+         Idx != QEMU_FW_CFG_CACHE_END;
+         Idx = Files[Idx].Next)
+    {
+      if (AsciiStrnCmp (Name, Files[Idx].Name, QEMU_FW_CFG_FNAME_SIZE) == 0) {
+        *Item = Files[Idx].Select;
+        *Size = Files[Idx].Size;
+        return RETURN_SUCCESS;
+      }
+    }
+
+    return RETURN_NOT_FOUND;
+  }
+
+  //
+  // The directory was too large to cache; scan it on the device.
+  //
   QemuFwCfgSelectItem (QemuFwCfgItemFileDir);
   Count = SwapBytes32 (QemuFwCfgRead32 ());
 
@@ -381,83 +624,3 @@ QemuFwCfgFindFile (
 
   return RETURN_NOT_FOUND;
 }
-
-/**
-  firmware config initialize.
-
-  @param  VOID
-
-  @return    RETURN_SUCCESS  Initialization succeeded.
-**/
-RETURN_STATUS
-EFIAPI
-QemuFwCfgInitialize (
-  VOID
-  )
-{
-  VOID              *DeviceTreeBase;
-  INT32             Node;
-  INT32             Prev;
-  CONST CHAR8       *Type;
-  INT32             Len;
-  CONST UINT64      *RegProp;
-  UINT64            FwCfgSelectorAddress;
-  UINT64            FwCfgDataAddress;
-  UINT64            FwCfgDataSize;
-  RETURN_STATUS     PcdStatus;
-
-  DeviceTreeBase = (VOID *) (UINTN)PcdGet64 (PcdDeviceTreeBase);
-  ASSERT (DeviceTreeBase != NULL);
-  //
-  // Make sure we have a valid device tree blob
-  //
-  ASSERT (fdt_check_header (DeviceTreeBase) == 0);
-
-  for (Prev = 0;; Prev = Node) {
-    Node = fdt_next_node (DeviceTreeBase, Prev, NULL);
-    if (Node < 0) {
-      break;
-    }
-
-    //
-    // Check for memory node
-    //
-    Type = fdt_getprop (DeviceTreeBase, Node, "compatible", &Len);
-    if ((Type)
-      && (AsciiStrnCmp (Type, "qemu,fw-cfg-mmio", Len) == 0))
-    {
-      //
-      // Get the 'reg' property of this node. For now, we will assume
-      // two 8 byte quantities for base and size, respectively.
-      //
-      RegProp = fdt_getprop (DeviceTreeBase, Node, "reg", &Len);
-      if ((RegProp != 0)
-        && (Len == (2 * sizeof (UINT64))))
-      {
-        FwCfgDataAddress      = SwapBytes64 (RegProp[0]);
-        FwCfgDataSize         = 8;
-        FwCfgSelectorAddress  = FwCfgDataAddress + FwCfgDataSize;
-
-        mFwCfgSelectorAddress = FwCfgSelectorAddress;
-        mFwCfgDataAddress = FwCfgDataAddress;
-
-        PcdStatus = PcdSet64S (
-          PcdFwCfgSelectorAddress,
-          FwCfgSelectorAddress
-          );
-        ASSERT_RETURN_ERROR (PcdStatus);
-        PcdStatus = PcdSet64S (
-          PcdFwCfgDataAddress,
-          FwCfgDataAddress
-          );
-        ASSERT_RETURN_ERROR (PcdStatus);
-        break;
-      } else {
-        DEBUG ((DEBUG_ERROR, "%a: Failed to parse FDT QemuCfg node\n",
-          __func__));
-        break;
-      }
-    }
-  }
-  return RETURN_SUCCESS;
-}
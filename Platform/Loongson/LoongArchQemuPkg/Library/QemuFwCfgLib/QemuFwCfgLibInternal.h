@@ -12,6 +12,77 @@
 #ifndef QEMU_FW_CFG_LIB_INTERNAL_H_
 #define QEMU_FW_CFG_LIB_INTERNAL_H_
 
+#include <Library/QemuFwCfgLib.h>
+
+//
+// Register offsets from the base of the "qemu,fw-cfg-mmio" node. The DMA
+// register is only present when the node's 'reg' size covers it.
+//
+#define QEMU_FW_CFG_MMIO_DATA_OFFSET      0x00
+#define QEMU_FW_CFG_MMIO_SELECTOR_OFFSET  0x08
+#define QEMU_FW_CFG_MMIO_DMA_OFFSET       0x10
+
+#define QEMU_FW_CFG_CACHE_BUCKETS         64
+#define QEMU_FW_CFG_CACHE_MAX_FILES       128
+#define QEMU_FW_CFG_CACHE_END             MAX_UINT16
+
+//
+// One fw_cfg file directory entry. The layout matches the entry the device
+// returns for QemuFwCfgItemFileDir, so the directory is read in one transfer;
+// Size and Select are converted to host endian afterwards and the reserved
+// field is reused as the hash chain link.
+//
+typedef struct {
+  UINT32    Size;
+  UINT16    Select;
+  UINT16    Next;
+  CHAR8     Name[QEMU_FW_CFG_FNAME_SIZE];
+} QEMU_FW_CFG_CACHED_FILE;
+
+//
+// State probed once per boot and kept in the gLoongArchQemuFwCfgCacheHobGuid
+// HOB. When DirectoryCached is set, the header is followed by FileCount
+// QEMU_FW_CFG_CACHED_FILE entries.
+//
+// Selector and Offset track the selected item and how many bytes were
+// transferred since it was selected, so that a failed DMA transfer can be
+// redone over MMIO.
+//
+typedef struct {
+  UINT64     SelectorAddress;
+  UINT64     DataAddress;
+  UINT64     DmaAddress;
+  BOOLEAN    DmaAvailable;
+  BOOLEAN    DirectoryCached;
+  UINT16     Selector;
+  UINT32     FileCount;
+  UINT32     Offset;
+  UINT16     Buckets[QEMU_FW_CFG_CACHE_BUCKETS];
+} QEMU_FW_CFG_CACHE;
+
+/**
+  Returns the fw_cfg cache of the current phase.
+
+  @retval    NULL     fw_cfg is not present, or the cache was never built.
+  @retval    Others   Pointer to the fw_cfg cache.
+**/
+QEMU_FW_CFG_CACHE *
+QemuFwCfgGetCache (
+  VOID
+  );
+
+/**
+  Returns the hash bucket of a fw_cfg file name.
+
+  @param[in]  Name  File name to hash.
+
+  @return    Index into QEMU_FW_CFG_CACHE.Buckets.
+**/
+UINTN
+QemuFwCfgHashName (
+  IN CONST CHAR8  *Name
+  );
+
 /**
   Returns a boolean indicating if the firmware configuration interface is
   available for library-internal purposes.
@@ -38,6 +109,19 @@ InternalQemuFwCfgDmaIsAvailable (
   VOID
   );
 
+/**
+  Reads firmware configuration bytes into a buffer
+
+  @param[in] Size - Size in bytes to read
+  @param[in] Buffer - Buffer to store data into  (OPTIONAL if Size is 0)
+**/
+VOID
+EFIAPI
+InternalQemuFwCfgReadBytes (
+  IN UINTN                  Size,
+  IN VOID                   *Buffer  OPTIONAL
+  );
+
 /**
   Transfer an array of bytes, or skip a number of bytes, using the DMA
   interface.
@@ -10,108 +10,215 @@
 **/
 
 #include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
+#include <Library/HobLib.h>
+#include <Library/IoLib.h>
+#include <Library/PcdLib.h>
 #include <Library/QemuFwCfgLib.h>
+#include <libfdt.h>
 
 #include "QemuFwCfgLibInternal.h"
 
 /**
-  Returns a boolean indicating if the firmware configuration interface
-  is available or not.
+  Returns the fw_cfg cache of the current phase.
 
-  This function may change fw_cfg state.
-
-  @retval    TRUE   The interface is available
-  @retval    FALSE  The interface is not available
+  @retval    NULL     fw_cfg is not present, or the cache was never built.
+  @retval    Others   Pointer to the fw_cfg cache.
 **/
-BOOLEAN
-EFIAPI
-QemuFwCfgIsAvailable (
+QEMU_FW_CFG_CACHE *
+QemuFwCfgGetCache (
   VOID
   )
 {
-  UINT32 Signature;
-  UINT32 Revision;
+  EFI_HOB_GUID_TYPE *GuidHob;
+
+  //
+  // PEIMs run in place from flash, so the cache can not live in a global.
+  //
+  GuidHob = GetFirstGuidHob (&gLoongArchQemuFwCfgCacheHobGuid);
+  if (GuidHob == NULL) {
+    return NULL;
+  }
+  return GET_GUID_HOB_DATA (GuidHob);
+}
 
-  QemuFwCfgSelectItem (QemuFwCfgItemSignature);
-  Signature = QemuFwCfgRead32 ();
+/**
+  Probe the fw_cfg device once and record the register addresses, whether
+  DMA is usable and the file directory in the fw_cfg cache HOB.
+
+  @param[in]  DataAddress  Base address of the fw_cfg MMIO registers.
+  @param[in]  RegSize      Size of the fw_cfg MMIO register window.
+**/
+STATIC
+VOID
+QemuFwCfgBuildCache (
+  IN UINT64  DataAddress,
+  IN UINT64  RegSize
+  )
+{
+  QEMU_FW_CFG_CACHE       *Cache;
+  QEMU_FW_CFG_CACHED_FILE *Files;
+  UINT64                  SelectorAddress;
+  UINT32                  Signature;
+  UINT32                  Features;
+  UINT32                  Count;
+  UINT32                  CachedCount;
+  UINT32                  Idx;
+  UINTN                   Bucket;
+
+  SelectorAddress = DataAddress + QEMU_FW_CFG_MMIO_SELECTOR_OFFSET;
+
+  MmioWrite16 (SelectorAddress, SwapBytes16 ((UINT16)QemuFwCfgItemSignature));
+  Signature = MmioRead32 (DataAddress);
   DEBUG ((DEBUG_INFO, "FW CFG Signature: 0x%x\n", Signature));
-  QemuFwCfgSelectItem (QemuFwCfgItemInterfaceVersion);
-  Revision = QemuFwCfgRead32 ();
-  DEBUG ((DEBUG_INFO, "FW CFG Revision: 0x%x\n", Revision));
+  MmioWrite16 (SelectorAddress, SwapBytes16 ((UINT16)QemuFwCfgItemInterfaceVersion));
+  Features = MmioRead32 (DataAddress);
+  DEBUG ((DEBUG_INFO, "FW CFG Revision: 0x%x\n", Features));
   if ((Signature != SIGNATURE_32 ('Q', 'E', 'M', 'U'))
-    || (Revision < 1))
+    || (Features < 1))
   {
     DEBUG ((DEBUG_INFO, "QemuFwCfg interface not supported.\n"));
-    return FALSE;
+    return;
   }
 
-  DEBUG ((DEBUG_INFO, "QemuFwCfg interface is supported.\n"));
-  return TRUE;
-}
+  MmioWrite16 (SelectorAddress, SwapBytes16 ((UINT16)QemuFwCfgItemFileDir));
+  Count = SwapBytes32 (MmioRead32 (DataAddress));
+  CachedCount = Count;
+  if (Count > QEMU_FW_CFG_CACHE_MAX_FILES) {
+    DEBUG ((DEBUG_INFO, "%a: %u fw_cfg files, not caching the directory\n",
+      __func__, Count));
+    CachedCount = 0;
+  }
 
-/**
-  Returns a boolean indicating if the firmware configuration interface is
-  available for library-internal purposes.
+  Cache = BuildGuidHob (
+            &gLoongArchQemuFwCfgCacheHobGuid,
+            sizeof (*Cache) + CachedCount * sizeof (QEMU_FW_CFG_CACHED_FILE)
+            );
+  if (Cache == NULL) {
+    DEBUG ((DEBUG_ERROR, "%a: Failed to build fw_cfg cache HOB\n", __func__));
+    return;
+  }
 
-  This function never changes fw_cfg state.
+  Cache->SelectorAddress = SelectorAddress;
+  Cache->DataAddress     = DataAddress + QEMU_FW_CFG_MMIO_DATA_OFFSET;
+  Cache->DmaAddress      = DataAddress + QEMU_FW_CFG_MMIO_DMA_OFFSET;
+  Cache->DmaAvailable    = (BOOLEAN)(((Features & FW_CFG_F_DMA) != 0)
+                             && (RegSize >= QEMU_FW_CFG_MMIO_DMA_OFFSET + sizeof (UINT64)));
+  Cache->DirectoryCached = FALSE;
+  Cache->Selector        = (UINT16)QemuFwCfgItemFileDir;
+  Cache->FileCount       = CachedCount;
+  Cache->Offset          = sizeof (Count);
+  SetMem16 (Cache->Buckets, sizeof (Cache->Buckets), QEMU_FW_CFG_CACHE_END);
+  DEBUG ((DEBUG_INFO, "QemuFwCfg interface is supported, DMA %a.\n",
+    Cache->DmaAvailable ? "enabled" : "disabled"));
+
+  if (Count != CachedCount) {
+    return;
+  }
 
-  @retval    TRUE   The interface is available internally.
-  @retval    FALSE  The interface is not available internally.
-**/
-BOOLEAN
-InternalQemuFwCfgIsAvailable (
-  VOID
-  )
-{
   //
-  // We always return TRUE, because the consumer of this library ought to have
-  // called QemuFwCfgIsAvailable before making other calls which would hit this
-  // path.
+  // The cache HOB is in place, so the directory itself is read in one
+  // transfer, over DMA when available.
   //
-  return TRUE;
-}
+  Files = (QEMU_FW_CFG_CACHED_FILE *)(Cache + 1);
+  InternalQemuFwCfgReadBytes (Count * sizeof (QEMU_FW_CFG_CACHED_FILE), Files);
 
-/**
-  Returns a boolean indicating whether QEMU provides the DMA-like access method
-  for fw_cfg.
+  for (Idx = 0; Idx < Count; ++Idx) {
+    Files[Idx].Size   = SwapBytes32 (Files[Idx].Size);
+    Files[Idx].Select = SwapBytes16 (Files[Idx].Select);
+    Files[Idx].Name[QEMU_FW_CFG_FNAME_SIZE - 1] = '\0';
 
-  @retval    TRUE   The DMA-like access method is available.
-  @retval    FALSE  The DMA-like access method is unavailable.
-**/
-BOOLEAN
-InternalQemuFwCfgDmaIsAvailable (
-  VOID
-  )
-{
-  return FALSE;
+    Bucket                 = QemuFwCfgHashName (Files[Idx].Name);
+    Files[Idx].Next        = Cache->Buckets[Bucket];
+    Cache->Buckets[Bucket] = (UINT16)Idx;
+  }
+
+  Cache->DirectoryCached = TRUE;
 }
 
 /**
-  Transfer an array of bytes, or skip a number of bytes, using the DMA
-  interface.
+  firmware config initialize.
 
-  @param[in]     Size     Size in bytes to transfer or skip.
+  @param  VOID
 
-  @param[in, out] Buffer   Buffer to read data into or write data from. Ignored,
-                          and may be NULL, if Size is zero, or Control is
-                          FW_CFG_DMA_CTL_SKIP.
-
-  @param[in]     Control  One of the following:
-                          FW_CFG_DMA_CTL_WRITE - write to fw_cfg from Buffer.
-                          FW_CFG_DMA_CTL_READ  - read from fw_cfg into Buffer.
-                          FW_CFG_DMA_CTL_SKIP  - skip bytes in fw_cfg.
+  @return    RETURN_SUCCESS  Initialization succeeded.
 **/
-VOID
-InternalQemuFwCfgDmaBytes (
-  IN     UINT32   Size,
-  IN OUT VOID     *Buffer OPTIONAL,
-  IN     UINT32   Control
+RETURN_STATUS
+EFIAPI
+QemuFwCfgInitialize (
+  VOID
   )
 {
+  VOID              *DeviceTreeBase;
+  INT32             Node;
+  INT32             Prev;
+  CONST CHAR8       *Type;
+  INT32             Len;
+  CONST UINT64      *RegProp;
+  UINT64            FwCfgSelectorAddress;
+  UINT64            FwCfgDataAddress;
+  UINT64            FwCfgRegSize;
+  RETURN_STATUS     PcdStatus;
+
   //
-  // We should never reach here
+  // An earlier module has already probed fw_cfg.
   //
-  ASSERT (FALSE);
-  CpuDeadLoop ();
+  if (QemuFwCfgGetCache () != NULL) {
+    return RETURN_SUCCESS;
+  }
+
+  DeviceTreeBase = (VOID *) (UINTN)PcdGet64 (PcdDeviceTreeBase);
+  ASSERT (DeviceTreeBase != NULL);
+  //
+  // Make sure we have a valid device tree blob
+  //
+  ASSERT (fdt_check_header (DeviceTreeBase) == 0);
+
+  for (Prev = 0;; Prev = Node) {
+    Node = fdt_next_node (DeviceTreeBase, Prev, NULL);
+    if (Node < 0) {
+      break;
+    }
+
+    //
+    // Check for memory node
+    //
+    Type = fdt_getprop (DeviceTreeBase, Node, "compatible", &Len);
+    if ((Type)
+      && (AsciiStrnCmp (Type, "qemu,fw-cfg-mmio", Len) == 0))
+    {
+      //
+      // Get the 'reg' property of this node. For now, we will assume
+      // two 8 byte quantities for base and size, respectively.
+      //
+      RegProp = fdt_getprop (DeviceTreeBase, Node, "reg", &Len);
+      if ((RegProp != 0)
+        && (Len == (2 * sizeof (UINT64))))
+      {
+        FwCfgDataAddress      = SwapBytes64 (RegProp[0]);
+        FwCfgRegSize          = SwapBytes64 (RegProp[1]);
+        FwCfgSelectorAddress  = FwCfgDataAddress + QEMU_FW_CFG_MMIO_SELECTOR_OFFSET;
+
+        PcdStatus = PcdSet64S (
+          PcdFwCfgSelectorAddress,
+          FwCfgSelectorAddress
+          );
+        ASSERT_RETURN_ERROR (PcdStatus);
+        PcdStatus = PcdSet64S (
+          PcdFwCfgDataAddress,
+          FwCfgDataAddress
+          );
+        ASSERT_RETURN_ERROR (PcdStatus);
+
+        QemuFwCfgBuildCache (FwCfgDataAddress, FwCfgRegSize);
+        break;
+      } else {
+        DEBUG ((DEBUG_ERROR, "%a: Failed to parse FDT QemuCfg node\n",
+          __func__));
+        break;
+      }
+    }
+  }
+  return RETURN_SUCCESS;
 }
@@ -29,6 +29,16 @@
 
 #define FW_CFG_QEMU_SIGNATURE SIGNATURE_32('Q', 'E', 'M', 'U')
 
+// Feature bits reported by the FW_CFG_ID selector
+#define FW_CFG_FEATURE_TRADITIONAL  BIT0
+#define FW_CFG_FEATURE_DMA          BIT1
+
+// DMA access control bits
+#define FW_CFG_DMA_CONTROL_ERROR   BIT0
+#define FW_CFG_DMA_CONTROL_READ    BIT1
+#define FW_CFG_DMA_CONTROL_SKIP    BIT2
+#define FW_CFG_DMA_CONTROL_SELECT  BIT3
+
 typedef struct {
   UINT32    Size;
   UINT16    Select;
@@ -36,6 +46,23 @@ typedef struct {
   CHAR8     Name[56];
 } QEMU_FW_CFG_FILE;
 
+// DMA access descriptor, all fields are big endian
+#pragma pack (1)
+typedef struct {
+  UINT32    Control;
+  UINT32    Length;
+  UINT64    Address;
+} QEMU_FW_CFG_DMA_ACCESS;
+#pragma pack ()
+
+// fw_cfg usage counters, TimeNs is only collected when PcdFwCfgProfileEnable is set
+typedef struct {
+  UINT64    DmaBytes;
+  UINT64    PioBytes;
+  UINT64    Lookups;
+  UINT64    TimeNs;
+} QEMU_FW_CFG_STATISTICS;
+
 /**
   Checks for Qemu fw_cfg device by reading "QEMU" using the signature selector
 
@@ -102,4 +129,18 @@ QemuFwCfgFindFile (
   OUT QEMU_FW_CFG_FILE   *FWConfigFile
   );
 
+/**
+  Returns the fw_cfg usage counters collected since the directory cache was built
+
+  @param[out] Statistics Buffer for the counters
+
+  @return EFI_SUCCESS Statistics is populated
+  @return EFI_NOT_FOUND The directory cache does not exist
+ */
+EFI_STATUS
+EFIAPI
+QemuFwCfgGetStatistics (
+  OUT QEMU_FW_CFG_STATISTICS  *Statistics
+  );
+
 #endif // QEMU_OPEN_BOARD_PKG_QEMU_FW_CFG_LIB_H_
@@ -6,13 +6,298 @@
   QEMU FW CFG device allow the OS to retrieve files passed by QEMU or the user.
   Files can vary from E820 entries to ACPI tables.
 
+  Reads go through the DMA interface when the device advertises it, every byte
+  read through the data port is a VM exit. File lookups are served from a
+  directory cache kept in a HOB.
+
   Copyright (c) 2022 Theo Jehl All rights reserved.
   SPDX-License-Identifier: BSD-2-Clause-Patent
 **/
 
-#include <Library/QemuOpenFwCfgLib.h>
+#include "QemuOpenFwCfgLibInternal.h"
+#include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
+#include <Library/HobLib.h>
+#include <Library/PcdLib.h>
+#include <Library/TimerLib.h>
+
+/**
+  Starts measuring a fw_cfg operation
+
+  @retval Performance counter value, 0 when profiling is disabled
+**/
+STATIC
+UINT64
+ProfileBegin (
+  VOID
+  )
+{
+  if (!FeaturePcdGet (PcdFwCfgProfileEnable)) {
+    return 0;
+  }
+
+  return GetPerformanceCounter ();
+}
+
+/**
+  Adds the time elapsed since ProfileBegin to the cache statistics
+
+  @param[in] Cache Directory cache, may be NULL
+  @param[in] Begin Value returned by ProfileBegin
+**/
+STATIC
+VOID
+ProfileEnd (
+  IN QEMU_FW_CFG_CACHE  *Cache,
+  IN UINT64             Begin
+  )
+{
+  UINT64  Current;
+  UINT64  Start;
+  UINT64  End;
+  UINT64  Ticks;
+
+  if (!FeaturePcdGet (PcdFwCfgProfileEnable) || (Cache == NULL)) {
+    return;
+  }
+
+  Current = GetPerformanceCounter ();
+  GetPerformanceCounterProperties (&Start, &End);
+
+  //
+  // The ACPI PM timer is only 24 bits wide, account for a single wrap
+  //
+  if (End > Start) {
+    Ticks = (Current >= Begin) ? Current - Begin : (End - Begin) + (Current - Start) + 1;
+  } else {
+    Ticks = (Begin >= Current) ? Begin - Current : (Begin - End) + (Start - Current) + 1;
+  }
+
+  Cache->Statistics.TimeNs += GetTimeInNanoSecond (Ticks);
+}
+
+/**
+  Reads from the selected item through the DMA interface
+
+  @param[in]  Size   Number of bytes to read
+  @param[out] Buffer Destination buffer
+
+  @retval EFI_SUCCESS The data was read
+  @retval EFI_DEVICE_ERROR The device reported an error
+**/
+STATIC
+EFI_STATUS
+DmaRead (
+  IN  UINTN  Size,
+  OUT VOID   *Buffer
+  )
+{
+  volatile QEMU_FW_CFG_DMA_ACCESS  Access;
+  UINT64                           AccessAddress;
+  UINT32                           Chunk;
+  UINT32                           Control;
+
+  while (Size > 0) {
+    Chunk = (UINT32)MIN (Size, MAX_UINT32);
+
+    Access.Control = SwapBytes32 (FW_CFG_DMA_CONTROL_READ);
+    Access.Length  = SwapBytes32 (Chunk);
+    Access.Address = SwapBytes64 ((UINTN)Buffer);
+
+    //
+    // Writing the low half of the descriptor address starts the transfer
+    //
+    AccessAddress = (UINTN)&Access;
+    MemoryFence ();
+    IoWrite32 (FW_CFG_PORT_DMA, SwapBytes32 ((UINT32)RShiftU64 (AccessAddress, 32)));
+    IoWrite32 (FW_CFG_PORT_DMA + 4, SwapBytes32 ((UINT32)AccessAddress));
+
+    do {
+      MemoryFence ();
+      Control = SwapBytes32 (Access.Control);
+    } while ((Control & ~FW_CFG_DMA_CONTROL_ERROR) != 0);
+
+    if ((Control & FW_CFG_DMA_CONTROL_ERROR) != 0) {
+      return EFI_DEVICE_ERROR;
+    }
+
+    Size  -= Chunk;
+    Buffer = (UINT8 *)Buffer + Chunk;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Reads from the selected item, using DMA when the device supports it
+
+  @param[in]  Cache  Directory cache, may be NULL
+  @param[in]  Size   Number of bytes to read
+  @param[out] Buffer Destination buffer
+**/
+STATIC
+VOID
+ReadBytes (
+  IN  QEMU_FW_CFG_CACHE  *Cache,
+  IN  UINTN              Size,
+  OUT VOID               *Buffer
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      Skipped;
+
+  if ((Cache != NULL) && ((Cache->Features & FW_CFG_FEATURE_DMA) != 0)) {
+    Status = DmaRead (Size, Buffer);
+    if (!EFI_ERROR (Status)) {
+      Cache->Statistics.DmaBytes += Size;
+      Cache->Offset              += (UINT32)Size;
+      return;
+    }
+
+    //
+    // The item offset is unknown after a failed transfer. Stop using DMA,
+    // select the item again and skip to where this read started.
+    //
+    DEBUG ((DEBUG_ERROR, "%a: fw_cfg DMA read failed, retrying through PIO\n", __func__));
+    Cache->Features &= ~FW_CFG_FEATURE_DMA;
+
+    IoWrite16 (FW_CFG_PORT_SEL, Cache->Selector);
+    for (Skipped = 0; Skipped < Cache->Offset; Skipped++) {
+      IoRead8 (FW_CFG_PORT_DATA);
+    }
+
+    Cache->Statistics.PioBytes += Skipped;
+  }
+
+  IoReadFifo8 (FW_CFG_PORT_DATA, Size, Buffer);
+  if (Cache != NULL) {
+    Cache->Statistics.PioBytes += Size;
+    Cache->Offset              += (UINT32)Size;
+  }
+}
+
+/**
+  Hashes a fw_cfg file name
+
+  @param[in] Name File name, at most 56 characters long
+
+  @retval Bucket index in the directory cache
+**/
+STATIC
+UINTN
+HashName (
+  IN CONST CHAR8  *Name
+  )
+{
+  UINT32  Hash;
+  UINTN   Idx;
+
+  //
+  // FNV-1a
+  //
+  Hash = 0x811C9DC5;
+  for (Idx = 0; Idx < sizeof (((QEMU_FW_CFG_FILE *)0)->Name) && Name[Idx] != '\0'; Idx++) {
+    Hash ^= (UINT8)Name[Idx];
+    Hash *= 0x01000193;
+  }
+
+  return Hash % QEMU_FW_CFG_CACHE_BUCKETS;
+}
+
+/**
+  Reads the fw_cfg signature, features and file directory and stores them in
+  a new directory cache HOB
+
+  @retval NULL The fw_cfg device is absent or the HOB could not be built
+  @retval Others Pointer to the new directory cache
+**/
+QEMU_FW_CFG_CACHE *
+QemuFwCfgBuildCache (
+  VOID
+  )
+{
+  QEMU_FW_CFG_CACHE  *Cache;
+  QEMU_FW_CFG_FILE   *Files;
+  UINT16             *Next;
+  UINT32             Signature;
+  UINT32             Features;
+  UINT32             FilesCount;
+  UINTN              CacheSize;
+  BOOLEAN            DirectoryCached;
+  UINTN              Bucket;
+  UINT32             Idx;
+  UINT64             Begin;
+
+  Begin = ProfileBegin ();
+
+  IoWrite16 (FW_CFG_PORT_SEL, FW_CFG_SIGNATURE);
+  IoReadFifo8 (FW_CFG_PORT_DATA, sizeof (Signature), &Signature);
+  if (Signature != FW_CFG_QEMU_SIGNATURE) {
+    return NULL;
+  }
+
+  IoWrite16 (FW_CFG_PORT_SEL, FW_CFG_ID);
+  IoReadFifo8 (FW_CFG_PORT_DATA, sizeof (Features), &Features);
+
+  IoWrite16 (FW_CFG_PORT_SEL, FW_CFG_FILE_DIR);
+  IoReadFifo8 (FW_CFG_PORT_DATA, sizeof (FilesCount), &FilesCount);
+  FilesCount = SwapBytes32 (FilesCount);
+
+  //
+  // A directory too large for a single HOB is looked up through the data port
+  //
+  DirectoryCached = TRUE;
+  CacheSize       = sizeof (QEMU_FW_CFG_CACHE) + (UINTN)FilesCount * (sizeof (QEMU_FW_CFG_FILE) + sizeof (UINT16));
+  if ((FilesCount >= QEMU_FW_CFG_CACHE_END) ||
+      (CacheSize > (0xFFF8 - sizeof (EFI_HOB_GUID_TYPE))))
+  {
+    DEBUG ((DEBUG_WARN, "%a: %u fw_cfg files do not fit in the directory cache\n", __func__, FilesCount));
+    DirectoryCached = FALSE;
+    FilesCount      = 0;
+    CacheSize       = sizeof (QEMU_FW_CFG_CACHE);
+  }
+
+  Cache = BuildGuidHob (&gQemuOpenFwCfgCacheHobGuid, CacheSize);
+  if (Cache == NULL) {
+    return NULL;
+  }
+
+  ZeroMem (Cache, sizeof (QEMU_FW_CFG_CACHE));
+  SetMem16 (Cache->Buckets, sizeof (Cache->Buckets), QEMU_FW_CFG_CACHE_END);
+  Cache->Features            = Features;
+  Cache->FileCount           = FilesCount;
+  Cache->DirectoryCached     = DirectoryCached;
+  Cache->Selector            = FW_CFG_FILE_DIR;
+  Cache->Offset              = sizeof (FilesCount);
+  Cache->Statistics.PioBytes = sizeof (Signature) + sizeof (Features) + sizeof (FilesCount);
+
+  if (DirectoryCached) {
+    Files = (QEMU_FW_CFG_FILE *)(Cache + 1);
+    Next  = (UINT16 *)(Files + FilesCount);
+
+    ReadBytes (Cache, FilesCount * sizeof (QEMU_FW_CFG_FILE), Files);
+
+    for (Idx = 0; Idx < FilesCount; Idx++) {
+      Files[Idx].Size   = SwapBytes32 (Files[Idx].Size);
+      Files[Idx].Select = SwapBytes16 (Files[Idx].Select);
+
+      Bucket                 = HashName (Files[Idx].Name);
+      Next[Idx]              = Cache->Buckets[Bucket];
+      Cache->Buckets[Bucket] = (UINT16)Idx;
+    }
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "QEMU fw_cfg: %u files cached, DMA %a\n",
+    Cache->FileCount,
+    ((Features & FW_CFG_FEATURE_DMA) != 0) ? "supported" : "not supported"
+    ));
+
+  ProfileEnd (Cache, Begin);
+  return Cache;
+}
 
 /**
   Reads 8 bits from the data register.
@@ -25,6 +310,14 @@ QemuFwCfgRead8 (
   VOID
   )
 {
+  QEMU_FW_CFG_CACHE  *Cache;
+
+  Cache = QemuFwCfgGetCache (FALSE);
+  if (Cache != NULL) {
+    Cache->Statistics.PioBytes++;
+    Cache->Offset++;
+  }
+
   return IoRead8 (FW_CFG_PORT_DATA);
 }
 
@@ -42,9 +335,19 @@ QemuFwCfgSelectItem (
   IN UINT16  Selector
   )
 {
-  UINT16  WritenSelector;
+  QEMU_FW_CFG_CACHE  *Cache;
+  UINT16             WritenSelector;
+
+  //
+  // Building the cache changes the selected item, do it before selecting
+  //
+  Cache = QemuFwCfgGetCache (TRUE);
 
   WritenSelector = IoWrite16 (FW_CFG_PORT_SEL, Selector);
+  if (Cache != NULL) {
+    Cache->Selector = Selector;
+    Cache->Offset   = 0;
+  }
 
   if (WritenSelector != Selector) {
     return EFI_UNSUPPORTED;
@@ -66,7 +369,13 @@ QemuFwCfgReadBytes (
   OUT VOID  *Buffer
   )
 {
-  IoReadFifo8 (FW_CFG_PORT_DATA, Size, Buffer);
+  QEMU_FW_CFG_CACHE  *Cache;
+  UINT64             Begin;
+
+  Begin = ProfileBegin ();
+  Cache = QemuFwCfgGetCache (FALSE);
+  ReadBytes (Cache, Size, Buffer);
+  ProfileEnd (Cache, Begin);
 }
 
 /**
@@ -83,6 +392,10 @@ QemuFwCfgIsPresent (
   EFI_STATUS  Status;
   UINT32      Control;
 
+  if (QemuFwCfgGetCache (TRUE) != NULL) {
+    return EFI_SUCCESS;
+  }
+
   Status = QemuFwCfgSelectItem (FW_CFG_SIGNATURE);
   if (EFI_ERROR (Status)) {
     return Status;
@@ -113,9 +426,35 @@ QemuFwCfgFindFile (
   OUT QEMU_FW_CFG_FILE  *FWConfigFile
   )
 {
-  QEMU_FW_CFG_FILE  FirmwareConfigFile;
-  UINT32            FilesCount;
-  UINT32            Idx;
+  QEMU_FW_CFG_CACHE  *Cache;
+  QEMU_FW_CFG_FILE   *Files;
+  UINT16             *Next;
+  QEMU_FW_CFG_FILE   FirmwareConfigFile;
+  UINT32             FilesCount;
+  UINT32             Idx;
+  UINT64             Begin;
+  EFI_STATUS         Status;
+
+  Cache  = QemuFwCfgGetCache (TRUE);
+  Begin  = ProfileBegin ();
+  Status = EFI_UNSUPPORTED;
+
+  if ((Cache != NULL) && Cache->DirectoryCached) {
+    Cache->Statistics.Lookups++;
+
+    Files = (QEMU_FW_CFG_FILE *)(Cache + 1);
+    Next  = (UINT16 *)(Files + Cache->FileCount);
+    for (Idx = Cache->Buckets[HashName (String)]; Idx != QEMU_FW_CFG_CACHE_END; Idx = Next[Idx]) {
+      if (AsciiStrCmp (Files[Idx].Name, String) == 0) {
+        CopyMem (FWConfigFile, &Files[Idx], sizeof (QEMU_FW_CFG_FILE));
+        Status = EFI_SUCCESS;
+        break;
+      }
+    }
+
+    ProfileEnd (Cache, Begin);
+    return Status;
+  }
 
   QemuFwCfgSelectItem (FW_CFG_FILE_DIR);
   QemuFwCfgReadBytes (sizeof (UINT32), &FilesCount);
@@ -128,9 +467,40 @@ QemuFwCfgFindFile (
       FirmwareConfigFile.Select = SwapBytes16 (FirmwareConfigFile.Select);
       FirmwareConfigFile.Size   = SwapBytes32 (FirmwareConfigFile.Size);
       CopyMem (FWConfigFile, &FirmwareConfigFile, sizeof (QEMU_FW_CFG_FILE));
-      return EFI_SUCCESS;
+      Status = EFI_SUCCESS;
+      break;
     }
   }
 
-  return EFI_UNSUPPORTED;
+  if (Cache != NULL) {
+    Cache->Statistics.Lookups++;
+  }
+
+  ProfileEnd (Cache, Begin);
+  return Status;
+}
+
+/**
+  Returns the fw_cfg usage counters collected since the directory cache was built
+
+  @param[out] Statistics Buffer for the counters
+
+  @retval EFI_SUCCESS Statistics is populated
+  @retval EFI_NOT_FOUND The directory cache does not exist
+**/
+EFI_STATUS
+EFIAPI
+QemuFwCfgGetStatistics (
+  OUT QEMU_FW_CFG_STATISTICS  *Statistics
+  )
+{
+  QEMU_FW_CFG_CACHE  *Cache;
+
+  Cache = QemuFwCfgGetCache (FALSE);
+  if (Cache == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
+  CopyMem (Statistics, &Cache->Statistics, sizeof (QEMU_FW_CFG_STATISTICS));
+  return EFI_SUCCESS;
 }
@@ -0,0 +1,34 @@
+/** @file QemuOpenFwCfgLibDxe.c
+  QemuOpenFwCfgLib DXE directory cache
+
+  DXE only consumes the cache built during PEI, HOBs cannot be created here.
+
+  Copyright (c) 2022 Theo Jehl All rights reserved.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include "QemuOpenFwCfgLibInternal.h"
+#include <Library/HobLib.h>
+
+/**
+  Returns the directory cache built during PEI
+
+  @param[in] Build Ignored, the cache cannot be built in DXE.
+
+  @retval NULL The cache does not exist
+  @retval Others Pointer to the directory cache
+**/
+QEMU_FW_CFG_CACHE *
+QemuFwCfgGetCache (
+  IN BOOLEAN  Build
+  )
+{
+  EFI_HOB_GUID_TYPE  *GuidHob;
+
+  GuidHob = GetFirstGuidHob (&gQemuOpenFwCfgCacheHobGuid);
+  if (GuidHob == NULL) {
+    return NULL;
+  }
+
+  return GET_GUID_HOB_DATA (GuidHob);
+}
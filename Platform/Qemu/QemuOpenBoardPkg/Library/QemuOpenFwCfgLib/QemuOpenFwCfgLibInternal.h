@@ -0,0 +1,68 @@
+/** @file QemuOpenFwCfgLibInternal.h
+  QemuOpenFwCfgLib internal definitions
+
+  The fw_cfg file directory is parsed once and kept, hashed by name, in a GUID
+  HOB so later lookups, including those made from DXE, do not have to walk the
+  directory through the data port again.
+
+  Copyright (c) 2022 Theo Jehl All rights reserved.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#ifndef QEMU_OPEN_FW_CFG_LIB_INTERNAL_H_
+#define QEMU_OPEN_FW_CFG_LIB_INTERNAL_H_
+
+#include <Library/QemuOpenFwCfgLib.h>
+
+#define QEMU_FW_CFG_CACHE_BUCKETS  64
+#define QEMU_FW_CFG_CACHE_END      MAX_UINT16
+
+//
+// Directory cache kept in the gQemuOpenFwCfgCacheHobGuid HOB. When
+// DirectoryCached is set, the header is followed by FileCount
+// QEMU_FW_CFG_FILE entries (host endian) and then by FileCount UINT16
+// hash chain links.
+//
+// Selector and Offset track the selected item and how many bytes were read
+// from it, so that a failed DMA transfer can be restarted through the data
+// port.
+//
+typedef struct {
+  UINT32                    Features;
+  UINT32                    FileCount;
+  BOOLEAN                   DirectoryCached;
+  UINT16                    Selector;
+  UINT32                    Offset;
+  QEMU_FW_CFG_STATISTICS    Statistics;
+  UINT16                    Buckets[QEMU_FW_CFG_CACHE_BUCKETS];
+} QEMU_FW_CFG_CACHE;
+
+extern EFI_GUID  gQemuOpenFwCfgCacheHobGuid;
+
+/**
+  Reads the fw_cfg signature, features and file directory and stores them in
+  a new directory cache HOB
+
+  @retval NULL The fw_cfg device is absent or the HOB could not be built
+  @retval Others Pointer to the new directory cache
+**/
+QEMU_FW_CFG_CACHE *
+QemuFwCfgBuildCache (
+  VOID
+  );
+
+/**
+  Returns the directory cache
+
+  @param[in] Build Build the cache if it does not exist yet and the phase allows it.
+                   Building the cache changes the selected item.
+
+  @retval NULL The cache does not exist
+  @retval Others Pointer to the directory cache
+**/
+QEMU_FW_CFG_CACHE *
+QemuFwCfgGetCache (
+  IN BOOLEAN  Build
+  );
+
+#endif // QEMU_OPEN_FW_CFG_LIB_INTERNAL_H_
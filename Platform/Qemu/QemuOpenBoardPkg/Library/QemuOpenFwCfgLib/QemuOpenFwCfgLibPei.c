@@ -0,0 +1,37 @@
+/** @file QemuOpenFwCfgLibPei.c
+  QemuOpenFwCfgLib PEI directory cache
+
+  Copyright (c) 2022 Theo Jehl All rights reserved.
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include "QemuOpenFwCfgLibInternal.h"
+#include <Library/HobLib.h>
+
+/**
+  Returns the directory cache, building it on first use
+
+  @param[in] Build Build the cache if it does not exist yet.
+                   Building the cache changes the selected item.
+
+  @retval NULL The cache does not exist
+  @retval Others Pointer to the directory cache
+**/
+QEMU_FW_CFG_CACHE *
+QemuFwCfgGetCache (
+  IN BOOLEAN  Build
+  )
+{
+  EFI_HOB_GUID_TYPE  *GuidHob;
+
+  GuidHob = GetFirstGuidHob (&gQemuOpenFwCfgCacheHobGuid);
+  if (GuidHob != NULL) {
+    return GET_GUID_HOB_DATA (GuidHob);
+  }
+
+  if (!Build) {
+    return NULL;
+  }
+
+  return QemuFwCfgBuildCache ();
+}
@@ -15,8 +15,38 @@
 #include <IndustryStandard/Pci.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/PcdLib.h>
+#include <Library/QemuOpenFwCfgLib.h>
 #include <IndustryStandard/Q35MchIch9.h>
 
+/**
+  Reports how much data was read from fw_cfg during PEI and how long it took
+**/
+STATIC
+VOID
+ReportFwCfgStatistics (
+  VOID
+  )
+{
+  QEMU_FW_CFG_STATISTICS  Statistics;
+
+  if (EFI_ERROR (QemuFwCfgGetStatistics (&Statistics))) {
+    return;
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "QEMU fw_cfg: %lu bytes via DMA, %lu bytes via PIO, %lu lookups",
+    Statistics.DmaBytes,
+    Statistics.PioBytes,
+    Statistics.Lookups
+    ));
+  if (FeaturePcdGet (PcdFwCfgProfileEnable)) {
+    DEBUG ((DEBUG_INFO, ", %lu us", DivU64x32 (Statistics.TimeNs, 1000)));
+  }
+
+  DEBUG ((DEBUG_INFO, "\n"));
+}
+
 EFI_STATUS
 EFIAPI
 PlatformInit (
@@ -67,9 +97,13 @@ PlatformInit (
   //
   if (DeviceId == INTEL_Q35_MCH_DEVICE_ID) {
     DEBUG ((DEBUG_INFO, "Q35: Initialize PCIe\n"));
-    return InitializePcie ();
+    Status = InitializePcie ();
   } else {
     DEBUG ((DEBUG_INFO, "PIIX4: Initialize PCI\n"));
-    return InitializePciPIIX4 ();
+    Status = InitializePciPIIX4 ();
   }
+
+  ReportFwCfgStatistics ();
+
+  return Status;
 }
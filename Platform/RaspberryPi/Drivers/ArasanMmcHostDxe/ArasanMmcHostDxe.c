@@ -18,6 +18,15 @@ UINT32 LastExecutedCommand = (UINT32) -1;
 STATIC RASPBERRY_PI_FIRMWARE_PROTOCOL *mFwProtocol;
 STATIC UINTN mMmcHsBase;
 
+STATIC MMC_DMA_MODE mDmaMode = DmaModeNone;
+STATIC UINT64 mDmaBusOffset;
+STATIC ADMA2_DESCRIPTOR *mAdma2Table;
+STATIC EFI_PHYSICAL_ADDRESS mAdma2TableBusAddress;
+
+// Block command waiting for its data buffer
+STATIC UINT32 mPendingCmd;
+STATIC UINT32 mPendingArg;
+
 STATIC
 UINT32
 EFIAPI
@@ -325,11 +334,16 @@ MMCBuildDevicePath (
   return EFI_SUCCESS;
 }
 
+/**
+   Issues an already translated command. BlockCount is programmed alongside
+   the block size for data commands that use BCE_ENABLE.
+**/
+STATIC
 EFI_STATUS
-MMCSendCommand (
-  IN EFI_MMC_HOST_PROTOCOL    *This,
-  IN MMC_CMD                  MmcCmd,
-  IN UINT32                   Argument
+SendTranslatedCommand (
+  IN UINT32                   MmcCmd,
+  IN UINT32                   Argument,
+  IN UINT32                   BlockCount
   )
 {
   UINTN MmcStatus;
@@ -340,17 +354,6 @@ MMCSendCommand (
   BOOLEAN IsDATCmd = FALSE;
   BOOLEAN IsADTCCmd = FALSE;
 
-  DEBUG ((DEBUG_MMCHOST_SD, "ArasanMMCHost: MMCSendCommand(MmcCmd: %08x, Argument: %08x)\n", MmcCmd, Argument));
-
-  if (IgnoreCommand (MmcCmd)) {
-    return EFI_SUCCESS;
-  }
-
-  MmcCmd = TranslateCommand (MmcCmd, Argument);
-  if (MmcCmd == 0xffffffff) {
-    return EFI_UNSUPPORTED;
-  }
-
   if ((MmcCmd & CMD_R1_ADTC) == CMD_R1_ADTC) {
     IsADTCCmd = TRUE;
   }
@@ -388,7 +391,8 @@ MMCSendCommand (
   } else if (!IsAppCmd && MmcCmd == CMD6) {
     SdMmioWrite32 (MMCHS_BLK, 64);
   } else if (IsADTCCmd) {
-    SdMmioWrite32 (MMCHS_BLK, BLEN_512BYTES);
+    SdMmioWrite32 (MMCHS_BLK, BLEN_512BYTES | SDMA_BOUNDARY_512K |
+      (BlockCount << BLOCK_COUNT_SHIFT));
   }
 
   // Set Data timeout counter value to max value.
@@ -451,11 +455,133 @@ Exit:
   if (EFI_ERROR (Status)) {
     LastExecutedCommand = (UINT32) -1;
   } else {
-    LastExecutedCommand = MmcCmd;
+    LastExecutedCommand = MmcCmd & ~(DE_ENABLE | BCE_ENABLE);
   }
   return Status;
 }
 
+EFI_STATUS
+MMCSendCommand (
+  IN EFI_MMC_HOST_PROTOCOL    *This,
+  IN MMC_CMD                  MmcCmd,
+  IN UINT32                   Argument
+  )
+{
+  DEBUG ((DEBUG_MMCHOST_SD, "ArasanMMCHost: MMCSendCommand(MmcCmd: %08x, Argument: %08x)\n", MmcCmd, Argument));
+
+  if (IgnoreCommand (MmcCmd)) {
+    return EFI_SUCCESS;
+  }
+
+  MmcCmd = TranslateCommand (MmcCmd, Argument);
+  if (MmcCmd == 0xffffffff) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (mPendingCmd != 0) {
+    DEBUG ((DEBUG_ERROR, "%a(%u): dropping unused MMC_CMD%u\n",
+      __func__, __LINE__, MMC_CMD_NUM (mPendingCmd)));
+    mPendingCmd = 0;
+  }
+
+  //
+  // Block transfers are only issued once the data buffer is known, so
+  // that the DMA engine and block count can be set up beforehand.
+  //
+  if (LastExecutedCommand != CMD55 &&
+      (MmcCmd == CMD_READ_SINGLE_BLOCK ||
+       MmcCmd == CMD_READ_MULTIPLE_BLOCK ||
+       MmcCmd == CMD_WRITE_SINGLE_BLOCK ||
+       MmcCmd == CMD_WRITE_MULTIPLE_BLOCK)) {
+    mPendingCmd = MmcCmd;
+    mPendingArg = Argument;
+    return EFI_SUCCESS;
+  }
+
+  return SendTranslatedCommand (MmcCmd, Argument, 0);
+}
+
+/**
+   Picks the transfer mode for block commands from the controller capabilities.
+**/
+STATIC
+MMC_DMA_MODE
+SelectDmaMode (
+  VOID
+  )
+{
+  UINT32 Capa;
+
+  //
+  // The legacy Arasan controller reports no capabilities and has no
+  // usable bus master, only emmc2 on BCM2711 does its own DMA.
+  //
+  if (mMmcHsBase != MMCHS2_BASE) {
+    return DmaModeNone;
+  }
+
+  Capa = MmioRead32 (MMCHS_CAPA);
+  if ((Capa & ADMA2_SUPPORT) != 0 && mAdma2Table != NULL) {
+    return DmaModeAdma2;
+  }
+
+  if ((Capa & SDMA_SUPPORT) != 0) {
+    return DmaModeSdma;
+  }
+
+  return DmaModeNone;
+}
+
+STATIC
+VOID
+DmaInitialize (
+  VOID
+  )
+{
+  EFI_STATUS Status;
+  VOID *Table;
+  VOID *Mapping;
+  UINTN Pages;
+  UINTN TableSize;
+
+#if (RPI_MODEL == 4)
+  //
+  // On BCM2711 revisions older than C0, emmc2 can only reach the
+  // first 1GB of RAM, through the same alias the VPU uses.
+  //
+  if ((MmioRead32 (ID_CHIPREV) & 0xFF) < 0x20) {
+    mDmaBusOffset = BCM2836_DMA_DEVICE_OFFSET;
+  }
+#endif
+
+  TableSize = ADMA2_MAX_DESCRIPTORS * sizeof (ADMA2_DESCRIPTOR);
+  Pages = EFI_SIZE_TO_PAGES (TableSize);
+  Status = DmaAllocateBuffer (EfiBootServicesData, Pages, &Table);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: DmaAllocateBuffer: %r\n", __func__, Status));
+    return;
+  }
+
+  Status = DmaMap (MapOperationBusMasterCommonBuffer, Table, &TableSize,
+             &mAdma2TableBusAddress, &Mapping);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: DmaMap: %r\n", __func__, Status));
+    DmaFreeBuffer (Pages, Table);
+    return;
+  }
+
+  mAdma2TableBusAddress += mDmaBusOffset;
+  if (mAdma2TableBusAddress > MAX_UINT32) {
+    DEBUG ((DEBUG_ERROR, "%a: ADMA2 table at 0x%lx is out of reach\n", __func__,
+      mAdma2TableBusAddress));
+    DmaUnmap (Mapping);
+    DmaFreeBuffer (Pages, Table);
+    return;
+  }
+
+  mAdma2Table = Table;
+}
+
 EFI_STATUS
 MMCNotifyState (
   IN EFI_MMC_HOST_PROTOCOL    *This,
@@ -486,6 +612,10 @@ MMCNotifyState (
 
       DEBUG ((DEBUG_MMCHOST_SD, "ArasanMMCHost: CAP %X CAPH %X\n", MmioRead32(MMCHS_CAPA),MmioRead32(MMCHS_CUR_CAPA)));
 
+      mDmaMode = SelectDmaMode ();
+      DEBUG ((DEBUG_INFO, "ArasanMMCHost: using %a\n",
+        mDmaMode == DmaModeAdma2 ? "ADMA2" : mDmaMode == DmaModeSdma ? "SDMA" : "PIO"));
+
       // Lets switch to card detect test mode.
       SdMmioOr32 (MMCHS_HCTL, BIT7|BIT6);
 
@@ -678,10 +808,9 @@ MMCReceiveResponse (
   return EFI_SUCCESS;
 }
 
+STATIC
 EFI_STATUS
-MMCReadBlockData (
-  IN EFI_MMC_HOST_PROTOCOL    *This,
-  IN EFI_LBA                  Lba,
+ReadBlockDataPio (
   IN UINTN                    Length,
   IN UINT32*                  Buffer
   )
@@ -690,19 +819,6 @@ MMCReadBlockData (
   UINTN RemLength;
   UINTN Count;
 
-  DEBUG ((DEBUG_VERBOSE, "%a(%u): LBA: 0x%x, Length: 0x%x, Buffer: 0x%x)\n",
-    __func__, __LINE__, Lba, Length, Buffer));
-
-  if (Buffer == NULL) {
-    DEBUG ((DEBUG_ERROR, "%a(%u): NULL Buffer\n", __func__, __LINE__));
-    return EFI_INVALID_PARAMETER;
-  }
-
-  if (Length % sizeof (UINT32) != 0) {
-    DEBUG ((DEBUG_ERROR, "%a(%u): bad Length %u\n", __func__, __LINE__, Length));
-    return EFI_INVALID_PARAMETER;
-  }
-
   RemLength = Length;
   while (RemLength != 0) {
     UINTN RetryCount = 0;
@@ -715,12 +831,9 @@ MMCReadBlockData (
         /*
          * Data is ready.
          */
-        mFwProtocol->SetLed (TRUE);
         for (Count = 0; Count < BlockLen; Count += 4, Buffer++) {
           *Buffer = MmioRead32 (MMCHS_DATA);
         }
-
-        mFwProtocol->SetLed (FALSE);
         break;
       }
 
@@ -742,10 +855,9 @@ MMCReadBlockData (
   return EFI_SUCCESS;
 }
 
+STATIC
 EFI_STATUS
-MMCWriteBlockData (
-  IN EFI_MMC_HOST_PROTOCOL    *This,
-  IN EFI_LBA                  Lba,
+WriteBlockDataPio (
   IN UINTN                    Length,
   IN UINT32*                  Buffer
   )
@@ -754,19 +866,6 @@ MMCWriteBlockData (
   UINTN RemLength;
   UINTN Count;
 
-  DEBUG ((DEBUG_VERBOSE, "%a(%u): LBA: 0x%x, Length: 0x%x, Buffer: 0x%x)\n",
-    __func__, __LINE__, Lba, Length, Buffer));
-
-  if (Buffer == NULL) {
-    DEBUG ((DEBUG_ERROR, "%a(%u): NULL Buffer\n", __func__, __LINE__));
-    return EFI_INVALID_PARAMETER;
-  }
-
-  if (Length % sizeof (UINT32) != 0) {
-    DEBUG ((DEBUG_ERROR, "%a(%u): bad Length %u\n", __func__, __LINE__, Length));
-    return EFI_INVALID_PARAMETER;
-  }
-
   RemLength = Length;
   while (RemLength != 0) {
     UINTN RetryCount = 0;
@@ -779,12 +878,9 @@ MMCWriteBlockData (
         /*
          * Can write data.
          */
-        mFwProtocol->SetLed (TRUE);
         for (Count = 0; Count < BlockLen; Count += 4, Buffer++) {
           SdMmioWrite32 (MMCHS_DATA, *Buffer);
         }
-
-        mFwProtocol->SetLed (FALSE);
         break;
       }
 
@@ -806,6 +902,242 @@ MMCWriteBlockData (
   return EFI_SUCCESS;
 }
 
+/**
+   Describes a contiguous bus region with the ADMA2 descriptor table.
+**/
+STATIC
+VOID
+BuildAdma2Table (
+  IN EFI_PHYSICAL_ADDRESS     BusAddress,
+  IN UINTN                    Length
+  )
+{
+  UINTN Index;
+  UINTN Chunk;
+
+  for (Index = 0; Length != 0; Index++) {
+    ASSERT (Index < ADMA2_MAX_DESCRIPTORS);
+    Chunk = MIN (Length, ADMA2_MAX_LENGTH);
+    mAdma2Table[Index].Attributes = ADMA2_VALID | ADMA2_ACT_TRAN;
+    mAdma2Table[Index].Length = (UINT16)Chunk;
+    mAdma2Table[Index].Address = (UINT32)BusAddress;
+    BusAddress += Chunk;
+    Length -= Chunk;
+  }
+
+  mAdma2Table[Index - 1].Attributes |= ADMA2_END;
+  MemoryFence ();
+}
+
+/**
+   Issues a deferred block command and moves its data with SDMA or ADMA2,
+   waiting for transfer complete rather than polling every block.
+
+   @retval EFI_UNSUPPORTED  The buffer cannot be used for DMA. The command has
+                            not been issued and PIO should be used instead.
+**/
+STATIC
+EFI_STATUS
+DmaTransferBlocks (
+  IN UINT32                   MmcCmd,
+  IN UINT32                   Argument,
+  IN UINTN                    Length,
+  IN UINT32*                  Buffer,
+  IN BOOLEAN                  IsWrite
+  )
+{
+  EFI_STATUS Status;
+  EFI_PHYSICAL_ADDRESS BusAddress;
+  EFI_PHYSICAL_ADDRESS SdmaAddress;
+  VOID *Mapping;
+  UINTN MapLength;
+  UINTN MmcStatus;
+  UINTN RetryCount;
+  UINTN MaxRetryCount;
+  UINT32 BlockCount;
+
+  if (Length == 0 || (Length % BLEN_512BYTES) != 0 ||
+      Length / BLEN_512BYTES > MAX_BLOCK_COUNT ||
+      ((UINTN)Buffer & 0x3) != 0) {
+    return EFI_UNSUPPORTED;
+  }
+  BlockCount = (UINT32)(Length / BLEN_512BYTES);
+
+  MapLength = Length;
+  Status = DmaMap (IsWrite ? MapOperationBusMasterRead : MapOperationBusMasterWrite,
+             Buffer, &MapLength, &BusAddress, &Mapping);
+  if (EFI_ERROR (Status)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  //
+  // Both SDMA and 32-bit ADMA2 can only reach the first 4GB of the bus.
+  //
+  BusAddress += mDmaBusOffset;
+  if (MapLength < Length || BusAddress + Length > (UINT64)MAX_UINT32 + 1) {
+    DmaUnmap (Mapping);
+    return EFI_UNSUPPORTED;
+  }
+
+  if (mDmaMode == DmaModeAdma2) {
+    BuildAdma2Table (BusAddress, Length);
+    SdMmioAndThenOr32 (MMCHS_HCTL, (UINT32) ~DMAS_MASK, DMAS_ADMA2);
+    SdMmioWrite32 (MMCHS_ADMA_ADDR, (UINT32)mAdma2TableBusAddress);
+  } else {
+    SdMmioAndThenOr32 (MMCHS_HCTL, (UINT32) ~DMAS_MASK, DMAS_SDMA);
+    SdMmioWrite32 (MMCHS_SDMA, (UINT32)BusAddress);
+  }
+
+  mFwProtocol->SetLed (TRUE);
+
+  Status = SendTranslatedCommand (MmcCmd | DE_ENABLE | BCE_ENABLE, Argument, BlockCount);
+  if (EFI_ERROR (Status)) {
+    goto Exit;
+  }
+
+  SdmaAddress = BusAddress;
+  MaxRetryCount = MAX_RETRY_COUNT +
+                  BlockCount * (DMA_BLOCK_TIMEOUT_US / STALL_AFTER_RETRY_US);
+  RetryCount = 0;
+  while (RetryCount < MaxRetryCount) {
+    MmcStatus = MmioRead32 (MMCHS_INT_STAT);
+    if ((MmcStatus & ERRI) != 0) {
+      Status = EFI_DEVICE_ERROR;
+      break;
+    }
+
+    if ((MmcStatus & TC) != 0) {
+      break;
+    }
+
+    if ((MmcStatus & DMAI) != 0) {
+      //
+      // SDMA stops at every buffer boundary until it is given the next address.
+      //
+      SdMmioWrite32 (MMCHS_INT_STAT, DMAI);
+      SdmaAddress = (SdmaAddress & ~(UINT64)(SDMA_BOUNDARY_SIZE - 1)) + SDMA_BOUNDARY_SIZE;
+      SdMmioWrite32 (MMCHS_SDMA, (UINT32)SdmaAddress);
+      continue;
+    }
+
+    gBS->Stall (STALL_AFTER_RETRY_US);
+    RetryCount++;
+  }
+
+  if (RetryCount == MaxRetryCount) {
+    Status = EFI_TIMEOUT;
+  }
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a(%u): MMC_CMD%u %u blocks: %r MMCHS_INT_STAT: %08x ADMA_ERR: %08x\n",
+      __func__, __LINE__, MMC_CMD_NUM (MmcCmd), BlockCount, Status,
+      MmcStatus, MmioRead32 (MMCHS_ADMA_ERR)));
+    SoftReset (SRC | SRD);
+  }
+
+  SdMmioWrite32 (MMCHS_INT_STAT, TC | DMAI);
+
+Exit:
+  mFwProtocol->SetLed (FALSE);
+  DmaUnmap (Mapping);
+  return Status;
+}
+
+/**
+   Issues the deferred block command and transfers its data.
+**/
+STATIC
+EFI_STATUS
+TransferBlocks (
+  IN UINTN                    Length,
+  IN UINT32*                  Buffer,
+  IN BOOLEAN                  IsWrite
+  )
+{
+  EFI_STATUS Status;
+  UINT32 MmcCmd = mPendingCmd;
+
+  mPendingCmd = 0;
+
+  if (mDmaMode != DmaModeNone) {
+    Status = DmaTransferBlocks (MmcCmd, mPendingArg, Length, Buffer, IsWrite);
+    if (Status != EFI_UNSUPPORTED) {
+      return Status;
+    }
+  }
+
+  Status = SendTranslatedCommand (MmcCmd, mPendingArg, 0);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  mFwProtocol->SetLed (TRUE);
+  if (IsWrite) {
+    Status = WriteBlockDataPio (Length, Buffer);
+  } else {
+    Status = ReadBlockDataPio (Length, Buffer);
+  }
+  mFwProtocol->SetLed (FALSE);
+
+  return Status;
+}
+
+EFI_STATUS
+MMCReadBlockData (
+  IN EFI_MMC_HOST_PROTOCOL    *This,
+  IN EFI_LBA                  Lba,
+  IN UINTN                    Length,
+  IN UINT32*                  Buffer
+  )
+{
+  DEBUG ((DEBUG_VERBOSE, "%a(%u): LBA: 0x%x, Length: 0x%x, Buffer: 0x%x)\n",
+    __func__, __LINE__, Lba, Length, Buffer));
+
+  if (Buffer == NULL) {
+    DEBUG ((DEBUG_ERROR, "%a(%u): NULL Buffer\n", __func__, __LINE__));
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (Length % sizeof (UINT32) != 0) {
+    DEBUG ((DEBUG_ERROR, "%a(%u): bad Length %u\n", __func__, __LINE__, Length));
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (mPendingCmd != 0) {
+    return TransferBlocks (Length, Buffer, FALSE);
+  }
+
+  return ReadBlockDataPio (Length, Buffer);
+}
+
+EFI_STATUS
+MMCWriteBlockData (
+  IN EFI_MMC_HOST_PROTOCOL    *This,
+  IN EFI_LBA                  Lba,
+  IN UINTN                    Length,
+  IN UINT32*                  Buffer
+  )
+{
+  DEBUG ((DEBUG_VERBOSE, "%a(%u): LBA: 0x%x, Length: 0x%x, Buffer: 0x%x)\n",
+    __func__, __LINE__, Lba, Length, Buffer));
+
+  if (Buffer == NULL) {
+    DEBUG ((DEBUG_ERROR, "%a(%u): NULL Buffer\n", __func__, __LINE__));
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (Length % sizeof (UINT32) != 0) {
+    DEBUG ((DEBUG_ERROR, "%a(%u): bad Length %u\n", __func__, __LINE__, Length));
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (mPendingCmd != 0) {
+    return TransferBlocks (Length, Buffer, TRUE);
+  }
+
+  return WriteBlockDataPio (Length, Buffer);
+}
+
 BOOLEAN
 MMCIsMultiBlock (
   IN EFI_MMC_HOST_PROTOCOL *This
@@ -858,6 +1190,10 @@ MMCInitialize (
     return Status;
   }
 
+  if (mMmcHsBase == MMCHS2_BASE) {
+    DmaInitialize ();
+  }
+
   Status = gBS->InstallMultipleProtocolInterfaces (
                   &Handle,
                   &gRaspberryPiMmcHostProtocolGuid,
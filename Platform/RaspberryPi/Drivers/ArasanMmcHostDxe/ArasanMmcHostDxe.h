@@ -27,6 +27,7 @@
 #include <Protocol/RpiMmcHost.h>
 #include <Protocol/RpiFirmware.h>
 
+#include <IndustryStandard/Bcm2711.h>
 #include <IndustryStandard/Bcm2836.h>
 #include <IndustryStandard/Bcm2836Sdio.h>
 #include <IndustryStandard/RpiMbox.h>
@@ -40,6 +41,17 @@
 #define STALL_AFTER_REG_WRITE_US (10)
 #define STALL_AFTER_RETRY_US (20)
 
+// Extra completion time allowed per block of a DMA transfer
+#define DMA_BLOCK_TIMEOUT_US (1000)
+#define ADMA2_MAX_DESCRIPTORS \
+  ((MAX_BLOCK_COUNT * BLEN_512BYTES + ADMA2_MAX_LENGTH - 1) / ADMA2_MAX_LENGTH)
+
+typedef enum {
+  DmaModeNone,
+  DmaModeSdma,
+  DmaModeAdma2
+} MMC_DMA_MODE;
+
 #define MAX_DIVISOR_VALUE 1023
 
 #endif
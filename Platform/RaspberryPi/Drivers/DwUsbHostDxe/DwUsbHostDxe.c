@@ -223,12 +223,84 @@ DwCoreReset (
   return EFI_SUCCESS;
 }
 
+STATIC
+EFI_STATUS
+DwHcAllocateChannel (
+  IN  DWUSB_OTGHC_DEV *DwHc,
+  OUT UINT32          *Channel
+  )
+{
+  EFI_STATUS Status;
+  EFI_TPL    Tpl;
+  UINT32     Index;
+
+  Status = EFI_OUT_OF_RESOURCES;
+
+  Tpl = gBS->RaiseTPL (TPL_NOTIFY);
+  for (Index = 0; Index < DwHc->NumChannels; Index++) {
+    if ((DwHc->ChannelsInUse & (1U << Index)) == 0) {
+      DwHc->ChannelsInUse |= 1U << Index;
+      *Channel = Index;
+      Status = EFI_SUCCESS;
+      break;
+    }
+  }
+  gBS->RestoreTPL (Tpl);
+
+  return Status;
+}
+
+STATIC
+VOID
+DwHcReleaseChannel (
+  IN  DWUSB_OTGHC_DEV *DwHc,
+  IN  UINT32          Channel
+  )
+{
+  EFI_TPL Tpl;
+
+  Tpl = gBS->RaiseTPL (TPL_NOTIFY);
+  DwHc->ChannelsInUse &= ~(1U << Channel);
+  gBS->RestoreTPL (Tpl);
+}
+
+/*
+ * Whether the caller's buffer can be handed to the controller
+ * as is, instead of going through the channel bounce buffer.
+ */
+STATIC
+BOOLEAN
+DwHcCanMapDirect (
+  IN  VOID    *Buffer,
+  IN  UINTN   Length,
+  IN  UINTN   MaximumPacketLength,
+  IN  UINT32  TransferDirection
+  )
+{
+  UINTN Alignment;
+
+  if (Length < MaximumPacketLength) {
+    return FALSE;
+  }
+
+  if (TransferDirection) { // in
+    /*
+     * Whole cache lines only, so that invalidating them after
+     * the transfer cannot discard anybody else's data.
+     */
+    Alignment = ArmCacheWritebackGranule ();
+    return ((UINTN)Buffer & (Alignment - 1)) == 0 &&
+      (MaximumPacketLength & (Alignment - 1)) == 0;
+  }
+
+  return ((UINTN)Buffer & (DWC2_DMA_ALIGNMENT - 1)) == 0;
+}
+
 STATIC
 EFI_STATUS
 DwHcTransfer (
   IN      DWUSB_OTGHC_DEV        *DwHc,
   IN      EFI_EVENT              Timeout,
-  IN      UINT32                 Channel,
   IN      EFI_USB2_HC_TRANSACTION_TRANSLATOR *Translator,
   IN      UINT8                  DeviceSpeed,
   IN      UINT8                  DeviceAddress,
@@ -243,58 +315,119 @@ DwHcTransfer (
   IN      BOOLEAN                IgnoreAck
   )
 {
+  UINT32                          Channel;
   UINT32                          TxferLen;
   UINT32                          Done = 0;
   UINT32                          NumPackets;
   UINT32                          Sub;
   UINT32                          Ret = 0;
   UINT32                          StopTransfer = 0;
+  UINTN                           Remaining;
+  UINTN                           Limit;
+  UINTN                           MapLength;
+  BOOLEAN                         Direct;
+  UINT8                           *Bounce;
+  EFI_PHYSICAL_ADDRESS            DmaAddress;
+  VOID                            *Mapping = NULL;
   EFI_STATUS                      Status = EFI_SUCCESS;
   SPLIT_CONTROL                   Split = { 0 };
-
-  EFI_TPL Tpl = gBS->RaiseTPL (TPL_NOTIFY);
+  BOOLEAN                         Splitting;
+  EFI_TPL                         Tpl = TPL_APPLICATION;
 
   *TransferResult = EFI_USB_NOERROR;
 
+  Status = DwHcAllocateChannel (DwHc, &Channel);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "DwHcTransfer: no free channel\n"));
+    *DataLength = 0;
+    *TransferResult = EFI_USB_ERR_SYSTEM;
+    return EFI_DEVICE_ERROR;
+  }
+
+  Bounce = DwHc->AlignedBuffer + Channel * DWC2_CHANNEL_BUF_SIZE;
+
+  /*
+   * Split transactions are timing sensitive and stay at TPL_NOTIFY.
+   * Everything else runs at the caller's TPL, so the periodic handler
+   * can service other endpoints on their own channels meanwhile.
+   */
+  Splitting = DeviceSpeed == EFI_USB_SPEED_LOW ||
+              DeviceSpeed == EFI_USB_SPEED_FULL;
+  if (Splitting) {
+    Tpl = gBS->RaiseTPL (TPL_NOTIFY);
+  }
+
   do {
   RestartXfer:
-    if (DeviceSpeed == EFI_USB_SPEED_LOW ||
-        DeviceSpeed == EFI_USB_SPEED_FULL) {
+    if (Mapping != NULL) {
+      DmaUnmap (Mapping);
+      Mapping = NULL;
+    }
+
+    if (Splitting) {
       Split.Splitting = TRUE;
       Split.SplitStart = TRUE;
       Split.Tries = 0;
     }
 
-    TxferLen = *DataLength - Done;
+    Remaining = *DataLength - Done;
+    Direct = !Split.Splitting &&
+      DwHcCanMapDirect ((UINT8 *)Data + Done, Remaining,
+        MaximumPacketLength, TransferDirection);
+    Limit = Direct ? DwHc->MaxTransferSize : DWC2_CHANNEL_BUF_SIZE;
+    Limit = (Limit / MaximumPacketLength) * MaximumPacketLength;
 
-    if (TxferLen > DWC2_MAX_TRANSFER_SIZE) {
-      TxferLen = DWC2_MAX_TRANSFER_SIZE - MaximumPacketLength + 1;
+    TxferLen = Remaining;
+    if (TxferLen > Limit) {
+      TxferLen = Limit;
     }
 
-    if (TxferLen > DWC2_DATA_BUF_SIZE) {
-      TxferLen = DWC2_DATA_BUF_SIZE - MaximumPacketLength + 1;
+    if (Direct && TransferDirection) {
+      /*
+       * The controller writes whole packets: stop short of a
+       * trailing partial packet, which goes through the bounce buffer.
+       */
+      TxferLen = (TxferLen / MaximumPacketLength) * MaximumPacketLength;
     }
 
     if (Split.Splitting || TxferLen == 0) {
       NumPackets = 1;
     } else {
       NumPackets = (TxferLen + MaximumPacketLength - 1) / MaximumPacketLength;
-      if (NumPackets > DWC2_MAX_PACKET_COUNT) {
-        NumPackets = DWC2_MAX_PACKET_COUNT;
+      if (NumPackets > DwHc->MaxPacketCount) {
+        NumPackets = DwHc->MaxPacketCount;
         TxferLen = NumPackets * MaximumPacketLength;
       }
     }
 
     if (TransferDirection) { // in
       TxferLen = NumPackets * MaximumPacketLength;
+    }
+
+    if (Direct) {
+      MapLength = TxferLen;
+      Status = DmaMap (TransferDirection ?
+                 MapOperationBusMasterWrite : MapOperationBusMasterRead,
+                 (UINT8 *)Data + Done, &MapLength, &DmaAddress, &Mapping);
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_ERROR, "DwHcTransfer: DmaMap: %r\n", Status));
+        Mapping = NULL;
+        *TransferResult = EFI_USB_ERR_SYSTEM;
+        Status = EFI_DEVICE_ERROR;
+        break;
+      }
+      ASSERT (MapLength == TxferLen);
     } else {
-      CopyMem (DwHc->AlignedBuffer, Data + Done, TxferLen);
-      ArmDataSynchronizationBarrier ();
+      DmaAddress = DwHc->AlignedBufferBusAddress +
+        Channel * DWC2_CHANNEL_BUF_SIZE;
+      if (!TransferDirection) {
+        CopyMem (Bounce, (UINT8 *)Data + Done, TxferLen);
+        ArmDataSynchronizationBarrier ();
+      }
     }
 
   RestartChannel:
-    MmioWrite32 (DwHc->DwUsbBase + HCDMA (Channel),
-      (UINTN)DwHc->AlignedBufferBusAddress);
+    MmioWrite32 (DwHc->DwUsbBase + HCDMA (Channel), (UINT32)DmaAddress);
 
     DwOtgHcInit (DwHc, Channel, Translator, DeviceSpeed,
       DeviceAddress, EpAddress,
@@ -366,10 +499,17 @@ DwHcTransfer (
       break;
     }
 
+    if (Mapping != NULL) {
+      DmaUnmap (Mapping);
+      Mapping = NULL;
+    }
+
     if (TransferDirection) { // in
-      ArmDataSynchronizationBarrier ();
       TxferLen -= Sub;
-      CopyMem (Data + Done, DwHc->AlignedBuffer, TxferLen);
+      if (!Direct) {
+        ArmDataSynchronizationBarrier ();
+        CopyMem ((UINT8 *)Data + Done, Bounce, TxferLen);
+      }
       if (Sub) {
         StopTransfer = 1;
       }
@@ -378,12 +518,20 @@ DwHcTransfer (
     Done += TxferLen;
   } while (Done < *DataLength && !StopTransfer);
 
+  if (Mapping != NULL) {
+    DmaUnmap (Mapping);
+  }
+
   MmioWrite32 (DwHc->DwUsbBase + HCINTMSK (Channel), 0);
   MmioWrite32 (DwHc->DwUsbBase + HCINT (Channel), 0xFFFFFFFF);
 
   *DataLength = Done;
 
-  gBS->RestoreTPL (Tpl);
+  if (Splitting) {
+    gBS->RestoreTPL (Tpl);
+  }
+
+  DwHcReleaseChannel (DwHc, Channel);
 
   ASSERT (!EFI_ERROR (Status) || *TransferResult != EFI_USB_NOERROR);
 
@@ -437,7 +585,7 @@ DwHcDeferredTransfer (
 
   Req->TransferResult = EFI_USB_NOERROR;
   Status = DwHcTransfer (Req->DwHc, TimeoutEvt,
-             Req->Channel, Req->Translator,
+             Req->Translator,
              Req->DeviceSpeed, Req->DeviceAddress,
              Req->MaximumPacketLength, &Req->Pid,
              Req->TransferDirection, Req->Data, &Req->DataLength,
@@ -883,7 +1031,7 @@ DwHcControlTransfer (
   Pid = DWC2_HC_PID_SETUP;
   Length = 8;
   Status = DwHcTransfer (DwHc, TimeoutEvt,
-             DWC2_HC_CHANNEL, Translator, DeviceSpeed,
+             Translator, DeviceSpeed,
              DeviceAddress, MaximumPacketLength, &Pid, 0,
              Request, &Length, 0, DWC2_HCCHAR_EPTYPE_CONTROL,
              TransferResult, 1);
@@ -904,7 +1052,7 @@ DwHcControlTransfer (
     }
 
     Status = DwHcTransfer (DwHc, TimeoutEvt,
-               DWC2_HC_CHANNEL, Translator, DeviceSpeed,
+               Translator, DeviceSpeed,
                DeviceAddress, MaximumPacketLength, &Pid,
                Direction, Data, DataLength, 0,
                DWC2_HCCHAR_EPTYPE_CONTROL,
@@ -927,7 +1075,7 @@ DwHcControlTransfer (
   Pid = DWC2_HC_PID_DATA1;
   Length = 0;
   Status = DwHcTransfer (DwHc, TimeoutEvt,
-             DWC2_HC_CHANNEL, Translator, DeviceSpeed,
+             Translator, DeviceSpeed,
              DeviceAddress, MaximumPacketLength, &Pid,
              StatusDirection, DwHc->StatusBuffer, &Length, 0,
              DWC2_HCCHAR_EPTYPE_CONTROL, TransferResult, 1);
@@ -1017,7 +1165,7 @@ DwHcBulkTransfer (
   Pid = (*DataToggle << 1);
 
   Status = DwHcTransfer (DwHc, TimeoutEvt,
-             DWC2_HC_CHANNEL_BULK, Translator, DeviceSpeed,
+             Translator, DeviceSpeed,
              DeviceAddress, MaximumPacketLength, &Pid,
              TransferDirection, Data[0], DataLength, EpAddress,
              DWC2_HCCHAR_EPTYPE_BULK, TransferResult, 1);
@@ -1130,7 +1278,6 @@ DwHcAsyncInterruptTransfer (
     NewReq->FrameInterval;
 
   NewReq->DwHc = DwHc;
-  NewReq->Channel = DWC2_HC_CHANNEL_ASYNC;
   NewReq->Translator = Translator;
   NewReq->DeviceSpeed = DeviceSpeed;
   NewReq->DeviceAddress = DeviceAddress;
@@ -1226,7 +1373,7 @@ DwHcSyncInterruptTransfer (
   EpAddress = EndPointAddress & 0x0F;
   Pid = (*DataToggle << 1);
   Status = DwHcTransfer (DwHc, TimeoutEvt,
-             DWC2_HC_CHANNEL_SYNC, Translator,
+             Translator,
              DeviceSpeed, DeviceAddress,
              MaximumPacketLength,
              &Pid, TransferDirection, Data,
@@ -1344,6 +1491,7 @@ DwHcInit (
   UINT32 NpTxFifoSz = 0;
   UINT32 pTxFifoSz = 0;
   UINT32 Hprt0 = 0;
+  UINT32 HwCfg3;
   INT32  i, Status, NumChannels;
 
   MmioWrite32 (DwHc->DwUsbBase + PCGCCTL, 0);
@@ -1372,6 +1520,18 @@ DwHcInit (
   NumChannels += 1;
   DEBUG ((DEBUG_INFO, "Host has %u channels\n", NumChannels));
 
+  DwHc->NumChannels = MIN (NumChannels, DWC2_HC_CHANNEL_POOL);
+  DwHc->ChannelsInUse = 0;
+
+  HwCfg3 = MmioRead32 (DwHc->DwUsbBase + GHWCFG3);
+  DwHc->MaxTransferSize = (1U << (((HwCfg3 & DWC2_HWCFG3_XFER_SIZE_CNTR_WIDTH_MASK) >>
+                                   DWC2_HWCFG3_XFER_SIZE_CNTR_WIDTH_OFFSET) + 11)) - 1;
+  DwHc->MaxTransferSize = MIN (DwHc->MaxTransferSize, DWC2_HCTSIZ_XFERSIZE_MASK);
+  DwHc->MaxPacketCount = (1U << (((HwCfg3 & DWC2_HWCFG3_PACKET_SIZE_CNTR_WIDTH_MASK) >>
+                                  DWC2_HWCFG3_PACKET_SIZE_CNTR_WIDTH_OFFSET) + 4)) - 1;
+  DwHc->MaxPacketCount = MIN (DwHc->MaxPacketCount,
+                           DWC2_HCTSIZ_PKTCNT_MASK >> DWC2_HCTSIZ_PKTCNT_OFFSET);
+
   for (i = 0; i < NumChannels; i++)
     MmioAndThenOr32 (DwHc->DwUsbBase + HCCHAR (i),
       ~(DWC2_HCCHAR_CHEN | DWC2_HCCHAR_EPDIR),
@@ -1588,6 +1748,9 @@ CreateDwUsbHc (
   DwHc->DwUsbOtgHc.MajorRevision                  = 0x02;
   DwHc->DwUsbOtgHc.MinorRevision                  = 0x00;
   DwHc->DwUsbBase                                 = BCM2836_USB_BASE_ADDRESS;
+  DwHc->NumChannels                               = 4;
+  DwHc->MaxTransferSize                           = DWC2_MAX_TRANSFER_SIZE;
+  DwHc->MaxPacketCount                            = DWC2_MAX_PACKET_COUNT;
 
   Pages = EFI_SIZE_TO_PAGES (DWC2_STATUS_BUF_SIZE);
   DwHc->StatusBuffer = AllocatePages (Pages);
@@ -74,7 +74,6 @@ typedef struct {
 typedef struct _DWUSB_DEFERRED_REQ {
   IN OUT LIST_ENTRY                         List;
   IN     struct _DWUSB_OTGHC_DEV            *DwHc;
-  IN     UINT32                             Channel;
   IN     UINT32                             FrameInterval;
   IN     UINT32                             TargetFrame;
   IN     EFI_USB2_HC_TRANSACTION_TRANSLATOR *Translator;
@@ -108,10 +107,19 @@ typedef struct _DWUSB_OTGHC_DEV {
   EFI_PHYSICAL_ADDRESS            DwUsbBase;
   UINT8                           *StatusBuffer;
 
+  /*
+   * One DWC2_CHANNEL_BUF_SIZE bounce area per channel, for
+   * transfers that cannot be mapped for DMA directly.
+   */
   UINT8                           *AlignedBuffer;
   VOID *                          AlignedBufferMapping;
   UINTN                           AlignedBufferBusAddress;
   LIST_ENTRY                      DeferredList;
+
+  UINT32                          NumChannels;
+  UINT32                          ChannelsInUse;
+  UINT32                          MaxTransferSize;
+  UINT32                          MaxPacketCount;
   /*
    * 1ms frames.
    */
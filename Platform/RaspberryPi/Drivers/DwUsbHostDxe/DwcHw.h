@@ -752,14 +752,14 @@
 #define DWC2_MAX_TRANSFER_SIZE           65535
 #define DWC2_MAX_PACKET_COUNT            511
 
-#define DWC2_HC_CHANNEL                 0
-#define DWC2_HC_CHANNEL_ASYNC           1
-#define DWC2_HC_CHANNEL_SYNC            2
-#define DWC2_HC_CHANNEL_BULK            3
+#define DWC2_HC_CHANNEL_POOL            8       /* Channels handed out to transfers */
 #define DWC2_HC_PORT                    0
 
+#define DWC2_DMA_ALIGNMENT              4
+
 #define DWC2_STATUS_BUF_SIZE            64
-#define DWC2_DATA_BUF_SIZE              (64 * 1024)
+#define DWC2_CHANNEL_BUF_SIZE           (32 * 1024)
+#define DWC2_DATA_BUF_SIZE              (DWC2_HC_CHANNEL_POOL * DWC2_CHANNEL_BUF_SIZE)
 
 
 #define USB_PORT_FEAT_CONNECTION     0
@@ -107,6 +107,12 @@ MMC_HOST_INSTANCE* CreateMmcHostInstance (
   MmcHostInstance->BlockIo.WriteBlocks = MmcWriteBlocks;
   MmcHostInstance->BlockIo.FlushBlocks = MmcFlushBlocks;
 
+  MmcHostInstance->BlockIo2.Media = MmcHostInstance->BlockIo.Media;
+  MmcHostInstance->BlockIo2.Reset = MmcResetEx;
+  MmcHostInstance->BlockIo2.ReadBlocksEx = MmcReadBlocksEx;
+  MmcHostInstance->BlockIo2.WriteBlocksEx = MmcWriteBlocksEx;
+  MmcHostInstance->BlockIo2.FlushBlocksEx = MmcFlushBlocksEx;
+
   MmcHostInstance->MmcHost = MmcHost;
 
   // Create DevicePath for the new MMC Host
@@ -127,6 +133,7 @@ MMC_HOST_INSTANCE* CreateMmcHostInstance (
   Status = gBS->InstallMultipleProtocolInterfaces (
                   &MmcHostInstance->MmcHandle,
                   &gEfiBlockIoProtocolGuid, &MmcHostInstance->BlockIo,
+                  &gEfiBlockIo2ProtocolGuid, &MmcHostInstance->BlockIo2,
                   &gEfiDevicePathProtocolGuid, MmcHostInstance->DevicePath,
                   NULL
                 );
@@ -158,6 +165,7 @@ EFI_STATUS DestroyMmcHostInstance (
   Status = gBS->UninstallMultipleProtocolInterfaces (
                   MmcHostInstance->MmcHandle,
                   &gEfiBlockIoProtocolGuid, &(MmcHostInstance->BlockIo),
+                  &gEfiBlockIo2ProtocolGuid, &(MmcHostInstance->BlockIo2),
                   &gEfiDevicePathProtocolGuid, MmcHostInstance->DevicePath,
                   NULL
                 );
@@ -170,6 +178,9 @@ EFI_STATUS DestroyMmcHostInstance (
   if (MmcHostInstance->CardInfo.ECSDData) {
     FreePages (MmcHostInstance->CardInfo.ECSDData, EFI_SIZE_TO_PAGES (sizeof (ECSD)));
   }
+  if (MmcHostInstance->ReadAheadBuffer) {
+    FreePages (MmcHostInstance->ReadAheadBuffer, EFI_SIZE_TO_PAGES (MMC_READ_AHEAD_SIZE));
+  }
   FreePool (MmcHostInstance);
 
   return Status;
@@ -385,6 +396,17 @@ CheckCardsCallback (
       if (EFI_ERROR (Status)) {
         Print (L"MMC Card: Error reinstalling BlockIo interface\n");
       }
+
+      Status = gBS->ReinstallProtocolInterface (
+                      (MmcHostInstance->MmcHandle),
+                      &gEfiBlockIo2ProtocolGuid,
+                      &(MmcHostInstance->BlockIo2),
+                      &(MmcHostInstance->BlockIo2)
+                    );
+
+      if (EFI_ERROR (Status)) {
+        Print (L"MMC Card: Error reinstalling BlockIo2 interface\n");
+      }
     }
 
     CurrentLink = CurrentLink->ForwardLink;
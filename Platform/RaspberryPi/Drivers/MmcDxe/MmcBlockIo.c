@@ -7,6 +7,7 @@
  **/
 
 #include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
 
 #include "Mmc.h"
 
@@ -167,6 +168,9 @@ MmcReset (
     return EFI_SUCCESS;
   }
 
+  MmcInvalidateReadAhead (MmcHostInstance);
+  MmcHostInstance->CardInTran = FALSE;
+
   // If a card is not present then clear all media settings
   if (!MmcHostInstance->MmcHost->IsCardPresent (MmcHostInstance->MmcHost)) {
     MmcHostInstance->BlockIo.Media->MediaPresent = FALSE;
@@ -230,9 +234,11 @@ MmcTransferBlock (
   MMC_HOST_INSTANCE       *MmcHostInstance;
   EFI_MMC_HOST_PROTOCOL   *MmcHost;
   UINTN                   CmdArg;
+  BOOLEAN                 PreDefined;
 
   MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO_THIS (This);
   MmcHost = MmcHostInstance->MmcHost;
+  MmcHostInstance->CardInTran = FALSE;
 
   //Set command argument based on the card access mode (Byte mode or Block mode)
   if ((MmcHostInstance->CardInfo.OCRData.AccessMode & MMC_OCR_ACCESS_MASK) ==
@@ -242,6 +248,21 @@ MmcTransferBlock (
     CmdArg = Lba * This->Media->BlockSize;
   }
 
+  //
+  // With a pre-defined block count the card leaves the data state by
+  // itself after the last block, saving the CMD12 round trip.
+  //
+  PreDefined = BufferSize > This->Media->BlockSize &&
+               MmcHostInstance->CardInfo.Cmd23Supported;
+  if (PreDefined) {
+    Status = MmcHost->SendCommand (MmcHost, MMC_CMD23,
+                        BufferSize / This->Media->BlockSize);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "%a(MMC_CMD23): Error %r\n", __func__, Status));
+      return Status;
+    }
+  }
+
   Status = MmcHost->SendCommand (MmcHost, Cmd, CmdArg);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "%a(MMC_CMD%d): Error %r\n", __func__, MMC_INDX (Cmd), Status));
@@ -262,10 +283,10 @@ MmcTransferBlock (
   }
 
   if (EFI_ERROR (Status) ||
-      BufferSize > This->Media->BlockSize) {
+      (BufferSize > This->Media->BlockSize && !PreDefined)) {
     /*
-     * CMD12 needs to be set for multiblock (to transition from
-     * RECV to PROG) or for errors.
+     * CMD12 needs to be set for open-ended multiblock (to transition
+     * from RECV to PROG) or for errors.
      */
     EFI_STATUS Status2 = MmcStopTransmission (MmcHost);
     if (EFI_ERROR (Status2)) {
@@ -311,28 +332,199 @@ MmcTransferBlock (
     *TransferredSize = BufferSize;
   }
 
+  MmcHostInstance->CardInTran = !EFI_ERROR (Status);
   return Status;
 }
 
+STATIC
+BOOLEAN
+MmcCanMultiBlock (
+  IN EFI_MMC_HOST_PROTOCOL    *MmcHost
+  )
+{
+  return PcdGet32 (PcdMmcDisableMulti) == 0 &&
+         MMC_HOST_HAS_ISMULTIBLOCK (MmcHost) &&
+         MmcHost->IsMultiBlock (MmcHost);
+}
+
+/**
+  Transfer a validated request to or from the card, splitting it into
+  chunks the host controller can handle.
+**/
+STATIC
 EFI_STATUS
-MmcIoBlocks (
+MmcTransferBlocks (
   IN EFI_BLOCK_IO_PROTOCOL    *This,
   IN UINTN                    Transfer,
   IN UINT32                   MediaId,
   IN EFI_LBA                  Lba,
   IN UINTN                    BufferSize,
-  OUT VOID                    *Buffer
+  IN OUT VOID                 *Buffer
   )
 {
   EFI_STATUS              Status;
   UINTN                   Cmd;
   MMC_HOST_INSTANCE       *MmcHostInstance;
-  EFI_MMC_HOST_PROTOCOL   *MmcHost;
   UINTN                   BytesRemainingToBeTransfered;
   UINTN                   BlockCount;
   UINTN                   ConsumeSize;
 
   BlockCount = 1;
+  MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO_THIS (This);
+
+  if (MmcCanMultiBlock (MmcHostInstance->MmcHost)) {
+    BlockCount = (BufferSize + This->Media->BlockSize - 1) / This->Media->BlockSize;
+    BlockCount = MIN (BlockCount, MMC_MAX_BLOCKS_PER_TRANSFER);
+  }
+
+  BytesRemainingToBeTransfered = BufferSize;
+  while (BytesRemainingToBeTransfered > 0) {
+    //
+    // A successful transfer already ended with the card back in TRAN.
+    //
+    if (!MmcHostInstance->CardInTran) {
+      Status = WaitUntilTran (MmcHostInstance);
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_ERROR, "WaitUntilTran before IO failed"));
+        return Status;
+      }
+    }
+
+    if (Transfer == MMC_IOBLOCKS_READ) {
+      if (BlockCount == 1) {
+        // Read a single block
+        Cmd = MMC_CMD17;
+      } else {
+        // Read multiple blocks
+        Cmd = MMC_CMD18;
+      }
+    } else {
+      if (BlockCount == 1) {
+        // Write a single block
+        Cmd = MMC_CMD24;
+      } else {
+        // Write multiple blocks
+        Cmd = MMC_CMD25;
+      }
+    }
+
+    ConsumeSize = BlockCount * This->Media->BlockSize;
+    if (BytesRemainingToBeTransfered < ConsumeSize) {
+      ConsumeSize = BytesRemainingToBeTransfered;
+    }
+
+    Status = MmcTransferBlock (This, Cmd, Transfer, MediaId, Lba, ConsumeSize, Buffer, &ConsumeSize);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "%a(): Failed to transfer block and Status:%r\n", __func__, Status));
+      return Status;
+    }
+
+    BytesRemainingToBeTransfered -= ConsumeSize;
+    if (BytesRemainingToBeTransfered > 0) {
+      Lba += BlockCount;
+      Buffer = (UINT8*)Buffer + ConsumeSize;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+VOID
+MmcInvalidateReadAhead (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance
+  )
+{
+  MmcHostInstance->ReadAheadBlocks = 0;
+  MmcHostInstance->NextReadLba = 0;
+}
+
+/**
+  Serve a small read from the read-ahead window. When the read continues
+  the previous one but misses the window, the window is refilled with one
+  large transfer starting at Lba.
+
+  @retval EFI_SUCCESS    The read was served from the read-ahead window.
+  @retval EFI_NOT_FOUND  The read should go to the card as is.
+  @retval Others         Refilling the window failed.
+**/
+STATIC
+EFI_STATUS
+MmcReadAhead (
+  IN  EFI_BLOCK_IO_PROTOCOL   *This,
+  IN  UINT32                  MediaId,
+  IN  EFI_LBA                 Lba,
+  IN  UINTN                   BufferSize,
+  OUT VOID                    *Buffer
+  )
+{
+  EFI_STATUS              Status;
+  MMC_HOST_INSTANCE       *MmcHostInstance;
+  UINTN                   BlockCount;
+  UINTN                   WindowBlocks;
+  BOOLEAN                 Sequential;
+
+  MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO_THIS (This);
+  BlockCount = BufferSize / This->Media->BlockSize;
+  Sequential = Lba == MmcHostInstance->NextReadLba;
+  MmcHostInstance->NextReadLba = Lba + BlockCount;
+
+  if (MmcHostInstance->ReadAheadBlocks != 0 &&
+      Lba >= MmcHostInstance->ReadAheadLba &&
+      Lba + BlockCount <= MmcHostInstance->ReadAheadLba +
+                          MmcHostInstance->ReadAheadBlocks) {
+    CopyMem (Buffer, MmcHostInstance->ReadAheadBuffer +
+               (Lba - MmcHostInstance->ReadAheadLba) * This->Media->BlockSize,
+      BufferSize);
+    return EFI_SUCCESS;
+  }
+
+  if (!Sequential ||
+      BufferSize >= MMC_READ_AHEAD_THRESHOLD ||
+      !MmcCanMultiBlock (MmcHostInstance->MmcHost)) {
+    return EFI_NOT_FOUND;
+  }
+
+  if (MmcHostInstance->ReadAheadBuffer == NULL) {
+    MmcHostInstance->ReadAheadBuffer = AllocatePages (EFI_SIZE_TO_PAGES (MMC_READ_AHEAD_SIZE));
+    if (MmcHostInstance->ReadAheadBuffer == NULL) {
+      return EFI_NOT_FOUND;
+    }
+  }
+
+  WindowBlocks = MMC_READ_AHEAD_SIZE / This->Media->BlockSize;
+  if (WindowBlocks > This->Media->LastBlock + 1 - Lba) {
+    WindowBlocks = (UINTN)(This->Media->LastBlock + 1 - Lba);
+  }
+
+  MmcHostInstance->ReadAheadBlocks = 0;
+  Status = MmcTransferBlocks (This, MMC_IOBLOCKS_READ, MediaId, Lba,
+             WindowBlocks * This->Media->BlockSize,
+             MmcHostInstance->ReadAheadBuffer);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  MmcHostInstance->ReadAheadLba = Lba;
+  MmcHostInstance->ReadAheadBlocks = WindowBlocks;
+  CopyMem (Buffer, MmcHostInstance->ReadAheadBuffer, BufferSize);
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+MmcIoBlocks (
+  IN EFI_BLOCK_IO_PROTOCOL    *This,
+  IN UINTN                    Transfer,
+  IN UINT32                   MediaId,
+  IN EFI_LBA                  Lba,
+  IN UINTN                    BufferSize,
+  OUT VOID                    *Buffer
+  )
+{
+  EFI_STATUS              Status;
+  MMC_HOST_INSTANCE       *MmcHostInstance;
+  EFI_MMC_HOST_PROTOCOL   *MmcHost;
+  UINTN                   BlockCount;
+
   MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO_THIS (This);
   ASSERT (MmcHostInstance != NULL);
   MmcHost = MmcHostInstance->MmcHost;
@@ -351,12 +543,6 @@ MmcIoBlocks (
     return EFI_NO_MEDIA;
   }
 
-  if (PcdGet32 (PcdMmcDisableMulti) == 0 &&
-      MMC_HOST_HAS_ISMULTIBLOCK (MmcHost) &&
-      MmcHost->IsMultiBlock (MmcHost)) {
-    BlockCount = (BufferSize + This->Media->BlockSize - 1) / This->Media->BlockSize;
-  }
-
   // All blocks must be within the device
   if ((Lba + (BufferSize / This->Media->BlockSize)) > (This->Media->LastBlock + 1)) {
     return EFI_INVALID_PARAMETER;
@@ -381,51 +567,21 @@ MmcIoBlocks (
     return EFI_INVALID_PARAMETER;
   }
 
-  BytesRemainingToBeTransfered = BufferSize;
-  while (BytesRemainingToBeTransfered > 0) {
-    Status = WaitUntilTran (MmcHostInstance);
-    if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_ERROR, "WaitUntilTran before IO failed"));
-      return Status;
-    }
-
-    if (Transfer == MMC_IOBLOCKS_READ) {
-      if (BlockCount == 1) {
-        // Read a single block
-        Cmd = MMC_CMD17;
-      } else {
-        // Read multiple blocks
-        Cmd = MMC_CMD18;
-      }
-    } else {
-      if (BlockCount == 1) {
-        // Write a single block
-        Cmd = MMC_CMD24;
-      } else {
-        // Write multiple blocks
-        Cmd = MMC_CMD25;
-      }
-    }
-
-    ConsumeSize = BlockCount * This->Media->BlockSize;
-    if (BytesRemainingToBeTransfered < ConsumeSize) {
-      ConsumeSize = BytesRemainingToBeTransfered;
-    }
-
-    Status = MmcTransferBlock (This, Cmd, Transfer, MediaId, Lba, ConsumeSize, Buffer, &ConsumeSize);
-    if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_ERROR, "%a(): Failed to transfer block and Status:%r\n", __func__, Status));
+  if (Transfer == MMC_IOBLOCKS_READ) {
+    Status = MmcReadAhead (This, MediaId, Lba, BufferSize, Buffer);
+    if (Status != EFI_NOT_FOUND) {
       return Status;
     }
-
-    BytesRemainingToBeTransfered -= ConsumeSize;
-    if (BytesRemainingToBeTransfered > 0) {
-      Lba += BlockCount;
-      Buffer = (UINT8*)Buffer + ConsumeSize;
+  } else if (MmcHostInstance->ReadAheadBlocks != 0) {
+    // Drop the read-ahead window if the write lands on it
+    BlockCount = BufferSize / This->Media->BlockSize;
+    if (Lba < MmcHostInstance->ReadAheadLba + MmcHostInstance->ReadAheadBlocks &&
+        Lba + BlockCount > MmcHostInstance->ReadAheadLba) {
+      MmcHostInstance->ReadAheadBlocks = 0;
     }
   }
 
-  return EFI_SUCCESS;
+  return MmcTransferBlocks (This, Transfer, MediaId, Lba, BufferSize, Buffer);
 }
 
 EFI_STATUS
@@ -462,3 +618,86 @@ MmcFlushBlocks (
 {
   return EFI_SUCCESS;
 }
+
+EFI_STATUS
+EFIAPI
+MmcResetEx (
+  IN EFI_BLOCK_IO2_PROTOCOL   *This,
+  IN BOOLEAN                  ExtendedVerification
+  )
+{
+  MMC_HOST_INSTANCE       *MmcHostInstance;
+
+  MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO2_THIS (This);
+  return MmcReset (&MmcHostInstance->BlockIo, ExtendedVerification);
+}
+
+//
+// The host drivers are polled, so BlockIo2 requests complete before
+// returning; a non-blocking caller only sees its event signalled early.
+//
+STATIC
+VOID
+MmcCompleteToken (
+  IN OUT EFI_BLOCK_IO2_TOKEN  *Token,
+  IN     EFI_STATUS           Status
+  )
+{
+  if (Token != NULL && Token->Event != NULL && !EFI_ERROR (Status)) {
+    Token->TransactionStatus = Status;
+    gBS->SignalEvent (Token->Event);
+  }
+}
+
+EFI_STATUS
+EFIAPI
+MmcReadBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  OUT    VOID                   *Buffer
+  )
+{
+  EFI_STATUS              Status;
+  MMC_HOST_INSTANCE       *MmcHostInstance;
+
+  MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO2_THIS (This);
+  Status = MmcIoBlocks (&MmcHostInstance->BlockIo, MMC_IOBLOCKS_READ, MediaId,
+             Lba, BufferSize, Buffer);
+  MmcCompleteToken (Token, Status);
+  return Status;
+}
+
+EFI_STATUS
+EFIAPI
+MmcWriteBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  IN     VOID                   *Buffer
+  )
+{
+  EFI_STATUS              Status;
+  MMC_HOST_INSTANCE       *MmcHostInstance;
+
+  MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO2_THIS (This);
+  Status = MmcIoBlocks (&MmcHostInstance->BlockIo, MMC_IOBLOCKS_WRITE, MediaId,
+             Lba, BufferSize, Buffer);
+  MmcCompleteToken (Token, Status);
+  return Status;
+}
+
+EFI_STATUS
+EFIAPI
+MmcFlushBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token
+  )
+{
+  MmcCompleteToken (Token, EFI_SUCCESS);
+  return EFI_SUCCESS;
+}
@@ -242,6 +242,8 @@ EmmcIdentificationMode (
 
   // Setup card type
   MmcHostInstance->CardInfo.CardType = EMMC_CARD;
+  // SET_BLOCK_COUNT is mandatory for eMMC
+  MmcHostInstance->CardInfo.Cmd23Supported = TRUE;
   return EFI_SUCCESS;
 
 FreePageExit:
@@ -675,6 +677,9 @@ InitializeSdMmcDevice (
      return Status;
   }
 
+  MmcHostInstance->CardInfo.Cmd23Supported =
+    (Scr.CMD_SUPPORT & SD_SCR_CMD23_SUPPORT) != 0;
+
   if (Scr.SD_SPEC == 2) {
     if (Scr.SD_SPEC3 == 1) {
       if (Scr.SD_SPEC4 == 1) {
@@ -956,6 +961,9 @@ InitializeMmcDevice (
 
   BlockCount = 1;
   MmcHost = MmcHostInstance->MmcHost;
+  MmcHostInstance->CardInfo.Cmd23Supported = FALSE;
+  MmcHostInstance->CardInTran = FALSE;
+  MmcInvalidateReadAhead (MmcHostInstance);
 
   Status = MmcIdentificationMode (MmcHostInstance);
   if (EFI_ERROR (Status)) {
@@ -51,11 +51,21 @@
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiRuntimeServicesTableLib.h>
 #include <Library/PrintLib.h>
+#include <Library/SmbiosRecordBuilderLib.h>
 #include <ConfigVars.h>
 
 #define SMB_IS_DIGIT(c)  (((c) >= '0') && ((c) <= '9'))
 
 STATIC RASPBERRY_PI_FIRMWARE_PROTOCOL *mFwProtocol;
+STATIC SMBIOS_RECORD_BUILDER          *mSmbiosBuilder;
+
+//
+// Builder indices of the records other records refer to by handle.
+//
+STATIC UINTN mEnclosureRecord    = MAX_UINTN;
+STATIC UINTN mL1DataCacheRecord  = MAX_UINTN;
+STATIC UINTN mL2CacheRecord      = MAX_UINTN;
+STATIC UINTN mPhyMemArrayRecord  = MAX_UINTN;
 
 /***********************************************************************
         SMBIOS data definition  TYPE0  BIOS Information
@@ -623,11 +633,12 @@ CHAR8 *mBootInfoType32Strings[] = {
 
 /**
 
-   Create SMBIOS record.
+   Queue an SMBIOS record.
 
-   Converts a fixed SMBIOS structure and an array of pointers to strings into
-   an SMBIOS record where the strings are cat'ed on the end of the fixed record
-   and terminated via a double NULL and add to SMBIOS table.
+   Hands a fixed SMBIOS structure and an array of pointers to strings to the
+   record builder. The driver entry point emits all queued records into a
+   single buffer, with the strings cat'ed on the end of each fixed record and
+   terminated via a double NULL, and adds them to the SMBIOS table.
 
    SMBIOS_TABLE_TYPE32 gSmbiosType12 = {
    { EFI_SMBIOS_TYPE_SYSTEM_CONFIGURATION_OPTIONS, sizeof (SMBIOS_TABLE_TYPE12), 0 },
@@ -649,8 +660,8 @@ CHAR8 *mBootInfoType32Strings[] = {
    @param  Template    Fixed SMBIOS structure, required.
    @param  StringPack  Array of strings to convert to an SMBIOS string pack.
    NULL is OK.
-   @param  DataSmbiosHandle  The new SMBIOS record handle.
-   NULL is OK.
+   @param  RecordIndex  The builder index of the new record, for use with
+   SmbiosBuilderLinkHandle (). NULL is OK.
 **/
 
 EFI_STATUS
@@ -658,78 +669,53 @@ EFIAPI
 LogSmbiosData (
   IN  EFI_SMBIOS_TABLE_HEADER *Template,
   IN  CHAR8                   **StringPack,
-  OUT EFI_SMBIOS_HANDLE       *DataSmbiosHandle
+  OUT UINTN                   *RecordIndex
   )
 {
   EFI_STATUS                Status;
-  EFI_SMBIOS_PROTOCOL       *Smbios;
-  EFI_SMBIOS_HANDLE         SmbiosHandle;
-  EFI_SMBIOS_TABLE_HEADER   *Record;
-  UINTN                     Index;
-  UINTN                     StringSize;
-  UINTN                     Size;
-  CHAR8                     *Str;
-
-  //
-  // Locate Smbios protocol.
-  //
-  Status = gBS->LocateProtocol (&gEfiSmbiosProtocolGuid, NULL, (VOID**)&Smbios);
 
-  if (EFI_ERROR (Status)) {
-    return Status;
-  }
+  Template->Handle = SMBIOS_HANDLE_PI_RESERVED;
+  Status = SmbiosBuilderAddRecord (
+             mSmbiosBuilder,
+             (SMBIOS_STRUCTURE *)Template,
+             (CONST CHAR8 * CONST *)StringPack,
+             RecordIndex
+             );
 
-  // Calculate the size of the fixed record and optional string pack
-
-  Size = Template->Length;
-  if (StringPack == NULL) {
-    // At least a double null is required
-    Size += 2;
-  } else {
-    for (Index = 0; StringPack[Index] != NULL; Index++) {
-      StringSize = AsciiStrSize (StringPack[Index]);
-      Size += StringSize;
-    }
-    if (StringPack[0] == NULL) {
-      // At least a double null is required
-      Size += 1;
-    }
-
-    // Don't forget the terminating double null
-    Size += 1;
-  }
+  ASSERT_EFI_ERROR (Status);
+  return Status;
+}
 
-  // Copy over Template
-  Record = (EFI_SMBIOS_TABLE_HEADER*)AllocateZeroPool (Size);
-  if (Record == NULL) {
-    return EFI_OUT_OF_RESOURCES;
-  }
-  CopyMem (Record, Template, Template->Length);
+/**
+   Make a handle field of a logged record refer to another logged record.
 
-  // Append string pack
-  Str = ((CHAR8*)Record) + Record->Length;
+   @param  RecordIndex  The builder index of the referring record.
+   @param  FieldOffset  Offset of the SMBIOS_HANDLE field in the record.
+   @param  TargetIndex  The builder index of the record referred to.
+**/
 
-  for (Index = 0; StringPack[Index] != NULL; Index++) {
-    StringSize = AsciiStrSize (StringPack[Index]);
-    CopyMem (Str, StringPack[Index], StringSize);
-    Str += StringSize;
-  }
+EFI_STATUS
+EFIAPI
+LinkSmbiosHandle (
+  IN  UINTN                   RecordIndex,
+  IN  UINTN                   FieldOffset,
+  IN  UINTN                   TargetIndex
+  )
+{
+  EFI_STATUS                Status;
 
-  *Str = 0;
-  SmbiosHandle = SMBIOS_HANDLE_PI_RESERVED;
-  Status = Smbios->Add (
-                     Smbios,
-                     gImageHandle,
-                     &SmbiosHandle,
-                     Record
-                   );
-
-  if ((Status == EFI_SUCCESS) && (DataSmbiosHandle != NULL)) {
-    *DataSmbiosHandle = SmbiosHandle;
+  Status = SmbiosBuilderLinkHandle (
+             mSmbiosBuilder,
+             RecordIndex,
+             FieldOffset,
+             TargetIndex
+             );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to link SMBIOS record %Lu to record %Lu: %r\n",
+      (UINT64)RecordIndex, (UINT64)TargetIndex, Status));
   }
 
   ASSERT_EFI_ERROR (Status);
-  FreePool (Record);
   return Status;
 }
 
@@ -910,8 +896,15 @@ BoardInfoUpdateSmbiosType2 (
   VOID
   )
 {
+  EFI_STATUS Status;
+  UINTN      RecordIndex;
 
-  LogSmbiosData ((EFI_SMBIOS_TABLE_HEADER*)&mBoardInfoType2, mBoardInfoType2Strings, NULL);
+  Status = LogSmbiosData ((EFI_SMBIOS_TABLE_HEADER*)&mBoardInfoType2, mBoardInfoType2Strings, &RecordIndex);
+  if (!EFI_ERROR (Status)) {
+    // Point Type2 ChassisHandle at the Type3 record
+    LinkSmbiosHandle (RecordIndex,
+      OFFSET_OF (SMBIOS_TABLE_TYPE2, ChassisHandle), mEnclosureRecord);
+  }
 }
 
 /***********************************************************************
@@ -924,7 +917,6 @@ EnclosureInfoUpdateSmbiosType3 (
 {
   UINTN             Size;
   EFI_STATUS        Status;
-  EFI_SMBIOS_HANDLE SmbiosHandle;
   CHAR16            AssetTagVar[ASSET_TAG_STR_STORAGE_SIZE] = L"";
 
   Size = sizeof(AssetTagVar);
@@ -943,10 +935,7 @@ EnclosureInfoUpdateSmbiosType3 (
   }
   DEBUG ((DEBUG_INFO, "System Asset Tag : %a\n", mChassisAssetTag));
 
-  LogSmbiosData ((EFI_SMBIOS_TABLE_HEADER*)&mEnclosureInfoType3, mEnclosureInfoType3Strings, &SmbiosHandle);
-
-  // Set Type2 ChassisHandle to point to the newly added Type3 handle
-  mBoardInfoType2.ChassisHandle = (UINT16) SmbiosHandle;
+  LogSmbiosData ((EFI_SMBIOS_TABLE_HEADER*)&mEnclosureInfoType3, mEnclosureInfoType3Strings, &mEnclosureRecord);
 }
 
 /***********************************************************************
@@ -957,9 +946,12 @@ ProcessorInfoUpdateSmbiosType4 (
   IN UINTN MaxCpus
   )
 {
-  EFI_STATUS Status;
-  UINT32     Rate;
-  UINT64     *ProcessorId;
+  EFI_STATUS                        Status;
+  RASPBERRY_PI_FIRMWARE_CLOCK_RATE  Clocks[2];
+  RASPBERRY_PI_FIRMWARE_TAG         Tags[2];
+  UINT64                            *ProcessorId;
+  UINTN                             RecordIndex;
+  UINTN                             Index;
 
   mProcessorInfoType4.CoreCount = (UINT8)MaxCpus;
   mProcessorInfoType4.CoreCount2 = (UINT8)MaxCpus;
@@ -968,20 +960,36 @@ ProcessorInfoUpdateSmbiosType4 (
   mProcessorInfoType4.ThreadCount = (UINT8)MaxCpus;
   mProcessorInfoType4.ThreadCount2 = (UINT8)MaxCpus;
 
-  Status = mFwProtocol->GetMaxClockRate (RPI_MBOX_CLOCK_RATE_ARM, &Rate);
+  //
+  // Fetch the max and current CPU speed in a single mailbox transaction.
+  //
+  Tags[0].TagId = RPI_MBOX_GET_MAX_CLOCK_RATE;
+  Tags[1].TagId = RPI_MBOX_GET_CLOCK_RATE;
+  for (Index = 0; Index < ARRAY_SIZE (Tags); Index++) {
+    Clocks[Index].ClockId = RPI_MBOX_CLOCK_RATE_ARM;
+    Clocks[Index].ClockRate = 0;
+    Tags[Index].ValueSize = sizeof (Clocks[Index]);
+    Tags[Index].Value = &Clocks[Index];
+    Tags[Index].ResponseSize = 0;
+  }
+
+  Status = mFwProtocol->QueryTags (Tags, ARRAY_SIZE (Tags));
   if (Status != EFI_SUCCESS) {
-    DEBUG ((DEBUG_ERROR, "Couldn't get the max CPU speed: %r\n", Status));
+    DEBUG ((DEBUG_ERROR, "Couldn't get the CPU speed: %r\n", Status));
+  }
+
+  if (Tags[0].ResponseSize < sizeof (Clocks[0])) {
+    DEBUG ((DEBUG_ERROR, "Couldn't get the max CPU speed\n"));
   } else {
-    mProcessorInfoType4.MaxSpeed = Rate / 1000000;
-    DEBUG ((DEBUG_INFO, "Max CPU speed: %uHz\n", Rate));
+    mProcessorInfoType4.MaxSpeed = Clocks[0].ClockRate / 1000000;
+    DEBUG ((DEBUG_INFO, "Max CPU speed: %uHz\n", Clocks[0].ClockRate));
   }
 
-  Status = mFwProtocol->GetClockRate (RPI_MBOX_CLOCK_RATE_ARM, &Rate);
-  if (Status != EFI_SUCCESS) {
-    DEBUG ((DEBUG_ERROR, "Couldn't get the current CPU speed: %r\n", Status));
+  if (Tags[1].ResponseSize < sizeof (Clocks[1])) {
+    DEBUG ((DEBUG_ERROR, "Couldn't get the current CPU speed\n"));
   } else {
-    mProcessorInfoType4.CurrentSpeed = Rate / 1000000;
-    DEBUG ((DEBUG_INFO, "Current CPU speed: %uHz\n", Rate));
+    mProcessorInfoType4.CurrentSpeed = Clocks[1].ClockRate / 1000000;
+    DEBUG ((DEBUG_INFO, "Current CPU speed: %uHz\n", Clocks[1].ClockRate));
   }
 
   AsciiStrCpyS (mCpuName, sizeof (mCpuName), mFwProtocol->GetCpuName (-1));
@@ -989,7 +997,14 @@ ProcessorInfoUpdateSmbiosType4 (
   ProcessorId = (UINT64 *)&(mProcessorInfoType4.ProcessorId);
   *ProcessorId = ArmReadMidr();
 
-  LogSmbiosData ((EFI_SMBIOS_TABLE_HEADER*)&mProcessorInfoType4, mProcessorInfoType4Strings, NULL);
+  Status = LogSmbiosData ((EFI_SMBIOS_TABLE_HEADER*)&mProcessorInfoType4, mProcessorInfoType4Strings, &RecordIndex);
+  if (!EFI_ERROR (Status)) {
+    // Point Type4 L1CacheHandle and L2CacheHandle at the Type7 records
+    LinkSmbiosHandle (RecordIndex,
+      OFFSET_OF (SMBIOS_TABLE_TYPE4, L1CacheHandle), mL1DataCacheRecord);
+    LinkSmbiosHandle (RecordIndex,
+      OFFSET_OF (SMBIOS_TABLE_TYPE4, L2CacheHandle), mL2CacheRecord);
+  }
 }
 
 /***********************************************************************
@@ -1000,17 +1015,11 @@ CacheInfoUpdateSmbiosType7 (
   VOID
   )
 {
-  EFI_SMBIOS_HANDLE SmbiosHandle;
-
   LogSmbiosData ((EFI_SMBIOS_TABLE_HEADER*)&mCacheInfoType7_L1I, mCacheInfoType7Strings_L1I, NULL);
 
-  LogSmbiosData ((EFI_SMBIOS_TABLE_HEADER*)&mCacheInfoType7_L1D, mCacheInfoType7Strings_L1D, &SmbiosHandle);
-  // Set Type4 L1CacheHandle to point to the newly added L1 Data Cache
-  mProcessorInfoType4.L1CacheHandle = (UINT16) SmbiosHandle;
+  LogSmbiosData ((EFI_SMBIOS_TABLE_HEADER*)&mCacheInfoType7_L1D, mCacheInfoType7Strings_L1D, &mL1DataCacheRecord);
 
-  LogSmbiosData ((EFI_SMBIOS_TABLE_HEADER*)&mCacheInfoType7_L2, mCacheInfoType7Strings_L2, &SmbiosHandle);
-  // Set Type4 L2CacheHandle to point to the newly added L2 Cache
-  mProcessorInfoType4.L2CacheHandle = (UINT16) SmbiosHandle;
+  LogSmbiosData ((EFI_SMBIOS_TABLE_HEADER*)&mCacheInfoType7_L2, mCacheInfoType7Strings_L2, &mL2CacheRecord);
 }
 
 /***********************************************************************
@@ -1043,7 +1052,6 @@ PhyMemArrayInfoUpdateSmbiosType16 (
   VOID
   )
 {
-  EFI_SMBIOS_HANDLE MemArraySmbiosHandle;
   EFI_STATUS        Status;
   UINT32            InstalledMB = 0;
 
@@ -1067,13 +1075,7 @@ PhyMemArrayInfoUpdateSmbiosType16 (
   mPhyMemArrayInfoType16.MaximumCapacity = mMemDevInfoType17.Size * 1024; // Size in KB
   mMemDevInfoType17.VolatileSize = MultU64x32 (mMemDevInfoType17.Size, 1024 * 1024);  // Size in Bytes
 
-  LogSmbiosData ((EFI_SMBIOS_TABLE_HEADER*)&mPhyMemArrayInfoType16, mPhyMemArrayInfoType16Strings, &MemArraySmbiosHandle);
-
-  //
-  // Update the memory device information and memory array map with the newly added type 16 handle
-  //
-  mMemDevInfoType17.MemoryArrayHandle = MemArraySmbiosHandle;
-  mMemArrMapInfoType19.MemoryArrayHandle = MemArraySmbiosHandle;
+  LogSmbiosData ((EFI_SMBIOS_TABLE_HEADER*)&mPhyMemArrayInfoType16, mPhyMemArrayInfoType16Strings, &mPhyMemArrayRecord);
 }
 
 /***********************************************************************
@@ -1084,7 +1086,15 @@ MemDevInfoUpdateSmbiosType17 (
   VOID
   )
 {
-  LogSmbiosData ((EFI_SMBIOS_TABLE_HEADER*)&mMemDevInfoType17, mMemDevInfoType17Strings, NULL);
+  EFI_STATUS Status;
+  UINTN      RecordIndex;
+
+  Status = LogSmbiosData ((EFI_SMBIOS_TABLE_HEADER*)&mMemDevInfoType17, mMemDevInfoType17Strings, &RecordIndex);
+  if (!EFI_ERROR (Status)) {
+    // Point Type17 MemoryArrayHandle at the Type16 record
+    LinkSmbiosHandle (RecordIndex,
+      OFFSET_OF (SMBIOS_TABLE_TYPE17, MemoryArrayHandle), mPhyMemArrayRecord);
+  }
 }
 
 /***********************************************************************
@@ -1097,6 +1107,7 @@ MemArrMapInfoUpdateSmbiosType19 (
 {
   EFI_STATUS Status;
   UINT32 InstalledMB = 0;
+  UINTN RecordIndex;
 
   // Note: Type 19 addresses are expressed in KB, not bytes
   // The memory layout used in all known Pi SoC's starts at 0
@@ -1117,7 +1128,12 @@ MemArrMapInfoUpdateSmbiosType19 (
   }
   mMemArrMapInfoType19.EndingAddress -= 1;
 
-  LogSmbiosData ((EFI_SMBIOS_TABLE_HEADER*)&mMemArrMapInfoType19, mMemArrMapInfoType19Strings, NULL);
+  Status = LogSmbiosData ((EFI_SMBIOS_TABLE_HEADER*)&mMemArrMapInfoType19, mMemArrMapInfoType19Strings, &RecordIndex);
+  if (!EFI_ERROR (Status)) {
+    // Point Type19 MemoryArrayHandle at the Type16 record
+    LinkSmbiosHandle (RecordIndex,
+      OFFSET_OF (SMBIOS_TABLE_TYPE19, MemoryArrayHandle), mPhyMemArrayRecord);
+  }
 }
 
 
@@ -1151,6 +1167,12 @@ PlatformSmbiosDriverEntryPoint (
     return Status;
   }
 
+  Status = SmbiosBuilderCreate (&mSmbiosBuilder);
+  ASSERT_EFI_ERROR (Status);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
   BIOSInfoUpdateSmbiosType0 ();
 
   SysInfoUpdateSmbiosType1 ();
@@ -1175,5 +1197,14 @@ PlatformSmbiosDriverEntryPoint (
 
   BootInfoUpdateSmbiosType32 ();
 
+  //
+  // Add all the records to the SMBIOS table in one go
+  //
+  Status = SmbiosBuilderInstall (mSmbiosBuilder, gImageHandle);
+  ASSERT_EFI_ERROR (Status);
+
+  SmbiosBuilderFree (mSmbiosBuilder);
+  mSmbiosBuilder = NULL;
+
   return EFI_SUCCESS;
 }
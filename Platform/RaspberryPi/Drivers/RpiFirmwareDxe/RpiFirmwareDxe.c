@@ -262,6 +262,71 @@ STATIC UINTN mDmaBufferBusAddress;
 
 STATIC SPIN_LOCK mMailboxLock;
 
+//
+// Board properties that cannot change while we are running. They are
+// fetched in a single batched transaction at start of day, and served
+// from here instead of going back to the VideoCore.
+//
+typedef struct {
+  UINT32                    TagId;
+  UINT32                    Size;
+  BOOLEAN                   Valid;
+  UINT8                     Value[8];
+} RPI_FW_CACHED_TAG;
+
+STATIC RPI_FW_CACHED_TAG mCachedTags[] = {
+  { RPI_MBOX_GET_REVISION,        sizeof (UINT32) },
+  { RPI_MBOX_GET_BOARD_MODEL,     sizeof (UINT32) },
+  { RPI_MBOX_GET_BOARD_REVISION,  sizeof (UINT32) },
+  { RPI_MBOX_GET_MAC_ADDRESS,     6 },
+  { RPI_MBOX_GET_BOARD_SERIAL,    sizeof (UINT64) },
+  { RPI_MBOX_GET_ARM_MEMSIZE,     sizeof (RPI_FW_ARM_MEMORY_TAG) },
+};
+
+STATIC
+BOOLEAN
+RpiFirmwareLookupCache (
+  IN  UINT32  TagId,
+  OUT VOID    *Value,
+  IN  UINTN   Size
+  )
+{
+  UINTN Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (mCachedTags); Index++) {
+    if (mCachedTags[Index].TagId == TagId) {
+      if (!mCachedTags[Index].Valid) {
+        return FALSE;
+      }
+      ASSERT (Size <= mCachedTags[Index].Size);
+      CopyMem (Value, mCachedTags[Index].Value, Size);
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+STATIC
+VOID
+RpiFirmwareUpdateCache (
+  IN  UINT32  TagId,
+  IN  VOID    *Value,
+  IN  UINTN   Size
+  )
+{
+  UINTN Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (mCachedTags); Index++) {
+    if (mCachedTags[Index].TagId == TagId) {
+      ASSERT (Size <= mCachedTags[Index].Size);
+      CopyMem (mCachedTags[Index].Value, Value, Size);
+      mCachedTags[Index].Valid = TRUE;
+      return;
+    }
+  }
+}
+
 STATIC
 BOOLEAN
 DrainMailbox (
@@ -370,6 +435,139 @@ MailboxTransaction (
   return EFI_SUCCESS;
 }
 
+/**
+  Pack several property tags into one buffer and process them with a
+  single mailbox transaction.
+
+  @param  Tags      The tags to query. Each Value is sent as the request
+                    value, and receives the response on return.
+  @param  TagCount  The number of entries in Tags.
+
+  @retval EFI_SUCCESS            The transaction completed. Tags the firmware
+                                 did not answer have a zero ResponseSize.
+  @retval EFI_INVALID_PARAMETER  Tags is NULL, TagCount is zero, or a tag
+                                 has a NULL Value with a non-zero ValueSize.
+  @retval EFI_BAD_BUFFER_SIZE    The tags do not fit in the mailbox buffer.
+  @retval EFI_DEVICE_ERROR       The mailbox transaction failed.
+
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+RpiFirmwareQueryTags (
+  IN OUT RASPBERRY_PI_FIRMWARE_TAG *Tags,
+  IN     UINTN                     TagCount
+  )
+{
+  RPI_FW_BUFFER_HEAD          *Head;
+  RPI_FW_TAG_HEAD             *TagHead;
+  UINT8                       *Ptr;
+  UINTN                       Index;
+  UINTN                       Length;
+  UINT32                      TagSize;
+  UINT32                      ResponseSize;
+  EFI_STATUS                  Status;
+  UINT32                      Result;
+
+  if (Tags == NULL || TagCount == 0) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Length = sizeof (RPI_FW_BUFFER_HEAD) + sizeof (UINT32);
+  for (Index = 0; Index < TagCount; Index++) {
+    if (Tags[Index].Value == NULL && Tags[Index].ValueSize != 0) {
+      return EFI_INVALID_PARAMETER;
+    }
+    Length += sizeof (RPI_FW_TAG_HEAD) + ALIGN_VALUE (Tags[Index].ValueSize, sizeof (UINT32));
+    if (Length > EFI_PAGES_TO_SIZE (NUM_PAGES)) {
+      return EFI_BAD_BUFFER_SIZE;
+    }
+  }
+
+  if (!AcquireSpinLockOrFail (&mMailboxLock)) {
+    DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __func__));
+    return EFI_DEVICE_ERROR;
+  }
+
+  Head = mDmaBuffer;
+  ZeroMem (Head, Length);
+
+  Head->BufferSize  = (UINT32)Length;
+  Head->Response    = 0;
+
+  Ptr = (UINT8 *)(Head + 1);
+  for (Index = 0; Index < TagCount; Index++) {
+    TagHead = (RPI_FW_TAG_HEAD *)Ptr;
+    TagSize = ALIGN_VALUE (Tags[Index].ValueSize, sizeof (UINT32));
+
+    TagHead->TagId        = Tags[Index].TagId;
+    TagHead->TagSize      = TagSize;
+    TagHead->TagValueSize = 0;
+    CopyMem (TagHead + 1, Tags[Index].Value, Tags[Index].ValueSize);
+
+    Ptr += sizeof (*TagHead) + TagSize;
+  }
+
+  //
+  // The end tag is already zero.
+  //
+  Status = MailboxTransaction (Head->BufferSize, RPI_MBOX_VC_CHANNEL, &Result);
+
+  if (EFI_ERROR (Status) ||
+      Head->Response != RPI_MBOX_RESP_SUCCESS) {
+    DEBUG ((DEBUG_ERROR,
+      "%a: mailbox transaction error: Status == %r, Response == 0x%x\n",
+      __func__, Status, Head->Response));
+    ReleaseSpinLock (&mMailboxLock);
+    return EFI_DEVICE_ERROR;
+  }
+
+  Ptr = (UINT8 *)(Head + 1);
+  for (Index = 0; Index < TagCount; Index++) {
+    TagHead = (RPI_FW_TAG_HEAD *)Ptr;
+    TagSize = ALIGN_VALUE (Tags[Index].ValueSize, sizeof (UINT32));
+
+    Tags[Index].ResponseSize = 0;
+    if ((TagHead->TagValueSize & RPI_MBOX_VALUE_SIZE_RESPONSE_MASK) != 0) {
+      ResponseSize = TagHead->TagValueSize & ~RPI_MBOX_VALUE_SIZE_RESPONSE_MASK;
+      CopyMem (Tags[Index].Value, TagHead + 1, MIN (ResponseSize, Tags[Index].ValueSize));
+      Tags[Index].ResponseSize = ResponseSize;
+    }
+
+    Ptr += sizeof (*TagHead) + TagSize;
+  }
+  ReleaseSpinLock (&mMailboxLock);
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+VOID
+RpiFirmwarePopulateCache (
+  VOID
+  )
+{
+  RASPBERRY_PI_FIRMWARE_TAG   Tags[ARRAY_SIZE (mCachedTags)];
+  EFI_STATUS                  Status;
+  UINTN                       Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (mCachedTags); Index++) {
+    Tags[Index].TagId     = mCachedTags[Index].TagId;
+    Tags[Index].ValueSize = mCachedTags[Index].Size;
+    Tags[Index].Value     = mCachedTags[Index].Value;
+  }
+
+  Status = RpiFirmwareQueryTags (Tags, ARRAY_SIZE (Tags));
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "%a: batched query failed: %r\n", __func__, Status));
+    return;
+  }
+
+  for (Index = 0; Index < ARRAY_SIZE (mCachedTags); Index++) {
+    mCachedTags[Index].Valid = Tags[Index].ResponseSize >= mCachedTags[Index].Size;
+  }
+}
+
 STATIC
 EFI_STATUS
 EFIAPI
@@ -432,9 +630,16 @@ RpiFirmwareGetArmMemory (
   )
 {
   RPI_FW_GET_ARM_MEMORY_CMD   *Cmd;
+  RPI_FW_ARM_MEMORY_TAG       Cached;
   EFI_STATUS                  Status;
   UINT32                      Result;
 
+  if (RpiFirmwareLookupCache (RPI_MBOX_GET_ARM_MEMSIZE, &Cached, sizeof (Cached))) {
+    *Base = Cached.Base;
+    *Size = Cached.Size;
+    return EFI_SUCCESS;
+  }
+
   if (!AcquireSpinLockOrFail (&mMailboxLock)) {
     DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __func__));
     return EFI_DEVICE_ERROR;
@@ -464,6 +669,7 @@ RpiFirmwareGetArmMemory (
 
   *Base = Cmd->TagBody.Base;
   *Size = Cmd->TagBody.Size;
+  RpiFirmwareUpdateCache (RPI_MBOX_GET_ARM_MEMSIZE, &Cmd->TagBody, sizeof (Cmd->TagBody));
   ReleaseSpinLock (&mMailboxLock);
 
   return EFI_SUCCESS;
@@ -480,6 +686,10 @@ RpiFirmwareGetMacAddress (
   EFI_STATUS                  Status;
   UINT32                      Result;
 
+  if (RpiFirmwareLookupCache (RPI_MBOX_GET_MAC_ADDRESS, MacAddress, sizeof (Cmd->TagBody.MacAddress))) {
+    return EFI_SUCCESS;
+  }
+
   if (!AcquireSpinLockOrFail (&mMailboxLock)) {
     DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __func__));
     return EFI_DEVICE_ERROR;
@@ -507,11 +717,32 @@ RpiFirmwareGetMacAddress (
   }
 
   CopyMem (MacAddress, Cmd->TagBody.MacAddress, sizeof (Cmd->TagBody.MacAddress));
+  RpiFirmwareUpdateCache (RPI_MBOX_GET_MAC_ADDRESS, MacAddress, sizeof (Cmd->TagBody.MacAddress));
   ReleaseSpinLock (&mMailboxLock);
 
   return EFI_SUCCESS;
 }
 
+STATIC
+EFI_STATUS
+RpiFirmwareFixupSerial (
+  IN OUT UINT64 *Serial
+  )
+{
+  EFI_STATUS                  Status;
+
+  Status = EFI_SUCCESS;
+  // Some platforms return 0 or 0x0000000010000000 for serial.
+  // For those, try to use the MAC address.
+  if ((*Serial == 0) || ((*Serial & 0xFFFFFFFF0FFFFFFFULL) == 0)) {
+    Status = RpiFirmwareGetMacAddress ((UINT8*) Serial);
+    // Convert to a more user-friendly value
+    *Serial = SwapBytes64 (*Serial << 16);
+  }
+
+  return Status;
+}
+
 STATIC
 EFI_STATUS
 EFIAPI
@@ -523,6 +754,10 @@ RpiFirmwareGetSerial (
   EFI_STATUS                  Status;
   UINT32                      Result;
 
+  if (RpiFirmwareLookupCache (RPI_MBOX_GET_BOARD_SERIAL, Serial, sizeof (*Serial))) {
+    return RpiFirmwareFixupSerial (Serial);
+  }
+
   if (!AcquireSpinLockOrFail (&mMailboxLock)) {
     DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __func__));
     return EFI_DEVICE_ERROR;
@@ -550,16 +785,10 @@ RpiFirmwareGetSerial (
   }
 
   *Serial = Cmd->TagBody.Serial;
+  RpiFirmwareUpdateCache (RPI_MBOX_GET_BOARD_SERIAL, Serial, sizeof (*Serial));
   ReleaseSpinLock (&mMailboxLock);
-  // Some platforms return 0 or 0x0000000010000000 for serial.
-  // For those, try to use the MAC address.
-  if ((*Serial == 0) || ((*Serial & 0xFFFFFFFF0FFFFFFFULL) == 0)) {
-    Status = RpiFirmwareGetMacAddress ((UINT8*) Serial);
-    // Convert to a more user-friendly value
-    *Serial = SwapBytes64 (*Serial << 16);
-  }
 
-  return Status;
+  return RpiFirmwareFixupSerial (Serial);
 }
 
 STATIC
@@ -573,6 +802,10 @@ RpiFirmwareGetModel (
   EFI_STATUS                  Status;
   UINT32                      Result;
 
+  if (RpiFirmwareLookupCache (RPI_MBOX_GET_BOARD_MODEL, Model, sizeof (*Model))) {
+    return EFI_SUCCESS;
+  }
+
   if (!AcquireSpinLockOrFail (&mMailboxLock)) {
     DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __func__));
     return EFI_DEVICE_ERROR;
@@ -600,6 +833,7 @@ RpiFirmwareGetModel (
   }
 
   *Model = Cmd->TagBody.Model;
+  RpiFirmwareUpdateCache (RPI_MBOX_GET_BOARD_MODEL, Model, sizeof (*Model));
   ReleaseSpinLock (&mMailboxLock);
 
   return EFI_SUCCESS;
@@ -616,6 +850,10 @@ RpiFirmwareGetModelRevision (
   EFI_STATUS                    Status;
   UINT32                        Result;
 
+  if (RpiFirmwareLookupCache (RPI_MBOX_GET_BOARD_REVISION, Revision, sizeof (*Revision))) {
+    return EFI_SUCCESS;
+  }
+
   if (!AcquireSpinLockOrFail (&mMailboxLock)) {
     DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __func__));
     return EFI_DEVICE_ERROR;
@@ -643,6 +881,7 @@ RpiFirmwareGetModelRevision (
   }
 
   *Revision = Cmd->TagBody.Revision;
+  RpiFirmwareUpdateCache (RPI_MBOX_GET_BOARD_REVISION, Revision, sizeof (*Revision));
   ReleaseSpinLock (&mMailboxLock);
 
   return EFI_SUCCESS;
@@ -659,6 +898,10 @@ RpiFirmwareGetFirmwareRevision (
   EFI_STATUS                    Status;
   UINT32                        Result;
 
+  if (RpiFirmwareLookupCache (RPI_MBOX_GET_REVISION, Revision, sizeof (*Revision))) {
+    return EFI_SUCCESS;
+  }
+
   if (!AcquireSpinLockOrFail (&mMailboxLock)) {
     DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __func__));
     return EFI_DEVICE_ERROR;
@@ -686,6 +929,7 @@ RpiFirmwareGetFirmwareRevision (
   }
 
   *Revision = Cmd->TagBody.Revision;
+  RpiFirmwareUpdateCache (RPI_MBOX_GET_REVISION, Revision, sizeof (*Revision));
   ReleaseSpinLock (&mMailboxLock);
 
   return EFI_SUCCESS;
@@ -1301,7 +1545,7 @@ RpiFirmwareSetClockState (
 }
 
 STATIC
-VOID
+EFI_STATUS
 EFIAPI
 RpiFirmwareSetGpio (
   IN  UINT32  Gpio,
@@ -1314,7 +1558,7 @@ RpiFirmwareSetGpio (
 
   if (!AcquireSpinLockOrFail (&mMailboxLock)) {
     DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __func__));
-    return;
+    return EFI_DEVICE_ERROR;
   }
 
   Cmd = mDmaBuffer;
@@ -1339,18 +1583,21 @@ RpiFirmwareSetGpio (
     DEBUG ((DEBUG_ERROR,
       "%a: mailbox  transaction error: Status == %r, Response == 0x%x\n",
       __func__, Status, Cmd->BufferHead.Response));
+    Status = EFI_DEVICE_ERROR;
   }
   ReleaseSpinLock (&mMailboxLock);
+
+  return Status;
 }
 
 STATIC
-VOID
+EFI_STATUS
 EFIAPI
 RpiFirmwareSetLed (
   IN  BOOLEAN On
   )
 {
-  RpiFirmwareSetGpio (RPI_EXP_GPIO_LED, On);
+  return RpiFirmwareSetGpio (RPI_EXP_GPIO_LED, On);
 }
 
 STATIC
@@ -1526,7 +1773,8 @@ STATIC RASPBERRY_PI_FIRMWARE_PROTOCOL mRpiFirmwareProtocol = {
   RpiFirmwareNotifyXhciReset,
   RpiFirmwareGetCurrentClockState,
   RpiFirmwareSetClockState,
-  RpiFirmwareNotifyGpioSetCfg
+  RpiFirmwareNotifyGpioSetCfg,
+  RpiFirmwareQueryTags
 };
 
 /**
@@ -1576,6 +1824,8 @@ RpiFirmwareDxeInitialize (
   //
   ASSERT (!(mDmaBufferBusAddress & (BCM2836_MBOX_NUM_CHANNELS - 1)));
 
+  RpiFirmwarePopulateCache ();
+
   Status = gBS->InstallProtocolInterface (&ImageHandle,
                   &gRaspberryPiFirmwareProtocolGuid, EFI_NATIVE_INTERFACE,
                   &mRpiFirmwareProtocol);
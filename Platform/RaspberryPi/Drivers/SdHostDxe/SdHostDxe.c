@@ -28,6 +28,7 @@
 #include <IndustryStandard/Bcm2836.h>
 #include <IndustryStandard/RpiMbox.h>
 #include <IndustryStandard/Bcm2836SdHost.h>
+#include <IndustryStandard/Bcm2836Dma.h>
 
 #define SDHOST_BLOCK_BYTE_LENGTH            512
 
@@ -42,6 +43,18 @@
 
 #define IDENT_MODE_SD_CLOCK_FREQ_HZ         400000 // 400KHz
 
+// DMA data path
+#define SDHOST_DMA_CHANNEL                  4
+#define SDHOST_DMA_MIN_LENGTH               SDHOST_BLOCK_BYTE_LENGTH
+#define SDHOST_DATA_BUS_ADDRESS             DMA_PERIPHERAL_BUS_ADDRESS (SDHOST_OFFSET + 0x40)
+#define SDHOST_FIFO_READ_THRESHOLD          4
+#define SDHOST_FIFO_WRITE_THRESHOLD         4
+// The read DREQ stops once fewer than READ_THRESHOLD words are left
+#define SDHOST_READ_DRAIN_WORDS             (SDHOST_FIFO_READ_THRESHOLD - 1)
+
+// Activity LED is switched off this long after the last transfer
+#define LED_OFF_DELAY_100NS                 (50 * 10000) // 50ms
+
 // Macros adopted from MmcDxe internal header
 #define SDHOST_R0_READY_FOR_DATA            BIT8
 #define SDHOST_R0_CURRENTSTATE(Response)    ((Response >> 9) & 0xF)
@@ -51,6 +64,10 @@
 #define DEBUG_MMCHOST_SD_ERROR DEBUG_ERROR
 
 STATIC RASPBERRY_PI_FIRMWARE_PROTOCOL   *mFwProtocol;
+STATIC DMA_CONTROL_BLOCK                *mDmaControlBlock;
+STATIC EFI_PHYSICAL_ADDRESS             mDmaControlBlockBusAddress;
+STATIC EFI_EVENT                        mLedOffEvent;
+STATIC BOOLEAN                          mLedIsOn;
 
 // Per Physical Layer Simplified Specs
 #ifndef NDEBUG
@@ -495,6 +512,289 @@ SdReceiveResponse (
   return EFI_SUCCESS;
 }
 
+STATIC VOID
+SdHostLedOn (
+  VOID
+  )
+{
+  if (!mLedIsOn) {
+    //
+    // Only record the LED as on once the firmware has switched it, so that
+    // a failed request is retried on the next transfer.
+    //
+    if (!EFI_ERROR (mFwProtocol->SetLed (TRUE))) {
+      mLedIsOn = TRUE;
+    }
+  }
+}
+
+STATIC VOID
+SdHostLedOff (
+  VOID
+  )
+{
+  //
+  // Each LED change is a round trip through the VPU mailbox, so rather
+  // than switching it off after every transfer, defer that until the
+  // card has been idle for a while.
+  //
+  if (mLedOffEvent != NULL) {
+    gBS->SetTimer (mLedOffEvent, TimerRelative, LED_OFF_DELAY_100NS);
+  } else if (!EFI_ERROR (mFwProtocol->SetLed (FALSE))) {
+    mLedIsOn = FALSE;
+  }
+}
+
+STATIC VOID
+EFIAPI
+SdHostLedOffNotify (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  EFI_STATUS  Status;
+
+  if (mLedIsOn) {
+    //
+    // The mailbox may be busy with a request from another TPL. Keep the LED
+    // marked as on and try again later rather than leave it lit.
+    //
+    Status = mFwProtocol->SetLed (FALSE);
+    if (EFI_ERROR (Status)) {
+      gBS->SetTimer (mLedOffEvent, TimerRelative, LED_OFF_DELAY_100NS);
+      return;
+    }
+    mLedIsOn = FALSE;
+  }
+}
+
+STATIC VOID
+EFIAPI
+SdHostExitBootServices (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  if (mLedIsOn) {
+    mFwProtocol->SetLed (FALSE);
+    mLedIsOn = FALSE;
+  }
+
+  if (mDmaControlBlock != NULL) {
+    MmioWrite32 (DMA_CS (SDHOST_DMA_CHANNEL), DMA_CS_RESET);
+  }
+}
+
+STATIC EFI_STATUS
+SdHostPioTransfer (
+  IN BOOLEAN                  IsWrite,
+  IN UINT32*                  Buffer,
+  IN UINTN                    Length
+  )
+{
+  UINTN NumWords = Length / 4;
+  UINTN WordIdx = 0;
+  UINT32 PollCount = 0;
+
+  while (WordIdx < NumWords) {
+    UINT32 Fill = SDHOST_EDM_FIFO_FILL (MmioRead32 (SDHOST_EDM));
+    UINTN Burst = IsWrite ? SDHOST_FIFO_WORDS - Fill : Fill;
+
+    if (Burst == 0) {
+      if ((MmioRead32 (SDHOST_HSTS) & SDHOST_HSTS_ERROR) != 0 ||
+          ++PollCount == FIFO_MAX_POLL_COUNT) {
+        DEBUG ((DEBUG_MMCHOST_SD_ERROR,
+          "SdHost: SdHostPioTransfer(): Block Word%d %a poll failed\n",
+          WordIdx, IsWrite ? "write" : "read"));
+        SdHostDumpStatus ();
+        MmioWrite32 (SDHOST_HSTS, SDHOST_HSTS_CLEAR);
+        return EFI_TIMEOUT;
+      }
+
+      gBS->Stall (CMD_STALL_AFTER_POLL_US);
+      continue;
+    }
+
+    // Move everything the FIFO can take without re-checking the status
+    PollCount = 0;
+    Burst = MIN (Burst, NumWords - WordIdx);
+    while (Burst-- > 0) {
+      if (IsWrite) {
+        MmioWrite32 (SDHOST_DATA, Buffer[WordIdx++]);
+      } else {
+        Buffer[WordIdx++] = MmioRead32 (SDHOST_DATA);
+      }
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Move a multi-block transfer between the SdHost FIFO and Buffer with the
+  DMA engine, paced by the SDHOST DREQ.
+
+  @retval EFI_SUCCESS      The data was transferred.
+  @retval EFI_UNSUPPORTED  The transfer is not suitable for DMA. Nothing has
+                           been moved and the caller should fall back to PIO.
+  @retval EFI_TIMEOUT      The DMA engine stopped making progress.
+  @retval EFI_DEVICE_ERROR The DMA engine or SdHost reported an error.
+**/
+STATIC EFI_STATUS
+SdHostDmaTransfer (
+  IN BOOLEAN                  IsWrite,
+  IN UINT32*                  Buffer,
+  IN UINTN                    Length
+  )
+{
+  EFI_STATUS Status;
+  EFI_PHYSICAL_ADDRESS BusAddress;
+  VOID *Mapping;
+  UINTN MapLength;
+  UINT32 DmaLength;
+  UINT32 Cs;
+  UINT32 Remaining;
+  UINT32 LastRemaining;
+  UINT32 PollCount;
+  UINT32 Tail[SDHOST_READ_DRAIN_WORDS];
+
+  if (mDmaControlBlock == NULL ||
+      Length < SDHOST_DMA_MIN_LENGTH ||
+      Length > DMA_TXFR_LEN_MAX ||
+      ((UINTN)Buffer & 0x3) != 0) {
+    return EFI_UNSUPPORTED;
+  }
+
+  MapLength = Length;
+  Status = DmaMap (IsWrite ? MapOperationBusMasterRead : MapOperationBusMasterWrite,
+             Buffer, &MapLength, &BusAddress, &Mapping);
+  if (EFI_ERROR (Status)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (MapLength < Length || BusAddress + Length > (UINT64)MAX_UINT32 + 1) {
+    DmaUnmap (Mapping);
+    return EFI_UNSUPPORTED;
+  }
+
+  //
+  // The read DREQ is only raised while the FIFO holds at least the read
+  // threshold, so the final words of a read are drained by PIO instead.
+  //
+  DmaLength = (UINT32)Length;
+  if (!IsWrite) {
+    DmaLength -= sizeof (Tail);
+  }
+
+  if (IsWrite) {
+    mDmaControlBlock->TransferInfo = DMA_TI_SRC_INC | DMA_TI_DEST_DREQ;
+    mDmaControlBlock->SourceAddress = (UINT32)BusAddress;
+    mDmaControlBlock->DestinationAddress = SDHOST_DATA_BUS_ADDRESS;
+  } else {
+    mDmaControlBlock->TransferInfo = DMA_TI_DEST_INC | DMA_TI_SRC_DREQ;
+    mDmaControlBlock->SourceAddress = SDHOST_DATA_BUS_ADDRESS;
+    mDmaControlBlock->DestinationAddress = (UINT32)BusAddress;
+  }
+  mDmaControlBlock->TransferInfo |= DMA_TI_PERMAP (DMA_DREQ_SDHOST) | DMA_TI_WAIT_RESP;
+  mDmaControlBlock->TransferLength = DmaLength;
+  mDmaControlBlock->Stride = 0;
+  mDmaControlBlock->NextControlBlock = 0;
+  MemoryFence ();
+
+  MmioWrite32 (DMA_CS (SDHOST_DMA_CHANNEL), DMA_CS_END | DMA_CS_INT);
+  MmioWrite32 (DMA_DEBUG (SDHOST_DMA_CHANNEL), DMA_DEBUG_ERROR);
+  MmioWrite32 (DMA_CONBLK_AD (SDHOST_DMA_CHANNEL), (UINT32)mDmaControlBlockBusAddress);
+  MmioWrite32 (DMA_CS (SDHOST_DMA_CHANNEL), DMA_CS_ACTIVE | DMA_CS_WAIT_FOR_WRITES);
+
+  //
+  // A large transfer at a slow card clock can take a long time, so only
+  // time out when the engine has stopped making progress.
+  //
+  Status = EFI_SUCCESS;
+  LastRemaining = DmaLength;
+  PollCount = 0;
+  for (;;) {
+    Cs = MmioRead32 (DMA_CS (SDHOST_DMA_CHANNEL));
+    if ((Cs & DMA_CS_ERROR) != 0 ||
+        (MmioRead32 (SDHOST_HSTS) & SDHOST_HSTS_ERROR) != 0) {
+      Status = EFI_DEVICE_ERROR;
+      break;
+    }
+
+    if ((Cs & DMA_CS_END) != 0) {
+      break;
+    }
+
+    Remaining = MmioRead32 (DMA_TXFR_LEN (SDHOST_DMA_CHANNEL));
+    if (Remaining != LastRemaining) {
+      LastRemaining = Remaining;
+      PollCount = 0;
+    } else if (++PollCount == FIFO_MAX_POLL_COUNT) {
+      Status = EFI_TIMEOUT;
+      break;
+    }
+
+    gBS->Stall (CMD_STALL_AFTER_POLL_US);
+  }
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_MMCHOST_SD_ERROR,
+      "SdHost: SdHostDmaTransfer(): %a of 0x%x bytes failed: %r, CS 0x%x, DEBUG 0x%x, %u bytes left\n",
+      IsWrite ? "Write" : "Read", DmaLength, Status, Cs,
+      MmioRead32 (DMA_DEBUG (SDHOST_DMA_CHANNEL)),
+      MmioRead32 (DMA_TXFR_LEN (SDHOST_DMA_CHANNEL))));
+    MmioWrite32 (DMA_CS (SDHOST_DMA_CHANNEL), DMA_CS_RESET);
+    SdHostDumpStatus ();
+    MmioWrite32 (SDHOST_HSTS, SDHOST_HSTS_CLEAR);
+  } else if (!IsWrite) {
+    Status = SdHostPioTransfer (FALSE, Tail, sizeof (Tail));
+  }
+
+  //
+  // Unmapping may copy a bounce buffer back over the whole of Buffer,
+  // so the PIO-drained tail can only be stored afterwards.
+  //
+  DmaUnmap (Mapping);
+  if (!IsWrite && !EFI_ERROR (Status)) {
+    CopyMem ((UINT8*)Buffer + DmaLength, Tail, sizeof (Tail));
+  }
+
+  return Status;
+}
+
+STATIC VOID
+SdHostDmaInitialize (
+  VOID
+  )
+{
+  EFI_STATUS Status;
+  VOID *ControlBlock;
+  VOID *Mapping;
+  UINTN BufferSize;
+
+  Status = DmaAllocateBuffer (EfiBootServicesData,
+             EFI_SIZE_TO_PAGES (sizeof (DMA_CONTROL_BLOCK)), &ControlBlock);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_MMCHOST_SD_ERROR, "SdHost: DmaAllocateBuffer: %r, using PIO\n", Status));
+    return;
+  }
+
+  BufferSize = sizeof (DMA_CONTROL_BLOCK);
+  Status = DmaMap (MapOperationBusMasterCommonBuffer, ControlBlock, &BufferSize,
+             &mDmaControlBlockBusAddress, &Mapping);
+  if (EFI_ERROR (Status) || mDmaControlBlockBusAddress > MAX_UINT32) {
+    DEBUG ((DEBUG_MMCHOST_SD_ERROR, "SdHost: DmaMap: %r, using PIO\n", Status));
+    DmaFreeBuffer (EFI_SIZE_TO_PAGES (sizeof (DMA_CONTROL_BLOCK)), ControlBlock);
+    return;
+  }
+
+  ASSERT ((mDmaControlBlockBusAddress % DMA_CONTROL_BLOCK_ALIGNMENT) == 0);
+  mDmaControlBlock = ControlBlock;
+
+  MmioOr32 (DMA_ENABLE, 1 << SDHOST_DMA_CHANNEL);
+  MmioWrite32 (DMA_CS (SDHOST_DMA_CHANNEL), DMA_CS_RESET);
+}
+
 STATIC EFI_STATUS
 SdReadBlockData (
   IN EFI_MMC_HOST_PROTOCOL    *This,
@@ -509,38 +809,14 @@ SdReadBlockData (
   ASSERT (Buffer != NULL);
   ASSERT (Length % 4 == 0);
 
-  EFI_STATUS Status = EFI_SUCCESS;
-
-  mFwProtocol->SetLed (TRUE);
-  {
-    UINT32 NumWords = Length / 4;
-    UINT32 WordIdx;
-
-    for (WordIdx = 0; WordIdx < NumWords; ++WordIdx) {
-      UINT32 PollCount = 0;
-      while (PollCount < FIFO_MAX_POLL_COUNT) {
-        UINT32 Hsts = MmioRead32 (SDHOST_HSTS);
-        if ((Hsts & SDHOST_HSTS_DATA_FLAG) != 0) {
-          MmioWrite32 (SDHOST_HSTS, SDHOST_HSTS_DATA_FLAG);
-          Buffer[WordIdx] = MmioRead32 (SDHOST_DATA);
-          break;
-        }
-
-        ++PollCount;
-        gBS->Stall (CMD_STALL_AFTER_RETRY_US);
-      }
+  EFI_STATUS Status;
 
-      if (PollCount == FIFO_MAX_POLL_COUNT) {
-        DEBUG ((DEBUG_MMCHOST_SD_ERROR,
-            "SdHost: SdReadBlockData(): Block Word%d read poll timed-out\n", WordIdx));
-        SdHostDumpStatus ();
-        MmioWrite32 (SDHOST_HSTS, SDHOST_HSTS_CLEAR);
-        Status = EFI_TIMEOUT;
-        break;
-      }
-    }
+  SdHostLedOn ();
+  Status = SdHostDmaTransfer (FALSE, Buffer, Length);
+  if (Status == EFI_UNSUPPORTED) {
+    Status = SdHostPioTransfer (FALSE, Buffer, Length);
   }
-  mFwProtocol->SetLed (FALSE);
+  SdHostLedOff ();
 
   return Status;
 }
@@ -560,37 +836,14 @@ SdWriteBlockData (
   ASSERT (Buffer != NULL);
   ASSERT (Length % SDHOST_BLOCK_BYTE_LENGTH == 0);
 
-  EFI_STATUS Status = EFI_SUCCESS;
-
-  mFwProtocol->SetLed (TRUE);
-  {
-    UINT32 NumWords = Length / 4;
-    UINT32 WordIdx;
-
-    for (WordIdx = 0; WordIdx < NumWords; ++WordIdx) {
-      UINT32 PollCount = 0;
-      while (PollCount < FIFO_MAX_POLL_COUNT) {
-        if (MmioRead32 (SDHOST_HSTS) & SDHOST_HSTS_DATA_FLAG) {
-          MmioWrite32 (SDHOST_HSTS, SDHOST_HSTS_DATA_FLAG);
-          MmioWrite32 (SDHOST_DATA, Buffer[WordIdx]);
-          break;
-        }
-
-        ++PollCount;
-        gBS->Stall (CMD_STALL_AFTER_RETRY_US);
-      }
+  EFI_STATUS Status;
 
-      if (PollCount == FIFO_MAX_POLL_COUNT) {
-        DEBUG ((DEBUG_MMCHOST_SD_ERROR,
-          "SdHost: SdWriteBlockData(): Block Word%d write poll timed-out\n", WordIdx));
-        SdHostDumpStatus ();
-        MmioWrite32 (SDHOST_HSTS, SDHOST_HSTS_CLEAR);
-        Status = EFI_TIMEOUT;
-        break;
-      }
-    }
+  SdHostLedOn ();
+  Status = SdHostDmaTransfer (TRUE, Buffer, Length);
+  if (Status == EFI_UNSUPPORTED) {
+    Status = SdHostPioTransfer (TRUE, Buffer, Length);
   }
-  mFwProtocol->SetLed (FALSE);
+  SdHostLedOff ();
 
   return Status;
 }
@@ -672,6 +925,14 @@ SdNotifyState (
     Hcfg |= SDHOST_HCFG_SLOW_CARD; // Use all bits of CDIV in DataMode
     MmioWrite32 (SDHOST_HCFG, Hcfg);
 
+    // FIFO thresholds at which the DMA DREQ is raised
+    UINT32 Edm = MmioRead32 (SDHOST_EDM);
+    Edm &= ~(SDHOST_EDM_READ_THRESHOLD (SDHOST_EDM_THRESHOLD_MASK) |
+             SDHOST_EDM_WRITE_THRESHOLD (SDHOST_EDM_THRESHOLD_MASK));
+    Edm |= SDHOST_EDM_READ_THRESHOLD (SDHOST_FIFO_READ_THRESHOLD) |
+           SDHOST_EDM_WRITE_THRESHOLD (SDHOST_FIFO_WRITE_THRESHOLD);
+    MmioWrite32 (SDHOST_EDM, Edm);
+
     // Set default clock frequency
     EFI_STATUS Status = SdHostSetClockFrequency (IDENT_MODE_SD_CLOCK_FREQ_HZ);
     if (EFI_ERROR (Status)) {
@@ -810,6 +1071,7 @@ SdHostInitialize (
 {
   EFI_STATUS Status;
   EFI_HANDLE Handle = NULL;
+  EFI_EVENT ExitBootServicesEvent;
 
   if (PcdGet32 (PcdSdIsArasan)) {
     DEBUG ((DEBUG_INFO, "SD is not routed to SdHost\n"));
@@ -831,6 +1093,21 @@ SdHostInitialize (
   DEBUG ((DEBUG_MMCHOST_SD, " - CMD_MAX_RETRY_COUNT=%d\n", CMD_MAX_RETRY_COUNT));
   DEBUG ((DEBUG_MMCHOST_SD, " - CMD_STALL_AFTER_RETRY_US=%dus\n", CMD_STALL_AFTER_RETRY_US));
 
+  SdHostDmaInitialize ();
+  DEBUG ((DEBUG_MMCHOST_SD, " - DMA channel %d %a\n", SDHOST_DMA_CHANNEL,
+    mDmaControlBlock != NULL ? "enabled" : "disabled"));
+
+  Status = gBS->CreateEvent (EVT_TIMER | EVT_NOTIFY_SIGNAL, TPL_CALLBACK,
+                  SdHostLedOffNotify, NULL, &mLedOffEvent);
+  if (EFI_ERROR (Status)) {
+    mLedOffEvent = NULL;
+  }
+
+  Status = gBS->CreateEventEx (EVT_NOTIFY_SIGNAL, TPL_CALLBACK,
+                  SdHostExitBootServices, NULL,
+                  &gEfiEventExitBootServicesGuid, &ExitBootServicesEvent);
+  ASSERT_EFI_ERROR (Status);
+
   Status = gBS->InstallMultipleProtocolInterfaces (
     &Handle,
     &gRaspberryPiMmcHostProtocolGuid,
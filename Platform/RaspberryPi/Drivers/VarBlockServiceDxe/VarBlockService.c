@@ -86,6 +86,33 @@ EFI_FW_VOL_BLOCK_DEVICE mFvbDeviceTemplate = {
 };
 
 
+STATIC
+VOID
+VarStoreMarkDirty (
+  IN UINTN Address,
+  IN UINTN Length
+  )
+{
+  UINTN Lba;
+  UINTN LastLba;
+
+  mFvInstance->Dirty = TRUE;
+
+  if (Length == 0 || mFvInstance->DirtyMap == NULL) {
+    return;
+  }
+
+  Lba = (Address - mFvInstance->FvBase) / mFvInstance->BlockSize;
+  LastLba = (Address + Length - 1 - mFvInstance->FvBase) / mFvInstance->BlockSize;
+  for (; Lba <= LastLba && Lba < mFvInstance->DirtyMax; Lba++) {
+    if ((mFvInstance->DirtyMap[Lba / 8] & (1 << (Lba % 8))) == 0) {
+      mFvInstance->DirtyMap[Lba / 8] |= (UINT8)(1 << (Lba % 8));
+      mFvInstance->DirtyCount++;
+    }
+  }
+}
+
+
 EFI_STATUS
 VarStoreWrite (
   IN     UINTN Address,
@@ -94,7 +121,7 @@ VarStoreWrite (
   )
 {
   CopyMem ((VOID*)Address, Buffer, *NumBytes);
-  mFvInstance->Dirty = TRUE;
+  VarStoreMarkDirty (Address, *NumBytes);
 
   return EFI_SUCCESS;
 }
@@ -107,7 +134,7 @@ VarStoreErase (
   )
 {
   SetMem ((VOID*)Address, LbaLength, 0xff);
-  mFvInstance->Dirty = TRUE;
+  VarStoreMarkDirty (Address, LbaLength);
 
   return EFI_SUCCESS;
 }
@@ -848,6 +875,15 @@ FvbInitialize (
    */
   mFvInstance->MappedFile = L"RPI_EFI.FD";
 
+  mFvInstance->BlockSize = PcdGet32 (PcdFirmwareBlockSize);
+  mFvInstance->DirtyMax = Length / mFvInstance->BlockSize;
+  mFvInstance->DirtyMap = AllocateRuntimeZeroPool ((mFvInstance->DirtyMax + 7) / 8);
+  if (mFvInstance->DirtyMap == NULL) {
+    FreePool (mFvInstance);
+    mFvInstance = NULL;
+    return EFI_OUT_OF_RESOURCES;
+  }
+
   Status = ValidateFvHeader (mFvInstance->VolumeHeader);
   if (!EFI_ERROR (Status)) {
     if (mFvInstance->VolumeHeader->FvLength != Length ||
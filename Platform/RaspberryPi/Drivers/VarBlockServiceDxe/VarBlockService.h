@@ -33,6 +33,14 @@ typedef struct {
   EFI_DEVICE_PATH_PROTOCOL   *Device;
   CHAR16                     *MappedFile;
   BOOLEAN                    Dirty;
+  //
+  // A bitmap with one bit per LBA marking the blocks modified since the
+  // last dump, and the number of bits set in it.
+  //
+  UINTN                      BlockSize;
+  UINT8                      *DirtyMap;
+  UINTN                      DirtyCount;
+  UINTN                      DirtyMax;
 } EFI_FW_VOL_INSTANCE;
 
 extern EFI_FW_VOL_INSTANCE *mFvInstance;
@@ -184,6 +192,14 @@ FileWrite (
   IN UINTN             Size
   );
 
+EFI_STATUS
+FileRead (
+  IN EFI_FILE_PROTOCOL *File,
+  IN UINTN             Offset,
+  IN UINTN             Buffer,
+  IN UINTN             Size
+  );
+
 EFI_STATUS
 CheckStore (
   IN  EFI_HANDLE SimpleFileSystemHandle,
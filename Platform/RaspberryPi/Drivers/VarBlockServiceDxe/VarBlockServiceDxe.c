@@ -10,6 +10,8 @@
 
 #include "VarBlockService.h"
 
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
 #include <Protocol/ResetNotification.h>
 
 //
@@ -110,6 +112,7 @@ FvbVirtualAddressChangeEvent (
 {
   EfiConvertPointer (0x0, (VOID**)&mFvInstance->FvBase);
   EfiConvertPointer (0x0, (VOID**)&mFvInstance->VolumeHeader);
+  EfiConvertPointer (0x0, (VOID**)&mFvInstance->DirtyMap);
   EfiConvertPointer (0x0, (VOID**)&mFvInstance);
 }
 
@@ -134,10 +137,114 @@ InstallVirtualAddressChangeHandler (
 }
 
 
+//
+// Write the blocks marked in the dirty bitmap back to the mapped file, in
+// LBA order, one write per run of consecutive dirty blocks. Like the full
+// dump this replaces, it updates the file in place and is not atomic: if
+// it is interrupted the file may hold a mix of old and new blocks.
+//
+STATIC
+EFI_STATUS
+DumpDirtyBlocks (
+  IN EFI_FILE_PROTOCOL *File
+  )
+{
+  EFI_STATUS Status;
+  UINTN Lba;
+  UINTN Count;
+
+  for (Lba = 0; Lba < mFvInstance->DirtyMax; Lba += Count) {
+    for (Count = 0; Lba + Count < mFvInstance->DirtyMax; Count++) {
+      if ((mFvInstance->DirtyMap[(Lba + Count) / 8] & (1 << ((Lba + Count) % 8))) == 0) {
+        break;
+      }
+    }
+    if (Count == 0) {
+      Count = 1;
+      continue;
+    }
+
+    Status = FileWrite (File,
+               mFvInstance->Offset + Lba * mFvInstance->BlockSize,
+               mFvInstance->FvBase + Lba * mFvInstance->BlockSize,
+               Count * mFvInstance->BlockSize);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  Status = File->Flush (File);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  DEBUG ((DEBUG_INFO, "Dumped %Lu of %Lu variable store blocks\n",
+    (UINT64)mFvInstance->DirtyCount,
+    (UINT64)(mFvInstance->FvLength / mFvInstance->BlockSize)));
+  ZeroMem (mFvInstance->DirtyMap, (mFvInstance->DirtyMax + 7) / 8);
+  mFvInstance->DirtyCount = 0;
+  return EFI_SUCCESS;
+}
+
+
+//
+// Bring a newly found mapped file in sync with the variable store. It
+// normally is the file the firmware was loaded from, so only the blocks
+// that differ are written instead of the whole variable store.
+//
+STATIC
+EFI_STATUS
+SyncAllBlocks (
+  IN EFI_FILE_PROTOCOL *File
+  )
+{
+  EFI_STATUS Status;
+  UINT8 *Buffer;
+  UINTN Lba;
+  UINTN Written;
+
+  Buffer = AllocatePool (mFvInstance->BlockSize);
+  if (Buffer == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Written = 0;
+  for (Lba = 0; Lba < mFvInstance->FvLength / mFvInstance->BlockSize; Lba++) {
+    Status = FileRead (File,
+               mFvInstance->Offset + Lba * mFvInstance->BlockSize,
+               (UINTN)Buffer,
+               mFvInstance->BlockSize);
+    if (!EFI_ERROR (Status) &&
+        CompareMem (Buffer, (VOID*)(mFvInstance->FvBase + Lba * mFvInstance->BlockSize),
+          mFvInstance->BlockSize) == 0) {
+      continue;
+    }
+
+    Status = FileWrite (File,
+               mFvInstance->Offset + Lba * mFvInstance->BlockSize,
+               mFvInstance->FvBase + Lba * mFvInstance->BlockSize,
+               mFvInstance->BlockSize);
+    if (EFI_ERROR (Status)) {
+      FreePool (Buffer);
+      return Status;
+    }
+    Written++;
+  }
+
+  FreePool (Buffer);
+  DEBUG ((DEBUG_INFO, "Synced %Lu variable store blocks\n", (UINT64)Written));
+  ZeroMem (mFvInstance->DirtyMap, (mFvInstance->DirtyMax + 7) / 8);
+  mFvInstance->DirtyCount = 0;
+  mFvInstance->Dirty = FALSE;
+  return EFI_SUCCESS;
+}
+
+
 STATIC
 EFI_STATUS
 DoDump (
-  IN EFI_DEVICE_PATH_PROTOCOL *Device
+  IN EFI_DEVICE_PATH_PROTOCOL *Device,
+  IN BOOLEAN                  FullSync
   )
 {
   EFI_STATUS Status;
@@ -152,10 +259,11 @@ DoDump (
     return Status;
   }
 
-  Status = FileWrite (File,
-             mFvInstance->Offset,
-             mFvInstance->FvBase,
-             mFvInstance->FvLength);
+  if (FullSync) {
+    Status = SyncAllBlocks (File);
+  } else {
+    Status = DumpDirtyBlocks (File);
+  }
   FileClose (File);
   return Status;
 }
@@ -180,7 +288,7 @@ DumpVars (
     return;
   }
 
-  Status = DoDump (mFvInstance->Device);
+  Status = DoDump (mFvInstance->Device, FALSE);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Couldn't dump '%s'\n", mFvInstance->MappedFile));
     ASSERT_EFI_ERROR (Status);
@@ -334,7 +442,7 @@ OnSimpleFileSystemInstall (
       continue;
     }
 
-    Status = DoDump (Device);
+    Status = DoDump (Device, TRUE);
     if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_ERROR, "Couldn't update '%s'\n", mFvInstance->MappedFile));
       ASSERT_EFI_ERROR (Status);
@@ -89,7 +89,7 @@ EFI_STATUS
   );
 
 typedef
-VOID
+EFI_STATUS
 (EFIAPI *SET_LED) (
   BOOLEAN On
   );
@@ -171,6 +171,34 @@ EFI_STATUS
   UINTN State
   );
 
+//
+// One property tag of a batched firmware query. Value holds the request
+// value on input and receives up to ValueSize bytes of the response.
+// ResponseSize is the response length reported by the firmware, or zero
+// if the firmware did not answer the tag.
+//
+typedef struct {
+  UINT32 TagId;
+  UINT32 ValueSize;
+  VOID   *Value;
+  UINT32 ResponseSize;
+} RASPBERRY_PI_FIRMWARE_TAG;
+
+//
+// Request and response value of the clock rate tags.
+//
+typedef struct {
+  UINT32 ClockId;
+  UINT32 ClockRate;
+} RASPBERRY_PI_FIRMWARE_CLOCK_RATE;
+
+typedef
+EFI_STATUS
+(EFIAPI *QUERY_TAGS) (
+  IN OUT RASPBERRY_PI_FIRMWARE_TAG *Tags,
+  IN     UINTN                     TagCount
+  );
+
 typedef struct {
   SET_POWER_STATE        SetPowerState;
   GET_MAC_ADDRESS        GetMacAddress;
@@ -197,6 +225,7 @@ typedef struct {
   GET_CLOCK_STATE        GetClockState;
   SET_CLOCK_STATE        SetClockState;
   GPIO_SET_CFG           SetGpioConfig;
+  QUERY_TAGS             QueryTags;
 } RASPBERRY_PI_FIRMWARE_PROTOCOL;
 
 extern EFI_GUID gRaspberryPiFirmwareProtocolGuid;
@@ -42,6 +42,39 @@ FlashFvbAddressChangeEvent (
   EfiConvertPointer (0x0, (VOID **)&mNvStorageBase);
 }
 
+/**
+  Report the Flash operations issued for the NV store during boot.
+
+  @param[in]    Event   The Event that is being processed
+  @param[in]    Context Event Context
+**/
+VOID
+EFIAPI
+FlashFvbReadyToBootEvent (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  FLASH_STATISTICS  Statistics;
+
+  if (EFI_ERROR (FlashGetStatistics (&Statistics))) {
+    return;
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "%a: %ld MM communications, %ld reads (0x%lx bytes), %ld writes (0x%lx bytes), %ld erases (0x%lx bytes)\n",
+    __func__,
+    Statistics.MmCommunicateCount,
+    Statistics.ReadCount,
+    Statistics.BytesRead,
+    Statistics.WriteCount,
+    Statistics.BytesWritten,
+    Statistics.EraseCount,
+    Statistics.BytesErased
+    ));
+}
+
 /**
   The GetAttributes() function retrieves the attributes and
   current settings of the block.
@@ -425,25 +458,57 @@ FlashFvbDxeErase (
   VA_LIST     Args;
   EFI_LBA     Start;
   UINTN       Length;
+  EFI_LBA     RangeStart;
+  UINTN       RangeLength;
   EFI_STATUS  Status;
 
-  Status = EFI_SUCCESS;
+  Status      = EFI_SUCCESS;
+  RangeStart  = 0;
+  RangeLength = 0;
 
   VA_START (Args, This);
 
+  //
+  // Merge ranges that continue the previous one, so that adjacent ranges are
+  // erased with a single MM communication.
+  //
   for (Start = VA_ARG (Args, EFI_LBA);
        Start != EFI_LBA_LIST_TERMINATOR;
        Start = VA_ARG (Args, EFI_LBA))
   {
     Length = VA_ARG (Args, UINTN);
-    Status = FlashEraseCommand (
-               mNvFlashBase + Start * mFlashBlockSize,
-               Length * mFlashBlockSize
-               );
+    if (Length == 0) {
+      continue;
+    }
+
+    if ((RangeLength != 0) && (Start == RangeStart + RangeLength)) {
+      RangeLength += Length;
+      continue;
+    }
+
+    if (RangeLength != 0) {
+      Status = FlashEraseCommand (
+                 mNvFlashBase + RangeStart * mFlashBlockSize,
+                 RangeLength * mFlashBlockSize
+                 );
+      if (EFI_ERROR (Status)) {
+        break;
+      }
+    }
+
+    RangeStart  = Start;
+    RangeLength = Length;
   }
 
   VA_END (Args);
 
+  if (!EFI_ERROR (Status) && (RangeLength != 0)) {
+    Status = FlashEraseCommand (
+               mNvFlashBase + RangeStart * mFlashBlockSize,
+               RangeLength * mFlashBlockSize
+               );
+  }
+
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Failed to do flash erase\n"));
     return EFI_DEVICE_ERROR;
@@ -472,6 +537,7 @@ FlashFvbDxeInitialize (
   EFI_STATUS  Status;
   EFI_HANDLE  FvbHandle = NULL;
   EFI_EVENT   VirtualAddressChangeEvent;
+  EFI_EVENT   ReadyToBootEvent;
 
   // Get NV store FV info
   mFlashBlockSize = FixedPcdGet32 (PcdFvBlockSize);
@@ -512,6 +578,16 @@ FlashFvbDxeInitialize (
                   );
   ASSERT_EFI_ERROR (Status);
 
+  Status = gBS->CreateEventEx (
+                  EVT_NOTIFY_SIGNAL,
+                  TPL_CALLBACK,
+                  FlashFvbReadyToBootEvent,
+                  NULL,
+                  &gEfiEventReadyToBootGuid,
+                  &ReadyToBootEvent
+                  );
+  ASSERT_EFI_ERROR (Status);
+
   Status = gBS->InstallMultipleProtocolInterfaces (
                   &FvbHandle,
                   &gEfiFirmwareVolumeBlockProtocolGuid,
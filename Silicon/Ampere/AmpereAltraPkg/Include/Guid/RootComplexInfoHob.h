@@ -104,6 +104,8 @@ typedef struct {
   BOOLEAN             Active;              // Active? Used in bi-furcation mode
   BOOLEAN             LinkUp;              // PHY and PCIE linkup
   BOOLEAN             HotPlug;             // Hotplug support
+  UINT32              TrainingTime;        // Microseconds from training start until the link settled
+  UINT8               RetrainCount;        // Soft resets issued to recover the link quality
 } AC01_PCIE_CONTROLLER;
 
 //
@@ -9,6 +9,19 @@
 #ifndef FLASH_LIB_H_
 #define FLASH_LIB_H_
 
+//
+// Counters of the Flash operations completed through the FlashLib
+//
+typedef struct {
+  UINT64    MmCommunicateCount;   // Number of MM communications for Flash operations
+  UINT64    ReadCount;
+  UINT64    WriteCount;
+  UINT64    EraseCount;
+  UINT64    BytesRead;
+  UINT64    BytesWritten;
+  UINT64    BytesErased;
+} FLASH_STATISTICS;
+
 /**
   Get the information about the Flash region to store the FailSafe status.
 
@@ -115,4 +128,18 @@ FlashReadCommand (
   IN  UINT32  Length
   );
 
+/**
+  Retrieve the counters of the Flash operations completed so far.
+
+  @param[out] Statistics         Pointer to the counters.
+
+  @retval EFI_SUCCESS            Operation succeeded.
+  @retval EFI_INVALID_PARAMETER  Statistics is NULL.
+**/
+EFI_STATUS
+EFIAPI
+FlashGetStatistics (
+  OUT FLASH_STATISTICS  *Statistics
+  );
+
 #endif /* FLASH_LIB_H_ */
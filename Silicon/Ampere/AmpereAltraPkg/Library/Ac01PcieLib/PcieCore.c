@@ -24,6 +24,62 @@
 
 #include "PcieCore.h"
 
+//
+// Link bring-up of every PCIe controller is driven by a state machine. All
+// links are serviced from a single polling loop so that their waits overlap.
+//
+typedef enum {
+  LinkStateIdle = 0,      // Controller inactive or nothing to be done
+  LinkStateTraining,      // Waiting for the initial link up
+  LinkStateEndpoint,      // Waiting for the endpoint config space
+  LinkStateEvaluate,      // RAS DES counters armed, collecting link errors
+  LinkStateRetrain,       // Waiting for link up after a soft reset
+  LinkStateDone
+} AC01_PCIE_LINK_STATE;
+
+typedef struct {
+  AC01_PCIE_LINK_STATE    State;
+  UINT64                  StartTick;       // System count when link training was started
+  UINT64                  DeadlineTick;    // System count when the current state times out
+  INT32                   LinkStatusCheck; // Result of the link capabilities check
+  UINT8                   ReInitCount;     // Controller re-initializations after link down
+  UINT8                   ResetCount;      // Soft resets left to recover the link quality
+} AC01_PCIE_LINK_CONTEXT;
+
+STATIC AC01_PCIE_LINK_CONTEXT  mLinkContext[AC01_PCIE_MAX_ROOT_COMPLEX][MaxPcieController];
+
+STATIC
+AC01_PCIE_LINK_CONTEXT *
+GetLinkContext (
+  IN AC01_ROOT_COMPLEX  *RootComplex,
+  IN UINT8              PcieIndex
+  )
+{
+  return &mLinkContext[RootComplex->Socket * AC01_PCIE_MAX_RCS_PER_SOCKET + RootComplex->ID][PcieIndex];
+}
+
+//
+// It is not guaranteed the timer service is ready prior to PCI Dxe.
+// Link training is timed with the system counter.
+//
+STATIC
+UINT64
+MicroSecondsToTicks (
+  IN UINT64  MicroSeconds
+  )
+{
+  return DivU64x32 (MultU64x64 (ArmGenericTimerGetTimerFreq (), MicroSeconds), 1000000);
+}
+
+STATIC
+UINT32
+TicksToMicroSeconds (
+  IN UINT64  Ticks
+  )
+{
+  return (UINT32)DivU64x64Remainder (MultU64x32 (Ticks, 1000000), ArmGenericTimerGetTimerFreq (), NULL);
+}
+
 VOID
 EnableDbiAccess (
   AC01_ROOT_COMPLEX  *RootComplex,
@@ -1203,6 +1259,9 @@ AutoLaneBifurcationRetry:
 
     // Start link training
     StartLinkTraining (RootComplex, PcieIndex, TRUE);
+    if (!ReInit) {
+      GetLinkContext (RootComplex, PcieIndex)->StartTick = ArmGenericTimerGetSystemCount ();
+    }
 
     // Lock programming of config space
     EnableDbiAccess (RootComplex, PcieIndex, FALSE);
@@ -1528,17 +1587,23 @@ EndpointCfgReady (
 
    @param RootComplex[in]  Pointer to AC01_ROOT_COMPLEX structure
    @param PcieIndex[in]    PCIe controller index
+   @param TimeOut[in]      Time in microseconds to wait for the EP config space
    @param EpMaxWidth[out]  EP max link width
    @param EpMaxGen[out]    EP max link speed
+
+   @retval TRUE            The EP config space was ready within TimeOut.
+   @retval FALSE           The EP config space is not ready yet.
 **/
-VOID
+BOOLEAN
 Ac01PcieCoreGetEndpointInfo (
   IN  AC01_ROOT_COMPLEX  *RootComplex,
   IN  UINT8              PcieIndex,
+  IN  UINT32             TimeOut,
   OUT UINT8              *EpMaxWidth,
   OUT UINT8              *EpMaxGen
   )
 {
+  BOOLEAN           Ready;
   PHYSICAL_ADDRESS  CfgBase;
   PHYSICAL_ADDRESS  EpCfgAddr;
   PHYSICAL_ADDRESS  PcieCapBase;
@@ -1564,7 +1629,8 @@ Ac01PcieCoreGetEndpointInfo (
   MmioWrite32 (SecLatTimerAddr, Val);
   EpCfgAddr = RootComplex->MmcfgBase + (RootComplex->Pcie[PcieIndex].DevNum << BUS_SHIFT);
 
-  if (!EndpointCfgReady (RootComplex, PcieIndex, EP_LINKUP_EXTRA_TIMEOUT)) {
+  Ready = EndpointCfgReady (RootComplex, PcieIndex, TimeOut);
+  if (!Ready) {
     goto Exit;
   }
 
@@ -1615,192 +1681,259 @@ Exit:
 
   // Disable programming to config space
   EnableDbiAccess (RootComplex, PcieIndex, FALSE);
+
+  return Ready;
+}
+
+BOOLEAN
+Ac01PcieCoreCheckCardPresent (
+  IN AC01_PCIE_CONTROLLER  *PcieController
+  )
+{
+  EFI_PHYSICAL_ADDRESS  TargetAddress;
+  UINT32                ControlValue;
+
+  ControlValue = 0;
+
+  TargetAddress = PcieController->CsrBase;
+
+  ControlValue = MmioRead32 (TargetAddress + AC01_PCIE_CORE_LINK_CTRL_REG);
+
+  if (0 == LTSSMENB_GET (ControlValue)) {
+    //
+    // LTSSMENB is clear to 0x00 by Hardware -> link partner is connected.
+    //
+    return TRUE;
+  }
+
+  return FALSE;
 }
 
+/**
+  Arm the link quality evaluation of a PCIe controller whose link is up.
+
+  @param RootComplex[in]  Pointer to AC01_ROOT_COMPLEX structure
+  @param PcieIndex[in]    PCIe controller index
+**/
+STATIC
 VOID
-PollLinkUp (
+Ac01PcieCoreStartLinkEvaluation (
   IN AC01_ROOT_COMPLEX  *RootComplex,
   IN UINT8              PcieIndex
   )
 {
-  UINT32  TimeOut;
-
-  // Poll until link up
-  // This checking for linkup status and
-  // give LTSSM state the time to transit from DECTECT state to L0 state
-  // Total delay are 100ms, smaller number of delay cannot always make sure
-  // the state transition is completed
-  TimeOut = LTSSM_TRANSITION_TIMEOUT;
-  do {
-    if (PcieLinkUpCheck (&RootComplex->Pcie[PcieIndex])) {
-      DEBUG ((
-        DEBUG_INFO,
-        "\tPCIE%d.%d LinkStat is correct after soft reset, transition time: %d\n",
-        RootComplex->ID,
-        PcieIndex,
-        TimeOut
-        ));
-      RootComplex->Pcie[PcieIndex].LinkUp = TRUE;
-      break;
-    }
+  AC01_PCIE_LINK_CONTEXT  *Link;
 
-    MicroSecondDelay (100);
-    TimeOut -= 100;
-  } while (TimeOut > 0);
+  Link = GetLinkContext (RootComplex, PcieIndex);
 
-  if (TimeOut <= 0) {
-    DEBUG ((DEBUG_ERROR, "\tPCIE%d.%d LinkStat TIMEOUT after re-init\n", RootComplex->ID, PcieIndex));
-  } else {
-    DEBUG ((DEBUG_INFO, "PCIE%d.%d Link re-initialization passed!\n", RootComplex->ID, PcieIndex));
-  }
+  // Enable all of RASDES register to detect any training error
+  Ac01PFACommand (RootComplex, PcieIndex, PFA_MODE_ENABLE);
+
+  Link->State        = LinkStateEndpoint;
+  Link->DeadlineTick = ArmGenericTimerGetSystemCount () + MicroSecondsToTicks (EP_LINKUP_EXTRA_TIMEOUT);
 }
 
 /**
-  Check active PCIe controllers of RootComplex, retrain or soft reset if needed
+  Soft reset a PCIe controller to recover the link quality.
 
   @param RootComplex[in]  Pointer to AC01_ROOT_COMPLEX structure
   @param PcieIndex[in]    PCIe controller index
-
-  @retval                 -1: Link recovery had failed
-                          1: Link width and speed are not correct
-                          0: Link recovery succeed
 **/
-INT32
-Ac01PcieCoreQoSLinkCheckRecovery (
+STATIC
+VOID
+Ac01PcieCoreRetrainLink (
   IN AC01_ROOT_COMPLEX  *RootComplex,
   IN UINT8              PcieIndex
   )
 {
-  INT32  LinkStatusCheck, RasdesChecking;
-  INT32  NumberOfReset = MAX_REINIT;
-  UINT8  EpMaxWidth, EpMaxGen;
+  AC01_PCIE_LINK_CONTEXT  *Link;
 
-  // PCIe controller is not active or Link is not up
-  // Nothing to be done
-  if ((!RootComplex->Pcie[PcieIndex].Active) || (!RootComplex->Pcie[PcieIndex].LinkUp)) {
-    return LINK_CHECK_WRONG_PARAMETER;
-  }
+  Link = GetLinkContext (RootComplex, PcieIndex);
 
-  do {
-    if (RootComplex->Pcie[PcieIndex].LinkUp) {
-      // Enable all of RASDES register to detect any training error
-      Ac01PFACommand (RootComplex, PcieIndex, PFA_MODE_ENABLE);
+  // Trigger controller soft reset
+  DEBUG ((DEBUG_INFO, "PCIE%d.%d Start link re-initialization..\n", RootComplex->ID, PcieIndex));
+  RootComplex->Pcie[PcieIndex].LinkUp = FALSE;
+  RootComplex->Pcie[PcieIndex].RetrainCount++;
+  Link->ResetCount--;
+  Ac01PcieCoreSetupRC (RootComplex, TRUE, PcieIndex);
 
-      // Accessing Endpoint and checking current link capabilities
-      Ac01PcieCoreGetEndpointInfo (RootComplex, PcieIndex, &EpMaxWidth, &EpMaxGen);
-      LinkStatusCheck = Ac01PcieCoreLinkCheck (RootComplex, PcieIndex, EpMaxWidth, EpMaxGen);
+  // Give LTSSM state the time to transit from DETECT state to L0 state
+  Link->State        = LinkStateRetrain;
+  Link->DeadlineTick = ArmGenericTimerGetSystemCount () + MicroSecondsToTicks (LTSSM_TRANSITION_TIMEOUT);
+}
 
-      // Delay to allow the link to perform internal operation and generate
-      // any error status update. This allows detection of any error observed
-      // during initial link training. Possible evaluation time can be
-      // between 100ms to 200ms.
-      MicroSecondDelay (100000);
+/**
+  Complete the bring-up of a PCIe controller whose link had come up.
 
-      // Check for error
-      RasdesChecking = Ac01PFACommand (RootComplex, PcieIndex, PFA_MODE_READ);
+  @param RootComplex[in]  Pointer to AC01_ROOT_COMPLEX structure
+  @param PcieIndex[in]    PCIe controller index
+**/
+STATIC
+VOID
+Ac01PcieCoreLinkDone (
+  IN AC01_ROOT_COMPLEX  *RootComplex,
+  IN UINT8              PcieIndex
+  )
+{
+  AC01_PCIE_CONTROLLER    *Pcie;
+  AC01_PCIE_LINK_CONTEXT  *Link;
 
-      // Clear error counter
-      Ac01PFACommand (RootComplex, PcieIndex, PFA_MODE_CLEAR);
+  Pcie = &RootComplex->Pcie[PcieIndex];
+  Link = GetLinkContext (RootComplex, PcieIndex);
 
-      // If link check functions return passed, then breaking out
-      // else go to soft reset
-      if ((LinkStatusCheck != LINK_CHECK_FAILED) &&
-          (RasdesChecking != LINK_CHECK_FAILED) &&
-          PcieLinkUpCheck (&RootComplex->Pcie[PcieIndex]))
-      {
-        return LINK_CHECK_SUCCESS;
-      }
+  if (Pcie->LinkUp) {
+    Pcie->TrainingTime = TicksToMicroSeconds (ArmGenericTimerGetSystemCount () - Link->StartTick);
+  }
 
-      RootComplex->Pcie[PcieIndex].LinkUp = FALSE;
-    }
+  DEBUG ((
+    DEBUG_INFO,
+    "PCIE%d.%d Link %a, training time %u us, %d retrain(s)\n",
+    RootComplex->ID,
+    PcieIndex,
+    Pcie->LinkUp ? "up" : "down",
+    Pcie->TrainingTime,
+    Pcie->RetrainCount
+    ));
 
-    // Trigger controller soft reset
-    DEBUG ((DEBUG_INFO, "PCIE%d.%d Start link re-initialization..\n", RootComplex->ID, PcieIndex));
-    Ac01PcieCoreSetupRC (RootComplex, TRUE, PcieIndex);
+  // Un-mask Completion Timeout
+  DisableCompletionTimeOut (RootComplex, PcieIndex, FALSE);
 
-    PollLinkUp (RootComplex, PcieIndex);
+  Link->State = LinkStateDone;
+}
 
-    NumberOfReset--;
-  } while (NumberOfReset > 0);
+/**
+  Advance the link state machine of a PCIe controller without blocking.
 
-  return LINK_CHECK_SUCCESS;
-}
+  A link is first given LINK_TRAINING_TIMEOUT to come up, the controller being
+  re-initialized up to MAX_REINIT times while a link partner is connected.
+  Once up, the link capabilities and the RAS DES error counters are checked
+  and the controller is soft reset up to MAX_REINIT times if needed.
+
+  @param RootComplex[in]  Pointer to AC01_ROOT_COMPLEX structure
+  @param PcieIndex[in]    PCIe controller index
 
+  @retval TRUE            The link still needs servicing.
+  @retval FALSE           The link has reached its final state.
+**/
+STATIC
 BOOLEAN
-Ac01PcieCoreCheckCardPresent (
-  IN AC01_PCIE_CONTROLLER  *PcieController
+Ac01PcieCoreServiceLink (
+  IN AC01_ROOT_COMPLEX  *RootComplex,
+  IN UINT8              PcieIndex
   )
 {
-  EFI_PHYSICAL_ADDRESS  TargetAddress;
-  UINT32                ControlValue;
+  AC01_PCIE_CONTROLLER    *Pcie;
+  AC01_PCIE_LINK_CONTEXT  *Link;
+  INT32                   RasdesChecking;
+  UINT64                  CurrentTick;
+  UINT8                   EpMaxWidth, EpMaxGen;
+
+  Pcie        = &RootComplex->Pcie[PcieIndex];
+  Link        = GetLinkContext (RootComplex, PcieIndex);
+  CurrentTick = ArmGenericTimerGetSystemCount ();
+
+  switch (Link->State) {
+    case LinkStateTraining:
+      if (PcieLinkUpCheck (Pcie)) {
+        Pcie->LinkUp = TRUE;
+        Ac01PcieCoreStartLinkEvaluation (RootComplex, PcieIndex);
+        break;
+      }
 
-  ControlValue = 0;
+      if (CurrentTick < Link->DeadlineTick) {
+        break;
+      }
 
-  TargetAddress = PcieController->CsrBase;
+      if (Ac01PcieCoreCheckCardPresent (Pcie) && (Link->ReInitCount < MAX_REINIT)) {
+        //
+        // Timer is up. Give another chance to re-program controller
+        //
+        DEBUG ((DEBUG_INFO, "PCIE%d.%d Link retry\n", RootComplex->ID, PcieIndex));
+        Link->ReInitCount++;
+        Ac01PcieCoreSetupRC (RootComplex, TRUE, PcieIndex);
+        Link->DeadlineTick = ArmGenericTimerGetSystemCount () + MicroSecondsToTicks (LINK_TRAINING_TIMEOUT);
+        break;
+      }
 
-  ControlValue = MmioRead32 (TargetAddress + AC01_PCIE_CORE_LINK_CTRL_REG);
+      // No link partner, Completion Timeout stays masked
+      Link->State = LinkStateDone;
+      break;
 
-  if (0 == LTSSMENB_GET (ControlValue)) {
-    //
-    // LTSSMENB is clear to 0x00 by Hardware -> link partner is connected.
-    //
-    return TRUE;
-  }
+    case LinkStateEndpoint:
+      // Accessing Endpoint and checking current link capabilities
+      if (  !Ac01PcieCoreGetEndpointInfo (RootComplex, PcieIndex, LINK_WAIT_INTERVAL_US, &EpMaxWidth, &EpMaxGen)
+         && (CurrentTick < Link->DeadlineTick))
+      {
+        break;
+      }
 
-  return FALSE;
-}
+      Link->LinkStatusCheck = Ac01PcieCoreLinkCheck (RootComplex, PcieIndex, EpMaxWidth, EpMaxGen);
 
-VOID
-Ac01PcieCoreUpdateLink (
-  IN  AC01_ROOT_COMPLEX  *RootComplex,
-  OUT BOOLEAN            *IsNextRoundNeeded,
-  OUT INT8               *FailedPciePtr,
-  OUT INT8               *FailedPcieCount
-  )
-{
-  AC01_PCIE_CONTROLLER  *Pcie;
-  UINT8                 PcieIndex;
-  UINT32                Index;
-
-  *IsNextRoundNeeded = FALSE;
-  *FailedPcieCount   = 0;
-  for (Index = 0; Index < MaxPcieControllerOfRootComplexB; Index++) {
-    FailedPciePtr[Index] = -1;
-  }
+      // Allow the link to perform internal operation and generate
+      // any error status update. This allows detection of any error observed
+      // during initial link training. Possible evaluation time can be
+      // between 100ms to 200ms.
+      Link->State        = LinkStateEvaluate;
+      Link->DeadlineTick = ArmGenericTimerGetSystemCount () + MicroSecondsToTicks (LINK_EVALUATION_TIMEOUT);
+      break;
 
-  if (!RootComplex->Active) {
-    return;
-  }
+    case LinkStateEvaluate:
+      if (CurrentTick < Link->DeadlineTick) {
+        break;
+      }
 
-  // Loop for all controllers
-  for (PcieIndex = 0; PcieIndex < RootComplex->MaxPcieController; PcieIndex++) {
-    Pcie = &RootComplex->Pcie[PcieIndex];
+      // Check for error
+      RasdesChecking = Ac01PFACommand (RootComplex, PcieIndex, PFA_MODE_READ);
 
-    if (Pcie->Active && !Pcie->LinkUp) {
-      if (PcieLinkUpCheck (Pcie)) {
-        Pcie->LinkUp = TRUE;
+      // Clear error counter
+      Ac01PFACommand (RootComplex, PcieIndex, PFA_MODE_CLEAR);
+
+      // If link check functions return passed, then the link is done
+      // else go to soft reset
+      if ((Link->LinkStatusCheck != LINK_CHECK_FAILED) &&
+          (RasdesChecking != LINK_CHECK_FAILED) &&
+          PcieLinkUpCheck (Pcie))
+      {
+        Ac01PcieCoreLinkDone (RootComplex, PcieIndex);
+        break;
+      }
 
-        // Doing link checking and recovery if needed
-        Ac01PcieCoreQoSLinkCheckRecovery (RootComplex, PcieIndex);
+      Ac01PcieCoreRetrainLink (RootComplex, PcieIndex);
+      break;
 
-        // Un-mask Completion Timeout
-        DisableCompletionTimeOut (RootComplex, PcieIndex, FALSE);
+    case LinkStateRetrain:
+      if (PcieLinkUpCheck (Pcie)) {
+        DEBUG ((DEBUG_INFO, "PCIE%d.%d Link re-initialization passed!\n", RootComplex->ID, PcieIndex));
+        Pcie->LinkUp = TRUE;
+      } else if (CurrentTick < Link->DeadlineTick) {
+        break;
       } else {
-        FailedPciePtr[*FailedPcieCount] = PcieIndex;
-        *FailedPcieCount               += 1;
+        DEBUG ((DEBUG_ERROR, "\tPCIE%d.%d LinkStat TIMEOUT after re-init\n", RootComplex->ID, PcieIndex));
+      }
 
-        if (Ac01PcieCoreCheckCardPresent (Pcie)) {
-          *IsNextRoundNeeded = TRUE;
-          DEBUG ((DEBUG_INFO, "PCIE%d.%d Link retry\n", RootComplex->ID, PcieIndex));
-        }
+      if (Link->ResetCount == 0) {
+        Ac01PcieCoreLinkDone (RootComplex, PcieIndex);
+      } else if (Pcie->LinkUp) {
+        Ac01PcieCoreStartLinkEvaluation (RootComplex, PcieIndex);
+      } else {
+        Ac01PcieCoreRetrainLink (RootComplex, PcieIndex);
       }
-    }
+
+      break;
+
+    default:
+      break;
   }
+
+  return (Link->State != LinkStateIdle) && (Link->State != LinkStateDone);
 }
 
 /**
   Verify the link status and retry to initialize the Root Complex if there's any issue.
 
+  The links of all Root Complexes are serviced together so that the training,
+  evaluation and recovery time of one link overlaps with the others.
+
   @param RootComplexList      Pointer to the Root Complex list
 **/
 VOID
@@ -1808,65 +1941,46 @@ Ac01PcieCorePostSetupRC (
   IN AC01_ROOT_COMPLEX  *RootComplexList
   )
 {
-  UINT8    RCIndex, Idx;
-  BOOLEAN  IsNextRoundNeeded, NextRoundNeeded;
-  UINT64   PrevTick, CurrTick, ElapsedCycle;
-  UINT64   TimerTicks64;
-  UINT8    ReInit;
-  INT8     FailedPciePtr[MaxPcieControllerOfRootComplexB];
-  INT8     FailedPcieCount;
-
-  ReInit = 0;
-
-_link_polling:
-  NextRoundNeeded = FALSE;
-  //
-  // It is not guaranteed the timer service is ready prior to PCI Dxe.
-  // Calculate system ticks for link training.
-  //
-  TimerTicks64 = ArmGenericTimerGetTimerFreq (); /* 1 Second */
-  PrevTick     = ArmGenericTimerGetSystemCount ();
-  ElapsedCycle = 0;
-
-  do {
-    CurrTick = ArmGenericTimerGetSystemCount ();
-    if (CurrTick < PrevTick) {
-      ElapsedCycle += MAX_UINT64 - PrevTick;
-      PrevTick      = 0;
-    }
-
-    ElapsedCycle += (CurrTick - PrevTick);
-    PrevTick      = CurrTick;
-  } while (ElapsedCycle < TimerTicks64);
+  AC01_ROOT_COMPLEX       *RootComplex;
+  AC01_PCIE_CONTROLLER    *Pcie;
+  AC01_PCIE_LINK_CONTEXT  *Link;
+  BOOLEAN                 LinkPending;
+  UINT8                   RCIndex;
+  UINT8                   PcieIndex;
 
   for (RCIndex = 0; RCIndex < AC01_PCIE_MAX_ROOT_COMPLEX; RCIndex++) {
-    Ac01PcieCoreUpdateLink (&RootComplexList[RCIndex], &IsNextRoundNeeded, FailedPciePtr, &FailedPcieCount);
-    if (IsNextRoundNeeded) {
-      NextRoundNeeded = TRUE;
+    RootComplex = &RootComplexList[RCIndex];
+    for (PcieIndex = 0; PcieIndex < RootComplex->MaxPcieController; PcieIndex++) {
+      Pcie = &RootComplex->Pcie[PcieIndex];
+      Link = GetLinkContext (RootComplex, PcieIndex);
+
+      Link->State = LinkStateIdle;
+      if (!RootComplex->Active || !Pcie->Active || Pcie->LinkUp) {
+        continue;
+      }
+
+      Link->State        = LinkStateTraining;
+      Link->DeadlineTick = Link->StartTick + MicroSecondsToTicks (LINK_TRAINING_TIMEOUT);
+      Link->ReInitCount  = 0;
+      Link->ResetCount   = MAX_REINIT;
+      Pcie->TrainingTime = 0;
+      Pcie->RetrainCount = 0;
     }
   }
 
-  if (NextRoundNeeded && (ReInit < MAX_REINIT)) {
-    //
-    // Timer is up. Give another chance to re-program controller
-    //
-    ReInit++;
+  do {
+    LinkPending = FALSE;
     for (RCIndex = 0; RCIndex < AC01_PCIE_MAX_ROOT_COMPLEX; RCIndex++) {
-      Ac01PcieCoreUpdateLink (&RootComplexList[RCIndex], &IsNextRoundNeeded, FailedPciePtr, &FailedPcieCount);
-      if (IsNextRoundNeeded) {
-        for (Idx = 0; Idx < FailedPcieCount; Idx++) {
-          if (FailedPciePtr[Idx] == -1) {
-            continue;
-          }
-
-          //
-          // Some controller still observes link-down. Re-init controller
-          //
-          Ac01PcieCoreSetupRC (&RootComplexList[RCIndex], TRUE, FailedPciePtr[Idx]);
+      RootComplex = &RootComplexList[RCIndex];
+      for (PcieIndex = 0; PcieIndex < RootComplex->MaxPcieController; PcieIndex++) {
+        if (Ac01PcieCoreServiceLink (RootComplex, PcieIndex)) {
+          LinkPending = TRUE;
         }
       }
     }
 
-    goto _link_polling;
-  }
+    if (LinkPending) {
+      MicroSecondDelay (LINK_WAIT_INTERVAL_US);
+    }
+  } while (LinkPending);
 }
@@ -40,6 +40,8 @@
 #define LTSSM_TRANSITION_TIMEOUT  100000             // 100 ms in total
 #define EP_LINKUP_TIMEOUT         (10 * 1000)        // 10ms
 #define EP_LINKUP_EXTRA_TIMEOUT   (500 * 1000)       // 500ms
+#define LINK_TRAINING_TIMEOUT     (1000 * 1000)      // 1s
+#define LINK_EVALUATION_TIMEOUT   (100 * 1000)       // 100ms
 #define LINK_WAIT_INTERVAL_US     50
 
 #define PFA_MODE_ENABLE  0
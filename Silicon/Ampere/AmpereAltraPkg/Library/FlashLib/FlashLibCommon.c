@@ -18,6 +18,8 @@
 UINT8  *gFlashLibPhysicalBuffer;
 UINT8  *gFlashLibVirtualBuffer;
 
+STATIC FLASH_STATISTICS  mFlashStatistics;
+
 /**
   Convert Virtual Address to Physical Address at Runtime.
 
@@ -234,11 +236,15 @@ FlashEraseCommand (
     return Status;
   }
 
+  mFlashStatistics.MmCommunicateCount++;
   if (MmSpiNorRes.Status != MM_SPINOR_RES_SUCCESS) {
     DEBUG ((DEBUG_ERROR, "%a: Device error %llx\n", __func__, MmSpiNorRes.Status));
     return EFI_DEVICE_ERROR;
   }
 
+  mFlashStatistics.EraseCount++;
+  mFlashStatistics.BytesErased += Length;
+
   return EFI_SUCCESS;
 }
 
@@ -290,15 +296,19 @@ FlashWriteCommand (
       return Status;
     }
 
+    mFlashStatistics.MmCommunicateCount++;
     if (MmSpiNorRes.Status != MM_SPINOR_RES_SUCCESS) {
       DEBUG ((DEBUG_ERROR, "%a: Device error 0x%llx\n", __func__, MmSpiNorRes.Status));
       return EFI_DEVICE_ERROR;
     }
 
+    mFlashStatistics.BytesWritten += NumWrite;
     Remain -= NumWrite;
     Count  += NumWrite;
   }
 
+  mFlashStatistics.WriteCount++;
+
   return EFI_SUCCESS;
 }
 
@@ -350,6 +360,7 @@ FlashReadCommand (
       return Status;
     }
 
+    mFlashStatistics.MmCommunicateCount++;
     if (MmSpiNorRes.Status != MM_SPINOR_RES_SUCCESS) {
       DEBUG ((DEBUG_ERROR, "%a: Device error %llx\n", __func__, MmSpiNorRes.Status));
       return EFI_DEVICE_ERROR;
@@ -359,9 +370,38 @@ FlashReadCommand (
     // Get data from the virtual address of the temp buffer.
     //
     CopyMem ((VOID *)(Buffer + Count), (VOID *)gFlashLibVirtualBuffer, NumRead);
+    mFlashStatistics.BytesRead += NumRead;
     Remain -= NumRead;
     Count  += NumRead;
   }
 
+  mFlashStatistics.ReadCount++;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Retrieve the counters of the Flash operations completed so far.
+
+  An operation is counted once it has succeeded. The bytes of the chunks
+  that completed before an operation failed are still counted.
+
+  @param[out] Statistics         Pointer to the counters.
+
+  @retval EFI_SUCCESS            Operation succeeded.
+  @retval EFI_INVALID_PARAMETER  Statistics is NULL.
+**/
+EFI_STATUS
+EFIAPI
+FlashGetStatistics (
+  OUT FLASH_STATISTICS  *Statistics
+  )
+{
+  if (Statistics == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  CopyMem (Statistics, &mFlashStatistics, sizeof (FLASH_STATISTICS));
+
   return EFI_SUCCESS;
 }
@@ -15,12 +15,160 @@
 
 #include "NVParamLibCommon.h"
 
+typedef struct {
+  BOOLEAN    Valid;
+  UINT16     ACLRd;       // Read permission the line was filled with
+  UINT32     Base;        // Parameter ID of the first entry of the line
+  UINT32     ValidMask;   // Entries with a cached value
+  UINT32     Value[NVPARAM_CACHE_LINE_ENTRIES];
+} NVPARAM_CACHE_LINE;
+
+BOOLEAN                    gNVParamCacheEnabled = TRUE;
+STATIC BOOLEAN             mNVParamReadRangeUnsupported = FALSE;
+STATIC NVPARAM_CACHE_LINE  mNVParamCache[NVPARAM_CACHE_LINES];
+
+/**
+  Drop all the cached NVParam values.
+**/
+VOID
+NVParamCacheInvalidateAll (
+  VOID
+  )
+{
+  ZeroMem (mNVParamCache, sizeof (mNVParamCache));
+}
+
+/**
+  Look up the cache line holding a parameter.
+
+  @param[in]  Param               Parameter ID.
+  @param[out] Entry               Index of the parameter within the line.
+
+  @return Pointer to the cache line slot of the parameter.
+**/
+STATIC
+NVPARAM_CACHE_LINE *
+NVParamCacheLookup (
+  IN  UINT32  Param,
+  OUT UINT32  *Entry
+  )
+{
+  *Entry = (Param % NVPARAM_CACHE_LINE_SIZE) / NVPARAM_ENTRY_SIZE;
+
+  return &mNVParamCache[(Param / NVPARAM_CACHE_LINE_SIZE) % NVPARAM_CACHE_LINES];
+}
+
+/**
+  Drop the cached value of a parameter.
+
+  @param[in]  Param               Parameter ID.
+**/
+STATIC
+VOID
+NVParamCacheInvalidate (
+  IN UINT32  Param
+  )
+{
+  NVPARAM_CACHE_LINE  *Line;
+  UINT32              Entry;
+
+  Line = NVParamCacheLookup (Param, &Entry);
+  if (Line->Valid && (Line->Base == Param - (Param % NVPARAM_CACHE_LINE_SIZE))) {
+    Line->ValidMask &= ~(1U << Entry);
+  }
+}
+
+/**
+  Fill the cache line of a parameter with a single MM communication.
+
+  @param[in]  Line                Pointer to the cache line slot.
+  @param[in]  Base                Parameter ID of the first entry of the line.
+  @param[in]  ACLRd               Permission for read operation.
+**/
+STATIC
+VOID
+NVParamCacheFill (
+  IN NVPARAM_CACHE_LINE  *Line,
+  IN UINT32              Base,
+  IN UINT16              ACLRd
+  )
+{
+  EFI_MM_COMMUNICATE_NVPARAM_RANGE_RESPONSE  MmNVParamRes;
+  EFI_STATUS                                 Status;
+  UINT64                                     MmData[5];
+
+  //
+  // Start from an empty line so that entries can still be cached one by one
+  // when the range read is not available.
+  //
+  ZeroMem (Line, sizeof (NVPARAM_CACHE_LINE));
+  Line->Valid = TRUE;
+  Line->ACLRd = ACLRd;
+  Line->Base  = Base;
+
+  if (mNVParamReadRangeUnsupported) {
+    return;
+  }
+
+  MmData[0] = MM_NVPARAM_FUNC_READ_RANGE;
+  MmData[1] = Base;
+  MmData[2] = NVPARAM_CACHE_LINE_ENTRIES;
+  MmData[3] = (UINT64)ACLRd;
+
+  Status = NVParamMmCommunicate (
+             MmData,
+             sizeof (MmData),
+             &MmNVParamRes,
+             sizeof (MmNVParamRes)
+             );
+  if (EFI_ERROR (Status)) {
+    //
+    // Only stop trying the range read when MM does not implement it. Any
+    // other error only affects this call, which falls back to reading the
+    // parameters one by one.
+    //
+    if (Status == EFI_UNSUPPORTED) {
+      mNVParamReadRangeUnsupported = TRUE;
+    }
+
+    return;
+  }
+
+  switch (MmNVParamRes.Status) {
+    case MM_NVPARAM_RES_SUCCESS:
+      break;
+
+    case MM_NVPARAM_RES_NO_PERM:
+      return;
+
+    default:
+      //
+      // The MM service does not report its version, so a handler that
+      // predates MM_NVPARAM_FUNC_READ_RANGE is only seen by its answer.
+      // It fails the unknown function or answers with an unknown code.
+      // Never retry it, so that a line fill does not cost an extra MM
+      // round trip on every miss.
+      //
+      mNVParamReadRangeUnsupported = TRUE;
+      return;
+  }
+
+  Line->ValidMask = MmNVParamRes.ValidMask;
+  CopyMem (Line->Value, MmNVParamRes.Value, sizeof (Line->Value));
+}
+
 /**
   Retrieve a non-volatile parameter.
 
   NOTE: If you need a signed value, cast it. It is expected that the
   caller will carry the correct permission over various call sequences.
 
+  Values are served from a read cache when possible. The cache is filled a
+  line of consecutive parameters at a time and updated by NVParamSet(),
+  NVParamClr() and NVParamClrAll() of the same module. Parameters that are
+  not set are not cached and always read from the MM service, as another
+  module may set them at any time.
+
   @param[in]  Param               Parameter ID to retrieve
   @param[in]  ACLRd               Permission for read operation.
   @param[out] Val                 Pointer to an UINT32 to the return value.
@@ -41,11 +189,29 @@ NVParamGet (
   EFI_MM_COMMUNICATE_NVPARAM_RESPONSE  MmNVParamRes;
   EFI_STATUS                           Status;
   UINT64                               MmData[5];
+  NVPARAM_CACHE_LINE                   *Line;
+  UINT32                               Entry;
+  UINT32                               Base;
 
   if (Val == NULL) {
     return EFI_INVALID_PARAMETER;
   }
 
+  Line  = NULL;
+  Entry = 0;
+  if (gNVParamCacheEnabled) {
+    Line = NVParamCacheLookup (Param, &Entry);
+    Base = Param - (Param % NVPARAM_CACHE_LINE_SIZE);
+    if (!Line->Valid || (Line->Base != Base) || (Line->ACLRd != ACLRd)) {
+      NVParamCacheFill (Line, Base, ACLRd);
+    }
+
+    if ((Line->ValidMask & (1U << Entry)) != 0) {
+      *Val = Line->Value[Entry];
+      return EFI_SUCCESS;
+    }
+  }
+
   MmData[0] = MM_NVPARAM_FUNC_READ;
   MmData[1] = Param;
   MmData[2] = (UINT64)ACLRd;
@@ -63,6 +229,11 @@ NVParamGet (
   switch (MmNVParamRes.Status) {
     case MM_NVPARAM_RES_SUCCESS:
       *Val = (UINT32)MmNVParamRes.Value;
+      if (Line != NULL) {
+        Line->Value[Entry] = *Val;
+        Line->ValidMask   |= 1U << Entry;
+      }
+
       return EFI_SUCCESS;
 
     case MM_NVPARAM_RES_NOT_SET:
@@ -109,6 +280,8 @@ NVParamSet (
   EFI_STATUS                           Status;
   UINT64                               MmData[5];
 
+  NVParamCacheInvalidate (Param);
+
   MmData[0] = MM_NVPARAM_FUNC_WRITE;
   MmData[1] = Param;
   MmData[2] = (UINT64)ACLRd;
@@ -164,6 +337,8 @@ NVParamClr (
   EFI_STATUS                           Status;
   UINT64                               MmData[5];
 
+  NVParamCacheInvalidate (Param);
+
   MmData[0] = MM_NVPARAM_FUNC_CLEAR;
   MmData[1] = Param;
   MmData[2] = 0;
@@ -210,6 +385,8 @@ NVParamClrAll (
   EFI_STATUS                           Status;
   UINT64                               MmData[5];
 
+  NVParamCacheInvalidateAll ();
+
   MmData[0] = MM_NVPARAM_FUNC_CLEAR_ALL;
 
   Status = NVParamMmCommunicate (
@@ -11,16 +11,26 @@
 
 #define EFI_MM_MAX_PAYLOAD_SIZE  0x50
 
-#define MM_NVPARAM_FUNC_READ       0x01
-#define MM_NVPARAM_FUNC_WRITE      0x02
-#define MM_NVPARAM_FUNC_CLEAR      0x03
-#define MM_NVPARAM_FUNC_CLEAR_ALL  0x04
+#define MM_NVPARAM_FUNC_READ        0x01
+#define MM_NVPARAM_FUNC_WRITE       0x02
+#define MM_NVPARAM_FUNC_CLEAR       0x03
+#define MM_NVPARAM_FUNC_CLEAR_ALL   0x04
+#define MM_NVPARAM_FUNC_READ_RANGE  0x05
 
 #define MM_NVPARAM_RES_SUCCESS  0xAABBCC00
 #define MM_NVPARAM_RES_NOT_SET  0xAABBCC01
 #define MM_NVPARAM_RES_NO_PERM  0xAABBCC02
 #define MM_NVPARAM_RES_FAIL     0xAABBCCFF
 
+//
+// Each NVParam entry takes 8 bytes. The read cache holds lines of
+// consecutive entries, filled with a single MM_NVPARAM_FUNC_READ_RANGE.
+//
+#define NVPARAM_ENTRY_SIZE          8
+#define NVPARAM_CACHE_LINE_ENTRIES  16
+#define NVPARAM_CACHE_LINE_SIZE     (NVPARAM_CACHE_LINE_ENTRIES * NVPARAM_ENTRY_SIZE)
+#define NVPARAM_CACHE_LINES         32
+
 #pragma pack (1)
 
 typedef struct {
@@ -45,8 +55,25 @@ typedef struct {
   UINT64    Value;
 } EFI_MM_COMMUNICATE_NVPARAM_RESPONSE;
 
+typedef struct {
+  UINT64    Status;
+  UINT32    ValidMask;    // Entries returned in Value
+  UINT32    NotSetMask;   // Entries which are not set
+  UINT32    Value[NVPARAM_CACHE_LINE_ENTRIES];
+} EFI_MM_COMMUNICATE_NVPARAM_RANGE_RESPONSE;
+
 #pragma pack ()
 
+extern BOOLEAN  gNVParamCacheEnabled;
+
+/**
+  Drop all the cached NVParam values.
+**/
+VOID
+NVParamCacheInvalidateAll (
+  VOID
+  );
+
 /**
   Provides an interface to access the NVParam services via MM interface.
 
@@ -34,6 +34,12 @@ NVParamLibAddressChangeEvent (
   )
 {
   gRT->ConvertPointer (0x0, (VOID **)&mMmCommunicationProtocol);
+
+  //
+  // NVParams may be changed by other agents while the OS is running.
+  // Always go to the MM service from now on.
+  //
+  gNVParamCacheEnabled = FALSE;
 }
 
 /**
@@ -0,0 +1,101 @@
+/** @file
+ *
+ *  Register definitions for the legacy BCM283x DMA engine (channels 0-14).
+ *
+ *  Copyright (c) Microsoft Corporation. All rights reserved.
+ *
+ *  SPDX-License-Identifier: BSD-2-Clause-Patent
+ *
+ **/
+
+#include <IndustryStandard/Bcm2836.h>
+
+#ifndef __BCM2836_DMA_H__
+#define __BCM2836_DMA_H__
+
+#define DMA_CHANNEL_BASE(Chan)      (BCM2836_DMA0_BASE_ADDRESS + ((Chan) * BCM2836_DMA_CHANNEL_LENGTH))
+#define DMA_CHANNEL_REG(Chan, X)    (DMA_CHANNEL_BASE (Chan) + (X))
+#define DMA_CS(Chan)                DMA_CHANNEL_REG (Chan, 0x00)
+#define DMA_CONBLK_AD(Chan)         DMA_CHANNEL_REG (Chan, 0x04)
+#define DMA_TI(Chan)                DMA_CHANNEL_REG (Chan, 0x08)
+#define DMA_SOURCE_AD(Chan)         DMA_CHANNEL_REG (Chan, 0x0C)
+#define DMA_DEST_AD(Chan)           DMA_CHANNEL_REG (Chan, 0x10)
+#define DMA_TXFR_LEN(Chan)          DMA_CHANNEL_REG (Chan, 0x14)
+#define DMA_STRIDE(Chan)            DMA_CHANNEL_REG (Chan, 0x18)
+#define DMA_NEXTCONBK(Chan)         DMA_CHANNEL_REG (Chan, 0x1C)
+#define DMA_DEBUG(Chan)             DMA_CHANNEL_REG (Chan, 0x20)
+
+#define DMA_INT_STATUS              (BCM2836_DMA_CTRL_BASE_ADDRESS + 0x00)
+#define DMA_ENABLE                  (BCM2836_DMA_CTRL_BASE_ADDRESS + 0x10)
+
+//
+// Peripherals are addressed by the DMA engine through the VC bus view.
+//
+#define DMA_PERIPHERAL_BUS_BASE     0x7E000000
+#define DMA_PERIPHERAL_BUS_ADDRESS(Offset) (DMA_PERIPHERAL_BUS_BASE + (Offset))
+
+//
+// CS
+//
+#define DMA_CS_ACTIVE               BIT0
+#define DMA_CS_END                  BIT1
+#define DMA_CS_INT                  BIT2
+#define DMA_CS_DREQ                 BIT3
+#define DMA_CS_PAUSED               BIT4
+#define DMA_CS_ERROR                BIT8
+#define DMA_CS_PRIORITY(X)          (((X) & 0xF) << 16)
+#define DMA_CS_PANIC_PRIORITY(X)    (((X) & 0xF) << 20)
+#define DMA_CS_WAIT_FOR_WRITES      BIT28
+#define DMA_CS_ABORT                BIT30
+#define DMA_CS_RESET                BIT31
+
+//
+// TI
+//
+#define DMA_TI_INTEN                BIT0
+#define DMA_TI_WAIT_RESP            BIT3
+#define DMA_TI_DEST_INC             BIT4
+#define DMA_TI_DEST_WIDTH           BIT5
+#define DMA_TI_DEST_DREQ            BIT6
+#define DMA_TI_SRC_INC              BIT8
+#define DMA_TI_SRC_WIDTH            BIT9
+#define DMA_TI_SRC_DREQ             BIT10
+#define DMA_TI_BURST_LENGTH(X)      (((X) & 0xF) << 12)
+#define DMA_TI_PERMAP(X)            (((X) & 0x1F) << 16)
+#define DMA_TI_NO_WIDE_BURSTS       BIT26
+
+//
+// DEBUG (write 1 to clear)
+//
+#define DMA_DEBUG_READ_LAST_NOT_SET BIT0
+#define DMA_DEBUG_FIFO_ERROR        BIT1
+#define DMA_DEBUG_READ_ERROR        BIT2
+#define DMA_DEBUG_ERROR             (DMA_DEBUG_READ_LAST_NOT_SET | DMA_DEBUG_FIFO_ERROR | DMA_DEBUG_READ_ERROR)
+
+//
+// Lite channels (7-14) can only move 64KB per control block.
+//
+#define DMA_TXFR_LEN_MAX            0x3FFFFFFC
+#define DMA_LITE_TXFR_LEN_MAX       0x0000FFFC
+
+//
+// DREQ peripheral numbers (TI.PERMAP)
+//
+#define DMA_DREQ_SDHOST             13
+
+//
+// Control blocks must be 32-byte aligned in the VC bus view.
+//
+#define DMA_CONTROL_BLOCK_ALIGNMENT 32
+
+typedef struct {
+  UINT32 TransferInfo;
+  UINT32 SourceAddress;
+  UINT32 DestinationAddress;
+  UINT32 TransferLength;
+  UINT32 Stride;
+  UINT32 NextControlBlock;
+  UINT32 Reserved[2];
+} DMA_CONTROL_BLOCK;
+
+#endif /* __BCM2836_DMA_H__ */
@@ -19,12 +19,18 @@
 #define MMCHS1_LENGTH     0x00000100
 #define MMCHS2_LENGTH     0x00000100
 
+#define MMCHS_SDMA        (mMmcHsBase + 0x0)
+
 #define MMCHS_BLK         (mMmcHsBase + 0x4)
 #define BLEN_512BYTES     (0x200UL << 0)
+#define SDMA_BOUNDARY_512K (0x7UL << 12)
+#define SDMA_BOUNDARY_SIZE SIZE_512KB
+#define MAX_BLOCK_COUNT   0xFFFF
 
 #define MMCHS_ARG         (mMmcHsBase + 0x8)
 
 #define MMCHS_CMD         (mMmcHsBase + 0xC)
+#define DE_ENABLE         BIT0
 #define BCE_ENABLE        BIT1
 #define DDIR_READ         BIT4
 #define DDIR_WRITE        (0x0UL << 4)
@@ -64,6 +70,9 @@
 #define MMCHS_HCTL        (mMmcHsBase + 0x28)
 #define DTW_1_BIT         (0x0UL << 1)
 #define DTW_4_BIT         BIT1
+#define DMAS_MASK         (0x3UL << 3)
+#define DMAS_SDMA         (0x0UL << 3)
+#define DMAS_ADMA2        (0x2UL << 3)
 #define SDBP_MASK         BIT8
 #define SDBP_OFF          (0x0UL << 8)
 #define SDBP_ON           BIT8
@@ -92,6 +101,7 @@
 #define MMCHS_INT_STAT    (mMmcHsBase + 0x30)
 #define CC                BIT0
 #define TC                BIT1
+#define DMAI              BIT3
 #define BWR               BIT4
 #define BRR               BIT5
 #define CARD_INS          BIT6
@@ -100,6 +110,7 @@
 #define DTO               BIT20
 #define DCRC              BIT21
 #define DEB               BIT22
+#define ADMAE             BIT25
 
 #define MMCHS_IE          (mMmcHsBase + 0x34)
 #define CC_EN             BIT0
@@ -136,15 +147,32 @@
 #define MMCHS_HC2R        (mMmcHsBase + 0x3E)
 
 #define MMCHS_CAPA        (mMmcHsBase + 0x40)
+#define ADMA2_SUPPORT     BIT19
+#define SDMA_SUPPORT      BIT22
 #define VS30              BIT25
 #define VS18              BIT26
 
 #define MMCHS_CUR_CAPA    (mMmcHsBase + 0x48)
+#define MMCHS_ADMA_ERR    (mMmcHsBase + 0x54)
+#define MMCHS_ADMA_ADDR   (mMmcHsBase + 0x58)
 #define MMCHS_REV         (mMmcHsBase + 0xFC)
 
 #define BLOCK_COUNT_SHIFT 16
 #define RCA_SHIFT         16
 
+// 32-bit ADMA2 descriptor
+#define ADMA2_VALID       BIT0
+#define ADMA2_END         BIT1
+#define ADMA2_INT         BIT2
+#define ADMA2_ACT_TRAN    (0x2U << 4)
+#define ADMA2_MAX_LENGTH  SIZE_32KB
+
+typedef struct {
+  UINT16 Attributes;
+  UINT16 Length;
+  UINT32 Address;
+} ADMA2_DESCRIPTOR;
+
 #define CMD_R1            (RSP_TYPE_48BITS | CCCE_ENABLE | CICE_ENABLE)
 #define CMD_R1B           (RSP_TYPE_48BUSY | CCCE_ENABLE | CICE_ENABLE)
 #define CMD_R2            (RSP_TYPE_136BITS | CCCE_ENABLE)
@@ -12,7 +12,9 @@
 #include <Library/DebugLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/ArmLib.h>
+#include <Library/BaseMemoryLib.h>
 #include <Library/PcdLib.h>
+#include <Library/TimerLib.h>
 #include <Protocol/NorFlashProtocol.h>
 #include <Library/DxeServicesTableLib.h>
 #include <Protocol/Cpu.h>
@@ -378,6 +380,111 @@ DO:
 }
 
 
+static EFI_STATUS FlashUnitFinish(
+    IN  UINT32       TempBase,
+    IN  UINT32       Offset,
+    IN  UINT8       *Buffer,
+    IN  UINT32       Length
+    )
+{
+    EFI_STATUS Status;
+    UINT32 Retry = 3;
+
+    Status = BufferWriteFinish(TempBase, Offset, Buffer, Length);
+    while (EFI_ERROR(Status) && (Retry--))
+    {
+        Status = BufferWriteStart(TempBase, Offset, Buffer);
+        if (!EFI_ERROR(Status))
+        {
+            Status = BufferWriteFinish(TempBase, Offset, Buffer, Length);
+        }
+    }
+
+    return Status;
+}
+
+
+/*
+  Update one sector to hold NewData, OldData being its current contents.
+
+  The sector is only erased when some bit has to go from 0 to 1, otherwise
+  the new data is programmed over the old. Only the write buffer units that
+  differ are programmed. Since OldData and NewData are in memory, the next
+  unit to program is looked up while the previous one is still busy, and
+  the previous one is only polled for completion after that.
+*/
+static EFI_STATUS FlashSectorUpdate(
+    IN  UINT32       TempBase,
+    IN  UINT32       SectorOffset,
+    IN  UINT8       *NewData,
+    IN  UINT8       *OldData,
+    IN  UINT32       SectorSize
+    )
+{
+    EFI_STATUS Status;
+    UINT32 FlashUnitLength;
+    UINT32 Loop;
+    UINT32 Pending;
+    BOOLEAN NeedErase;
+
+    FlashUnitLength = gFlashInfo[gIndex.InfIndex].BufferProgramSize << gFlashInfo[gIndex.InfIndex].ParallelNum;
+
+    NeedErase = FALSE;
+    for (Loop = 0; Loop < SectorSize; Loop ++)
+    {
+        if ((OldData[Loop] & NewData[Loop]) != NewData[Loop])
+        {
+            NeedErase = TRUE;
+            break;
+        }
+    }
+
+    if (NeedErase)
+    {
+        Status = SectorErase(TempBase, SectorOffset);
+        if (EFI_ERROR(Status))
+        {
+            DEBUG ((DEBUG_ERROR, "[%a]:[%dL]:SectorErase %r!\n", __func__,__LINE__, Status));
+            return Status;
+        }
+        SetMem (OldData, SectorSize, 0xFF);
+    }
+
+    Pending = MAX_UINT32;
+    for (Loop = 0; Loop < SectorSize; Loop += FlashUnitLength)
+    {
+        if (0 == CompareMem (NewData + Loop, OldData + Loop, FlashUnitLength))
+        {
+            gFlashStatistics.BuffersSkipped ++;
+            continue;
+        }
+
+        if (MAX_UINT32 != Pending)
+        {
+            Status = FlashUnitFinish(TempBase, SectorOffset + Pending, NewData + Pending, FlashUnitLength);
+            if (EFI_ERROR(Status))
+            {
+                return Status;
+            }
+        }
+
+        Status = BufferWriteStart(TempBase, SectorOffset + Loop, NewData + Loop);
+        if (EFI_ERROR(Status))
+        {
+            return Status;
+        }
+        Pending = Loop;
+    }
+
+    if (MAX_UINT32 != Pending)
+    {
+        return FlashUnitFinish(TempBase, SectorOffset + Pending, NewData + Pending, FlashUnitLength);
+    }
+
+    return EFI_SUCCESS;
+}
+
+
 EFI_STATUS
 EFIAPI Erase(
    IN UNI_NOR_FLASH_PROTOCOL   *This,
@@ -459,6 +566,13 @@ EFIAPI Write(
     UINT32       TempBase;
     UINT32           Loop;
     UINT32        Sectors;
+    UINT32     SectorSize;
+    UINT32   SectorOffset;
+    UINT8        *OldData;
+    UINT8        *NewData;
+    UINT32    TotalLength;
+    UINT64      StartTime;
+    UINT64    ElapsedTime;
 
     if((Offset + ulLength) > (gFlashInfo[gIndex.InfIndex].SingleChipSize * gFlashInfo[gIndex.InfIndex].ParallelNum))
     {
@@ -470,6 +584,18 @@ EFIAPI Write(
         return EFI_SUCCESS;
     }
 
+    SectorSize = gFlashInfo[gIndex.InfIndex].BlockSize * gFlashInfo[gIndex.InfIndex].ParallelNum;
+    Status = gBS->AllocatePool(EfiBootServicesData, 2 * (UINTN)SectorSize, (VOID *)&OldData);
+    if (EFI_ERROR(Status))
+    {
+        DEBUG ((DEBUG_ERROR, "[%a]:[%dL]:Allocate Pool failed, %r!\n", __func__,__LINE__, Status));
+        return Status;
+    }
+    NewData = OldData + SectorSize;
+
+    TotalLength = ulLength;
+    StartTime = GetPerformanceCounter ();
+
 
     Sectors = ((Offset + ulLength - 1) / (gFlashInfo[gIndex.InfIndex].BlockSize * gFlashInfo[gIndex.InfIndex].ParallelNum)) - (Offset / (gFlashInfo[gIndex.InfIndex].BlockSize * gFlashInfo[gIndex.InfIndex].ParallelNum)) + 1;
     TempBase = gIndex.Base;
@@ -495,21 +621,22 @@ EFIAPI Write(
 
         if (TRUE == IsNeedToWrite(TempBase, Offset, Buffer, TempLength))
         {
-            Status = FlashSectorErase(TempBase, Offset, TempLength);
-            if (EFI_ERROR(Status))
-            {
-                DEBUG ((DEBUG_ERROR, "[%a]:[%dL]:FlashErase One Sector Error, Status = %r!\n", __func__,__LINE__,Status));
-                return Status;
-            }
-
+            SectorOffset = Offset - (Offset % SectorSize);
+            CopyMem (OldData, (VOID *)(UINTN)(TempBase + SectorOffset), SectorSize);
+            CopyMem (NewData, OldData, SectorSize);
+            CopyMem (NewData + (Offset - SectorOffset), Buffer, TempLength);
 
-            Status = WriteAfterErase(TempBase, Offset, Buffer, TempLength);
+            Status = FlashSectorUpdate(TempBase, SectorOffset, NewData, OldData, SectorSize);
             if (EFI_ERROR(Status))
             {
-                DEBUG ((DEBUG_ERROR, "[%a]:[%dL]:WriteAfterErase Status = %r!\n", __func__,__LINE__,Status));
-                return Status;
+                DEBUG ((DEBUG_ERROR, "[%a]:[%dL]:FlashSectorUpdate Status = %r!\n", __func__,__LINE__,Status));
+                goto Exit;
             }
         }
+        else if (0 != TempLength)
+        {
+            gFlashStatistics.SectorsSkipped ++;
+        }
 
         Offset += TempLength;
         Buffer += TempLength;
@@ -523,7 +650,21 @@ EFIAPI Write(
         ulLength -= TempLength;
     }
 
-    return EFI_SUCCESS;
+    ElapsedTime = GetTimeInNanoSecond (GetPerformanceCounter () - StartTime);
+    gFlashStatistics.BytesWritten += TotalLength;
+    gFlashStatistics.WriteTimeNs += ElapsedTime;
+
+    DEBUG ((DEBUG_INFO, "[%a]: 0x%x bytes in %lu us, total 0x%lx bytes in %lu ms, buffers %lu programmed %lu skipped, sectors %lu erased %lu skipped\n",
+            __func__, TotalLength, ElapsedTime / 1000,
+            gFlashStatistics.BytesWritten, gFlashStatistics.WriteTimeNs / 1000000,
+            gFlashStatistics.BuffersProgrammed, gFlashStatistics.BuffersSkipped,
+            gFlashStatistics.SectorsErased, gFlashStatistics.SectorsSkipped));
+
+    Status = EFI_SUCCESS;
+
+Exit:
+    (void)gBS->FreePool((VOID *)OldData);
+    return Status;
 }
 
 
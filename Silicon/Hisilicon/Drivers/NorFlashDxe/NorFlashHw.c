@@ -23,6 +23,7 @@ FLASH_INDEX gIndex = {
     0,
     0
 };
+NOR_FLASH_STATISTICS gFlashStatistics;
 
 
 UINT32 PortReadData (
@@ -378,7 +379,7 @@ EFI_STATUS BufferWriteCommand(UINTN Base, UINTN Offset, void *pData)
 
     }
 
-    (void)gBS->Stall(200);
+    gFlashStatistics.BuffersProgrammed ++;
 
     gFlashBusy = FALSE;
     return EFI_SUCCESS;
@@ -418,6 +419,8 @@ EFI_STATUS SectorEraseCommand(UINTN Base, UINTN Offset)
 
     (void)gBS->Stall(500000);
 
+    gFlashStatistics.SectorsErased ++;
+
     gFlashBusy = FALSE;
     return EFI_SUCCESS;
 }
@@ -547,6 +550,7 @@ EFI_STATUS BufferWrite(UINT32 Offset, void *pData, UINT32 Length)
     do
     {
         (void)BufferWriteCommand(gIndex.Base, Offset, pData);
+        (void)gBS->Stall(200);
         Status = CompleteCheck(gIndex.Base, Offset, pData, Length);
 
 
@@ -573,6 +577,42 @@ EFI_STATUS BufferWrite(UINT32 Offset, void *pData, UINT32 Length)
 }
 
 
+/*
+  Start programming one write buffer unit without waiting for it, so that
+  the caller can get the next unit ready while the flash is busy.
+  BufferWriteFinish must be called before any other access to the flash.
+*/
+EFI_STATUS BufferWriteStart(UINT32 Base, UINT32 Offset, void *pData)
+{
+    return BufferWriteCommand(Base, Offset, pData);
+}
+
+
+EFI_STATUS BufferWriteFinish(UINT32 Base, UINT32 Offset, void *pData, UINT32 Length)
+{
+    EFI_STATUS Status;
+    UINT32 dwLoop;
+
+    Status = CompleteCheck(Base, Offset, pData, Length);
+    if (EFI_ERROR(Status))
+    {
+        DEBUG((DEBUG_ERROR, "Flash_WriteUnit ERROR: complete check failed, %r\n", Status));
+        return Status;
+    }
+
+    for (dwLoop = 0; dwLoop < Length; dwLoop ++)
+    {
+        if (*(UINT8 *)(UINTN)(Base + Offset + dwLoop) != *((UINT8 *)pData + dwLoop))
+        {
+            DEBUG((DEBUG_ERROR, "Flash_WriteUnit ERROR: address %x, buffer %x, flash %x\n", Offset + dwLoop, *((UINT8 *)pData + dwLoop), *(UINT8 *)(UINTN)(Base + Offset + dwLoop)));
+            return EFI_ABORTED;
+        }
+    }
+
+    return EFI_SUCCESS;
+}
+
+
 EFI_STATUS SectorErase(UINT32 Base, UINT32 Offset)
 {
     UINT8 gTemp[FLASH_MAX_UNIT];
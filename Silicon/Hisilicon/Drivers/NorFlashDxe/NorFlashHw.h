@@ -93,9 +93,22 @@ typedef struct {
 }FLASH_INDEX;
 
 
+/*Write and erase counters, for tracking flash update time*/
+typedef struct {
+    UINT64 BytesWritten;
+    UINT64 WriteTimeNs;
+    UINT64 BuffersProgrammed;
+    UINT64 BuffersSkipped;
+    UINT64 SectorsErased;
+    UINT64 SectorsSkipped;
+}NOR_FLASH_STATISTICS;
+
+
 extern EFI_STATUS FlashInit(UINT32 Base);
 extern EFI_STATUS SectorErase(UINT32 Base, UINT32 Offset);
 extern EFI_STATUS BufferWrite(UINT32 Offset, void *pData, UINT32 Length);
+extern EFI_STATUS BufferWriteStart(UINT32 Base, UINT32 Offset, void *pData);
+extern EFI_STATUS BufferWriteFinish(UINT32 Base, UINT32 Offset, void *pData, UINT32 Length);
 extern EFI_STATUS IsNeedToWrite(UINT32 Base, UINT32 Offset, UINT8 *Buffer, UINT32 Length);
 
 
@@ -105,6 +118,7 @@ extern FLASH_COMMAND_ID gFlashCommandId[FLASH_DEVICE_NUM];
 extern FLASH_COMMAND_WRITE gFlashCommandWrite[FLASH_DEVICE_NUM];
 extern FLASH_COMMAND_ERASE gFlashCommandErase[FLASH_DEVICE_NUM];
 extern FLASH_INDEX gIndex;
+extern NOR_FLASH_STATISTICS gFlashStatistics;
 
 
 #endif
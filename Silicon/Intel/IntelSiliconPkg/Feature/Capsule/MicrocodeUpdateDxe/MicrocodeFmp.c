@@ -624,18 +624,48 @@ InitializedProcessorMicrocodeIndex (
   IN MICROCODE_FMP_PRIVATE_DATA *MicrocodeFmpPrivate
   )
 {
-  UINTN       CpuIndex;
-  UINTN       MicrocodeIndex;
-  UINTN       TargetCpuIndex;
-  UINT32      AttemptStatus;
-  EFI_STATUS  Status;
+  UINTN                  CpuIndex;
+  UINTN                  Index;
+  UINTN                  MicrocodeIndex;
+  UINTN                  TargetCpuIndex;
+  UINT32                 AttemptStatus;
+  EFI_STATUS             Status;
+  PROCESSOR_INFO         *ProcessorInfo;
+  PROCESSOR_INFO         *TypeProcessorInfo;
+  MICROCODE_INDEX_ENTRY  *IndexEntry;
 
   for (CpuIndex = 0; CpuIndex < MicrocodeFmpPrivate->ProcessorCount; CpuIndex++) {
-    if (MicrocodeFmpPrivate->ProcessorInfo[CpuIndex].MicrocodeIndex != (UINTN)-1) {
+    ProcessorInfo = &MicrocodeFmpPrivate->ProcessorInfo[CpuIndex];
+    if (ProcessorInfo->MicrocodeIndex != (UINTN)-1) {
       continue;
     }
-    for (MicrocodeIndex = 0; MicrocodeIndex < MicrocodeFmpPrivate->DescriptorCount; MicrocodeIndex++) {
-      if (!MicrocodeFmpPrivate->MicrocodeInfo[MicrocodeIndex].InUse) {
+    //
+    // A processor of the same type at the same revision matches the same
+    // Microcode as the first processor of its type, which is handled already.
+    //
+    TypeProcessorInfo = &MicrocodeFmpPrivate->ProcessorInfo[MicrocodeFmpPrivate->ProcessorTypeInfo[ProcessorInfo->ProcessorTypeIndex].CpuIndex];
+    if ((TypeProcessorInfo->CpuIndex < CpuIndex) &&
+        (TypeProcessorInfo->MicrocodeRevision == ProcessorInfo->MicrocodeRevision)) {
+      ProcessorInfo->MicrocodeIndex = TypeProcessorInfo->MicrocodeIndex;
+      continue;
+    }
+    //
+    // Only the Microcode indexed under the signature and platform of this
+    // processor can match it.
+    //
+    for (Index = FindMicrocodeIndexEntry (MicrocodeFmpPrivate, ProcessorInfo->ProcessorSignature);
+         Index < MicrocodeFmpPrivate->MicrocodeIndexCount;
+         Index++) {
+      IndexEntry = &MicrocodeFmpPrivate->MicrocodeIndexTable[Index];
+      if (IndexEntry->ProcessorSignature != ProcessorInfo->ProcessorSignature) {
+        break;
+      }
+      if ((IndexEntry->ProcessorFlags & (1 << ProcessorInfo->PlatformId)) == 0) {
+        continue;
+      }
+      MicrocodeIndex = IndexEntry->MicrocodeIndex;
+      if ((MicrocodeIndex >= MicrocodeFmpPrivate->DescriptorCount) ||
+          !MicrocodeFmpPrivate->MicrocodeInfo[MicrocodeIndex].InUse) {
         continue;
       }
       TargetCpuIndex = CpuIndex;
@@ -671,6 +701,12 @@ InitializeMicrocodeDescriptor (
   EFI_STATUS Status;
   UINT8      CurrentMicrocodeCount;
 
+  PERF_INMODULE_BEGIN ("MicrocodeScan");
+  Status = BuildMicrocodeIndex (MicrocodeFmpPrivate);
+  if (EFI_ERROR(Status)) {
+    PERF_INMODULE_END ("MicrocodeScan");
+    return Status;
+  }
   CurrentMicrocodeCount = (UINT8)GetMicrocodeInfo (MicrocodeFmpPrivate, 0, NULL, NULL);
 
   if (CurrentMicrocodeCount > MicrocodeFmpPrivate->DescriptorCount) {
@@ -692,6 +728,7 @@ InitializeMicrocodeDescriptor (
   if (MicrocodeFmpPrivate->ImageDescriptor == NULL) {
     MicrocodeFmpPrivate->ImageDescriptor = AllocateZeroPool(MicrocodeFmpPrivate->DescriptorCount * sizeof(EFI_FIRMWARE_IMAGE_DESCRIPTOR));
     if (MicrocodeFmpPrivate->ImageDescriptor == NULL) {
+      PERF_INMODULE_END ("MicrocodeScan");
       return EFI_OUT_OF_RESOURCES;
     }
   }
@@ -699,6 +736,7 @@ InitializeMicrocodeDescriptor (
     MicrocodeFmpPrivate->MicrocodeInfo = AllocateZeroPool(MicrocodeFmpPrivate->DescriptorCount * sizeof(MICROCODE_INFO));
     if (MicrocodeFmpPrivate->MicrocodeInfo == NULL) {
       FreePool (MicrocodeFmpPrivate->ImageDescriptor);
+      PERF_INMODULE_END ("MicrocodeScan");
       return EFI_OUT_OF_RESOURCES;
     }
   }
@@ -707,6 +745,7 @@ InitializeMicrocodeDescriptor (
   ASSERT(CurrentMicrocodeCount == MicrocodeFmpPrivate->DescriptorCount);
 
   InitializedProcessorMicrocodeIndex (MicrocodeFmpPrivate);
+  PERF_INMODULE_END ("MicrocodeScan");
 
   Status = InitializeFitMicrocodeInfo (MicrocodeFmpPrivate);
   if (EFI_ERROR(Status)) {
@@ -737,7 +776,11 @@ InitializeProcessorInfo (
   UINTN                                NumberOfProcessors;
   UINTN                                NumberOfEnabledProcessors;
   UINTN                                Index;
+  UINTN                                TypeIndex;
   UINTN                                BspIndex;
+  EFI_PROCESSOR_INFORMATION            ProcessorInformation;
+  PROCESSOR_INFO                       *ProcessorInfo;
+  PROCESSOR_TYPE_INFO                  *ProcessorTypeInfo;
 
   Status = gBS->LocateProtocol (&gEfiMpServiceProtocolGuid, NULL, (VOID **)&MpService);
   ASSERT_EFI_ERROR(Status);
@@ -745,6 +788,8 @@ InitializeProcessorInfo (
   MicrocodeFmpPrivate->MpService = MpService;
   MicrocodeFmpPrivate->ProcessorCount = 0;
   MicrocodeFmpPrivate->ProcessorInfo = NULL;
+  MicrocodeFmpPrivate->ProcessorTypeCount = 0;
+  MicrocodeFmpPrivate->ProcessorTypeInfo = NULL;
 
   Status = MpService->GetNumberOfProcessors (MpService, &NumberOfProcessors, &NumberOfEnabledProcessors);
   ASSERT_EFI_ERROR(Status);
@@ -776,6 +821,49 @@ InitializeProcessorInfo (
                             );
       ASSERT_EFI_ERROR(Status);
     }
+
+    Status = MpService->GetProcessorInfo (MpService, Index, &ProcessorInformation);
+    if (!EFI_ERROR(Status)) {
+      CopyMem (&MicrocodeFmpPrivate->ProcessorInfo[Index].Location, &ProcessorInformation.Location, sizeof(EFI_CPU_PHYSICAL_LOCATION));
+    } else {
+      //
+      // Without the location, treat each processor as a core of its own.
+      //
+      MicrocodeFmpPrivate->ProcessorInfo[Index].Location.Package = 0;
+      MicrocodeFmpPrivate->ProcessorInfo[Index].Location.Core    = (UINT32)Index;
+      MicrocodeFmpPrivate->ProcessorInfo[Index].Location.Thread  = 0;
+    }
+  }
+
+  //
+  // Group the processors by (ProcessorSignature, PlatformId), so a Microcode
+  // is matched once per processor type instead of once per processor.
+  //
+  MicrocodeFmpPrivate->ProcessorTypeInfo = AllocateZeroPool (sizeof(PROCESSOR_TYPE_INFO) * MicrocodeFmpPrivate->ProcessorCount);
+  if (MicrocodeFmpPrivate->ProcessorTypeInfo == NULL) {
+    FreePool (MicrocodeFmpPrivate->ProcessorInfo);
+    MicrocodeFmpPrivate->ProcessorInfo = NULL;
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  for (Index = 0; Index < NumberOfProcessors; Index++) {
+    ProcessorInfo = &MicrocodeFmpPrivate->ProcessorInfo[Index];
+    for (TypeIndex = 0; TypeIndex < MicrocodeFmpPrivate->ProcessorTypeCount; TypeIndex++) {
+      ProcessorTypeInfo = &MicrocodeFmpPrivate->ProcessorTypeInfo[TypeIndex];
+      if ((ProcessorTypeInfo->ProcessorSignature == ProcessorInfo->ProcessorSignature) &&
+          (ProcessorTypeInfo->PlatformId == ProcessorInfo->PlatformId)) {
+        break;
+      }
+    }
+    ProcessorTypeInfo = &MicrocodeFmpPrivate->ProcessorTypeInfo[TypeIndex];
+    if (TypeIndex == MicrocodeFmpPrivate->ProcessorTypeCount) {
+      ProcessorTypeInfo->ProcessorSignature = ProcessorInfo->ProcessorSignature;
+      ProcessorTypeInfo->PlatformId = ProcessorInfo->PlatformId;
+      ProcessorTypeInfo->CpuIndex = Index;
+      MicrocodeFmpPrivate->ProcessorTypeCount++;
+    }
+    ProcessorTypeInfo->CpuCount++;
+    ProcessorInfo->ProcessorTypeIndex = TypeIndex;
   }
 
   return EFI_SUCCESS;
@@ -793,6 +881,7 @@ DumpPrivateInfo (
 {
   UINTN                                Index;
   PROCESSOR_INFO                       *ProcessorInfo;
+  PROCESSOR_TYPE_INFO                  *ProcessorTypeInfo;
   MICROCODE_INFO                       *MicrocodeInfo;
   EFI_FIRMWARE_IMAGE_DESCRIPTOR        *ImageDescriptor;
   FIT_MICROCODE_INFO                   *FitMicrocodeInfo;
@@ -814,6 +903,20 @@ DumpPrivateInfo (
       ));
   }
 
+  DEBUG ((DEBUG_INFO, "  ProcessorTypeCount - 0x%x\n", MicrocodeFmpPrivate->ProcessorTypeCount));
+  ProcessorTypeInfo = MicrocodeFmpPrivate->ProcessorTypeInfo;
+  for (Index = 0; Index < MicrocodeFmpPrivate->ProcessorTypeCount; Index++) {
+    DEBUG ((
+      DEBUG_INFO,
+      "  ProcessorTypeInfo[0x%x] - 0x%08x, 0x%02x, (0x%x, 0x%x)\n",
+      Index,
+      ProcessorTypeInfo[Index].ProcessorSignature,
+      ProcessorTypeInfo[Index].PlatformId,
+      ProcessorTypeInfo[Index].CpuIndex,
+      ProcessorTypeInfo[Index].CpuCount
+      ));
+  }
+
   DEBUG ((DEBUG_INFO, "MicrocodeInfo:\n"));
   MicrocodeInfo = MicrocodeFmpPrivate->MicrocodeInfo;
   DEBUG ((DEBUG_INFO, "  MicrocodeRegion - 0x%x - 0x%x\n", MicrocodeFmpPrivate->MicrocodePatchAddress, MicrocodeFmpPrivate->MicrocodePatchRegionSize));
@@ -919,6 +1022,8 @@ InitializePrivateData (
   Status = InitializeMicrocodeDescriptor(MicrocodeFmpPrivate);
   if (EFI_ERROR(Status)) {
     FreePool (MicrocodeFmpPrivate->ProcessorInfo);
+    FreePool (MicrocodeFmpPrivate->ProcessorTypeInfo);
+    FreeMicrocodeIndex (MicrocodeFmpPrivate);
     DEBUG((DEBUG_ERROR, "InitializeMicrocodeDescriptor - %r\n", Status));
     return Status;
   }
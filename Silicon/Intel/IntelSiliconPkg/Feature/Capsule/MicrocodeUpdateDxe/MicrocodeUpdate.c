@@ -166,6 +166,193 @@ LoadMicrocodeOnThis (
   }
 }
 
+/**
+  Load Microcode on every Application Processor selected in the load buffer.
+  The function prototype for invoking a function on an Application Processor.
+
+  @param[in,out] Buffer  The pointer to private data buffer.
+**/
+VOID
+EFIAPI
+MicrocodeLoadAllAps (
+  IN OUT VOID  *Buffer
+  )
+{
+  EFI_STATUS                           Status;
+  MICROCODE_LOAD_ALL_BUFFER            *MicrocodeLoadAllBuffer;
+  MICROCODE_LOAD_BUFFER                *MicrocodeLoadBuffer;
+  UINTN                                CpuIndex;
+
+  MicrocodeLoadAllBuffer = Buffer;
+  Status = MicrocodeLoadAllBuffer->MpService->WhoAmI (MicrocodeLoadAllBuffer->MpService, &CpuIndex);
+  if (EFI_ERROR(Status)) {
+    return;
+  }
+
+  MicrocodeLoadBuffer = &MicrocodeLoadAllBuffer->LoadBuffer[CpuIndex];
+  if (MicrocodeLoadBuffer->Address == 0) {
+    return;
+  }
+
+  MicrocodeLoadBuffer->Revision = GetCurrentMicrocodeSignature();
+  if (MicrocodeLoadBuffer->Revision != MicrocodeLoadAllBuffer->UpdateRevision) {
+    MicrocodeLoadBuffer->Revision = LoadMicrocode (MicrocodeLoadBuffer->Address);
+  }
+}
+
+/**
+  Load new Microcode on all other processors which the Microcode applies to.
+
+  The Microcode is matched once per processor type, and loaded on only one
+  logical processor of each core because the update is shared by the threads
+  of a core. The Application Processors are started in parallel.
+
+  @param[in]  MicrocodeFmpPrivate        The Microcode driver private data
+  @param[in]  MicrocodeEntryPoint        The verified Microcode.
+  @param[in]  ImageSize                  The size of Microcode image buffer in bytes.
+  @param[in]  TargetCpuIndex             The index of the processor the Microcode is already loaded on.
+
+  @retval EFI_SUCCESS            The Microcode is loaded on all matched processors.
+  @retval EFI_OUT_OF_RESOURCES   No enough resource for the load buffer.
+  @retval EFI_SECURITY_VIOLATION The Microcode fails to load on some processors.
+**/
+EFI_STATUS
+LoadMicrocodeOnAllProcessors (
+  IN  MICROCODE_FMP_PRIVATE_DATA  *MicrocodeFmpPrivate,
+  IN  CPU_MICROCODE_HEADER        *MicrocodeEntryPoint,
+  IN  UINTN                       ImageSize,
+  IN  UINTN                       TargetCpuIndex
+  )
+{
+  EFI_STATUS                           Status;
+  EFI_MP_SERVICES_PROTOCOL             *MpService;
+  PROCESSOR_INFO                       *ProcessorInfo;
+  PROCESSOR_TYPE_INFO                  *ProcessorTypeInfo;
+  MICROCODE_LOAD_ALL_BUFFER            MicrocodeLoadAllBuffer;
+  MICROCODE_LOAD_BUFFER                *MicrocodeLoadBuffer;
+  BOOLEAN                              *TypeMatched;
+  UINTN                                TypeIndex;
+  UINTN                                CpuIndex;
+  UINTN                                Index;
+  UINTN                                TypeCpuIndex;
+  UINTN                                LoadCount;
+  UINTN                                FailCount;
+  UINT32                               AttemptStatus;
+  UINT64                               Address;
+
+  ProcessorInfo = MicrocodeFmpPrivate->ProcessorInfo;
+  ProcessorTypeInfo = MicrocodeFmpPrivate->ProcessorTypeInfo;
+  Address = (UINTN)MicrocodeEntryPoint + sizeof(CPU_MICROCODE_HEADER);
+
+  MicrocodeLoadBuffer = AllocateZeroPool (sizeof(MICROCODE_LOAD_BUFFER) * MicrocodeFmpPrivate->ProcessorCount);
+  TypeMatched = AllocateZeroPool (sizeof(BOOLEAN) * MicrocodeFmpPrivate->ProcessorTypeCount);
+  if (MicrocodeLoadBuffer == NULL || TypeMatched == NULL) {
+    if (MicrocodeLoadBuffer != NULL) {
+      FreePool (MicrocodeLoadBuffer);
+    }
+    if (TypeMatched != NULL) {
+      FreePool (TypeMatched);
+    }
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  //
+  // Match the Microcode against each processor type only once. The type of
+  // the target processor has been verified already.
+  //
+  for (TypeIndex = 0; TypeIndex < MicrocodeFmpPrivate->ProcessorTypeCount; TypeIndex++) {
+    if (TypeIndex == ProcessorInfo[TargetCpuIndex].ProcessorTypeIndex) {
+      TypeMatched[TypeIndex] = TRUE;
+      continue;
+    }
+    TypeCpuIndex = ProcessorTypeInfo[TypeIndex].CpuIndex;
+    Status = VerifyMicrocode (
+               MicrocodeFmpPrivate,
+               MicrocodeEntryPoint,
+               ImageSize,
+               FALSE,
+               &AttemptStatus,
+               NULL,
+               &TypeCpuIndex
+               );
+    TypeMatched[TypeIndex] = (BOOLEAN)!EFI_ERROR(Status);
+  }
+
+  //
+  // Select one logical processor of each core. The core of the target
+  // processor is skipped because the Microcode is loaded on it already.
+  //
+  LoadCount = 0;
+  for (CpuIndex = 0; CpuIndex < MicrocodeFmpPrivate->ProcessorCount; CpuIndex++) {
+    if (!TypeMatched[ProcessorInfo[CpuIndex].ProcessorTypeIndex]) {
+      continue;
+    }
+    if ((ProcessorInfo[CpuIndex].Location.Package == ProcessorInfo[TargetCpuIndex].Location.Package) &&
+        (ProcessorInfo[CpuIndex].Location.Core == ProcessorInfo[TargetCpuIndex].Location.Core)) {
+      continue;
+    }
+    for (Index = 0; Index < CpuIndex; Index++) {
+      if ((MicrocodeLoadBuffer[Index].Address != 0) &&
+          (ProcessorInfo[Index].Location.Package == ProcessorInfo[CpuIndex].Location.Package) &&
+          (ProcessorInfo[Index].Location.Core == ProcessorInfo[CpuIndex].Location.Core)) {
+        break;
+      }
+    }
+    if (Index < CpuIndex) {
+      continue;
+    }
+    MicrocodeLoadBuffer[CpuIndex].Address = Address;
+    LoadCount++;
+  }
+
+  DEBUG((DEBUG_INFO, "LoadMicrocodeOnAllProcessors - 0x%x processor types, 0x%x cores\n", MicrocodeFmpPrivate->ProcessorTypeCount, LoadCount));
+
+  if (LoadCount != 0) {
+    if (MicrocodeLoadBuffer[MicrocodeFmpPrivate->BspIndex].Address != 0) {
+      MicrocodeLoadBuffer[MicrocodeFmpPrivate->BspIndex].Revision = GetCurrentMicrocodeSignature();
+      if (MicrocodeLoadBuffer[MicrocodeFmpPrivate->BspIndex].Revision != MicrocodeEntryPoint->UpdateRevision) {
+        MicrocodeLoadBuffer[MicrocodeFmpPrivate->BspIndex].Revision = LoadMicrocode (Address);
+      }
+    }
+
+    MpService = MicrocodeFmpPrivate->MpService;
+    MicrocodeLoadAllBuffer.MpService = MpService;
+    MicrocodeLoadAllBuffer.UpdateRevision = MicrocodeEntryPoint->UpdateRevision;
+    MicrocodeLoadAllBuffer.LoadBuffer = MicrocodeLoadBuffer;
+    Status = MpService->StartupAllAPs (
+                          MpService,
+                          MicrocodeLoadAllAps,
+                          FALSE,
+                          NULL,
+                          0,
+                          &MicrocodeLoadAllBuffer,
+                          NULL
+                          );
+    if (EFI_ERROR(Status) && Status != EFI_NOT_STARTED) {
+      DEBUG((DEBUG_ERROR, "LoadMicrocodeOnAllProcessors - StartupAllAPs - %r\n", Status));
+    }
+  }
+
+  FailCount = 0;
+  for (CpuIndex = 0; CpuIndex < MicrocodeFmpPrivate->ProcessorCount; CpuIndex++) {
+    if (MicrocodeLoadBuffer[CpuIndex].Address == 0) {
+      continue;
+    }
+    if (MicrocodeLoadBuffer[CpuIndex].Revision != MicrocodeEntryPoint->UpdateRevision) {
+      DEBUG((DEBUG_ERROR, "LoadMicrocodeOnAllProcessors - fail on CpuIndex 0x%x (0x%08x)\n", CpuIndex, MicrocodeLoadBuffer[CpuIndex].Revision));
+      FailCount++;
+    }
+  }
+
+  FreePool (TypeMatched);
+  FreePool (MicrocodeLoadBuffer);
+
+  if (FailCount != 0) {
+    return EFI_SECURITY_VIOLATION;
+  }
+  return EFI_SUCCESS;
+}
+
 /**
   Collect processor information.
   The function prototype for invoking a function on an Application Processor.
@@ -186,12 +373,268 @@ CollectProcessorInfo (
   ProcessorInfo->MicrocodeRevision = GetCurrentMicrocodeSignature();
 }
 
+/**
+  Free the Microcode index.
+
+  @param[in, out] MicrocodeFmpPrivate    The Microcode driver private data
+**/
+VOID
+FreeMicrocodeIndex (
+  IN OUT MICROCODE_FMP_PRIVATE_DATA  *MicrocodeFmpPrivate
+  )
+{
+  if (MicrocodeFmpPrivate->MicrocodeEntry != NULL) {
+    FreePool (MicrocodeFmpPrivate->MicrocodeEntry);
+    MicrocodeFmpPrivate->MicrocodeEntry = NULL;
+  }
+  if (MicrocodeFmpPrivate->MicrocodeIndexTable != NULL) {
+    FreePool (MicrocodeFmpPrivate->MicrocodeIndexTable);
+    MicrocodeFmpPrivate->MicrocodeIndexTable = NULL;
+  }
+  MicrocodeFmpPrivate->MicrocodeEntryCount = 0;
+  MicrocodeFmpPrivate->MicrocodeIndexCount = 0;
+}
+
+/**
+  Add one (ProcessorSignature, ProcessorFlags) pair to the Microcode index,
+  keeping the index sorted by ProcessorSignature.
+
+  @param[in, out] MicrocodeFmpPrivate    The Microcode driver private data
+  @param[in, out] IndexCapacity          The number of entries allocated for MicrocodeIndexTable.
+  @param[in]      ProcessorSignature     The processor signature of the Microcode
+  @param[in]      ProcessorFlags         The processor flags of the Microcode
+  @param[in]      MicrocodeIndex         The position of the Microcode in the region
+
+  @retval EFI_SUCCESS            The entry is added.
+  @retval EFI_OUT_OF_RESOURCES   No enough resource for the entry.
+**/
+STATIC
+EFI_STATUS
+AddMicrocodeIndexEntry (
+  IN OUT MICROCODE_FMP_PRIVATE_DATA  *MicrocodeFmpPrivate,
+  IN OUT UINTN                       *IndexCapacity,
+  IN     UINT32                      ProcessorSignature,
+  IN     UINT32                      ProcessorFlags,
+  IN     UINTN                       MicrocodeIndex
+  )
+{
+  MICROCODE_INDEX_ENTRY  *IndexTable;
+  UINTN                  Index;
+
+  if (MicrocodeFmpPrivate->MicrocodeIndexCount == *IndexCapacity) {
+    IndexTable = ReallocatePool (
+                   *IndexCapacity * sizeof(MICROCODE_INDEX_ENTRY),
+                   (*IndexCapacity + MICROCODE_INDEX_GROWTH) * sizeof(MICROCODE_INDEX_ENTRY),
+                   MicrocodeFmpPrivate->MicrocodeIndexTable
+                   );
+    if (IndexTable == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+    MicrocodeFmpPrivate->MicrocodeIndexTable = IndexTable;
+    *IndexCapacity += MICROCODE_INDEX_GROWTH;
+  }
+
+  //
+  // Insert after every entry whose signature is not above this one, so the
+  // entries of one signature stay in region order.
+  //
+  IndexTable = MicrocodeFmpPrivate->MicrocodeIndexTable;
+  Index = MicrocodeFmpPrivate->MicrocodeIndexCount;
+  while ((Index > 0) && (IndexTable[Index - 1].ProcessorSignature > ProcessorSignature)) {
+    CopyMem (&IndexTable[Index], &IndexTable[Index - 1], sizeof(MICROCODE_INDEX_ENTRY));
+    Index--;
+  }
+  IndexTable[Index].ProcessorSignature = ProcessorSignature;
+  IndexTable[Index].ProcessorFlags = ProcessorFlags;
+  IndexTable[Index].MicrocodeIndex = MicrocodeIndex;
+  MicrocodeFmpPrivate->MicrocodeIndexCount++;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Scan the Microcode region once, and index its Microcode by
+  (ProcessorSignature, ProcessorFlags).
+
+  The signatures of the extended signature table are indexed without being
+  verified. The index only selects the Microcode to verify; VerifyMicrocode()
+  still checks each selected Microcode in full.
+
+  @param[in, out] MicrocodeFmpPrivate    The Microcode driver private data
+
+  @retval EFI_SUCCESS            The Microcode index is built.
+  @retval EFI_OUT_OF_RESOURCES   No enough resource for the Microcode index.
+**/
+EFI_STATUS
+BuildMicrocodeIndex (
+  IN OUT MICROCODE_FMP_PRIVATE_DATA  *MicrocodeFmpPrivate
+  )
+{
+  EFI_STATUS                              Status;
+  CPU_MICROCODE_HEADER                    *MicrocodeEntryPoint;
+  UINTN                                   MicrocodeEnd;
+  UINTN                                   TotalSize;
+  UINTN                                   DataSize;
+  UINTN                                   ExtendedTableLength;
+  UINT32                                  ExtendedTableCount;
+  CPU_MICROCODE_EXTENDED_TABLE_HEADER     *ExtendedTableHeader;
+  CPU_MICROCODE_EXTENDED_TABLE            *ExtendedTable;
+  MICROCODE_INFO                          *MicrocodeEntry;
+  UINTN                                   EntryCapacity;
+  UINTN                                   IndexCapacity;
+  UINTN                                   Count;
+  UINTN                                   Index;
+
+  FreeMicrocodeIndex (MicrocodeFmpPrivate);
+  EntryCapacity = 0;
+  IndexCapacity = 0;
+  Count = 0;
+
+  MicrocodeEnd = (UINTN)MicrocodeFmpPrivate->MicrocodePatchAddress + MicrocodeFmpPrivate->MicrocodePatchRegionSize;
+  MicrocodeEntryPoint = (CPU_MICROCODE_HEADER *) (UINTN) MicrocodeFmpPrivate->MicrocodePatchAddress;
+  do {
+    if (MicrocodeEntryPoint->HeaderVersion == 0x1 && MicrocodeEntryPoint->LoaderRevision == 0x1) {
+      //
+      // It is the microcode header. It is not the padding data between microcode patches
+      // becasue the padding data should not include 0x00000001 and it should be the repeated
+      // byte format (like 0xXYXYXYXY....).
+      //
+      if (MicrocodeEntryPoint->DataSize == 0) {
+        TotalSize = 2048;
+        DataSize = 2048 - sizeof(CPU_MICROCODE_HEADER);
+      } else {
+        TotalSize = MicrocodeEntryPoint->TotalSize;
+        DataSize = MicrocodeEntryPoint->DataSize;
+      }
+    } else {
+      //
+      // It is the padding data between the microcode patches for microcode patches alignment.
+      // Skip SIZE_1KB padding data to find the next possible microcode patch header.
+      //
+      MicrocodeEntryPoint = (CPU_MICROCODE_HEADER *) (((UINTN) MicrocodeEntryPoint) + SIZE_1KB);
+      continue;
+    }
+
+    if (Count == EntryCapacity) {
+      MicrocodeEntry = ReallocatePool (
+                         EntryCapacity * sizeof(MICROCODE_INFO),
+                         (EntryCapacity + MICROCODE_INDEX_GROWTH) * sizeof(MICROCODE_INFO),
+                         MicrocodeFmpPrivate->MicrocodeEntry
+                         );
+      if (MicrocodeEntry == NULL) {
+        FreeMicrocodeIndex (MicrocodeFmpPrivate);
+        return EFI_OUT_OF_RESOURCES;
+      }
+      MicrocodeFmpPrivate->MicrocodeEntry = MicrocodeEntry;
+      EntryCapacity += MICROCODE_INDEX_GROWTH;
+    }
+    MicrocodeFmpPrivate->MicrocodeEntry[Count].MicrocodeEntryPoint = MicrocodeEntryPoint;
+    MicrocodeFmpPrivate->MicrocodeEntry[Count].TotalSize = TotalSize;
+    MicrocodeFmpPrivate->MicrocodeEntry[Count].InUse = FALSE;
+
+    Status = AddMicrocodeIndexEntry (
+               MicrocodeFmpPrivate,
+               &IndexCapacity,
+               MicrocodeEntryPoint->ProcessorSignature.Uint32,
+               MicrocodeEntryPoint->ProcessorFlags,
+               Count
+               );
+    if (EFI_ERROR(Status)) {
+      FreeMicrocodeIndex (MicrocodeFmpPrivate);
+      return Status;
+    }
+
+    //
+    // The region is untrusted input, so only index an extended signature
+    // table which lies completely inside the Microcode and the region.
+    //
+    if ((DataSize + sizeof(CPU_MICROCODE_HEADER) < TotalSize) &&
+        ((UINTN)MicrocodeEntryPoint + TotalSize <= MicrocodeEnd)) {
+      ExtendedTableLength = TotalSize - (DataSize + sizeof(CPU_MICROCODE_HEADER));
+      if (ExtendedTableLength > sizeof(CPU_MICROCODE_EXTENDED_TABLE_HEADER)) {
+        ExtendedTableHeader = (CPU_MICROCODE_EXTENDED_TABLE_HEADER *)((UINT8 *)(MicrocodeEntryPoint) + DataSize + sizeof(CPU_MICROCODE_HEADER));
+        ExtendedTableCount = ExtendedTableHeader->ExtendedSignatureCount;
+        if (ExtendedTableCount <= (ExtendedTableLength - sizeof(CPU_MICROCODE_EXTENDED_TABLE_HEADER)) / sizeof(CPU_MICROCODE_EXTENDED_TABLE)) {
+          ExtendedTable = (CPU_MICROCODE_EXTENDED_TABLE *)(ExtendedTableHeader + 1);
+          for (Index = 0; Index < ExtendedTableCount; Index++, ExtendedTable++) {
+            Status = AddMicrocodeIndexEntry (
+                       MicrocodeFmpPrivate,
+                       &IndexCapacity,
+                       ExtendedTable->ProcessorSignature.Uint32,
+                       ExtendedTable->ProcessorFlag,
+                       Count
+                       );
+            if (EFI_ERROR(Status)) {
+              FreeMicrocodeIndex (MicrocodeFmpPrivate);
+              return Status;
+            }
+          }
+        }
+      }
+    }
+
+    Count++;
+    ASSERT(Count < 0xFF);
+
+    //
+    // Get the next patch.
+    //
+    MicrocodeEntryPoint = (CPU_MICROCODE_HEADER *) (((UINTN) MicrocodeEntryPoint) + TotalSize);
+  } while (((UINTN) MicrocodeEntryPoint < MicrocodeEnd));
+
+  MicrocodeFmpPrivate->MicrocodeEntryCount = Count;
+  DEBUG((DEBUG_INFO, "BuildMicrocodeIndex - 0x%x Microcode, 0x%x index entries\n", Count, MicrocodeFmpPrivate->MicrocodeIndexCount));
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Return the first Microcode index entry of a ProcessorSignature.
+
+  @param[in]  MicrocodeFmpPrivate        The Microcode driver private data
+  @param[in]  ProcessorSignature         The processor signature to look up
+
+  @return The position of the first entry in MicrocodeIndexTable, or
+          MicrocodeIndexCount if no Microcode has the ProcessorSignature.
+**/
+UINTN
+FindMicrocodeIndexEntry (
+  IN MICROCODE_FMP_PRIVATE_DATA  *MicrocodeFmpPrivate,
+  IN UINT32                      ProcessorSignature
+  )
+{
+  UINTN  Low;
+  UINTN  High;
+  UINTN  Middle;
+
+  Low = 0;
+  High = MicrocodeFmpPrivate->MicrocodeIndexCount;
+  while (Low < High) {
+    Middle = Low + (High - Low) / 2;
+    if (MicrocodeFmpPrivate->MicrocodeIndexTable[Middle].ProcessorSignature < ProcessorSignature) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
+    }
+  }
+
+  if ((Low < MicrocodeFmpPrivate->MicrocodeIndexCount) &&
+      (MicrocodeFmpPrivate->MicrocodeIndexTable[Low].ProcessorSignature == ProcessorSignature)) {
+    return Low;
+  }
+  return MicrocodeFmpPrivate->MicrocodeIndexCount;
+}
+
 /**
   Get current Microcode information.
 
   The ProcessorInformation (BspIndex/ProcessorCount/ProcessorInfo)
   in MicrocodeFmpPrivate must be initialized.
 
+  The Microcode index must be built by BuildMicrocodeIndex(). Only the
+  Microcode which the index matches to a processor type of this system is
+  verified; the region itself is not scanned again.
+
   The MicrocodeInformation (DescriptorCount/ImageDescriptor/MicrocodeInfo)
   in MicrocodeFmpPrivate may not be avaiable in this function.
 
@@ -210,96 +653,100 @@ GetMicrocodeInfo (
   OUT MICROCODE_INFO                 *MicrocodeInfo    OPTIONAL
   )
 {
-  VOID                                    *MicrocodePatchAddress;
-  UINTN                                   MicrocodePatchRegionSize;
   CPU_MICROCODE_HEADER                    *MicrocodeEntryPoint;
-  UINTN                                   MicrocodeEnd;
   UINTN                                   TotalSize;
   UINTN                                   Count;
+  UINTN                                   Index;
+  UINTN                                   TypeIndex;
+  UINTN                                   VerifiedCount;
   UINT64                                  ImageAttributes;
   BOOLEAN                                 IsInUse;
+  BOOLEAN                                 *Matched;
   EFI_STATUS                              Status;
   UINT32                                  AttemptStatus;
   UINTN                                   TargetCpuIndex;
+  PROCESSOR_TYPE_INFO                     *ProcessorTypeInfo;
+  MICROCODE_INDEX_ENTRY                   *IndexEntry;
 
-  MicrocodePatchAddress = MicrocodeFmpPrivate->MicrocodePatchAddress;
-  MicrocodePatchRegionSize = MicrocodeFmpPrivate->MicrocodePatchRegionSize;
-
-  DEBUG((DEBUG_INFO, "Microcode Region - 0x%x - 0x%x\n", MicrocodePatchAddress, MicrocodePatchRegionSize));
+  DEBUG((DEBUG_INFO, "Microcode Region - 0x%x - 0x%x\n", MicrocodeFmpPrivate->MicrocodePatchAddress, MicrocodeFmpPrivate->MicrocodePatchRegionSize));
 
-  Count = 0;
+  Count = MicrocodeFmpPrivate->MicrocodeEntryCount;
+  if (ImageDescriptor == NULL && MicrocodeInfo == NULL) {
+    return Count;
+  }
 
-  MicrocodeEnd = (UINTN)MicrocodePatchAddress + MicrocodePatchRegionSize;
-  MicrocodeEntryPoint = (CPU_MICROCODE_HEADER *) (UINTN) MicrocodePatchAddress;
-  do {
-    if (MicrocodeEntryPoint->HeaderVersion == 0x1 && MicrocodeEntryPoint->LoaderRevision == 0x1) {
-      //
-      // It is the microcode header. It is not the padding data between microcode patches
-      // becasue the padding data should not include 0x00000001 and it should be the repeated
-      // byte format (like 0xXYXYXYXY....).
-      //
-      if (MicrocodeEntryPoint->DataSize == 0) {
-        TotalSize = 2048;
-      } else {
-        TotalSize = MicrocodeEntryPoint->TotalSize;
+  //
+  // Look up each processor type in the index. Microcode which matches no
+  // processor type can not be in use, so it is not verified (and checksummed)
+  // at all. Without the lookup table every Microcode is verified.
+  //
+  Matched = AllocateZeroPool (sizeof(BOOLEAN) * (Count + 1));
+  if (Matched != NULL) {
+    for (TypeIndex = 0; TypeIndex < MicrocodeFmpPrivate->ProcessorTypeCount; TypeIndex++) {
+      ProcessorTypeInfo = &MicrocodeFmpPrivate->ProcessorTypeInfo[TypeIndex];
+      for (Index = FindMicrocodeIndexEntry (MicrocodeFmpPrivate, ProcessorTypeInfo->ProcessorSignature);
+           Index < MicrocodeFmpPrivate->MicrocodeIndexCount;
+           Index++) {
+        IndexEntry = &MicrocodeFmpPrivate->MicrocodeIndexTable[Index];
+        if (IndexEntry->ProcessorSignature != ProcessorTypeInfo->ProcessorSignature) {
+          break;
+        }
+        if ((IndexEntry->ProcessorFlags & (1 << ProcessorTypeInfo->PlatformId)) != 0) {
+          Matched[IndexEntry->MicrocodeIndex] = TRUE;
+        }
       }
+    }
+  }
+
+  VerifiedCount = 0;
+  for (Index = 0; Index < Count; Index++) {
+    MicrocodeEntryPoint = MicrocodeFmpPrivate->MicrocodeEntry[Index].MicrocodeEntryPoint;
+    TotalSize = MicrocodeFmpPrivate->MicrocodeEntry[Index].TotalSize;
 
+    IsInUse = FALSE;
+    if (Matched == NULL || Matched[Index]) {
+      VerifiedCount++;
       TargetCpuIndex = (UINTN)-1;
       Status = VerifyMicrocode(MicrocodeFmpPrivate, MicrocodeEntryPoint, TotalSize, FALSE, &AttemptStatus, NULL, &TargetCpuIndex);
       if (!EFI_ERROR(Status)) {
         IsInUse = TRUE;
         ASSERT (TargetCpuIndex < MicrocodeFmpPrivate->ProcessorCount);
-        MicrocodeFmpPrivate->ProcessorInfo[TargetCpuIndex].MicrocodeIndex = Count;
-      } else {
-        IsInUse = FALSE;
+        MicrocodeFmpPrivate->ProcessorInfo[TargetCpuIndex].MicrocodeIndex = Index;
       }
+    }
 
-      if (ImageDescriptor != NULL && DescriptorCount > Count) {
-        ImageDescriptor[Count].ImageIndex = (UINT8)(Count + 1);
-        CopyGuid (&ImageDescriptor[Count].ImageTypeId, &gMicrocodeFmpImageTypeIdGuid);
-        ImageDescriptor[Count].ImageId = LShiftU64(MicrocodeEntryPoint->ProcessorFlags, 32) + MicrocodeEntryPoint->ProcessorSignature.Uint32;
-        ImageDescriptor[Count].ImageIdName = NULL;
-        ImageDescriptor[Count].Version = MicrocodeEntryPoint->UpdateRevision;
-        ImageDescriptor[Count].VersionName = NULL;
-        ImageDescriptor[Count].Size = TotalSize;
-        ImageAttributes = IMAGE_ATTRIBUTE_IMAGE_UPDATABLE | IMAGE_ATTRIBUTE_RESET_REQUIRED;
-        if (IsInUse) {
-          ImageAttributes |= IMAGE_ATTRIBUTE_IN_USE;
-        }
-        ImageDescriptor[Count].AttributesSupported = ImageAttributes | IMAGE_ATTRIBUTE_IN_USE;
-        ImageDescriptor[Count].AttributesSetting = ImageAttributes;
-        ImageDescriptor[Count].Compatibilities = 0;
-        ImageDescriptor[Count].LowestSupportedImageVersion = MicrocodeEntryPoint->UpdateRevision; // do not support rollback
-        ImageDescriptor[Count].LastAttemptVersion = 0;
-        ImageDescriptor[Count].LastAttemptStatus = 0;
-        ImageDescriptor[Count].HardwareInstance = 0;
-      }
-      if (MicrocodeInfo != NULL && DescriptorCount > Count) {
-        MicrocodeInfo[Count].MicrocodeEntryPoint = MicrocodeEntryPoint;
-        MicrocodeInfo[Count].TotalSize = TotalSize;
-        MicrocodeInfo[Count].InUse = IsInUse;
+    if (ImageDescriptor != NULL && DescriptorCount > Index) {
+      ImageDescriptor[Index].ImageIndex = (UINT8)(Index + 1);
+      CopyGuid (&ImageDescriptor[Index].ImageTypeId, &gMicrocodeFmpImageTypeIdGuid);
+      ImageDescriptor[Index].ImageId = LShiftU64(MicrocodeEntryPoint->ProcessorFlags, 32) + MicrocodeEntryPoint->ProcessorSignature.Uint32;
+      ImageDescriptor[Index].ImageIdName = NULL;
+      ImageDescriptor[Index].Version = MicrocodeEntryPoint->UpdateRevision;
+      ImageDescriptor[Index].VersionName = NULL;
+      ImageDescriptor[Index].Size = TotalSize;
+      ImageAttributes = IMAGE_ATTRIBUTE_IMAGE_UPDATABLE | IMAGE_ATTRIBUTE_RESET_REQUIRED;
+      if (IsInUse) {
+        ImageAttributes |= IMAGE_ATTRIBUTE_IN_USE;
       }
-    } else {
-      //
-      // It is the padding data between the microcode patches for microcode patches alignment.
-      // Because the microcode patch is the multiple of 1-KByte, the padding data should not
-      // exist if the microcode patch alignment value is not larger than 1-KByte. So, the microcode
-      // alignment value should be larger than 1-KByte. We could skip SIZE_1KB padding data to
-      // find the next possible microcode patch header.
-      //
-      MicrocodeEntryPoint = (CPU_MICROCODE_HEADER *) (((UINTN) MicrocodeEntryPoint) + SIZE_1KB);
-      continue;
+      ImageDescriptor[Index].AttributesSupported = ImageAttributes | IMAGE_ATTRIBUTE_IN_USE;
+      ImageDescriptor[Index].AttributesSetting = ImageAttributes;
+      ImageDescriptor[Index].Compatibilities = 0;
+      ImageDescriptor[Index].LowestSupportedImageVersion = MicrocodeEntryPoint->UpdateRevision; // do not support rollback
+      ImageDescriptor[Index].LastAttemptVersion = 0;
+      ImageDescriptor[Index].LastAttemptStatus = 0;
+      ImageDescriptor[Index].HardwareInstance = 0;
     }
+    if (MicrocodeInfo != NULL && DescriptorCount > Index) {
+      MicrocodeInfo[Index].MicrocodeEntryPoint = MicrocodeEntryPoint;
+      MicrocodeInfo[Index].TotalSize = TotalSize;
+      MicrocodeInfo[Index].InUse = IsInUse;
+    }
+  }
 
-    Count++;
-    ASSERT(Count < 0xFF);
-
-    //
-    // Get the next patch.
-    //
-    MicrocodeEntryPoint = (CPU_MICROCODE_HEADER *) (((UINTN) MicrocodeEntryPoint) + TotalSize);
-  } while (((UINTN) MicrocodeEntryPoint < MicrocodeEnd));
+  if (Matched != NULL) {
+    FreePool (Matched);
+  }
 
+  DEBUG((DEBUG_INFO, "GetMicrocodeInfo - verified 0x%x of 0x%x Microcode\n", VerifiedCount, Count));
   return Count;
 }
 
@@ -322,7 +769,8 @@ GetMatchedProcessor (
   IN OUT UINTN                   *TargetCpuIndex
   )
 {
-  UINTN  Index;
+  UINTN                Index;
+  PROCESSOR_TYPE_INFO  *ProcessorTypeInfo;
 
   if (*TargetCpuIndex != (UINTN)-1) {
     Index = *TargetCpuIndex;
@@ -334,6 +782,22 @@ GetMatchedProcessor (
     }
   }
 
+  //
+  // The first processor of each type is the first processor with that
+  // ProcessorSignature and PlatformId, so only the types need to be checked.
+  //
+  if (MicrocodeFmpPrivate->ProcessorTypeInfo != NULL) {
+    for (Index = 0; Index < MicrocodeFmpPrivate->ProcessorTypeCount; Index++) {
+      ProcessorTypeInfo = &MicrocodeFmpPrivate->ProcessorTypeInfo[Index];
+      if ((ProcessorSignature == ProcessorTypeInfo->ProcessorSignature) &&
+          ((ProcessorFlags & (1 << ProcessorTypeInfo->PlatformId)) != 0)) {
+        *TargetCpuIndex = ProcessorTypeInfo->CpuIndex;
+        return &MicrocodeFmpPrivate->ProcessorInfo[ProcessorTypeInfo->CpuIndex];
+      }
+    }
+    return NULL;
+  }
+
   for (Index = 0; Index < MicrocodeFmpPrivate->ProcessorCount; Index++) {
     if ((ProcessorSignature == MicrocodeFmpPrivate->ProcessorInfo[Index].ProcessorSignature) &&
         ((ProcessorFlags & (1 << MicrocodeFmpPrivate->ProcessorInfo[Index].PlatformId)) != 0)) {
@@ -1278,14 +1742,25 @@ MicrocodeWrite (
     return EFI_OUT_OF_RESOURCES;
   }
 
+  PERF_INMODULE_BEGIN ("MicrocodeVerify");
   TargetCpuIndex = (UINTN)-1;
   Status = VerifyMicrocode(MicrocodeFmpPrivate, AlignedImage, ImageSize, TRUE, LastAttemptStatus, AbortReason, &TargetCpuIndex);
+  PERF_INMODULE_END ("MicrocodeVerify");
   if (EFI_ERROR(Status)) {
     DEBUG((DEBUG_ERROR, "Fail to verify Microcode Region\n"));
     FreePool(AlignedImage);
     return Status;
   }
   DEBUG((DEBUG_INFO, "Pass VerifyMicrocode\n"));
+
+  //
+  // The flash update below does not depend on the other processors, so a
+  // failure here is reported but does not abort the update.
+  //
+  PERF_INMODULE_BEGIN ("MicrocodeLoadAll");
+  Status = LoadMicrocodeOnAllProcessors (MicrocodeFmpPrivate, AlignedImage, ImageSize, TargetCpuIndex);
+  PERF_INMODULE_END ("MicrocodeLoadAll");
+  DEBUG((DEBUG_INFO, "LoadMicrocodeOnAllProcessors - %r\n", Status));
   *LastAttemptVersion = ((CPU_MICROCODE_HEADER *)Image)->UpdateRevision;
 
   DEBUG((DEBUG_INFO, "  TargetCpuIndex - 0x%x\n", TargetCpuIndex));
@@ -1300,6 +1775,7 @@ MicrocodeWrite (
   }
   DEBUG((DEBUG_INFO, "  TargetMicrocodeEntryPoint - 0x%x\n", TargetMicrocodeEntryPoint));
 
+  PERF_INMODULE_BEGIN ("MicrocodeFlashUpdate");
   if (MicrocodeFmpPrivate->FitMicrocodeInfo != NULL) {
     Status = UpdateMicrocodeFlashRegionWithFit (
                MicrocodeFmpPrivate,
@@ -1317,6 +1793,7 @@ MicrocodeWrite (
                LastAttemptStatus
                );
   }
+  PERF_INMODULE_END ("MicrocodeFlashUpdate");
 
   FreePool(AlignedImage);
 
@@ -31,6 +31,7 @@
 #include <Library/DevicePathLib.h>
 #include <Library/HobLib.h>
 #include <Library/MicrocodeFlashAccessLib.h>
+#include <Library/PerformanceLib.h>
 
 #include <Register/Cpuid.h>
 #include <Register/Msr.h>
@@ -61,18 +62,53 @@ typedef struct {
 } FIT_MICROCODE_INFO;
 
 typedef struct {
-  UINTN                  CpuIndex;
+  UINTN                      CpuIndex;
+  UINT32                     ProcessorSignature;
+  UINT8                      PlatformId;
+  UINT32                     MicrocodeRevision;
+  UINTN                      MicrocodeIndex;
+  UINTN                      ProcessorTypeIndex;
+  EFI_CPU_PHYSICAL_LOCATION  Location;
+} PROCESSOR_INFO;
+
+//
+// Distinct (ProcessorSignature, PlatformId) pairs in the system. CpuIndex is
+// the first processor of that type, so matching a Microcode against the type
+// table gives the same result as matching it against every processor.
+//
+typedef struct {
   UINT32                 ProcessorSignature;
   UINT8                  PlatformId;
-  UINT32                 MicrocodeRevision;
+  UINTN                  CpuIndex;
+  UINTN                  CpuCount;
+} PROCESSOR_TYPE_INFO;
+
+#define MICROCODE_INDEX_GROWTH  16
+
+//
+// One (ProcessorSignature, ProcessorFlags) pair of a Microcode in the
+// Microcode region. A Microcode with an extended signature table has one
+// entry per signature. The entries are sorted by ProcessorSignature, and the
+// entries of one ProcessorSignature stay in region order. MicrocodeIndex is
+// the position of the Microcode in the region.
+//
+typedef struct {
+  UINT32                 ProcessorSignature;
+  UINT32                 ProcessorFlags;
   UINTN                  MicrocodeIndex;
-} PROCESSOR_INFO;
+} MICROCODE_INDEX_ENTRY;
 
 typedef struct {
   UINT64                 Address;
   UINT32                 Revision;
 } MICROCODE_LOAD_BUFFER;
 
+typedef struct {
+  EFI_MP_SERVICES_PROTOCOL  *MpService;
+  UINT32                    UpdateRevision;
+  MICROCODE_LOAD_BUFFER     *LoadBuffer;
+} MICROCODE_LOAD_ALL_BUFFER;
+
 struct _MICROCODE_FMP_PRIVATE_DATA {
   UINT32                               Signature;
   EFI_FIRMWARE_MANAGEMENT_PROTOCOL     Fmp;
@@ -89,6 +125,12 @@ struct _MICROCODE_FMP_PRIVATE_DATA {
   UINTN                                BspIndex;
   UINTN                                ProcessorCount;
   PROCESSOR_INFO                       *ProcessorInfo;
+  UINTN                                ProcessorTypeCount;
+  PROCESSOR_TYPE_INFO                  *ProcessorTypeInfo;
+  UINTN                                MicrocodeEntryCount;
+  MICROCODE_INFO                       *MicrocodeEntry;
+  UINTN                                MicrocodeIndexCount;
+  MICROCODE_INDEX_ENTRY                *MicrocodeIndexTable;
   UINT32                               FitMicrocodeEntryCount;
   FIT_MICROCODE_INFO                   *FitMicrocodeInfo;
 };
@@ -142,12 +184,53 @@ CollectProcessorInfo (
   IN OUT VOID  *Buffer
   );
 
+/**
+  Scan the Microcode region once, and index its Microcode by
+  (ProcessorSignature, ProcessorFlags).
+
+  @param[in, out] MicrocodeFmpPrivate    The Microcode driver private data
+
+  @retval EFI_SUCCESS            The Microcode index is built.
+  @retval EFI_OUT_OF_RESOURCES   No enough resource for the Microcode index.
+**/
+EFI_STATUS
+BuildMicrocodeIndex (
+  IN OUT MICROCODE_FMP_PRIVATE_DATA  *MicrocodeFmpPrivate
+  );
+
+/**
+  Free the Microcode index.
+
+  @param[in, out] MicrocodeFmpPrivate    The Microcode driver private data
+**/
+VOID
+FreeMicrocodeIndex (
+  IN OUT MICROCODE_FMP_PRIVATE_DATA  *MicrocodeFmpPrivate
+  );
+
+/**
+  Return the first Microcode index entry of a ProcessorSignature.
+
+  @param[in]  MicrocodeFmpPrivate        The Microcode driver private data
+  @param[in]  ProcessorSignature         The processor signature to look up
+
+  @return The position of the first entry in MicrocodeIndexTable, or
+          MicrocodeIndexCount if no Microcode has the ProcessorSignature.
+**/
+UINTN
+FindMicrocodeIndexEntry (
+  IN MICROCODE_FMP_PRIVATE_DATA  *MicrocodeFmpPrivate,
+  IN UINT32                      ProcessorSignature
+  );
+
 /**
   Get current Microcode information.
 
   The ProcessorInformation (BspIndex/ProcessorCount/ProcessorInfo)
   in MicrocodeFmpPrivate must be initialized.
 
+  The Microcode index must be built by BuildMicrocodeIndex().
+
   The MicrocodeInformation (DescriptorCount/ImageDescriptor/MicrocodeInfo)
   in MicrocodeFmpPrivate may not be avaiable in this function.
 
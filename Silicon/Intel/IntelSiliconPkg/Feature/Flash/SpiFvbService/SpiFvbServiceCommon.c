@@ -16,6 +16,11 @@
 //
 FVB_GLOBAL   mFvbModuleGlobal;
 
+//
+// SPI operation counters of this driver
+//
+SPI_FVB_STATISTICS  mSpiFvbStatistics;
+
 //
 // This platform driver knows there are multiple FVs on FD.
 // Now we only provide FVs on Variable region and MicorCode region for performance issue.
@@ -270,6 +275,139 @@ FvbReadBlock (
   }
 }
 
+/**
+  Programs the bytes of a flash range that differ from the input buffer.
+
+  The current flash content is read back through the memory mapped flash.
+  Bytes that already hold the requested value are not programmed again, and
+  the changed bytes of each flash page are merged into one program operation.
+
+  @param[in]      Address           The starting physical address of the write.
+  @param[in, out] NumBytes          On input, the number of bytes to write. On output,
+                                    the number of bytes from Address that hold the
+                                    content of Buffer.
+  @param[in]      Buffer            The source data buffer for the write.
+
+  @retval     EFI_SUCCESS           The range holds the content of Buffer.
+  @retval     EFI_DEVICE_ERROR      The block device is not functioning correctly and
+                                    could not be written, or wrote fewer bytes than
+                                    requested
+
+**/
+EFI_STATUS
+FvbProgramRange (
+  IN        UINTN                         Address,
+  IN OUT    UINTN                         *NumBytes,
+  IN        UINT8                         *Buffer
+  )
+{
+  EFI_STATUS                              Status;
+  volatile UINT8                          *Flash;
+  UINTN                                   Index;
+  UINTN                                   PageEnd;
+  UINTN                                   First;
+  UINTN                                   Last;
+  UINT32                                  ProgramSize;
+
+  mSpiFvbStatistics.WriteRequests++;
+  mSpiFvbStatistics.BytesRequested += *NumBytes;
+
+  WriteBackInvalidateDataCacheRange ((VOID *) Address, *NumBytes);
+  Flash = (volatile UINT8 *) Address;
+
+  for (Index = 0; Index < *NumBytes; Index = PageEnd) {
+    PageEnd = Index + SPI_FVB_PAGE_SIZE - ((Address + Index) & (SPI_FVB_PAGE_SIZE - 1));
+    if (PageEnd > *NumBytes) {
+      PageEnd = *NumBytes;
+    }
+
+    //
+    // Find the first and the last changed byte in this page.
+    //
+    for (First = Index; First < PageEnd && Flash[First] == Buffer[First]; First++) {
+    }
+    if (First == PageEnd) {
+      continue;
+    }
+    for (Last = PageEnd; Flash[Last - 1] == Buffer[Last - 1]; Last--) {
+    }
+
+    ProgramSize = (UINT32) (Last - First);
+    Status = SpiFlashWrite (Address + First, &ProgramSize, Buffer + First);
+    if (EFI_ERROR (Status) || (ProgramSize != Last - First)) {
+      //
+      // Everything before First already holds the content of Buffer.
+      //
+      if (ProgramSize > Last - First) {
+        ProgramSize = 0;
+      }
+      DEBUG ((
+        DEBUG_ERROR,
+        "FvbProgramRange: Wrote 0x%x of 0x%x bytes at 0x%lx - %r\n",
+        ProgramSize,
+        (UINT32) (Last - First),
+        (UINT64) (Address + First),
+        Status
+        ));
+      *NumBytes = First + ProgramSize;
+      return EFI_ERROR (Status) ? Status : EFI_DEVICE_ERROR;
+    }
+    mSpiFvbStatistics.ProgramOps++;
+    mSpiFvbStatistics.BytesProgrammed += ProgramSize;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Checks whether a flash block is already in the erased state.
+
+  @param[in]  Address               The starting physical address of the block.
+  @param[in]  NumBytes              The length of the block in bytes.
+
+  @retval     TRUE                  All bytes of the block are 0xFF.
+  @retval     FALSE                 The block needs to be erased.
+
+**/
+BOOLEAN
+FvbIsBlockErased (
+  IN        UINTN                         Address,
+  IN        UINTN                         NumBytes
+  )
+{
+  volatile UINT32                         *Flash;
+  UINTN                                   Index;
+
+  WriteBackInvalidateDataCacheRange ((VOID *) Address, NumBytes);
+  Flash = (volatile UINT32 *) Address;
+
+  for (Index = 0; Index < NumBytes / sizeof (UINT32); Index++) {
+    if (Flash[Index] != MAX_UINT32) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Dump the SPI operation counters of this driver.
+
+**/
+VOID
+SpiFvbDumpStatistics (
+  VOID
+  )
+{
+  DEBUG ((DEBUG_INFO, "SpiFvbService statistics:\n"));
+  DEBUG ((DEBUG_INFO, "  WriteRequests   - 0x%lx\n", mSpiFvbStatistics.WriteRequests));
+  DEBUG ((DEBUG_INFO, "  BytesRequested  - 0x%lx\n", mSpiFvbStatistics.BytesRequested));
+  DEBUG ((DEBUG_INFO, "  ProgramOps      - 0x%lx\n", mSpiFvbStatistics.ProgramOps));
+  DEBUG ((DEBUG_INFO, "  BytesProgrammed - 0x%lx\n", mSpiFvbStatistics.BytesProgrammed));
+  DEBUG ((DEBUG_INFO, "  EraseRequests   - 0x%lx\n", mSpiFvbStatistics.EraseRequests));
+  DEBUG ((DEBUG_INFO, "  EraseOps        - 0x%lx\n", mSpiFvbStatistics.EraseOps));
+}
+
 /**
   Writes specified number of bytes from the input buffer to the block.
 
@@ -344,7 +482,7 @@ FvbWriteBlock (
     BadBufferSize = TRUE;
   }
 
-  Status = SpiFlashWrite (LbaAddress + BlockOffset, (UINT32 *)NumBytes, Buffer);
+  Status = FvbProgramRange (LbaAddress + BlockOffset, NumBytes, Buffer);
   if (EFI_ERROR (Status)) {
     return Status;
   }
@@ -410,10 +548,19 @@ FvbEraseBlock (
     return Status;
   }
 
+  //
+  // Reclaim and FTW erase blocks that are often still blank, skip those.
+  //
+  mSpiFvbStatistics.EraseRequests++;
+  if (FvbIsBlockErased (LbaAddress, LbaLength)) {
+    return EFI_SUCCESS;
+  }
+
   Status = SpiFlashBlockErase (LbaAddress, &LbaLength);
   if (EFI_ERROR (Status)) {
     return Status;
   }
+  mSpiFvbStatistics.EraseOps++;
 
   Status = SpiFlashLock ();
   if (EFI_ERROR (Status)) {
@@ -80,6 +80,24 @@ typedef struct {
   UINT32              FvSize;
 } FV_INFO;
 
+//
+// Serial flash page size. A program operation never crosses a page, so the
+// changed bytes of one page are written with a single program operation.
+//
+#define SPI_FVB_PAGE_SIZE             256
+
+//
+// SPI operation counters, dumped at ready to boot for boot-time analysis.
+//
+typedef struct {
+  UINT64              WriteRequests;
+  UINT64              BytesRequested;
+  UINT64              ProgramOps;
+  UINT64              BytesProgrammed;
+  UINT64              EraseRequests;
+  UINT64              EraseOps;
+} SPI_FVB_STATISTICS;
+
 //
 // Firmware Volume Block (FVB) Protocol APIs
 //
@@ -146,6 +164,15 @@ IsFvHeaderValid (
   IN CONST EFI_FIRMWARE_VOLUME_HEADER    *FwVolHeader
   );
 
+/**
+  Dump the SPI operation counters of this driver.
+
+**/
+VOID
+SpiFvbDumpStatistics (
+  VOID
+  );
+
 //
 // Module Local Functions
 //
@@ -185,5 +212,6 @@ extern FV_MEMMAP_DEVICE_PATH              mFvMemmapDevicePathTemplate;
 extern FV_PIWG_DEVICE_PATH                mFvPIWGDevicePathTemplate;
 extern EFI_FIRMWARE_VOLUME_BLOCK_PROTOCOL mFvbProtocolTemplate;
 extern FV_INFO                            mPlatformFvBaseAddress[];
+extern SPI_FVB_STATISTICS                 mSpiFvbStatistics;
 
 #endif
@@ -12,6 +12,7 @@
 #include <Library/MmServicesTableLib.h>
 #include <Library/UefiDriverEntryPoint.h>
 #include <Protocol/SmmFirmwareVolumeBlock.h>
+#include <Protocol/SmmReadyToBoot.h>
 #include <Guid/VariableFormat.h>
 
 /**
@@ -91,6 +92,27 @@ InstallFvbProtocol (
   ASSERT_EFI_ERROR (Status);
 }
 
+/**
+  MM Ready To Boot event notification handler.
+
+  @param[in] Protocol   Points to the protocol's unique identifier.
+  @param[in] Interface  Points to the interface instance.
+  @param[in] Handle     The handle on which the interface was installed.
+
+  @retval EFI_SUCCESS   Notification handler runs successfully.
+**/
+EFI_STATUS
+EFIAPI
+SpiFvbMmReadyToBootNotify (
+  IN CONST EFI_GUID  *Protocol,
+  IN VOID            *Interface,
+  IN EFI_HANDLE      Handle
+  )
+{
+  SpiFvbDumpStatistics ();
+  return EFI_SUCCESS;
+}
+
 /**
   The function does the necessary initialization work for
   the Firmware Volume Block Driver.
@@ -117,6 +139,7 @@ FvbInitialize (
   VARIABLE_STORE_HEADER                 *VariableStoreHeader;
   UINT8                                 VariableStoreType;
   UINT8                                 *NvStoreBuffer;
+  VOID                                  *ReadyToBootRegistration;
 
   Status = GetVariableFlashNvStorageInfo (&BaseAddress, &NvStorageFvSize);
   if (EFI_ERROR (Status)) {
@@ -365,4 +388,11 @@ FvbInitialize (
 
     }
   }
+
+  Status = gMmst->MmRegisterProtocolNotify (
+                    &gEdkiiSmmReadyToBootProtocolGuid,
+                    SpiFvbMmReadyToBootNotify,
+                    &ReadyToBootRegistration
+                    );
+  ASSERT_EFI_ERROR (Status);
 }
@@ -0,0 +1,107 @@
+/** @file
+  The definition of the PCH SMI residency profile communication interface.
+
+  The PCH SMI dispatcher collects TSC based residency counters per top level SMI
+  source and per child handler in SMRAM. They can be read through
+  EFI_SMM_COMMUNICATION_PROTOCOL with gPchSmiResidencyProfileGuid, in the same
+  two step way as the SMI handler profile: GET_INFO returns the size of a
+  snapshot, GET_DATA_BY_OFFSET copies the snapshot out piece by piece.
+  The interface is read only.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#ifndef _PCH_SMI_RESIDENCY_PROFILE_H_
+#define _PCH_SMI_RESIDENCY_PROFILE_H_
+
+#define PCH_SMI_RESIDENCY_PROFILE_GUID \
+  { \
+    0x545ef335, 0xd733, 0x40ac, { 0x9f, 0x62, 0x44, 0xb1, 0x66, 0xd8, 0xc1, 0xb2 } \
+  }
+
+extern EFI_GUID gPchSmiResidencyProfileGuid;
+
+#define PCH_SMI_RESIDENCY_PROFILE_COMMAND_GET_INFO            0x1
+#define PCH_SMI_RESIDENCY_PROFILE_COMMAND_GET_DATA_BY_OFFSET  0x2
+
+typedef struct {
+  UINT32                              Command;
+  UINT32                              DataLength;
+  UINT64                              ReturnStatus;
+} PCH_SMI_RESIDENCY_PROFILE_PARAMETER_HEADER;
+
+typedef struct {
+  PCH_SMI_RESIDENCY_PROFILE_PARAMETER_HEADER  Header;
+  UINT64                                      DataSize;
+} PCH_SMI_RESIDENCY_PROFILE_PARAMETER_GET_INFO;
+
+typedef struct {
+  PCH_SMI_RESIDENCY_PROFILE_PARAMETER_HEADER  Header;
+  ///
+  /// On input, data buffer size.
+  /// On output, actual data buffer size copied.
+  ///
+  UINT64                                      DataSize;
+  PHYSICAL_ADDRESS                            DataBuffer;
+  ///
+  /// On input, data buffer offset to copy.
+  /// On output, next time data buffer offset to copy.
+  ///
+  UINT64                                      DataOffset;
+} PCH_SMI_RESIDENCY_PROFILE_PARAMETER_GET_DATA_BY_OFFSET;
+
+///
+/// Snapshot layout:
+///   PCH_SMI_RESIDENCY_PROFILE_HEADER
+///   PCH_SMI_RESIDENCY_SOURCE_ENTRY   [SourceCount]
+///   PCH_SMI_RESIDENCY_HANDLER_ENTRY  [HandlerCount]
+///   PCH_SMI_RESIDENCY_RING_ENTRY     [RingCount], oldest first
+/// All times are in TSC ticks.
+///
+#define PCH_SMI_RESIDENCY_PROFILE_SIGNATURE  SIGNATURE_32 ('P', 'S', 'R', 'P')
+
+///
+/// StsBit value of the sources which are not reported in PMC SMI_STS
+///
+#define PCH_SMI_RESIDENCY_STS_BIT_OTHER      0xFFFFFFFF
+
+typedef struct {
+  UINT64                              Count;
+  UINT64                              TotalTicks;
+  UINT64                              MaxTicks;
+} PCH_SMI_RESIDENCY_COUNTER;
+
+typedef struct {
+  UINT32                              Signature;
+  UINT32                              Length;       ///< Length of the whole snapshot
+  UINT32                              SourceCount;
+  UINT32                              HandlerCount;
+  UINT32                              RingCount;
+  UINT32                              Reserved;
+  PCH_SMI_RESIDENCY_COUNTER           Dispatcher;   ///< Whole PCH SMI dispatcher invocations
+} PCH_SMI_RESIDENCY_PROFILE_HEADER;
+
+typedef struct {
+  UINT32                              StsBit;       ///< PMC SMI_STS bit or PCH_SMI_RESIDENCY_STS_BIT_OTHER
+  UINT32                              Reserved;
+  PCH_SMI_RESIDENCY_COUNTER           Counter;
+} PCH_SMI_RESIDENCY_SOURCE_ENTRY;
+
+typedef struct {
+  UINT64                              Handler;      ///< Address of the child callback
+  UINT32                              StsBit;       ///< PMC SMI_STS bit or PCH_SMI_RESIDENCY_STS_BIT_OTHER
+  UINT32                              ProtocolType; ///< Dispatcher internal protocol type
+  UINT32                              PchSmiType;   ///< PCH_SMI_TYPES, valid for PCH SMI dispatch protocols
+  UINT32                              Reserved;
+  PCH_SMI_RESIDENCY_COUNTER           Counter;
+} PCH_SMI_RESIDENCY_HANDLER_ENTRY;
+
+typedef struct {
+  UINT64                              StartTsc;     ///< TSC when the source was found active
+  UINT64                              Ticks;        ///< Time spent servicing the source
+  UINT32                              StsBit;       ///< PMC SMI_STS bit or PCH_SMI_RESIDENCY_STS_BIT_OTHER
+  UINT32                              Reserved;
+} PCH_SMI_RESIDENCY_RING_ENTRY;
+
+#endif
@@ -2198,9 +2198,15 @@ PchSmiTypeCallbackDispatcher (
   PCH_SMI_TYPES                         PchSmiType;
   UINTN                                 RpIndex;
   PCH_PCIE_SMI_RP_CONTEXT               RpContext;
+  UINT64                                StartTicks;
 
   PchSmiType = Record->PchSmiType;
   Status     = EFI_SUCCESS;
+  StartTicks = 0;
+
+  if (FixedPcdGetBool (PcdPchSmiResidencyProfileEnable)) {
+    StartTicks = AsmReadTsc ();
+  }
 
   switch (PchSmiType) {
     case PchTcoSmiMchType:
@@ -2244,6 +2250,13 @@ PchSmiTypeCallbackDispatcher (
       break;
   }
 
+  //
+  // Skip the accounting if the child has unregistered itself in the callback
+  //
+  if (FixedPcdGetBool (PcdPchSmiResidencyProfileEnable) && !EFI_ERROR (Status) && (mDispatchRecord == Record)) {
+    PchSmmResidencyRecordHandler (Record, AsmReadTsc () - StartTicks);
+  }
+
   return Status;
 }
 
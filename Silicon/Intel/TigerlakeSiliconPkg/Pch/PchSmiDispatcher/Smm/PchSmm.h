@@ -44,6 +44,7 @@
 #include <Protocol/PchEspiSmiDispatch.h>
 #include <Protocol/IoTrapExDispatch.h>
 #include <Library/PmcLib.h>
+#include <Guid/PchSmiResidencyProfile.h>
 #include "IoTrap.h"
 
 #define EFI_BAD_POINTER          0xAFAFAFAFAFAFAFAFULL
@@ -424,6 +425,14 @@ VOID
 struct _DATABASE_RECORD {
   UINT32                        Signature;
   LIST_ENTRY                    Link;
+  ///
+  /// Link in the status bucket selected by SrcDesc.PmcSmiSts
+  ///
+  LIST_ENTRY                    StsLink;
+  ///
+  /// Registration sequence number, lower numbers were registered first
+  ///
+  UINTN                         Order;
   BOOLEAN                       Processed;
   ///
   /// Status and Enable bit description
@@ -465,10 +474,15 @@ struct _DATABASE_RECORD {
   /// Indicate the PCH SMI types.
   ///
   PCH_SMI_TYPES                 PchSmiType;
+  ///
+  /// Residency of this child, only updated when PcdPchSmiResidencyProfileEnable is TRUE
+  ///
+  PCH_SMI_RESIDENCY_COUNTER     Residency;
 };
 
 #define DATABASE_RECORD_FROM_LINK(_record)  CR (_record, DATABASE_RECORD, Link, DATABASE_RECORD_SIGNATURE)
 #define DATABASE_RECORD_FROM_CHILDCONTEXT(_record)  CR (_record, DATABASE_RECORD, ChildContext, DATABASE_RECORD_SIGNATURE)
+#define DATABASE_RECORD_FROM_STS_LINK(_record)  CR (_record, DATABASE_RECORD, StsLink, DATABASE_RECORD_SIGNATURE)
 
 ///
 /// HOOKING INTO THE ARCHITECTURE
@@ -593,6 +607,20 @@ typedef struct {
   PROTOCOL_SIGNATURE \
   )
 
+///
+/// Besides CallbackDataBase, every record is linked into one status bucket.
+/// Buckets 0-31 hold the sources whose top level status is that bit of PMC SMI_STS,
+/// so the dispatcher only walks the buckets of pending bits. Sources without a
+/// SMI_STS top level bit go to PCH_SMM_STS_BUCKET_OTHER, which is walked on every SMI.
+///
+#define PCH_SMM_STS_BUCKET_OTHER  32
+#define PCH_SMM_STS_BUCKET_MAX    33
+
+///
+/// Number of source dispatches kept in the residency profile ring
+///
+#define PCH_SMM_RESIDENCY_RING_SIZE  64
+
 ///
 /// Create private data for the protocols that we'll publish
 ///
@@ -601,11 +629,16 @@ typedef struct {
   EFI_HANDLE                  SmiHandle;
   EFI_HANDLE                  InstallMultProtHandle;
   PCH_SMM_QUALIFIED_PROTOCOL  Protocols[PCH_SMM_PROTOCOL_TYPE_MAX];
+  LIST_ENTRY                  StsBucket[PCH_SMM_STS_BUCKET_MAX];
 } PRIVATE_DATA;
 
 extern PRIVATE_DATA           mPrivateData;
 extern UINT16                 mAcpiBaseAddr;
 extern UINT16                 mTcoBaseAddr;
+///
+/// The child whose callback is being dispatched, cleared if the child unregisters
+///
+extern DATABASE_RECORD        *mDispatchRecord;
 
 /**
   The internal function used to create and insert a database record
@@ -623,6 +656,31 @@ SmmCoreInsertRecord (
   OUT EFI_HANDLE                        *DispatchHandle
   );
 
+/**
+  Get the status bucket of a SMI source. Sources whose top level status is a
+  bit in PMC SMI_STS go to the bucket of that bit, all others share
+  PCH_SMM_STS_BUCKET_OTHER.
+
+  @param[in] SrcDesc                    Pointer to the PCH SMI source description
+
+  @retval The status bucket index
+**/
+UINTN
+SmmCoreGetStsBucket (
+  IN CONST PCH_SMM_SOURCE_DESC          *SrcDesc
+  );
+
+/**
+  The internal function used to take a database record out of the database
+  and its status bucket. The record itself is not freed.
+
+  @param[in]  Record                    Record to remove from database.
+**/
+VOID
+SmmCoreRemoveRecord (
+  IN  DATABASE_RECORD                   *Record
+  );
+
 /**
   Get the Sleep type
 
@@ -1040,4 +1098,48 @@ PchGpiSmiUnRegister (
   IN       EFI_HANDLE                      DispatchHandle
   );
 
+/**
+  Account one PchSmmCoreDispatcher invocation in the residency profile.
+
+  @param[in] Ticks                TSC ticks spent in the dispatcher
+**/
+VOID
+PchSmmResidencyRecordDispatch (
+  IN UINT64                       Ticks
+  );
+
+/**
+  Account one serviced SMI source in the residency profile.
+
+  @param[in] Bucket               Status bucket of the source
+  @param[in] StartTsc             TSC when the source was found active
+  @param[in] Ticks                TSC ticks spent servicing the source
+**/
+VOID
+PchSmmResidencyRecordSource (
+  IN UINTN                        Bucket,
+  IN UINT64                       StartTsc,
+  IN UINT64                       Ticks
+  );
+
+/**
+  Account one child handler invocation in the residency profile.
+
+  @param[in] Record               The database record of the child
+  @param[in] Ticks                TSC ticks spent in the child handler
+**/
+VOID
+PchSmmResidencyRecordHandler (
+  IN DATABASE_RECORD              *Record,
+  IN UINT64                       Ticks
+  );
+
+/**
+  Register the residency profile communication handler.
+**/
+VOID
+PchSmmResidencyProfileInit (
+  VOID
+  );
+
 #endif
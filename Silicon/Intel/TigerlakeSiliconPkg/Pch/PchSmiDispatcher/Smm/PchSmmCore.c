@@ -24,6 +24,9 @@ GLOBAL_REMOVE_IF_UNREFERENCED UINT16                mAcpiBaseAddr;
 GLOBAL_REMOVE_IF_UNREFERENCED UINT16                mTcoBaseAddr;
 GLOBAL_REMOVE_IF_UNREFERENCED BOOLEAN               mReadyToLock;
 GLOBAL_REMOVE_IF_UNREFERENCED BOOLEAN               mS3SusStart;
+GLOBAL_REMOVE_IF_UNREFERENCED UINTN                 mNextRecordOrder;
+GLOBAL_REMOVE_IF_UNREFERENCED DATABASE_RECORD       *mDispatchRecord;
+GLOBAL_REMOVE_IF_UNREFERENCED LIST_ENTRY            *mDispatchNextLink;
 
 GLOBAL_REMOVE_IF_UNREFERENCED PRIVATE_DATA          mPrivateData = {
   {
@@ -219,6 +222,7 @@ InitializePchSmmDispatcher (
 {
   EFI_STATUS           Status;
   VOID                 *SmmReadyToLockRegistration;
+  UINTN                Bucket;
 
   mS3SusStart = FALSE;
   //
@@ -244,6 +248,9 @@ InitializePchSmmDispatcher (
   // Initialize Callback DataBase
   //
   InitializeListHead (&mPrivateData.CallbackDataBase);
+  for (Bucket = 0; Bucket < PCH_SMM_STS_BUCKET_MAX; Bucket++) {
+    InitializeListHead (&mPrivateData.StsBucket[Bucket]);
+  }
 
   //
   // Enable SMIs on the PCH now that we have a callback
@@ -260,6 +267,10 @@ InitializePchSmmDispatcher (
   InstallEspiSmi (ImageHandle);
   InstallPchSmmPeriodicTimerControlProtocol (mPrivateData.InstallMultProtHandle);
 
+  if (FixedPcdGetBool (PcdPchSmiResidencyProfileEnable)) {
+    PchSmmResidencyProfileInit ();
+  }
+
   //
   // Register EFI_SMM_READY_TO_LOCK_PROTOCOL_GUID notify function.
   //
@@ -273,6 +284,30 @@ InitializePchSmmDispatcher (
   return EFI_SUCCESS;
 }
 
+/**
+  Get the status bucket of a SMI source. Sources whose top level status is a
+  bit in PMC SMI_STS go to the bucket of that bit, all others share
+  PCH_SMM_STS_BUCKET_OTHER.
+
+  @param[in] SrcDesc                    Pointer to the PCH SMI source description
+
+  @retval The status bucket index
+**/
+UINTN
+SmmCoreGetStsBucket (
+  IN CONST PCH_SMM_SOURCE_DESC          *SrcDesc
+  )
+{
+  if (!IS_BIT_DESC_NULL (SrcDesc->PmcSmiSts) &&
+      (SrcDesc->PmcSmiSts.Reg.Type == ACPI_ADDR_TYPE) &&
+      (SrcDesc->PmcSmiSts.Reg.Data.acpi == R_ACPI_IO_SMI_STS) &&
+      (SrcDesc->PmcSmiSts.Bit < PCH_SMM_STS_BUCKET_OTHER))
+  {
+    return SrcDesc->PmcSmiSts.Bit;
+  }
+  return PCH_SMM_STS_BUCKET_OTHER;
+}
+
 /**
   The internal function used to create and insert a database record
 
@@ -305,11 +340,17 @@ SmmCoreInsertRecord (
     return EFI_OUT_OF_RESOURCES;
   }
   CopyMem (Record, NewRecord, sizeof (DATABASE_RECORD));
+  Record->Order = mNextRecordOrder++;
 
   //
   // After ensuring the source of event is not null, we will insert the record into the database
   //
   InsertTailList (&mPrivateData.CallbackDataBase, &Record->Link);
+  //
+  // Also file the record under its top level status bit so the dispatcher can find it
+  // without walking the whole database
+  //
+  InsertTailList (&mPrivateData.StsBucket[SmmCoreGetStsBucket (&Record->SrcDesc)], &Record->StsLink);
 
   //
   // Child's handle will be the address linked list link in the record
@@ -319,6 +360,31 @@ SmmCoreInsertRecord (
   return EFI_SUCCESS;
 }
 
+/**
+  The internal function used to take a database record out of the database
+  and its status bucket. The record itself is not freed.
+
+  @param[in]  Record                    Record to remove from database.
+**/
+VOID
+SmmCoreRemoveRecord (
+  IN  DATABASE_RECORD                   *Record
+  )
+{
+  //
+  // A callback may unregister itself or another child of the bucket being
+  // dispatched. Keep the dispatcher off the record before it is freed.
+  //
+  if (Record == mDispatchRecord) {
+    mDispatchRecord = NULL;
+  }
+  if (&Record->StsLink == mDispatchNextLink) {
+    mDispatchNextLink = Record->StsLink.ForwardLink;
+  }
+  RemoveEntryList (&Record->Link);
+  RemoveEntryList (&Record->StsLink);
+}
+
 /**
   Unregister a child SMI source dispatch function with a parent SMM driver
 
@@ -582,7 +648,7 @@ PchSmmCoreUnRegister (
     return EFI_INVALID_PARAMETER;
   }
 
-  RemoveEntryList (&RecordToDelete->Link);
+  SmmCoreRemoveRecord (RecordToDelete);
 
   //
   // Loop through all the souces in record linked list to see if any source enable is equal.
@@ -659,6 +725,56 @@ ClearPendingSmiStatus (
   }
 }
 
+/**
+  Look for the first active SMI source, in registration order. This is the same
+  record a walk of CallbackDataBase would find first, but only the status buckets
+  of the pending SMI_STS bits and the PCH_SMM_STS_BUCKET_OTHER bucket are walked.
+  Each bucket is in registration order, so the walk of a bucket stops at the first
+  active record or at a record registered after the best one found so far.
+
+  @param[in]  SciEn                     Sci Enable status
+  @param[in]  SmiEnValue                SMI enable value
+  @param[in]  SmiStsValue               SMI status value
+  @param[out] Bucket                    The status bucket of the returned record
+
+  @retval The first active database record, or NULL if none of the sources is active
+**/
+STATIC
+DATABASE_RECORD *
+SmmCoreFindActiveRecord (
+  IN  BOOLEAN                           SciEn,
+  IN  UINT32                            SmiEnValue,
+  IN  UINT32                            SmiStsValue,
+  OUT UINTN                             *Bucket
+  )
+{
+  UINTN               Index;
+  LIST_ENTRY          *LinkInDb;
+  DATABASE_RECORD     *RecordInDb;
+  DATABASE_RECORD     *FirstRecord;
+
+  FirstRecord = NULL;
+  for (Index = 0; Index < PCH_SMM_STS_BUCKET_MAX; Index++) {
+    if ((Index < PCH_SMM_STS_BUCKET_OTHER) && ((SmiStsValue & (1u << Index)) == 0)) {
+      continue;
+    }
+    LinkInDb = GetFirstNode (&mPrivateData.StsBucket[Index]);
+    while (!IsNull (&mPrivateData.StsBucket[Index], LinkInDb)) {
+      RecordInDb = DATABASE_RECORD_FROM_STS_LINK (LinkInDb);
+      if ((FirstRecord != NULL) && (RecordInDb->Order > FirstRecord->Order)) {
+        break;
+      }
+      if (SourceIsActive (&RecordInDb->SrcDesc, SciEn, SmiEnValue, SmiStsValue)) {
+        FirstRecord = RecordInDb;
+        *Bucket     = Index;
+        break;
+      }
+      LinkInDb = GetNextNode (&mPrivateData.StsBucket[Index], LinkInDb);
+    }
+  }
+  return FirstRecord;
+}
+
 /**
   The callback function to handle subsequent SMIs.  This callback will be called by SmmCoreDispatcher.
 
@@ -688,9 +804,15 @@ PchSmmCoreDispatcher (
   BOOLEAN             SxChildWasDispatched;
 
   DATABASE_RECORD     *RecordInDb;
-  LIST_ENTRY          *LinkInDb;
   DATABASE_RECORD     *RecordToExhaust;
   LIST_ENTRY          *LinkToExhaust;
+  LIST_ENTRY          *BucketHead;
+  PCH_SMM_CLEAR_SOURCE ClearSource;
+  PCH_SMM_PROTOCOL_TYPE ProtocolType;
+  UINTN               Bucket;
+  UINT64              StartTicks;
+  UINT64              DispatchStartTicks;
+  UINT64              HandlerStartTicks;
 
   PCH_SMM_CONTEXT     Context;
   VOID                *CommBuffer;
@@ -715,6 +837,14 @@ PchSmmCoreDispatcher (
   EosSet                = FALSE;
   SxChildWasDispatched  = FALSE;
   Status                = EFI_SUCCESS;
+  Bucket                = PCH_SMM_STS_BUCKET_OTHER;
+  StartTicks            = 0;
+  DispatchStartTicks    = 0;
+  HandlerStartTicks     = 0;
+
+  if (FixedPcdGetBool (PcdPchSmiResidencyProfileEnable)) {
+    DispatchStartTicks = AsmReadTsc ();
+  }
 
   //
   // Save IO index registers
@@ -732,8 +862,6 @@ PchSmmCoreDispatcher (
     while ((!EosSet) && (EscapeCount > 0)) {
       EscapeCount--;
 
-      LinkInDb = GetFirstNode (&mPrivateData.CallbackDataBase);
-
       //
       // Cache SciEn, SmiEnValue and SmiStsValue to determine if source is active
       //
@@ -741,150 +869,159 @@ PchSmmCoreDispatcher (
       SmiEnValue  = IoRead32 ((UINTN) (mAcpiBaseAddr + R_ACPI_IO_SMI_EN));
       SmiStsValue = IoRead32 ((UINTN) (mAcpiBaseAddr + R_ACPI_IO_SMI_STS));
 
-      while (!IsNull (&mPrivateData.CallbackDataBase, LinkInDb)) {
-        RecordInDb = DATABASE_RECORD_FROM_LINK (LinkInDb);
+      //
+      // look for the first active source
+      //
+      RecordInDb = SmmCoreFindActiveRecord (SciEn, SmiEnValue, SmiStsValue, &Bucket);
+      if (RecordInDb == NULL) {
+        //
+        // No source is active, clear pending SMI status and try to clear EOS
+        //
+        ClearPendingSmiStatus (SmiStsValue, SciEn);
+        EosSet = PchSmmSetAndCheckEos ();
+      } else {
+        if (FixedPcdGetBool (PcdPchSmiResidencyProfileEnable)) {
+          StartTicks = AsmReadTsc ();
+        }
+        //
+        // We found a source. If this is a sleep type, we have to go to
+        // appropriate sleep state anyway.No matter there is sleep child or not
+        //
+        if (RecordInDb->ProtocolType == SxType) {
+          SxChildWasDispatched = TRUE;
+        }
+        //
+        // "cache" the source description and don't query I/O anymore
+        //
+        CopyMem ((VOID *) &ActiveSource, (VOID *) &(RecordInDb->SrcDesc), sizeof (PCH_SMM_SOURCE_DESC));
+        ClearSource = RecordInDb->ClearSource;
 
         //
-        // look for the first active source
+        // exhaust the rest of the bucket looking for the same source. Equal sources
+        // share the top level status bit, so they are all in this bucket.
         //
-        if (!SourceIsActive (&RecordInDb->SrcDesc, SciEn, SmiEnValue, SmiStsValue)) {
+        BucketHead    = &mPrivateData.StsBucket[Bucket];
+        LinkToExhaust = &RecordInDb->StsLink;
+        while (!IsNull (BucketHead, LinkToExhaust)) {
+          RecordToExhaust = DATABASE_RECORD_FROM_STS_LINK (LinkToExhaust);
           //
-          // Didn't find the source yet, keep looking
+          // RecordToExhaust->StsLink might be removed (unregistered) by Callback function, and then the
+          // system will hang in ASSERT() while calling GetNextNode().
+          // To prevent the issue, we need to get next record in bucket here (before Callback function).
+          // SmmCoreRemoveRecord moves mDispatchNextLink on if the callback unregisters the next record.
           //
-          LinkInDb = GetNextNode (&mPrivateData.CallbackDataBase, &RecordInDb->Link);
+          mDispatchNextLink = GetNextNode (BucketHead, &RecordToExhaust->StsLink);
+          mDispatchRecord   = RecordToExhaust;
 
-          //
-          // if it's the last one, try to clear EOS
-          //
-          if (IsNull (&mPrivateData.CallbackDataBase, LinkInDb)) {
+          if (CompareSources (&RecordToExhaust->SrcDesc, &ActiveSource)) {
             //
-            // Clear pending SMI status before EOS
+            // These source descriptions are equal, so this callback should be
+            // dispatched.
             //
-            ClearPendingSmiStatus (SmiStsValue, SciEn);
-            EosSet = PchSmmSetAndCheckEos ();
-          }
-        } else {
-          //
-          // We found a source. If this is a sleep type, we have to go to
-          // appropriate sleep state anyway.No matter there is sleep child or not
-          //
-          if (RecordInDb->ProtocolType == SxType) {
-            SxChildWasDispatched = TRUE;
-          }
-          //
-          // "cache" the source description and don't query I/O anymore
-          //
-          CopyMem ((VOID *) &ActiveSource, (VOID *) &(RecordInDb->SrcDesc), sizeof (PCH_SMM_SOURCE_DESC));
-          LinkToExhaust = LinkInDb;
+            if (RecordToExhaust->ContextFunctions.GetContext != NULL) {
+              //
+              // This child requires that we get a calling context from
+              // hardware and compare that context to the one supplied
+              // by the child.
+              //
+              ASSERT (RecordToExhaust->ContextFunctions.CmpContext != NULL);
 
-          //
-          // exhaust the rest of the queue looking for the same source
-          //
-          while (!IsNull (&mPrivateData.CallbackDataBase, LinkToExhaust)) {
-            RecordToExhaust = DATABASE_RECORD_FROM_LINK (LinkToExhaust);
-            //
-            // RecordToExhaust->Link might be removed (unregistered) by Callback function, and then the
-            // system will hang in ASSERT() while calling GetNextNode().
-            // To prevent the issue, we need to get next record in DB here (before Callback function).
-            //
-            LinkToExhaust = GetNextNode (&mPrivateData.CallbackDataBase, &RecordToExhaust->Link);
+              //
+              // Make sure contexts match before dispatching event to child
+              //
+              RecordToExhaust->ContextFunctions.GetContext (RecordToExhaust, &Context);
+              ContextsMatch = RecordToExhaust->ContextFunctions.CmpContext (&Context, &RecordToExhaust->ChildContext);
 
-            if (CompareSources (&RecordToExhaust->SrcDesc, &ActiveSource)) {
+            } else {
               //
-              // These source descriptions are equal, so this callback should be
-              // dispatched.
+              // This child doesn't require any more calling context beyond what
+              // it supplied in registration.  Simply pass back what it gave us.
               //
-              if (RecordToExhaust->ContextFunctions.GetContext != NULL) {
-                //
-                // This child requires that we get a calling context from
-                // hardware and compare that context to the one supplied
-                // by the child.
-                //
-                ASSERT (RecordToExhaust->ContextFunctions.CmpContext != NULL);
+              Context       = RecordToExhaust->ChildContext;
+              ContextsMatch = TRUE;
+            }
 
+            if (ContextsMatch) {
+              if (RecordToExhaust->ProtocolType == PchSmiDispatchType) {
                 //
-                // Make sure contexts match before dispatching event to child
+                // For PCH SMI dispatch protocols
                 //
-                RecordToExhaust->ContextFunctions.GetContext (RecordToExhaust, &Context);
-                ContextsMatch = RecordToExhaust->ContextFunctions.CmpContext (&Context, &RecordToExhaust->ChildContext);
-
+                PchSmiTypeCallbackDispatcher (RecordToExhaust);
               } else {
+                if ((RecordToExhaust->ProtocolType == SxType) && (Context.Sx.Type == SxS3) && (Context.Sx.Phase == SxEntry) && !mS3SusStart) {
+                  REPORT_STATUS_CODE (EFI_PROGRESS_CODE, PROGRESS_CODE_S3_SUSPEND_START);
+                  mS3SusStart = TRUE;
+                }
                 //
-                // This child doesn't require any more calling context beyond what
-                // it supplied in registration.  Simply pass back what it gave us.
+                // For EFI standard SMI dispatch protocols
                 //
-                Context       = RecordToExhaust->ChildContext;
-                ContextsMatch = TRUE;
-              }
+                if (RecordToExhaust->Callback != NULL) {
+                  if (RecordToExhaust->ContextFunctions.GetCommBuffer != NULL) {
+                    //
+                    // This callback function needs CommBuffer and CommBufferSize.
+                    // Get those from child and then pass to callback function.
+                    //
+                    RecordToExhaust->ContextFunctions.GetCommBuffer (RecordToExhaust, &CommBuffer, &CommBufferSize);
+                  } else {
+                    //
+                    // Child doesn't support the CommBuffer and CommBufferSize.
+                    // Just pass NULL value to callback function.
+                    //
+                    CommBuffer     = NULL;
+                    CommBufferSize = 0;
+                  }
 
-              if (ContextsMatch) {
-                if (RecordToExhaust->ProtocolType == PchSmiDispatchType) {
-                  //
-                  // For PCH SMI dispatch protocols
-                  //
-                  PchSmiTypeCallbackDispatcher (RecordToExhaust);
-                } else {
-                  if ((RecordToExhaust->ProtocolType == SxType) && (Context.Sx.Type == SxS3) && (Context.Sx.Phase == SxEntry) && !mS3SusStart) {
-                    REPORT_STATUS_CODE (EFI_PROGRESS_CODE, PROGRESS_CODE_S3_SUSPEND_START);
-                    mS3SusStart = TRUE;
+                  if (RecordToExhaust->ProtocolType == SxType) {
+                    SxChildWasDispatched = TRUE;
+                  }
+                  if (FixedPcdGetBool (PcdPchSmiResidencyProfileEnable)) {
+                    HandlerStartTicks = AsmReadTsc ();
                   }
+                  ProtocolType = RecordToExhaust->ProtocolType;
+                  PERF_START_EX (NULL, "SmmFunction", NULL, AsmReadTsc (), ProtocolType);
+                  RecordToExhaust->Callback ((EFI_HANDLE) & RecordToExhaust->Link, &Context, CommBuffer, &CommBufferSize);
+                  PERF_END_EX (NULL, "SmmFunction", NULL, AsmReadTsc (), ProtocolType);
                   //
-                  // For EFI standard SMI dispatch protocols
+                  // The callback may have unregistered and freed RecordToExhaust, in which
+                  // case SmmCoreRemoveRecord has cleared mDispatchRecord.
                   //
-                  if (RecordToExhaust->Callback != NULL) {
-                    if (RecordToExhaust->ContextFunctions.GetCommBuffer != NULL) {
-                      //
-                      // This callback function needs CommBuffer and CommBufferSize.
-                      // Get those from child and then pass to callback function.
-                      //
-                      RecordToExhaust->ContextFunctions.GetCommBuffer (RecordToExhaust, &CommBuffer, &CommBufferSize);
-                    } else {
-                      //
-                      // Child doesn't support the CommBuffer and CommBufferSize.
-                      // Just pass NULL value to callback function.
-                      //
-                      CommBuffer     = NULL;
-                      CommBufferSize = 0;
-                    }
-
-                    PERF_START_EX (NULL, "SmmFunction", NULL, AsmReadTsc (), RecordToExhaust->ProtocolType);
-                    RecordToExhaust->Callback ((EFI_HANDLE) & RecordToExhaust->Link, &Context, CommBuffer, &CommBufferSize);
-                    PERF_END_EX (NULL, "SmmFunction", NULL, AsmReadTsc (), RecordToExhaust->ProtocolType);
-                    if (RecordToExhaust->ProtocolType == SxType) {
-                      SxChildWasDispatched = TRUE;
-                    }
-                  } else {
-                    ASSERT (FALSE);
+                  if (FixedPcdGetBool (PcdPchSmiResidencyProfileEnable) && (mDispatchRecord != NULL)) {
+                    PchSmmResidencyRecordHandler (RecordToExhaust, AsmReadTsc () - HandlerStartTicks);
                   }
+                } else {
+                  ASSERT (FALSE);
                 }
               }
             }
           }
+          LinkToExhaust = mDispatchNextLink;
+        }
+        mDispatchRecord   = NULL;
+        mDispatchNextLink = NULL;
 
-          if (RecordInDb->ClearSource == NULL) {
-            //
-            // Clear the SMI associated w/ the source using the default function
-            //
-            PchSmmClearSource (&ActiveSource);
-          } else {
-            //
-            // This source requires special handling to clear
-            //
-            RecordInDb->ClearSource (&ActiveSource);
-          }
-          //
-          // Clear pending SMI status before EOS
-          //
-          ClearPendingSmiStatus (SmiStsValue, SciEn);
+        if (ClearSource == NULL) {
           //
-          // Also, try to clear EOS
+          // Clear the SMI associated w/ the source using the default function
           //
-          EosSet = PchSmmSetAndCheckEos ();
+          PchSmmClearSource (&ActiveSource);
+        } else {
           //
-          // Queue is empty, reset the search
+          // This source requires special handling to clear
           //
-          break;
+          ClearSource (&ActiveSource);
         }
+        //
+        // Clear pending SMI status before EOS
+        //
+        ClearPendingSmiStatus (SmiStsValue, SciEn);
+
+        if (FixedPcdGetBool (PcdPchSmiResidencyProfileEnable)) {
+          PchSmmResidencyRecordSource (Bucket, StartTicks, AsmReadTsc () - StartTicks);
+        }
+        //
+        // Also, try to clear EOS
+        //
+        EosSet = PchSmmSetAndCheckEos ();
       }
     }
   }
@@ -922,5 +1059,9 @@ PchSmmCoreDispatcher (
   IoWrite8 (R_RTC_IO_EXT_INDEX_ALT, Port76Save);
   IoWrite8 (R_RTC_IO_INDEX_ALT, Port74Save);
 
+  if (FixedPcdGetBool (PcdPchSmiResidencyProfileEnable)) {
+    PchSmmResidencyRecordDispatch (AsmReadTsc () - DispatchStartTicks);
+  }
+
   return Status;
 }
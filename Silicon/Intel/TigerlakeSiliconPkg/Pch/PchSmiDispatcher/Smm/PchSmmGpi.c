@@ -244,8 +244,7 @@ PchGpiSmiUnRegister (
     S3BootScriptSaveMemReadWrite (S3BootScriptWidthUint32, GpiHostSwOwnRegAddress, &Data32Or, &Data32And);
   }
 
-
-  RemoveEntryList (&RecordToDelete->Link);
+  SmmCoreRemoveRecord (RecordToDelete);
   ZeroMem (RecordToDelete, sizeof (DATABASE_RECORD));
   Status = gSmst->SmmFreePool (RecordToDelete);
 
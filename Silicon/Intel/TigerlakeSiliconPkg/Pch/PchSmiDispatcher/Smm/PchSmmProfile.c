@@ -0,0 +1,334 @@
+/** @file
+  PCH SMI residency profiling.
+
+  TSC based counters are kept per status bucket (top level SMI source) and per
+  child record, together with a ring of the last PCH_SMM_RESIDENCY_RING_SIZE
+  serviced sources. A snapshot can be read from outside SMM through the
+  gPchSmiResidencyProfileGuid communication handler.
+  Everything here is only reached when PcdPchSmiResidencyProfileEnable is TRUE.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+#include "PchSmmHelpers.h"
+#include <Library/SmmMemLib.h>
+
+GLOBAL_REMOVE_IF_UNREFERENCED PCH_SMI_RESIDENCY_COUNTER     mResidencyDispatcher;
+GLOBAL_REMOVE_IF_UNREFERENCED PCH_SMI_RESIDENCY_COUNTER     mResidencySource[PCH_SMM_STS_BUCKET_MAX];
+GLOBAL_REMOVE_IF_UNREFERENCED PCH_SMI_RESIDENCY_RING_ENTRY  mResidencyRing[PCH_SMM_RESIDENCY_RING_SIZE];
+GLOBAL_REMOVE_IF_UNREFERENCED UINTN                         mResidencyRingIndex;
+GLOBAL_REMOVE_IF_UNREFERENCED UINTN                         mResidencyRingCount;
+
+GLOBAL_REMOVE_IF_UNREFERENCED VOID                          *mResidencySnapshot;
+GLOBAL_REMOVE_IF_UNREFERENCED UINTN                         mResidencySnapshotSize;
+
+/**
+  Add one sample to a residency counter.
+
+  @param[in, out] Counter         The residency counter
+  @param[in]      Ticks           The sample in TSC ticks
+**/
+STATIC
+VOID
+ResidencyCounterAdd (
+  IN OUT PCH_SMI_RESIDENCY_COUNTER  *Counter,
+  IN     UINT64                     Ticks
+  )
+{
+  Counter->Count++;
+  Counter->TotalTicks += Ticks;
+  if (Ticks > Counter->MaxTicks) {
+    Counter->MaxTicks = Ticks;
+  }
+}
+
+/**
+  Convert a status bucket to the StsBit value reported in the snapshot.
+
+  @param[in] Bucket               Status bucket
+
+  @retval The PMC SMI_STS bit, or PCH_SMI_RESIDENCY_STS_BIT_OTHER
+**/
+STATIC
+UINT32
+ResidencyBucketToStsBit (
+  IN UINTN                        Bucket
+  )
+{
+  if (Bucket < PCH_SMM_STS_BUCKET_OTHER) {
+    return (UINT32) Bucket;
+  }
+  return PCH_SMI_RESIDENCY_STS_BIT_OTHER;
+}
+
+/**
+  Account one PchSmmCoreDispatcher invocation in the residency profile.
+
+  @param[in] Ticks                TSC ticks spent in the dispatcher
+**/
+VOID
+PchSmmResidencyRecordDispatch (
+  IN UINT64                       Ticks
+  )
+{
+  ResidencyCounterAdd (&mResidencyDispatcher, Ticks);
+}
+
+/**
+  Account one serviced SMI source in the residency profile.
+
+  @param[in] Bucket               Status bucket of the source
+  @param[in] StartTsc             TSC when the source was found active
+  @param[in] Ticks                TSC ticks spent servicing the source
+**/
+VOID
+PchSmmResidencyRecordSource (
+  IN UINTN                        Bucket,
+  IN UINT64                       StartTsc,
+  IN UINT64                       Ticks
+  )
+{
+  PCH_SMI_RESIDENCY_RING_ENTRY    *Entry;
+
+  ASSERT (Bucket < PCH_SMM_STS_BUCKET_MAX);
+  ResidencyCounterAdd (&mResidencySource[Bucket], Ticks);
+
+  Entry           = &mResidencyRing[mResidencyRingIndex];
+  Entry->StartTsc = StartTsc;
+  Entry->Ticks    = Ticks;
+  Entry->StsBit   = ResidencyBucketToStsBit (Bucket);
+  Entry->Reserved = 0;
+
+  mResidencyRingIndex = (mResidencyRingIndex + 1) % PCH_SMM_RESIDENCY_RING_SIZE;
+  if (mResidencyRingCount < PCH_SMM_RESIDENCY_RING_SIZE) {
+    mResidencyRingCount++;
+  }
+}
+
+/**
+  Account one child handler invocation in the residency profile.
+
+  @param[in] Record               The database record of the child
+  @param[in] Ticks                TSC ticks spent in the child handler
+**/
+VOID
+PchSmmResidencyRecordHandler (
+  IN DATABASE_RECORD              *Record,
+  IN UINT64                       Ticks
+  )
+{
+  ResidencyCounterAdd (&Record->Residency, Ticks);
+}
+
+/**
+  Build a snapshot of the residency profile in SMRAM. The snapshot is what
+  GET_DATA_BY_OFFSET copies out, so the data stays consistent across the
+  calls needed to read it.
+
+  @retval EFI_SUCCESS             The snapshot is built
+  @retval EFI_OUT_OF_RESOURCES    Fail to allocate pool for the snapshot
+**/
+STATIC
+EFI_STATUS
+ResidencyBuildSnapshot (
+  VOID
+  )
+{
+  EFI_STATUS                        Status;
+  PCH_SMI_RESIDENCY_PROFILE_HEADER  *Header;
+  PCH_SMI_RESIDENCY_SOURCE_ENTRY    *Source;
+  PCH_SMI_RESIDENCY_HANDLER_ENTRY   *Handler;
+  PCH_SMI_RESIDENCY_RING_ENTRY      *Ring;
+  DATABASE_RECORD                   *RecordInDb;
+  LIST_ENTRY                        *LinkInDb;
+  UINTN                             HandlerCount;
+  UINTN                             Index;
+  UINTN                             RingIndex;
+
+  if (mResidencySnapshot != NULL) {
+    gSmst->SmmFreePool (mResidencySnapshot);
+    mResidencySnapshot     = NULL;
+    mResidencySnapshotSize = 0;
+  }
+
+  HandlerCount = 0;
+  LinkInDb = GetFirstNode (&mPrivateData.CallbackDataBase);
+  while (!IsNull (&mPrivateData.CallbackDataBase, LinkInDb)) {
+    HandlerCount++;
+    LinkInDb = GetNextNode (&mPrivateData.CallbackDataBase, LinkInDb);
+  }
+
+  mResidencySnapshotSize = sizeof (PCH_SMI_RESIDENCY_PROFILE_HEADER) +
+                           PCH_SMM_STS_BUCKET_MAX * sizeof (PCH_SMI_RESIDENCY_SOURCE_ENTRY) +
+                           HandlerCount * sizeof (PCH_SMI_RESIDENCY_HANDLER_ENTRY) +
+                           mResidencyRingCount * sizeof (PCH_SMI_RESIDENCY_RING_ENTRY);
+  Status = gSmst->SmmAllocatePool (EfiRuntimeServicesData, mResidencySnapshotSize, &mResidencySnapshot);
+  if (EFI_ERROR (Status)) {
+    mResidencySnapshot     = NULL;
+    mResidencySnapshotSize = 0;
+    return EFI_OUT_OF_RESOURCES;
+  }
+  ZeroMem (mResidencySnapshot, mResidencySnapshotSize);
+
+  Header               = mResidencySnapshot;
+  Header->Signature    = PCH_SMI_RESIDENCY_PROFILE_SIGNATURE;
+  Header->Length       = (UINT32) mResidencySnapshotSize;
+  Header->SourceCount  = PCH_SMM_STS_BUCKET_MAX;
+  Header->HandlerCount = (UINT32) HandlerCount;
+  Header->RingCount    = (UINT32) mResidencyRingCount;
+  CopyMem (&Header->Dispatcher, &mResidencyDispatcher, sizeof (PCH_SMI_RESIDENCY_COUNTER));
+
+  Source = (PCH_SMI_RESIDENCY_SOURCE_ENTRY *) (Header + 1);
+  for (Index = 0; Index < PCH_SMM_STS_BUCKET_MAX; Index++) {
+    Source[Index].StsBit = ResidencyBucketToStsBit (Index);
+    CopyMem (&Source[Index].Counter, &mResidencySource[Index], sizeof (PCH_SMI_RESIDENCY_COUNTER));
+  }
+
+  Handler = (PCH_SMI_RESIDENCY_HANDLER_ENTRY *) (Source + PCH_SMM_STS_BUCKET_MAX);
+  LinkInDb = GetFirstNode (&mPrivateData.CallbackDataBase);
+  while (!IsNull (&mPrivateData.CallbackDataBase, LinkInDb)) {
+    RecordInDb = DATABASE_RECORD_FROM_LINK (LinkInDb);
+    if (RecordInDb->ProtocolType == PchSmiDispatchType) {
+      Handler->Handler = (UINT64) (UINTN) RecordInDb->PchSmiCallback;
+    } else {
+      Handler->Handler = (UINT64) (UINTN) RecordInDb->Callback;
+    }
+    Handler->StsBit       = ResidencyBucketToStsBit (SmmCoreGetStsBucket (&RecordInDb->SrcDesc));
+    Handler->ProtocolType = (UINT32) RecordInDb->ProtocolType;
+    Handler->PchSmiType   = (UINT32) RecordInDb->PchSmiType;
+    CopyMem (&Handler->Counter, &RecordInDb->Residency, sizeof (PCH_SMI_RESIDENCY_COUNTER));
+    Handler++;
+    LinkInDb = GetNextNode (&mPrivateData.CallbackDataBase, LinkInDb);
+  }
+
+  //
+  // Oldest entry first
+  //
+  Ring      = (PCH_SMI_RESIDENCY_RING_ENTRY *) Handler;
+  RingIndex = (mResidencyRingIndex + PCH_SMM_RESIDENCY_RING_SIZE - mResidencyRingCount) % PCH_SMM_RESIDENCY_RING_SIZE;
+  for (Index = 0; Index < mResidencyRingCount; Index++) {
+    CopyMem (&Ring[Index], &mResidencyRing[RingIndex], sizeof (PCH_SMI_RESIDENCY_RING_ENTRY));
+    RingIndex = (RingIndex + 1) % PCH_SMM_RESIDENCY_RING_SIZE;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Communication handler to read the residency profile.
+
+  @param[in]     DispatchHandle   The unique handle assigned to this handler by SmiHandlerRegister().
+  @param[in]     Context          Points to an optional handler context which was specified when the
+                                  handler was registered.
+  @param[in, out] CommBuffer      A pointer to a collection of data in memory that will
+                                  be conveyed from a non-SMM environment into an SMM environment.
+  @param[in, out] CommBufferSize  The size of the CommBuffer.
+
+  @retval EFI_SUCCESS             The interrupt was handled and quiesced. No other handlers
+                                  should still be called.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PchSmmResidencyProfileHandler (
+  IN     EFI_HANDLE               DispatchHandle,
+  IN     CONST VOID               *Context         OPTIONAL,
+  IN OUT VOID                     *CommBuffer      OPTIONAL,
+  IN OUT UINTN                    *CommBufferSize  OPTIONAL
+  )
+{
+  PCH_SMI_RESIDENCY_PROFILE_PARAMETER_HEADER              *ParameterHeader;
+  PCH_SMI_RESIDENCY_PROFILE_PARAMETER_GET_INFO            *GetInfo;
+  PCH_SMI_RESIDENCY_PROFILE_PARAMETER_GET_DATA_BY_OFFSET  GetData;
+  UINTN                                                   TempCommBufferSize;
+
+  //
+  // If input is invalid, stop processing this SMI
+  //
+  if ((CommBuffer == NULL) || (CommBufferSize == NULL)) {
+    return EFI_SUCCESS;
+  }
+
+  TempCommBufferSize = *CommBufferSize;
+  if (TempCommBufferSize < sizeof (PCH_SMI_RESIDENCY_PROFILE_PARAMETER_HEADER)) {
+    DEBUG ((DEBUG_ERROR, "PchSmmResidencyProfileHandler: SMM communication buffer size invalid!\n"));
+    return EFI_SUCCESS;
+  }
+
+  if (!SmmIsBufferOutsideSmmValid ((UINTN) CommBuffer, TempCommBufferSize)) {
+    DEBUG ((DEBUG_ERROR, "PchSmmResidencyProfileHandler: SMM communication buffer in SMRAM or overflow!\n"));
+    return EFI_SUCCESS;
+  }
+
+  ParameterHeader = (PCH_SMI_RESIDENCY_PROFILE_PARAMETER_HEADER *) CommBuffer;
+  ParameterHeader->ReturnStatus = (UINT64) -1;
+
+  switch (ParameterHeader->Command) {
+    case PCH_SMI_RESIDENCY_PROFILE_COMMAND_GET_INFO:
+      if (TempCommBufferSize != sizeof (PCH_SMI_RESIDENCY_PROFILE_PARAMETER_GET_INFO)) {
+        DEBUG ((DEBUG_ERROR, "PchSmmResidencyProfileHandler: SMM communication buffer size invalid!\n"));
+        return EFI_SUCCESS;
+      }
+      GetInfo = (PCH_SMI_RESIDENCY_PROFILE_PARAMETER_GET_INFO *) CommBuffer;
+      if (EFI_ERROR (ResidencyBuildSnapshot ())) {
+        return EFI_SUCCESS;
+      }
+      GetInfo->DataSize = mResidencySnapshotSize;
+      GetInfo->Header.ReturnStatus = 0;
+      break;
+
+    case PCH_SMI_RESIDENCY_PROFILE_COMMAND_GET_DATA_BY_OFFSET:
+      if (TempCommBufferSize != sizeof (PCH_SMI_RESIDENCY_PROFILE_PARAMETER_GET_DATA_BY_OFFSET)) {
+        DEBUG ((DEBUG_ERROR, "PchSmmResidencyProfileHandler: SMM communication buffer size invalid!\n"));
+        return EFI_SUCCESS;
+      }
+      //
+      // Copy the parameters to SMRAM first so they cannot change while being checked
+      //
+      CopyMem (&GetData, CommBuffer, sizeof (GetData));
+      if ((mResidencySnapshot == NULL) || (GetData.DataOffset >= mResidencySnapshotSize)) {
+        return EFI_SUCCESS;
+      }
+      if (GetData.DataSize > mResidencySnapshotSize - GetData.DataOffset) {
+        GetData.DataSize = mResidencySnapshotSize - GetData.DataOffset;
+      }
+      if (!SmmIsBufferOutsideSmmValid ((UINTN) GetData.DataBuffer, (UINTN) GetData.DataSize)) {
+        DEBUG ((DEBUG_ERROR, "PchSmmResidencyProfileHandler: SMM data buffer in SMRAM or overflow!\n"));
+        return EFI_SUCCESS;
+      }
+      CopyMem (
+        (VOID *) (UINTN) GetData.DataBuffer,
+        (UINT8 *) mResidencySnapshot + GetData.DataOffset,
+        (UINTN) GetData.DataSize
+        );
+      GetData.DataOffset += GetData.DataSize;
+      GetData.Header.ReturnStatus = 0;
+      CopyMem (CommBuffer, &GetData, sizeof (GetData));
+      break;
+
+    default:
+      break;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Register the residency profile communication handler.
+**/
+VOID
+PchSmmResidencyProfileInit (
+  VOID
+  )
+{
+  EFI_STATUS                      Status;
+  EFI_HANDLE                      DispatchHandle;
+
+  DispatchHandle = NULL;
+  Status = gSmst->SmiHandlerRegister (
+                    PchSmmResidencyProfileHandler,
+                    &gPchSmiResidencyProfileGuid,
+                    &DispatchHandle
+                    );
+  ASSERT_EFI_ERROR (Status);
+}
@@ -0,0 +1,927 @@
+/** @file
+  Host based unit tests of the PCH SMM core dispatcher.
+
+  PchSmmCore.c and PchSmmHelpers.c are built as they are. The I/O space that
+  holds the ACPI SMI_EN and SMI_STS registers is an array in this file, and the
+  parts of the driver that talk to other hardware or to the SMM core are stubs.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <cmocka.h>
+
+#include "../Smm/PchSmmHelpers.h"
+#include "../Smm/PchSmmEspi.h"
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UnitTestLib.h>
+#include <Register/PmcRegs.h>
+
+#define UNIT_TEST_NAME     "PCH SMM Core Dispatcher Unit Tests"
+#define UNIT_TEST_VERSION  "1.0"
+
+#define TEST_ACPI_BASE     0x1800
+#define TEST_TCO_BASE      0x1860
+#define TEST_MAX_CHILDREN  8
+
+///
+/// Mocked I/O space. SMI_STS is write 1 to clear, everything else reads back
+/// what was written.
+///
+STATIC UINT8        mMockIo[SIZE_64KB];
+
+STATIC EFI_HANDLE   mHandle[TEST_MAX_CHILDREN];
+STATIC UINTN        mHandleCount;
+STATIC UINTN        mCallLog[TEST_MAX_CHILDREN * 2];
+STATIC UINTN        mCallCount;
+STATIC EFI_HANDLE   *mUnregisterOnCall[TEST_MAX_CHILDREN];
+
+STATIC CONST PCH_SMM_SOURCE_DESC  mNullSourceDesc = NULL_SOURCE_DESC_INITIALIZER;
+
+//
+// I/O space
+//
+
+STATIC
+UINT32
+MockIoGet (
+  IN UINTN  Port,
+  IN UINTN  Size
+  )
+{
+  UINT32  Value;
+
+  Value = 0;
+  CopyMem (&Value, &mMockIo[Port], Size);
+  return Value;
+}
+
+STATIC
+VOID
+MockIoSet (
+  IN UINTN   Port,
+  IN UINTN   Size,
+  IN UINT32  Value
+  )
+{
+  if (Port == (UINTN) (mAcpiBaseAddr + R_ACPI_IO_SMI_STS)) {
+    Value = MockIoGet (Port, Size) & ~Value;
+  }
+  CopyMem (&mMockIo[Port], &Value, Size);
+}
+
+UINT8
+EFIAPI
+IoRead8 (
+  IN UINTN  Port
+  )
+{
+  return (UINT8) MockIoGet (Port, sizeof (UINT8));
+}
+
+UINT16
+EFIAPI
+IoRead16 (
+  IN UINTN  Port
+  )
+{
+  return (UINT16) MockIoGet (Port, sizeof (UINT16));
+}
+
+UINT32
+EFIAPI
+IoRead32 (
+  IN UINTN  Port
+  )
+{
+  return MockIoGet (Port, sizeof (UINT32));
+}
+
+UINT8
+EFIAPI
+IoWrite8 (
+  IN UINTN  Port,
+  IN UINT8  Value
+  )
+{
+  MockIoSet (Port, sizeof (UINT8), Value);
+  return Value;
+}
+
+UINT16
+EFIAPI
+IoWrite16 (
+  IN UINTN   Port,
+  IN UINT16  Value
+  )
+{
+  MockIoSet (Port, sizeof (UINT16), Value);
+  return Value;
+}
+
+UINT32
+EFIAPI
+IoWrite32 (
+  IN UINTN   Port,
+  IN UINT32  Value
+  )
+{
+  MockIoSet (Port, sizeof (UINT32), Value);
+  return Value;
+}
+
+BOOLEAN
+ReadBitDesc (
+  CONST PCH_SMM_BIT_DESC *BitDesc
+  )
+{
+  if (BitDesc->Reg.Type != ACPI_ADDR_TYPE) {
+    return FALSE;
+  }
+  return (BOOLEAN) ((MockIoGet (mAcpiBaseAddr + BitDesc->Reg.Data.acpi, BitDesc->SizeInBytes) >> BitDesc->Bit) & 1);
+}
+
+VOID
+WriteBitDesc (
+  CONST PCH_SMM_BIT_DESC  *BitDesc,
+  CONST BOOLEAN           ValueToWrite,
+  CONST BOOLEAN           WriteClear
+  )
+{
+  UINTN   Port;
+  UINT32  Value;
+
+  if (BitDesc->Reg.Type != ACPI_ADDR_TYPE) {
+    return;
+  }
+  Port = mAcpiBaseAddr + BitDesc->Reg.Data.acpi;
+  if (WriteClear) {
+    Value = ValueToWrite ? (1u << BitDesc->Bit) : 0;
+  } else {
+    Value = MockIoGet (Port, BitDesc->SizeInBytes) & ~(1u << BitDesc->Bit);
+    if (ValueToWrite) {
+      Value |= (1u << BitDesc->Bit);
+    }
+  }
+  MockIoSet (Port, BitDesc->SizeInBytes, Value);
+}
+
+/**
+  EOS only sticks when no enabled source is pending, otherwise the PMC raises
+  the next SMI right away and the dispatcher has to take another pass.
+**/
+BOOLEAN
+PchSmmSetAndCheckEos (
+  VOID
+  )
+{
+  return (BOOLEAN) ((IoRead32 (mAcpiBaseAddr + R_ACPI_IO_SMI_STS) &
+                     IoRead32 (mAcpiBaseAddr + R_ACPI_IO_SMI_EN)) == 0);
+}
+
+BOOLEAN
+PchSmmGetSciEn (
+  VOID
+  )
+{
+  return FALSE;
+}
+
+//
+// SMM services
+//
+
+STATIC
+EFI_STATUS
+EFIAPI
+MockSmmAllocatePool (
+  IN  EFI_MEMORY_TYPE  PoolType,
+  IN  UINTN            Size,
+  OUT VOID             **Buffer
+  )
+{
+  *Buffer = AllocatePool (Size);
+  return (*Buffer == NULL) ? EFI_OUT_OF_RESOURCES : EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+EFIAPI
+MockSmmFreePool (
+  IN VOID  *Buffer
+  )
+{
+  FreePool (Buffer);
+  return EFI_SUCCESS;
+}
+
+STATIC EFI_SMM_SYSTEM_TABLE2  mMockSmst;
+EFI_SMM_SYSTEM_TABLE2         *gSmst = &mMockSmst;
+
+//
+// Parts of the driver that are not under test
+//
+
+CONST PCH_SMM_SOURCE_DESC  mSxSourceDesc          = NULL_SOURCE_DESC_INITIALIZER;
+CONST PCH_SMM_SOURCE_DESC  mPowerButtonSourceDesc = NULL_SOURCE_DESC_INITIALIZER;
+CONST PCH_SMM_SOURCE_DESC  mSrcDescNewCentury     = NULL_SOURCE_DESC_INITIALIZER;
+
+VOID
+EFIAPI
+NullInitSourceDesc (
+  PCH_SMM_SOURCE_DESC  *SrcDesc
+  )
+{
+  CopyMem (SrcDesc, &mNullSourceDesc, sizeof (PCH_SMM_SOURCE_DESC));
+}
+
+VOID
+MapUsbToSrcDesc (
+  IN  PCH_SMM_CONTEXT         *Context,
+  OUT PCH_SMM_SOURCE_DESC     *SrcDesc
+  )
+{
+  NullInitSourceDesc (SrcDesc);
+}
+
+VOID
+MapPeriodicTimerToSrcDesc (
+  IN  PCH_SMM_CONTEXT         *DispatchContext,
+  OUT PCH_SMM_SOURCE_DESC     *SrcDesc
+  )
+{
+  NullInitSourceDesc (SrcDesc);
+}
+
+VOID
+EFIAPI
+SxGetContext (
+  IN  DATABASE_RECORD    *Record,
+  OUT PCH_SMM_CONTEXT    *Context
+  )
+{
+}
+
+BOOLEAN
+EFIAPI
+SxCmpContext (
+  IN PCH_SMM_CONTEXT     *Context1,
+  IN PCH_SMM_CONTEXT     *Context2
+  )
+{
+  return FALSE;
+}
+
+VOID
+EFIAPI
+PowerButtonGetContext (
+  IN  DATABASE_RECORD    *Record,
+  OUT PCH_SMM_CONTEXT    *Context
+  )
+{
+}
+
+BOOLEAN
+EFIAPI
+PowerButtonCmpContext (
+  IN PCH_SMM_CONTEXT     *Context1,
+  IN PCH_SMM_CONTEXT     *Context2
+  )
+{
+  return FALSE;
+}
+
+VOID
+EFIAPI
+PeriodicTimerGetContext (
+  IN  DATABASE_RECORD    *Record,
+  OUT PCH_SMM_CONTEXT    *Context
+  )
+{
+}
+
+BOOLEAN
+EFIAPI
+PeriodicTimerCmpContext (
+  IN PCH_SMM_CONTEXT     *Context1,
+  IN PCH_SMM_CONTEXT     *Context2
+  )
+{
+  return FALSE;
+}
+
+VOID
+EFIAPI
+PeriodicTimerGetCommBuffer (
+  IN  DATABASE_RECORD    *Record,
+  OUT VOID               **CommBuffer,
+  OUT UINTN              *CommBufferSize
+  )
+{
+  *CommBuffer     = NULL;
+  *CommBufferSize = 0;
+}
+
+VOID
+EFIAPI
+PchSmmPeriodicTimerClearSource (
+  IN CONST PCH_SMM_SOURCE_DESC    *SrcDesc
+  )
+{
+}
+
+EFI_STATUS
+PchSmmPeriodicTimerDispatchGetNextShorterInterval (
+  IN CONST EFI_SMM_PERIODIC_TIMER_DISPATCH2_PROTOCOL    *This,
+  IN OUT UINT64                                         **SmiTickInterval
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+EFI_STATUS
+EFIAPI
+PchSwSmiRegister (
+  IN  EFI_SMM_SW_DISPATCH2_PROTOCOL       *This,
+  IN  EFI_SMM_HANDLER_ENTRY_POINT2        DispatchFunction,
+  IN  EFI_SMM_SW_REGISTER_CONTEXT         *DispatchContext,
+  OUT EFI_HANDLE                          *DispatchHandle
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+EFI_STATUS
+EFIAPI
+PchSwSmiUnRegister (
+  IN CONST EFI_SMM_SW_DISPATCH2_PROTOCOL  *This,
+  IN       EFI_HANDLE                     DispatchHandle
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+EFI_STATUS
+EFIAPI
+PchGpiSmiRegister (
+  IN CONST EFI_SMM_GPI_DISPATCH2_PROTOCOL  *This,
+  IN       EFI_SMM_HANDLER_ENTRY_POINT2    DispatchFunction,
+  IN       EFI_SMM_GPI_REGISTER_CONTEXT    *RegisterContext,
+  OUT      EFI_HANDLE                      *DispatchHandle
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+EFI_STATUS
+EFIAPI
+PchGpiSmiUnRegister (
+  IN CONST EFI_SMM_GPI_DISPATCH2_PROTOCOL  *This,
+  IN       EFI_HANDLE                      DispatchHandle
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+EFI_STATUS
+PchSmiTypeCallbackDispatcher (
+  IN  DATABASE_RECORD                   *Record
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+VOID
+EFIAPI
+PchTcoSmiClearSourceAndBlock (
+  CONST PCH_SMM_SOURCE_DESC             *SrcDesc
+  )
+{
+}
+
+VOID
+PchSmmSxGoToSleep (
+  VOID
+  )
+{
+}
+
+UINT16
+PmcGetAcpiBase (
+  VOID
+  )
+{
+  return TEST_ACPI_BASE;
+}
+
+EFI_STATUS
+PchTcoBaseGet (
+  OUT UINT16                            *Address
+  )
+{
+  *Address = TEST_TCO_BASE;
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+PchSmmInitHardware (
+  VOID
+  )
+{
+  return EFI_SUCCESS;
+}
+
+VOID
+PchSmmPublishDispatchProtocols (
+  VOID
+  )
+{
+}
+
+VOID
+PchSwDispatchInit (
+  VOID
+  )
+{
+}
+
+EFI_STATUS
+InstallPchSmiDispatchProtocols (
+  VOID
+  )
+{
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+InstallIoTrap (
+  IN EFI_HANDLE                     ImageHandle
+  )
+{
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+InstallEspiSmi (
+  IN EFI_HANDLE           ImageHandle
+  )
+{
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+InstallPchSmmPeriodicTimerControlProtocol (
+  IN EFI_HANDLE                         Handle
+  )
+{
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+SmiHandlerProfileRegisterHandler (
+  IN EFI_GUID                       *HandlerGuid,
+  IN EFI_SMM_HANDLER_ENTRY_POINT2   Handler,
+  IN PHYSICAL_ADDRESS               CallerAddress,
+  IN VOID                           *Context  OPTIONAL,
+  IN UINTN                          ContextSize  OPTIONAL
+  )
+{
+  return EFI_SUCCESS;
+}
+
+EFI_STATUS
+EFIAPI
+SmiHandlerProfileUnregisterHandler (
+  IN EFI_GUID                       *HandlerGuid,
+  IN EFI_SMM_HANDLER_ENTRY_POINT2   Handler,
+  IN VOID                           *Context  OPTIONAL,
+  IN UINTN                          ContextSize  OPTIONAL
+  )
+{
+  return EFI_SUCCESS;
+}
+
+VOID
+PchSmmResidencyRecordDispatch (
+  IN UINT64                       Ticks
+  )
+{
+}
+
+VOID
+PchSmmResidencyRecordSource (
+  IN UINTN                        Bucket,
+  IN UINT64                       StartTsc,
+  IN UINT64                       Ticks
+  )
+{
+}
+
+VOID
+PchSmmResidencyRecordHandler (
+  IN DATABASE_RECORD              *Record,
+  IN UINT64                       Ticks
+  )
+{
+}
+
+VOID
+PchSmmResidencyProfileInit (
+  VOID
+  )
+{
+}
+
+//
+// Test helpers
+//
+
+/**
+  Child callback. Logs which child ran, and unregisters the child in
+  mUnregisterOnCall if the test asked for it.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+TestChildCallback (
+  IN     EFI_HANDLE  DispatchHandle,
+  IN     CONST VOID  *Context         OPTIONAL,
+  IN OUT VOID        *CommBuffer      OPTIONAL,
+  IN OUT UINTN       *CommBufferSize  OPTIONAL
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < mHandleCount; Index++) {
+    if (mHandle[Index] == DispatchHandle) {
+      break;
+    }
+  }
+  ASSERT (Index < mHandleCount);
+  ASSERT (mCallCount < ARRAY_SIZE (mCallLog));
+  mCallLog[mCallCount++] = Index;
+
+  if (mUnregisterOnCall[Index] != NULL) {
+    PchSmmCoreUnRegister (NULL, (EFI_HANDLE *) *mUnregisterOnCall[Index]);
+    *mUnregisterOnCall[Index] = NULL;
+  }
+  return EFI_SUCCESS;
+}
+
+/**
+  Register a child whose enable and status bits are bit Bit of SMI_EN and
+  SMI_STS. With TopLevel the status bit is also the PMC SMI_STS top level bit,
+  otherwise the source has no top level bit and lands in the shared bucket.
+
+  @retval The index of the child in mHandle
+**/
+STATIC
+UINTN
+TestRegisterChild (
+  IN UINT8    Bit,
+  IN BOOLEAN  TopLevel
+  )
+{
+  DATABASE_RECORD  Record;
+  EFI_STATUS       Status;
+
+  ZeroMem (&Record, sizeof (Record));
+  Record.Signature    = DATABASE_RECORD_SIGNATURE;
+  Record.ProtocolType = SwType;
+  Record.Callback     = TestChildCallback;
+  CopyMem (&Record.SrcDesc, &mNullSourceDesc, sizeof (PCH_SMM_SOURCE_DESC));
+
+  Record.SrcDesc.En[0].Reg.Type      = ACPI_ADDR_TYPE;
+  Record.SrcDesc.En[0].Reg.Data.acpi = R_ACPI_IO_SMI_EN;
+  Record.SrcDesc.En[0].SizeInBytes   = S_ACPI_IO_SMI_STS;
+  Record.SrcDesc.En[0].Bit           = Bit;
+
+  Record.SrcDesc.Sts[0].Reg.Type      = ACPI_ADDR_TYPE;
+  Record.SrcDesc.Sts[0].Reg.Data.acpi = R_ACPI_IO_SMI_STS;
+  Record.SrcDesc.Sts[0].SizeInBytes   = S_ACPI_IO_SMI_STS;
+  Record.SrcDesc.Sts[0].Bit           = Bit;
+
+  if (TopLevel) {
+    Record.SrcDesc.PmcSmiSts = Record.SrcDesc.Sts[0];
+  }
+
+  ASSERT (mHandleCount < TEST_MAX_CHILDREN);
+  Status = SmmCoreInsertRecord (&Record, &mHandle[mHandleCount]);
+  ASSERT_EFI_ERROR (Status);
+
+  WriteBitDesc (&Record.SrcDesc.En[0], TRUE, FALSE);
+  return mHandleCount++;
+}
+
+/**
+  Make the source of a child pending in SMI_STS.
+**/
+STATIC
+VOID
+TestRaise (
+  IN UINT8  Bit
+  )
+{
+  UINTN   Port;
+  UINT32  Value;
+
+  //
+  // Hardware sets the status bit, so go around the write 1 to clear logic
+  //
+  Port  = mAcpiBaseAddr + R_ACPI_IO_SMI_STS;
+  Value = MockIoGet (Port, sizeof (UINT32)) | (1u << Bit);
+  CopyMem (&mMockIo[Port], &Value, sizeof (UINT32));
+}
+
+STATIC
+VOID
+EFIAPI
+TestReset (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < mHandleCount; Index++) {
+    if (mHandle[Index] != NULL) {
+      PchSmmCoreUnRegister (NULL, (EFI_HANDLE *) mHandle[Index]);
+    }
+  }
+
+  ZeroMem (mMockIo, sizeof (mMockIo));
+  ZeroMem (mHandle, sizeof (mHandle));
+  ZeroMem (mUnregisterOnCall, sizeof (mUnregisterOnCall));
+  mHandleCount = 0;
+  mCallCount   = 0;
+}
+
+STATIC
+VOID
+TestDispatch (
+  VOID
+  )
+{
+  PchSmmCoreDispatcher (NULL, NULL, NULL, NULL);
+}
+
+//
+// Test cases
+//
+
+/**
+  Children on different SMI_STS bits run in registration order, not in the
+  order of their status bits.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+DispatchInRegistrationOrder (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  Mcsmi;
+  UINTN  SwSmiTmr;
+
+  Mcsmi    = TestRegisterChild (N_ACPI_IO_SMI_STS_MCSMI, TRUE);
+  SwSmiTmr = TestRegisterChild (N_ACPI_IO_SMI_STS_SWSMI_TMR, TRUE);
+
+  TestRaise (N_ACPI_IO_SMI_STS_MCSMI);
+  TestRaise (N_ACPI_IO_SMI_STS_SWSMI_TMR);
+  TestDispatch ();
+
+  UT_ASSERT_EQUAL (mCallCount, 2);
+  UT_ASSERT_EQUAL (mCallLog[0], Mcsmi);
+  UT_ASSERT_EQUAL (mCallLog[1], SwSmiTmr);
+  UT_ASSERT_EQUAL (IoRead32 (mAcpiBaseAddr + R_ACPI_IO_SMI_STS), 0);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A source without a top level SMI_STS bit keeps its place in registration
+  order, even though its bucket is walked last.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+DispatchSharedBucketInRegistrationOrder (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  Monitor;
+  UINTN  Apm;
+
+  Monitor = TestRegisterChild (N_ACPI_IO_SMI_STS_MONITOR, FALSE);
+  Apm     = TestRegisterChild (N_ACPI_IO_SMI_STS_APM, TRUE);
+
+  TestRaise (N_ACPI_IO_SMI_STS_APM);
+  TestRaise (N_ACPI_IO_SMI_STS_MONITOR);
+  TestDispatch ();
+
+  UT_ASSERT_EQUAL (mCallCount, 2);
+  UT_ASSERT_EQUAL (mCallLog[0], Monitor);
+  UT_ASSERT_EQUAL (mCallLog[1], Apm);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Only children whose status bit is pending run, and the status of the others
+  is left alone.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+DispatchOnlyPendingSources (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  SwSmiTmr;
+  UINTN  Mcsmi;
+
+  SwSmiTmr = TestRegisterChild (N_ACPI_IO_SMI_STS_SWSMI_TMR, TRUE);
+  Mcsmi    = TestRegisterChild (N_ACPI_IO_SMI_STS_MCSMI, TRUE);
+
+  TestRaise (N_ACPI_IO_SMI_STS_MCSMI);
+  TestDispatch ();
+
+  UT_ASSERT_EQUAL (mCallCount, 1);
+  UT_ASSERT_EQUAL (mCallLog[0], Mcsmi);
+  UT_ASSERT_NOT_EQUAL (mCallLog[0], SwSmiTmr);
+
+  //
+  // A status bit that is pending but not enabled does not dispatch
+  //
+  WriteBitDesc (&DATABASE_RECORD_FROM_LINK (mHandle[SwSmiTmr])->SrcDesc.En[0], FALSE, FALSE);
+  TestRaise (N_ACPI_IO_SMI_STS_SWSMI_TMR);
+  TestDispatch ();
+
+  UT_ASSERT_EQUAL (mCallCount, 1);
+  UT_ASSERT_EQUAL (IoRead32 (mAcpiBaseAddr + R_ACPI_IO_SMI_STS), 1u << N_ACPI_IO_SMI_STS_SWSMI_TMR);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  All children of the same source run once, in registration order, and the
+  source is cleared once they are done.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+DispatchAllChildrenOfSource (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  First;
+  UINTN  Other;
+  UINTN  Second;
+
+  First  = TestRegisterChild (N_ACPI_IO_SMI_STS_APM, TRUE);
+  Other  = TestRegisterChild (N_ACPI_IO_SMI_STS_SWSMI_TMR, TRUE);
+  Second = TestRegisterChild (N_ACPI_IO_SMI_STS_APM, TRUE);
+
+  TestRaise (N_ACPI_IO_SMI_STS_APM);
+  TestDispatch ();
+
+  UT_ASSERT_EQUAL (mCallCount, 2);
+  UT_ASSERT_EQUAL (mCallLog[0], First);
+  UT_ASSERT_EQUAL (mCallLog[1], Second);
+  UT_ASSERT_NOT_EQUAL (mCallLog[1], Other);
+  UT_ASSERT_EQUAL (IoRead32 (mAcpiBaseAddr + R_ACPI_IO_SMI_STS), 0);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A child may unregister itself from its callback. The children after it still
+  run, and the unregistered child does not run again.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+DispatchChildUnregistersItself (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  First;
+  UINTN  Second;
+
+  First  = TestRegisterChild (N_ACPI_IO_SMI_STS_APM, TRUE);
+  Second = TestRegisterChild (N_ACPI_IO_SMI_STS_APM, TRUE);
+  mUnregisterOnCall[First] = &mHandle[First];
+
+  TestRaise (N_ACPI_IO_SMI_STS_APM);
+  TestDispatch ();
+
+  UT_ASSERT_EQUAL (mCallCount, 2);
+  UT_ASSERT_EQUAL (mCallLog[0], First);
+  UT_ASSERT_EQUAL (mCallLog[1], Second);
+
+  TestRaise (N_ACPI_IO_SMI_STS_APM);
+  TestDispatch ();
+
+  UT_ASSERT_EQUAL (mCallCount, 3);
+  UT_ASSERT_EQUAL (mCallLog[2], Second);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  A child may unregister the next child of the same source from its callback.
+  The unregistered child does not run, the ones after it do.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+DispatchChildUnregistersNext (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  First;
+  UINTN  Second;
+  UINTN  Third;
+
+  First  = TestRegisterChild (N_ACPI_IO_SMI_STS_APM, TRUE);
+  Second = TestRegisterChild (N_ACPI_IO_SMI_STS_APM, TRUE);
+  Third  = TestRegisterChild (N_ACPI_IO_SMI_STS_APM, TRUE);
+  mUnregisterOnCall[First] = &mHandle[Second];
+
+  TestRaise (N_ACPI_IO_SMI_STS_APM);
+  TestDispatch ();
+
+  UT_ASSERT_EQUAL (mCallCount, 2);
+  UT_ASSERT_EQUAL (mCallLog[0], First);
+  UT_ASSERT_EQUAL (mCallLog[1], Third);
+  UT_ASSERT_EQUAL (IoRead32 (mAcpiBaseAddr + R_ACPI_IO_SMI_STS), 0);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the
+  PCH SMM core dispatcher and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+SetupAndRunUnitTests (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      Dispatch;
+  UINTN                       Bucket;
+
+  Framework = NULL;
+  DEBUG ((DEBUG_INFO, "%a: v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  mMockSmst.SmmAllocatePool = MockSmmAllocatePool;
+  mMockSmst.SmmFreePool     = MockSmmFreePool;
+  mAcpiBaseAddr             = TEST_ACPI_BASE;
+  mTcoBaseAddr              = TEST_TCO_BASE;
+  InitializeListHead (&mPrivateData.CallbackDataBase);
+  for (Bucket = 0; Bucket < PCH_SMM_STS_BUCKET_MAX; Bucket++) {
+    InitializeListHead (&mPrivateData.StsBucket[Bucket]);
+  }
+
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&Dispatch, Framework, "PCH SMM Core Dispatch Tests", "PchSmmCore.Dispatch", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for Dispatch Tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (Dispatch, "Sources are dispatched in registration order", "DispatchInRegistrationOrder", DispatchInRegistrationOrder, NULL, TestReset, NULL);
+  AddTestCase (Dispatch, "Sources without a top level bit keep registration order", "DispatchSharedBucketInRegistrationOrder", DispatchSharedBucketInRegistrationOrder, NULL, TestReset, NULL);
+  AddTestCase (Dispatch, "Only pending and enabled sources are dispatched", "DispatchOnlyPendingSources", DispatchOnlyPendingSources, NULL, TestReset, NULL);
+  AddTestCase (Dispatch, "All children of a source are dispatched", "DispatchAllChildrenOfSource", DispatchAllChildrenOfSource, NULL, TestReset, NULL);
+  AddTestCase (Dispatch, "A child can unregister itself in its callback", "DispatchChildUnregistersItself", DispatchChildUnregistersItself, NULL, TestReset, NULL);
+  AddTestCase (Dispatch, "A child can unregister the next child in its callback", "DispatchChildUnregistersNext", DispatchChildUnregistersNext, NULL, TestReset, NULL);
+
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return SetupAndRunUnitTests ();
+}
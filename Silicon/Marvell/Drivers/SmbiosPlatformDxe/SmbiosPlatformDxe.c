@@ -14,6 +14,7 @@
 #include <Library/MemoryAllocationLib.h>
 #include <Library/PcdLib.h>
 #include <Library/SampleAtResetLib.h>
+#include <Library/SmbiosRecordBuilderLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 
 #include <Protocol/Smbios.h>
@@ -561,116 +562,21 @@ STATIC CONST VOID *DefaultCommonTables[][2] =
 };
 
 /**
+   Adds a memory descriptor (type19) for the given address range to the builder
 
-  Create SMBIOS record.
-
-  Converts a fixed SMBIOS structure and an array of pointers to strings into
-  an SMBIOS record where the strings are cat'ed on the end of the fixed record
-  and terminated via a double NULL and add to SMBIOS table.
-
-  SMBIOS_TABLE_TYPE32 gSmbiosType12 = {
-    { EFI_SMBIOS_TYPE_SYSTEM_CONFIGURATION_OPTIONS, sizeof (SMBIOS_TABLE_TYPE12), 0 },
-    1 // StringCount
-  };
-
-  CHAR8 *gSmbiosType12Strings[] = {
-    "Not Found",
-    NULL
-  };
-
-  ...
-
-  LogSmbiosData (
-    (EFI_SMBIOS_TABLE_HEADER*)&gSmbiosType12,
-    gSmbiosType12Strings
-    );
-
-  @param  Smbios      SMBIOS protocol
-  @param  Template    Fixed SMBIOS structure, required.
-  @param  StringArray Array of strings to convert to an SMBIOS string pack.
-                      NULL is OK.
-**/
-STATIC
-EFI_STATUS
-EFIAPI
-LogSmbiosData (
-  IN  EFI_SMBIOS_PROTOCOL     *Smbios,
-  IN  EFI_SMBIOS_TABLE_HEADER *Template,
-  IN  CONST CHAR8 * CONST     *StringArray
-  )
-{
-  EFI_STATUS                Status;
-  EFI_SMBIOS_TABLE_HEADER   *Record;
-  UINTN                     Index;
-  UINTN                     StringSize;
-  UINTN                     Size;
-  CHAR8                     *Str;
-
-
-  // Calculate the size of the fixed record and optional string pack
-  Size = Template->Length;
-  if (StringArray == NULL) {
-    // At least a double null is required
-    Size += 1;
-  } else {
-    for (Index = 0; StringArray[Index] != NULL; Index++) {
-      StringSize = AsciiStrSize (StringArray[Index]);
-      Size += StringSize;
-    }
-    if (StringArray[0] == NULL) {
-      // At least a double null is required
-      Size += 1;
-    }
-
-    // Don't forget the terminating double null
-    Size += 1;
-  }
-
-  // Copy over Template
-  Record = (EFI_SMBIOS_TABLE_HEADER *)AllocateZeroPool (Size);
-  if (Record == NULL) {
-    return EFI_OUT_OF_RESOURCES;
-  }
-  CopyMem (Record, Template, Template->Length);
-
-  // Append string pack
-  Str = (CHAR8*)((UINTN)Record + Record->Length);
-  for (Index = 0; StringArray[Index] != NULL; Index++) {
-    StringSize = AsciiStrSize (StringArray[Index]);
-    CopyMem (Str, StringArray[Index], StringSize);
-    Str += StringSize;
-  }
-  *Str = 0;
-
-  Status = Smbios->Add (Smbios,
-                     NULL,
-                     &Record->Handle,
-                     Record);
-  ASSERT_EFI_ERROR (Status);
-
-  FreePool (Record);
-
-  return Status;
-}
-
-/**
-   Installs a memory descriptor (type19) for the given address range
-
-   @param  Smbios               SMBIOS protocol.
+   @param  Builder              SMBIOS record builder.
    @param  StartingAddress      Start address of the memory chunk.
    @param  RegionLength         Memory chunk size.
 
 **/
 EFI_STATUS
 SmbiosInstallMemoryStructure (
-  IN EFI_SMBIOS_PROTOCOL       *Smbios,
+  IN SMBIOS_RECORD_BUILDER     *Builder,
   IN UINT64                    StartingAddress,
   IN UINT64                    RegionLength
   )
 {
-  EFI_SMBIOS_HANDLE         SmbiosHandle;
   SMBIOS_TABLE_TYPE19       MemoryDescriptor;
-  EFI_STATUS                Status = EFI_SUCCESS;
 
   CopyMem (&MemoryDescriptor,
     &mArmadaDefaultType19,
@@ -678,26 +584,20 @@ SmbiosInstallMemoryStructure (
 
   MemoryDescriptor.ExtendedStartingAddress = StartingAddress;
   MemoryDescriptor.ExtendedEndingAddress = StartingAddress + RegionLength;
-  SmbiosHandle = MemoryDescriptor.Hdr.Handle;
 
-  Status = Smbios->Add (Smbios,
-                     NULL,
-                     &SmbiosHandle,
-                     (EFI_SMBIOS_TABLE_HEADER*) &MemoryDescriptor);
-
-  return Status;
+  return SmbiosBuilderAddRecord (Builder, &MemoryDescriptor.Hdr, NULL, NULL);
 }
 
 /**
-   Install a whole table worth of structructures
+   Add a whole table worth of structructures to the builder
 
-   @param  Smbios               SMBIOS protocol.
+   @param  Builder              SMBIOS record builder.
    @param  DefaultTables        A pointer to the default SMBIOS table structure.
 
 **/
 EFI_STATUS
 SmbiosInstallStructures (
-   IN EFI_SMBIOS_PROTOCOL   *Smbios,
+   IN SMBIOS_RECORD_BUILDER *Builder,
    IN CONST VOID            *DefaultTables[][2]
    )
 {
@@ -711,9 +611,10 @@ SmbiosInstallStructures (
         continue;
       }
 
-      Status = LogSmbiosData (Smbios,
-                 ((EFI_SMBIOS_TABLE_HEADER *)DefaultTables[TableEntry][0]),
-                 DefaultTables[TableEntry][1]);
+      Status = SmbiosBuilderAddRecord (Builder,
+                 (SMBIOS_STRUCTURE *)DefaultTables[TableEntry][0],
+                 DefaultTables[TableEntry][1],
+                 NULL);
       if (EFI_ERROR (Status))
         break;
     }
@@ -724,13 +625,13 @@ SmbiosInstallStructures (
 /**
    Update memory information basing on the HOB list.
 
-   @param  Smbios               SMBIOS protocol
+   @param  Builder              SMBIOS record builder
 
 **/
 STATIC
 EFI_STATUS
 SmbiosMemoryInstall (
-  IN EFI_SMBIOS_PROTOCOL       *Smbios
+  IN SMBIOS_RECORD_BUILDER     *Builder
   )
 {
   EFI_PEI_HOB_POINTERS    Hob;
@@ -752,7 +653,7 @@ SmbiosMemoryInstall (
       if (Hob.ResourceDescriptor->ResourceType == EFI_RESOURCE_SYSTEM_MEMORY) {
           MemorySize += (UINT64)(Hob.ResourceDescriptor->ResourceLength);
 
-          Status = SmbiosInstallMemoryStructure (Smbios,
+          Status = SmbiosInstallMemoryStructure (Builder,
                      Hob.ResourceDescriptor->PhysicalStart,
                      Hob.ResourceDescriptor->ResourceLength);
           if (EFI_ERROR(Status)) {
@@ -773,14 +674,14 @@ SmbiosMemoryInstall (
 }
 
 /**
-   Install all structures from the DefaultTables structure
+   Add all structures from the DefaultTables structure to the builder
 
-   @param  Smbios               SMBIOS protocol
+   @param  Builder              SMBIOS record builder
 
 **/
 EFI_STATUS
 SmbiosInstallAllStructures (
-   IN EFI_SMBIOS_PROTOCOL       *Smbios
+   IN SMBIOS_RECORD_BUILDER     *Builder
    )
 {
   EFI_STATUS    Status;
@@ -802,13 +703,13 @@ SmbiosInstallAllStructures (
   //
   // Generate memory descriptors.
   //
-  Status = SmbiosMemoryInstall (Smbios);
+  Status = SmbiosMemoryInstall (Builder);
   ASSERT_EFI_ERROR (Status);
 
   //
-  // Install all tables.
+  // Queue all tables.
   //
-  Status = SmbiosInstallStructures (Smbios, DefaultCommonTables);
+  Status = SmbiosInstallStructures (Builder, DefaultCommonTables);
   ASSERT_EFI_ERROR (Status);
 
   return EFI_SUCCESS;
@@ -832,19 +733,22 @@ SmbiosPlatformDriverEntryPoint (
   )
 {
   EFI_STATUS                Status;
-  EFI_SMBIOS_PROTOCOL       *Smbios;
+  SMBIOS_RECORD_BUILDER     *Builder;
 
-  //
-  // Find the SMBIOS protocol
-  //
-  Status = gBS->LocateProtocol (&gEfiSmbiosProtocolGuid,
-                  NULL,
-                  (VOID **)&Smbios);
+  Status = SmbiosBuilderCreate (&Builder);
   if (EFI_ERROR (Status)) {
     return Status;
   }
 
-  Status = SmbiosInstallAllStructures (Smbios);
+  Status = SmbiosInstallAllStructures (Builder);
+  if (!EFI_ERROR (Status)) {
+    //
+    // Add all records to the SMBIOS table in a single pass
+    //
+    Status = SmbiosBuilderInstall (Builder, NULL);
+  }
+
+  SmbiosBuilderFree (Builder);
 
   return Status;
 }
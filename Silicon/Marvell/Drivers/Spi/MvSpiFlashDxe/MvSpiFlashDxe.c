@@ -68,12 +68,8 @@ MvSpiFlashWriteEnableCmd (
 
 STATIC
 EFI_STATUS
-MvSpiFlashWriteCommon (
-  IN SPI_DEVICE *Slave,
-  IN UINT8 *Cmd,
-  IN UINT32 Length,
-  IN UINT8* Buffer,
-  IN UINT32 BufferLength
+MvSpiFlashWaitReady (
+  IN SPI_DEVICE *Slave
   )
 {
   UINT8 CmdStatus = CMD_READ_STATUS;
@@ -88,13 +84,6 @@ MvSpiFlashWriteCommon (
     CheckStatus = STATUS_REG_POLL_PEC;
   }
 
-  // Send command
-  MvSpiFlashWriteEnableCmd (Slave);
-
-  // Write data
-  SpiMasterProtocol->ReadWrite (SpiMasterProtocol, Slave, Cmd, Length,
-    Buffer, NULL, BufferLength);
-
   // Poll status register
   SpiMasterProtocol->Transfer (SpiMasterProtocol, Slave, 1, &CmdStatus,
     NULL, SPI_TRANSFER_BEGIN);
@@ -105,17 +94,65 @@ MvSpiFlashWriteCommon (
     if ((State & PollBit) == CheckStatus)
       break;
   } while (Counter > 0);
+
+  // Deactivate CS
+  SpiMasterProtocol->Transfer (SpiMasterProtocol, Slave, 0, NULL, NULL, SPI_TRANSFER_END);
+
   if (Counter == 0) {
     DEBUG((DEBUG_ERROR, "SpiFlash: Timeout while writing to spi flash\n"));
     return EFI_DEVICE_ERROR;
   }
 
-  // Deactivate CS
-  SpiMasterProtocol->Transfer (SpiMasterProtocol, Slave, 0, NULL, NULL, SPI_TRANSFER_END);
-
   return EFI_SUCCESS;
 }
 
+/**
+  Issue a write-type command without waiting for the flash to finish it.
+  The caller must call MvSpiFlashWaitReady () before the next command.
+**/
+STATIC
+EFI_STATUS
+MvSpiFlashWriteStart (
+  IN SPI_DEVICE *Slave,
+  IN UINT8 *Cmd,
+  IN UINT32 Length,
+  IN UINT8* Buffer,
+  IN UINT32 BufferLength
+  )
+{
+  EFI_STATUS Status;
+
+  // Send command
+  Status = MvSpiFlashWriteEnableCmd (Slave);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  // Write data
+  return SpiMasterProtocol->ReadWrite (SpiMasterProtocol, Slave, Cmd, Length,
+           Buffer, NULL, BufferLength);
+}
+
+STATIC
+EFI_STATUS
+MvSpiFlashWriteCommon (
+  IN SPI_DEVICE *Slave,
+  IN UINT8 *Cmd,
+  IN UINT32 Length,
+  IN UINT8* Buffer,
+  IN UINT32 BufferLength
+  )
+{
+  EFI_STATUS Status;
+
+  Status = MvSpiFlashWriteStart (Slave, Cmd, Length, Buffer, BufferLength);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return MvSpiFlashWaitReady (Slave);
+}
+
 STATIC
 VOID
 SpiFlashCmdBankaddrWrite (
@@ -283,6 +320,96 @@ MvSpiFlashWrite (
   return EFI_SUCCESS;
 }
 
+STATIC
+BOOLEAN
+MvSpiFlashNeedsErase (
+  IN CONST UINT8 *Current,
+  IN CONST UINT8 *New,
+  IN UINTN Length
+  )
+{
+  UINTN Index;
+
+  // Programming can only clear bits, any 0->1 transition needs an erase
+  for (Index = 0; Index < Length; Index++) {
+    if ((Current[Index] & New[Index]) != New[Index]) {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/**
+  Program Length bytes of Data at Offset page by page, skipping the pages
+  whose contents already match Current. The status of each page program is
+  only polled once the next page to be programmed has been found, so that
+  the comparison overlaps with the flash being busy.
+
+  The range must not cross a 16MB bank boundary, and the bank must already
+  be selected.
+**/
+STATIC
+EFI_STATUS
+MvSpiFlashProgramPages (
+  IN SPI_DEVICE *Slave,
+  IN UINT32 Offset,
+  IN UINTN Length,
+  IN UINT8 *Data,
+  IN UINT8 *Current
+  )
+{
+  EFI_STATUS Status;
+  UINTN Index, ChunkLength, PageSize;
+  BOOLEAN Pending;
+  UINT8 Cmd[5];
+
+  PageSize = Slave->Info->PageSize;
+  Pending = FALSE;
+
+  Cmd[0] = CMD_PAGE_PROGRAM;
+
+  for (Index = 0; Index < Length; Index += ChunkLength) {
+    ChunkLength = MIN (Length - Index, PageSize - ((Offset + Index) % PageSize));
+
+    if (CompareMem (&Data[Index], &Current[Index], ChunkLength) == 0) {
+      continue;
+    }
+
+    if (Pending) {
+      Status = MvSpiFlashWaitReady (Slave);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+
+    SpiFlashFormatAddress (Offset + Index, Slave->AddrSize, Cmd);
+    Status = MvSpiFlashWriteStart (Slave, Cmd, Slave->AddrSize + 1,
+               &Data[Index], ChunkLength);
+    if (EFI_ERROR (Status)) {
+      DEBUG((DEBUG_ERROR, "SpiFlash: Error while programming write address\n"));
+      return Status;
+    }
+    Pending = TRUE;
+  }
+
+  if (Pending) {
+    return MvSpiFlashWaitReady (Slave);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Update the first ToUpdate bytes of the sector at Offset with Buf.
+
+  The sector is left alone if it already holds the new data. It is only
+  erased when the new data needs a bit to go from 0 to 1, otherwise the
+  differing pages are programmed over the old contents. Either way the
+  result is read back and compared.
+
+  TmpBuf and VerifyBuf must each hold EraseSize bytes.
+**/
 STATIC
 EFI_STATUS
 MvSpiFlashUpdateBlock (
@@ -291,40 +418,65 @@ MvSpiFlashUpdateBlock (
   IN UINTN ToUpdate,
   IN UINT8 *Buf,
   IN UINT8 *TmpBuf,
+  IN UINT8 *VerifyBuf,
   IN UINTN EraseSize
   )
 {
   EFI_STATUS Status;
+  UINT8 *Expected, *Current;
+  UINTN Length;
 
-  // Read backup
+  // Read current contents
   Status = MvSpiFlashRead (Slave, Offset, EraseSize, TmpBuf);
+  if (EFI_ERROR (Status)) {
+    DEBUG((DEBUG_ERROR, "SpiFlash: Update: Error while reading old data\n"));
+    return Status;
+  }
+
+  if (CompareMem (TmpBuf, Buf, ToUpdate) == 0) {
+    return EFI_SUCCESS;
+  }
+
+  SpiFlashBank (Slave, Offset);
+
+  if (MvSpiFlashNeedsErase (TmpBuf, Buf, ToUpdate)) {
+    // Erase entire sector
+    Status = MvSpiFlashErase (Slave, Offset, EraseSize);
     if (EFI_ERROR (Status)) {
-      DEBUG((DEBUG_ERROR, "SpiFlash: Update: Error while reading old data\n"));
+      DEBUG((DEBUG_ERROR, "SpiFlash: Update: Error while erasing block\n"));
       return Status;
     }
 
-  // Erase entire sector
-  Status = MvSpiFlashErase (Slave, Offset, EraseSize);
+    // Write new data together with the backup of the rest of the sector,
+    // pages that are left all 0xFF need no programming.
+    CopyMem (TmpBuf, Buf, ToUpdate);
+    SetMem (VerifyBuf, EraseSize, 0xFF);
+    Expected = TmpBuf;
+    Current = VerifyBuf;
+    Length = EraseSize;
+  } else {
+    // Only clear bits in the pages that differ
+    Expected = Buf;
+    Current = TmpBuf;
+    Length = ToUpdate;
+  }
+
+  Status = MvSpiFlashProgramPages (Slave, Offset, Length, Expected, Current);
   if (EFI_ERROR (Status)) {
-      DEBUG((DEBUG_ERROR, "SpiFlash: Update: Error while erasing block\n"));
-      return Status;
-    }
+    DEBUG((DEBUG_ERROR, "SpiFlash: Update: Error while writing new data\n"));
+    return Status;
+  }
 
-  // Write new data
-  MvSpiFlashWrite (Slave, Offset, ToUpdate, Buf);
+  // Verify
+  Status = MvSpiFlashRead (Slave, Offset, Length, VerifyBuf);
   if (EFI_ERROR (Status)) {
-      DEBUG((DEBUG_ERROR, "SpiFlash: Update: Error while writing new data\n"));
-      return Status;
-    }
+    DEBUG((DEBUG_ERROR, "SpiFlash: Update: Error while reading back data\n"));
+    return Status;
+  }
 
-  // Write backup
-  if (ToUpdate != EraseSize) {
-    Status = MvSpiFlashWrite (Slave, Offset + ToUpdate, EraseSize - ToUpdate,
-      &TmpBuf[ToUpdate]);
-    if (EFI_ERROR (Status)) {
-      DEBUG((DEBUG_ERROR, "SpiFlash: Update: Error while writing backup\n"));
-      return Status;
-    }
+  if (CompareMem (VerifyBuf, Expected, Length) != 0) {
+    DEBUG((DEBUG_ERROR, "SpiFlash: Update: Verify failed at 0x%x\n", Offset));
+    return EFI_DEVICE_ERROR;
   }
 
   return EFI_SUCCESS;
@@ -346,7 +498,7 @@ MvSpiFlashUpdate (
 
   End = Buf + ByteCount;
 
-  TmpBuf = (UINT8 *)AllocateZeroPool (SectorSize);
+  TmpBuf = (UINT8 *)AllocateZeroPool (2 * SectorSize);
   if (TmpBuf == NULL) {
     DEBUG((DEBUG_ERROR, "SpiFlash: Cannot allocate memory\n"));
     return EFI_OUT_OF_RESOURCES;
@@ -358,10 +510,12 @@ MvSpiFlashUpdate (
   for (; Buf < End; Buf += ToUpdate, Offset += ToUpdate) {
     ToUpdate = MIN((UINT64)(End - Buf), SectorSize);
     Print (L"   \rUpdating, %d%%", 100 - (End - Buf) / Scale);
-    Status = MvSpiFlashUpdateBlock (Slave, Offset, ToUpdate, Buf, TmpBuf, SectorSize);
+    Status = MvSpiFlashUpdateBlock (Slave, Offset, ToUpdate, Buf, TmpBuf,
+               TmpBuf + SectorSize, SectorSize);
 
     if (EFI_ERROR (Status)) {
       DEBUG((DEBUG_ERROR, "SpiFlash: Error while updating\n"));
+      FreePool (TmpBuf);
       return Status;
     }
   }
@@ -394,7 +548,7 @@ MvSpiFlashUpdateWithProgress (
   SectorNum = (ByteCount / SectorSize) + 1;
   ToUpdate = SectorSize;
 
-  TmpBuf = (UINT8 *)AllocateZeroPool (SectorSize);
+  TmpBuf = (UINT8 *)AllocateZeroPool (2 * SectorSize);
   if (TmpBuf == NULL) {
     DEBUG ((DEBUG_ERROR, "%a: Cannot allocate memory\n", __func__));
     return EFI_OUT_OF_RESOURCES;
@@ -416,9 +570,11 @@ MvSpiFlashUpdateWithProgress (
                ToUpdate,
                Buffer + Index * SectorSize,
                TmpBuf,
+               TmpBuf + SectorSize,
                SectorSize);
     if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_ERROR, "%a: Error while updating\n", __func__));
+      FreePool (TmpBuf);
       return Status;
     }
   }
@@ -27,6 +27,15 @@
                              FixedPcdGet32 (PcdFlashNvStorageFtwWorkingSize) + \
                              FixedPcdGet32 (PcdFlashNvStorageFtwSpareSize))
 
+//
+// The command used for memory mapped reads of the array
+//
+#define NOR_FLASH_READ_OPCODE \
+  ((FixedPcdGet8 (PcdFip006DxeReadMode) == FIP006_READ_MODE_QUAD) ? \
+     SPINOR_OP_READ_1_1_4_4B : \
+   (FixedPcdGet8 (PcdFip006DxeReadMode) == FIP006_READ_MODE_FAST) ? \
+     SPINOR_OP_READ_FAST_4B : SPINOR_OP_READ_4B)
+
 STATIC NOR_FLASH_DESCRIPTION mNorFlashDevices[] = {
   {
     // UEFI code region
@@ -77,6 +86,12 @@ STATIC CONST CSDC_DEFINITION mN25qCSDCDefTable[] = {
   // Read Operations
   { SPINOR_OP_READ_4B,  TRUE,  TRUE,  FALSE, FALSE, CS_CFG_MBM_SINGLE,
                         CSDC_TRP_SINGLE },
+  { SPINOR_OP_READ_FAST_4B,
+                        TRUE,  TRUE,  TRUE,  FALSE, CS_CFG_MBM_SINGLE,
+                        CSDC_TRP_SINGLE },
+  { SPINOR_OP_READ_1_1_4_4B,
+                        TRUE,  TRUE,  TRUE,  FALSE, CS_CFG_MBM_QUAD,
+                        CSDC_TRP_SINGLE },
   // Write Operations
   { SPINOR_OP_PP_4B,    TRUE,  TRUE,  FALSE, TRUE,  CS_CFG_MBM_SINGLE,
                         CSDC_TRP_SINGLE },
@@ -296,11 +311,25 @@ NorFlashSetHostCommand (
 {
   CONST CSDC_DEFINITION     *Cmd;
   UINT16                    CSDC[ARRAY_SIZE (mFip006NullCmdSeq)];
+  FIP006_CS_CFG             CsCfg;
 
   Cmd = NorFlashGetCmdDef (Instance, Code);
   if (Cmd == NULL) {
     return EFI_INVALID_PARAMETER;
   }
+
+  //
+  // The data phase of the quad read uses the multi bit mode of the
+  // sequencer, so switch it whenever the command needs a different one.
+  //
+  CsCfg.Raw = MmioRead32 (Instance->HostRegisterBaseAddress +
+                          FIP006_REG_CS_CFG);
+  if (CsCfg.Reg.MBM != Cmd->CscfgMbm) {
+    CsCfg.Reg.MBM = Cmd->CscfgMbm;
+    MmioWrite32 (Instance->HostRegisterBaseAddress + FIP006_REG_CS_CFG,
+                 CsCfg.Raw);
+  }
+
   GenCSDC (
       Cmd->Code,
       Cmd->AddrAccess,
@@ -323,31 +352,50 @@ NorFlashReadStatusRegister (
 
   NorFlashSetHostCommand (Instance, SPINOR_OP_RDSR);
   StatusRegister = MmioRead8 (Instance->RegionBaseAddress);
-  NorFlashSetHostCommand (Instance, SPINOR_OP_READ_4B);
+  NorFlashSetHostCommand (Instance, NOR_FLASH_READ_OPCODE);
   return StatusRegister;
 }
 
+/**
+ * Wait for a program or erase cycle to complete. The status register read
+ * sequence is left in place, the caller restores the read command.
+ **/
 STATIC
-EFI_STATUS
-NorFlashWaitProgramErase (
+VOID
+NorFlashPollProgramErase (
   IN NOR_FLASH_INSTANCE     *Instance
   )
 {
   BOOLEAN     SRegDone;
   BOOLEAN     FSRegDone;
 
-  DEBUG ((DEBUG_BLKIO, "NorFlashWaitProgramErase()\n"));
-
+  //
+  // Leave the status register read sequence in place while polling,
+  // there is no need to restore the read command after every read.
+  //
+  NorFlashSetHostCommand (Instance, SPINOR_OP_RDSR);
   do {
-    SRegDone = (NorFlashReadStatusRegister (Instance) & SPINOR_SR_WIP) == 0;
+    SRegDone = (MmioRead8 (Instance->RegionBaseAddress) & SPINOR_SR_WIP) == 0;
     FSRegDone = TRUE;
     if (Instance->Flags & NOR_FLASH_POLL_FSR) {
       NorFlashSetHostCommand (Instance, SPINOR_OP_RDFSR);
       FSRegDone = (MmioRead8 (Instance->RegionBaseAddress) &
                    SPINOR_FSR_READY) != 0;
+      NorFlashSetHostCommand (Instance, SPINOR_OP_RDSR);
     }
   } while (!SRegDone || !FSRegDone);
-  NorFlashSetHostCommand (Instance, SPINOR_OP_READ_4B);
+}
+
+STATIC
+EFI_STATUS
+NorFlashWaitProgramErase (
+  IN NOR_FLASH_INSTANCE     *Instance
+  )
+{
+  DEBUG ((DEBUG_BLKIO, "NorFlashWaitProgramErase()\n"));
+
+  NorFlashPollProgramErase (Instance);
+  NorFlashSetHostCommand (Instance, NOR_FLASH_READ_OPCODE);
   return EFI_SUCCESS;
 }
 
@@ -548,6 +596,63 @@ NorFlashWriteSingleWord (
   return Status;
 }
 
+/**
+ * Program up to one page with a single write enable and page program cycle.
+ * The range must not cross a page boundary. The device is left with the
+ * status register read sequence selected, so that the pages of a block can
+ * be programmed back to back; the caller restores the read command.
+ **/
+STATIC
+EFI_STATUS
+NorFlashWritePage (
+  IN NOR_FLASH_INSTANCE     *Instance,
+  IN UINTN                  PageAddress,
+  IN CONST UINT32           *DataBuffer,
+  IN UINTN                  SizeInWords
+  )
+{
+  UINTN                 Index;
+
+  DEBUG ((DEBUG_BLKIO,
+    "NorFlashWritePage(PageAddress=0x%08x, SizeInWords=0x%x)\n",
+    PageAddress, SizeInWords));
+
+  ASSERT ((PageAddress % NOR_FLASH_PAGE_SIZE) + SizeInWords * 4 <=
+          NOR_FLASH_PAGE_SIZE);
+
+  if (EFI_ERROR (NorFlashEnableWrite (Instance))) {
+    return EFI_DEVICE_ERROR;
+  }
+  NorFlashSetHostCommand (Instance, SPINOR_OP_PP_4B);
+  for (Index = 0; Index < SizeInWords; Index++) {
+    MmioWrite32 (PageAddress + Index * 4, DataBuffer[Index]);
+  }
+
+  //
+  // The write enable latch is cleared by the device once the page program
+  // completes, so there is no need for an explicit write disable here.
+  //
+  NorFlashPollProgramErase (Instance);
+  return EFI_SUCCESS;
+}
+
+STATIC
+BOOLEAN
+NorFlashIsErased (
+  IN CONST UINT32           *DataBuffer,
+  IN UINTN                  SizeInWords
+  )
+{
+  UINTN                 Index;
+
+  for (Index = 0; Index < SizeInWords; Index++) {
+    if (DataBuffer[Index] != MAX_UINT32) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
 STATIC
 EFI_STATUS
 NorFlashWriteFullBlock (
@@ -559,8 +664,11 @@ NorFlashWriteFullBlock (
 {
   EFI_STATUS              Status;
   UINTN                   WordAddress;
+  UINTN                   PageAddress;
   UINT32                  WordIndex;
+  UINT32                  PageWords;
   UINTN                   BlockAddress;
+  UINTN                   BlockEnd;
   NOR_FLASH_LOCK_CONTEXT  Lock;
 
   Status = EFI_SUCCESS;
@@ -571,6 +679,8 @@ NorFlashWriteFullBlock (
 
   // Start writing from the first address at the start of the block
   WordAddress = BlockAddress;
+  BlockEnd = BlockAddress + BlockSizeInWords * 4;
+  PageWords = NOR_FLASH_PAGE_SIZE / 4;
 
   NorFlashLock (&Lock);
 
@@ -582,12 +692,60 @@ NorFlashWriteFullBlock (
     goto EXIT;
   }
 
-  for (WordIndex=0;
-       WordIndex < BlockSizeInWords;
-       WordIndex++, DataBuffer++, WordAddress += 4) {
-    Status = NorFlashWriteSingleWord (Instance, WordAddress, *DataBuffer);
+  //
+  // Program all pages of the block before switching back to the read
+  // command. Every page still needs its own write enable, as the device
+  // clears the write enable latch at the end of each page program.
+  //
+  for (PageAddress = BlockAddress, WordIndex = 0;
+       PageAddress < BlockEnd;
+       PageAddress += NOR_FLASH_PAGE_SIZE, WordIndex += PageWords) {
+
+    // Pages that are still all 1s after the erase need no programming
+    if (NorFlashIsErased (&DataBuffer[WordIndex], PageWords)) {
+      continue;
+    }
+
+    WordAddress = PageAddress;
+    Status = NorFlashWritePage (Instance, PageAddress, &DataBuffer[WordIndex],
+               PageWords);
     if (EFI_ERROR (Status)) {
-      goto EXIT;
+      break;
+    }
+  }
+
+  NorFlashSetHostCommand (Instance, NOR_FLASH_READ_OPCODE);
+  NorFlashSetHostCSDC (Instance, TRUE, mFip006NullCmdSeq);
+  if (EFI_ERROR (Status)) {
+    goto EXIT;
+  }
+
+  for (PageAddress = BlockAddress;
+       PageAddress < BlockEnd;
+       PageAddress += NOR_FLASH_PAGE_SIZE, DataBuffer += PageWords) {
+
+    if (NorFlashIsErased (DataBuffer, PageWords) ||
+        CompareMem ((VOID *)PageAddress, DataBuffer, NOR_FLASH_PAGE_SIZE) == 0) {
+      continue;
+    }
+
+    //
+    // The controller did not turn the burst into a single page program,
+    // so program this page again word by word. Programming the words that
+    // did make it again is harmless.
+    //
+    DEBUG ((DEBUG_WARN,
+      "NorFlashWriteFullBlock: page program failed at 0x%08x, using word writes\n",
+      PageAddress));
+
+    for (WordIndex = 0, WordAddress = PageAddress;
+         WordIndex < PageWords;
+         WordIndex++, WordAddress += 4) {
+      Status = NorFlashWriteSingleWord (Instance, WordAddress,
+                 DataBuffer[WordIndex]);
+      if (EFI_ERROR (Status)) {
+        goto EXIT;
+      }
     }
   }
 
@@ -722,7 +880,7 @@ NorFlashReadBlocks (
                                         Instance->BlockSize);
 
   // Put the device into Read Array mode
-  NorFlashSetHostCommand (Instance, SPINOR_OP_READ_4B);
+  NorFlashSetHostCommand (Instance, NOR_FLASH_READ_OPCODE);
   NorFlashSetHostCSDC (Instance, TRUE, mFip006NullCmdSeq);
 
   // Readout the data
@@ -764,7 +922,7 @@ NorFlashRead (
                                         Instance->BlockSize);
 
   // Put the device into Read Array mode
-  NorFlashSetHostCommand (Instance, SPINOR_OP_READ_4B);
+  NorFlashSetHostCommand (Instance, NOR_FLASH_READ_OPCODE);
   NorFlashSetHostCSDC (Instance, TRUE, mFip006NullCmdSeq);
 
   // Readout the data
@@ -1000,7 +1158,7 @@ NorFlashReset (
   CsCfg.Reg.SRAM = CS_CFG_SRAM_RW;
   MmioWrite32 (Instance->HostRegisterBaseAddress + FIP006_REG_CS_CFG,
                CsCfg.Raw);
-  NorFlashSetHostCommand (Instance, SPINOR_OP_READ_4B);
+  NorFlashSetHostCommand (Instance, NOR_FLASH_READ_OPCODE);
   NorFlashSetHostCSDC (Instance, TRUE, mFip006NullCmdSeq);
   return EFI_SUCCESS;
 }
@@ -1019,7 +1177,7 @@ NorFlashReadID (
   JedecId[0] = MmioRead8 (Instance->DeviceBaseAddress);
   JedecId[1] = MmioRead8 (Instance->DeviceBaseAddress + 1);
   JedecId[2] = MmioRead8 (Instance->DeviceBaseAddress + 2);
-  NorFlashSetHostCommand (Instance, SPINOR_OP_READ_4B);
+  NorFlashSetHostCommand (Instance, NOR_FLASH_READ_OPCODE);
   return EFI_SUCCESS;
 }
 
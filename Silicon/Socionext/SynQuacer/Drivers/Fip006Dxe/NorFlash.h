@@ -27,6 +27,15 @@
 
 #define NOR_FLASH_ERASE_RETRY                     10
 
+#define NOR_FLASH_PAGE_SIZE                       256
+
+//
+// Values of PcdFip006DxeReadMode
+//
+#define FIP006_READ_MODE_NORMAL                   0
+#define FIP006_READ_MODE_FAST                     1
+#define FIP006_READ_MODE_QUAD                     2
+
 #define GET_NOR_BLOCK_ADDRESS(BaseAddr, Lba, LbaSize) \
                                       ((BaseAddr) + (UINTN)((Lba) * (LbaSize)))
 